@@ -288,6 +288,7 @@ pub fn build(b: *std.Build) !void {
         .enable_runner = b.option(bool, "with_runner", "Build with runner.") orelse false,
         .enable_samples = b.option(bool, "with_samples", "Build with sample modules.") orelse true,
         .enable_test = b.option(bool, "with_test", "Build tests.") orelse false,
+        .enable_bench = b.option(bool, "with_bench", "Run benchmark tests in test step.") orelse false,
 
         .modules = b.option([]const []const u8, "with_module", "build with this modules."),
 
@@ -49,6 +49,7 @@ pub const ByteList = ArrayList(u8);
 pub const AutoArrayHashMap = std.AutoArrayHashMapUnmanaged;
 pub const AutoHashMap = std.AutoHashMapUnmanaged;
 pub const StringHashMap = std.StringHashMapUnmanaged;
+pub const ConcurrentAutoHashMap = @import("kernel/hash_map.zig").ConcurrentAutoHashMap;
 
 // Sets
 const ziglangSet = @import("ziglangSet");
@@ -59,6 +60,7 @@ pub const HashSet = ziglangSet.HashSet;
 const queues = @import("kernel/queue.zig");
 pub const MPMCBoundedQueue = queues.MPMCBoundedQueue;
 pub const QueueWithLock = queues.QueueWithLock;
+pub const WorkStealingDeque = queues.WorkStealingDeque;
 
 // Strings
 pub const string = @import("kernel/string.zig");
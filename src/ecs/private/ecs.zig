@@ -34,7 +34,11 @@ const StrId2Id = cetech1.AutoArrayHashMap(public.IdStrId, public.Id);
 const Id2StrId = cetech1.AutoArrayHashMap(public.Id, public.IdStrId);
 
 const ChangedObjsSet = cetech1.ArraySet(cdb.ObjId);
-const ComponentVersionMap = cetech1.AutoArrayHashMap(cdb.TypeIdx, cdb.TypeVersion);
+const ComponentChanges = struct {
+    consumer: cdb.ChangeConsumer,
+    version: cdb.TypeVersion = 0,
+};
+const ComponentVersionMap = cetech1.AutoArrayHashMap(cdb.TypeIdx, ComponentChanges);
 
 const ObserverMaps = cetech1.AutoArrayHashMap(cetech1.StrId32, public.EntityId);
 
@@ -469,6 +473,8 @@ pub fn init(io: std.Io, allocator: std.mem.Allocator) !void {
     FlecsAllocator.allocator = allocator;
 
     _component_version = .{};
+    _entity_changes = null;
+    _entity_version = 0;
 
     _world_data_lck = .init;
 
@@ -516,6 +522,11 @@ pub fn deinit() void {
 
     // _obj2prefab.deinit(_allocator);
     // _obj2parent_obj.deinit(_allocator);
+
+    // Consumer watermark pin change journal.
+    if (_entity_changes) |consumer| cdb.removeChangeConsumer(consumer);
+    _entity_changes = null;
+    for (_component_version.values()) |changes| cdb.removeChangeConsumer(changes.consumer);
     _component_version.deinit(_allocator);
 
     _world_data.deinit(_allocator);
@@ -531,6 +542,7 @@ fn getPrivateWorldPtr(world: *public.World) *World {
 }
 
 var _component_version: ComponentVersionMap = undefined;
+var _entity_changes: ?cdb.ChangeConsumer = null;
 var _entity_version: cdb.TypeVersion = 0;
 
 // TODO: SHIT!!!!!!
@@ -561,7 +573,13 @@ var sync_changes_from_cdb_task = cetech1.kernel.KernelTaskUpdateI.implment(
 
             // TODO: clean maps on delete components and entities
             {
-                const changed = try cdb.getChangeObjects(alloc, db, public.EntityCdb.typeIdx(db), _entity_version);
+                if (_entity_changes == null) {
+                    _entity_changes = try cdb.addChangeConsumer(db, public.EntityCdb.typeIdx(db));
+                    // Entities are mostly prefab instances.
+                    try cdb.enablePrototypeReadCache(db, public.EntityCdb.typeIdx(db));
+                }
+
+                const changed = try cdb.getConsumerChangeObjects(alloc, _entity_changes.?, _entity_version);
                 defer alloc.free(changed.objects);
                 if (!changed.need_fullscan) {
                     for (changed.objects) |entity_obj| {
@@ -639,9 +657,13 @@ var sync_changes_from_cdb_task = cetech1.kernel.KernelTaskUpdateI.implment(
                 if (iface.cdb_type_hash.isEmpty()) continue;
                 const type_idx = cdb.getTypeIdx(db, iface.cdb_type_hash).?;
 
-                const last_check = _component_version.get(type_idx) orelse 0;
+                if (!_component_version.contains(type_idx)) {
+                    try _component_version.put(_allocator, type_idx, .{ .consumer = try cdb.addChangeConsumer(db, type_idx) });
+                    try cdb.enablePrototypeReadCache(db, type_idx);
+                }
+                const component_changes = _component_version.get(type_idx).?;
 
-                const changed = try cdb.getChangeObjects(alloc, db, type_idx, last_check);
+                const changed = try cdb.getConsumerChangeObjects(alloc, component_changes.consumer, component_changes.version);
                 defer alloc.free(changed.objects);
                 if (!changed.need_fullscan) {
                     for (changed.objects) |component_obj| {
@@ -757,7 +779,7 @@ var sync_changes_from_cdb_task = cetech1.kernel.KernelTaskUpdateI.implment(
                     }
                 }
 
-                try _component_version.put(_allocator, type_idx, changed.last_version);
+                _component_version.getPtr(type_idx).?.version = changed.last_version;
             }
         }
     },
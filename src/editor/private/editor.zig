@@ -56,6 +56,11 @@ const G = struct {
 
     filter_buff: [256:0]u8 = std.mem.zeroes([256:0]u8),
     filter: ?[:0]const u8 = null,
+
+    // Save running in background task, UI only poll progress.
+    save_task: task.TaskID = .none,
+    save_progress: assetdb.SaveProgress = .{},
+    quit_after_save: bool = false,
 };
 var _g: *G = undefined;
 
@@ -442,6 +447,76 @@ fn showObjContextMenu(
     }
 }
 
+fn isSaving() bool {
+    return _g.save_task != .none;
+}
+
+// Save modified assets in background so UI is not blocked by serialization and fsync.
+fn startSaveModified(quit_after_save: bool) !void {
+    if (isSaving()) {
+        _g.quit_after_save = _g.quit_after_save or quit_after_save;
+        return;
+    }
+
+    _g.save_progress = .{};
+    _g.quit_after_save = quit_after_save;
+
+    const Task = struct {
+        pub fn exec(_: *@This()) !void {
+            const allocator = try tempalloc.create();
+            defer tempalloc.destroy(allocator);
+
+            assetdb.saveAllModifiedAssetsWithProgress(allocator, &_g.save_progress) catch |err| {
+                log.err("Could not save assets: {}", .{err});
+            };
+        }
+    };
+
+    _g.save_task = try task.schedule(.none, Task{}, .{});
+}
+
+const modal_save = "Saving###save_progress_modal";
+fn saveProgressModal() !void {
+    if (!isSaving()) return;
+
+    if (task.isDone(_g.save_task)) {
+        _g.save_task = .none;
+
+        const quit = _g.quit_after_save and !_g.save_progress.isCanceled();
+        _g.quit_after_save = false;
+        if (quit) kernel.quit();
+        return;
+    }
+
+    coreui.openPopup(modal_save, .{});
+
+    if (coreui.beginPopupModal(
+        modal_save,
+        .{ .flags = .{
+            .always_auto_resize = true,
+            .no_saved_settings = true,
+        } },
+    )) {
+        defer coreui.endPopup();
+
+        var buff: [128]u8 = undefined;
+        const progress = &_g.save_progress;
+        coreui.text(std.fmt.bufPrint(&buff, "Saving assets {d}/{d} ({d:.0}%)", .{
+            progress.done.load(.acquire),
+            progress.total.load(.acquire),
+            progress.fraction() * 100,
+        }) catch "Saving assets");
+
+        coreui.separator();
+
+        if (progress.isCanceled()) {
+            coreui.text("Canceling...");
+        } else if (coreui.button(coreui.Icons.Nothing ++ "" ++ "Cancel", .{})) {
+            progress.cancel();
+        }
+    }
+}
+
 const modal_quit = "Quit?###quit_unsaved_modal";
 var show_quit_modal = false;
 fn quitSaveModal() !void {
@@ -462,11 +537,7 @@ fn quitSaveModal() !void {
             show_quit_modal = false;
             coreui.closeCurrentPopup();
 
-            const allocator = tempalloc.create() catch undefined;
-            defer tempalloc.destroy(allocator);
-
-            try assetdb.saveAllModifiedAssets(allocator);
-            kernel.quit();
+            try startSaveModified(true);
         }
 
         coreui.sameLine(.{});
@@ -492,6 +563,12 @@ fn quitSaveModal() !void {
 }
 
 fn tryQuit() void {
+    // Quit when running save is done.
+    if (isSaving()) {
+        _g.quit_after_save = true;
+        return;
+    }
+
     if (assetdb.isProjectModified()) {
         show_quit_modal = true;
     } else {
@@ -536,8 +613,8 @@ fn doMainMenu(allocator: std.mem.Allocator) !void {
                 task.wait(t);
             }
 
-            if (coreui.menuItem(allocator, coreui.Icons.SaveAll ++ "  " ++ "Save all", .{ .enabled = assetdb.isProjectOpened() and assetdb.isProjectModified() }, null)) {
-                try assetdb.saveAllModifiedAssets(allocator);
+            if (coreui.menuItem(allocator, coreui.Icons.SaveAll ++ "  " ++ "Save all", .{ .enabled = assetdb.isProjectOpened() and assetdb.isProjectModified() and !isSaving() }, null)) {
+                try startSaveModified(false);
             }
 
             if (coreui.menuItem(allocator, coreui.Icons.SaveAll ++ "  " ++ "Save project as", .{ .enabled = host.supportFileDialog() }, null)) {
@@ -629,6 +706,7 @@ var coreui_ui_i = coreui.CoreUII.implement(struct {
 
         try doMainMenu(allocator);
         try quitSaveModal();
+        try saveProgressModal();
         try editor_tabs.doTabs(allocator, kernel_tick, dt);
 
         if (_g.show_demos) coreui.showDemoWindow();
@@ -113,6 +113,11 @@ pub const AssetIOI = struct {
         reimport_to: ?cdb.ObjId,
     ) anyerror!task.TaskID,
 
+    /// Importer output version for import cache.
+    /// If set, import of file is skipped when file content and this version are same as in last successful import.
+    /// Bump it when importer produce different output from same source.
+    import_cache_version: ?u32 = null,
+
     /// Crete export asset task.
     export_asset: ?*const fn (
         io: std.Io,
@@ -129,6 +134,7 @@ pub const AssetIOI = struct {
         const hasCanImport = std.meta.hasFn(T, "canImport");
         const hasCanReimport = std.meta.hasFn(T, "canReimport");
         const hasCanExport = std.meta.hasFn(T, "canExport");
+        const hasImportCacheVersion = @hasDecl(T, "import_cache_version");
 
         if (!hasExport and !hasImport) {
             @compileError("AssetIOI must have least one of importAsset, exportAsset");
@@ -139,6 +145,7 @@ pub const AssetIOI = struct {
             .can_reimport = if (hasCanReimport) T.canReimport else null,
             .can_export = if (hasCanExport) T.canExport else null,
             .import_asset = if (hasImport) T.importAsset else null,
+            .import_cache_version = if (hasImportCacheVersion) T.import_cache_version else null,
             .export_asset = if (hasExport) T.exportAsset else null,
         };
     }
@@ -156,6 +163,30 @@ pub const FilteredAsset = struct {
 
 pub const FilteredAssets = []FilteredAsset;
 
+/// Progress and cancel of saving assets.
+/// Counters are updated from worker tasks so it can be read from other thread while saving.
+pub const SaveProgress = struct {
+    total: std.atomic.Value(usize) = .init(0),
+    done: std.atomic.Value(usize) = .init(0),
+    canceled: std.atomic.Value(bool) = .init(false),
+
+    /// Stop saving. Assets that are not written stay modified and nothing on disk is replaced.
+    pub fn cancel(self: *SaveProgress) void {
+        self.canceled.store(true, .release);
+    }
+
+    pub fn isCanceled(self: *const SaveProgress) bool {
+        return self.canceled.load(.acquire);
+    }
+
+    /// Saved part in range 0..1.
+    pub fn fraction(self: *const SaveProgress) f32 {
+        const total = self.total.load(.acquire);
+        if (total == 0) return 1;
+        return @as(f32, @floatFromInt(self.done.load(.acquire))) / @as(f32, @floatFromInt(total));
+    }
+};
+
 pub const AssetRootI = struct {
     const Self = @This();
 
@@ -186,8 +217,8 @@ pub const AssetRootI = struct {
     pub fn saveAll(self: Self, io: std.Io, allocator: std.mem.Allocator) !void {
         return self.vtable.saveAll(self.inst, io, allocator);
     }
-    pub fn saveAllModifiedAssets(self: Self, io: std.Io, allocator: std.mem.Allocator) !void {
-        return self.vtable.saveAllModifiedAssets(self.inst, io, allocator);
+    pub fn saveAllModifiedAssets(self: Self, io: std.Io, allocator: std.mem.Allocator, progress: ?*SaveProgress) !void {
+        return self.vtable.saveAllModifiedAssets(self.inst, io, allocator, progress);
     }
     pub fn saveAsAllAssets(self: Self, io: std.Io, allocator: std.mem.Allocator, path: []const u8) !void {
         return self.vtable.saveAsAllAssets(self.inst, io, allocator, path);
@@ -210,6 +241,9 @@ pub const AssetRootI = struct {
     pub fn openAssetRootFolder(self: Self, io: std.Io, asset_root_path: []const u8, allocator: std.mem.Allocator) !void {
         return self.vtable.openAssetRootFolder(self.inst, io, asset_root_path, allocator);
     }
+    pub fn cookSnapshot(self: Self, io: std.Io, asset_root_path: []const u8, allocator: std.mem.Allocator) !void {
+        return self.vtable.cookSnapshot(self.inst, io, asset_root_path, allocator);
+    }
     pub fn saveAsset(self: Self, io: std.Io, allocator: std.mem.Allocator, root_path: []const u8, asset: cdb.ObjId) !cetech1.task.TaskID {
         return self.vtable.saveAsset(self.inst, io, allocator, root_path, asset);
     }
@@ -240,7 +274,7 @@ pub const AssetRootI = struct {
         reviveDeleted: *const fn (self: *anyopaque, asset_or_folder: cdb.ObjId) void,
         getAssetUuid: *const fn (self: *anyopaque, io: std.Io, path: []const u8) ?uuid.Uuid,
         saveAll: *const fn (self: *anyopaque, io: std.Io, allocator: std.mem.Allocator) anyerror!void,
-        saveAllModifiedAssets: *const fn (self: *anyopaque, io: std.Io, allocator: std.mem.Allocator) anyerror!void,
+        saveAllModifiedAssets: *const fn (self: *anyopaque, io: std.Io, allocator: std.mem.Allocator, progress: ?*SaveProgress) anyerror!void,
         saveAsAllAssets: *const fn (self: *anyopaque, io: std.Io, allocator: std.mem.Allocator, path: []const u8) anyerror!void,
         markObjSaved: *const fn (self: *anyopaque, io: std.Io, objdi: cdb.ObjId, version: u64) void,
         isProjectOpened: *const fn (self: *anyopaque) bool,
@@ -248,6 +282,7 @@ pub const AssetRootI = struct {
         getRootFolder: *const fn (self: *anyopaque) cdb.ObjId,
         addAssetToRoot: *const fn (self: *anyopaque, io: std.Io, asset: cdb.ObjId) anyerror!void,
         openAssetRootFolder: *const fn (self: *anyopaque, io: std.Io, asset_root_path: []const u8, allocator: std.mem.Allocator) anyerror!void,
+        cookSnapshot: *const fn (self: *anyopaque, io: std.Io, asset_root_path: []const u8, allocator: std.mem.Allocator) anyerror!void,
         saveAsset: *const fn (self: *anyopaque, io: std.Io, allocator: std.mem.Allocator, root_path: []const u8, asset: cdb.ObjId) anyerror!cetech1.task.TaskID,
         saveFolderObj: *const fn (self: *anyopaque, io: std.Io, allocator: std.mem.Allocator, folder_asset: cdb.ObjId, root_path: []const u8) anyerror!void,
         getAssetRootPath: *const fn (self: *anyopaque) ?[]const u8,
@@ -272,6 +307,7 @@ pub const AssetRootI = struct {
                 .getRootFolder = @ptrCast(&T.getRootFolder),
                 .addAssetToRoot = @ptrCast(&T.addAssetToRoot),
                 .openAssetRootFolder = @ptrCast(&T.openAssetRootFolder),
+                .cookSnapshot = @ptrCast(&T.cookSnapshot),
                 .saveAsset = @ptrCast(&T.saveAsset),
                 .saveFolderObj = @ptrCast(&T.saveFolderObj),
                 .getAssetRootPath = @ptrCast(&T.getAssetRootPath),
@@ -312,6 +348,12 @@ pub inline fn openAssetRootFolder(asset_root_path: []const u8, allocator: std.me
     try api.openAssetRootFolder(asset_root_path, allocator);
 }
 
+/// Cook binary snapshot of all assets in asset root.
+/// Next open of asset root load unchanged assets from snapshot instead of parsing json.
+pub inline fn cookAssetRootSnapshot(asset_root_path: []const u8, allocator: std.mem.Allocator) !void {
+    try api.cookAssetRootSnapshot(asset_root_path, allocator);
+}
+
 /// Get root folder object.
 pub inline fn getRootFolder() cdb.ObjId {
     return api.getRootFolder();
@@ -339,7 +381,14 @@ pub inline fn saveAllAssets(allocator: std.mem.Allocator) !void {
 
 /// Save only modified assets.
 pub inline fn saveAllModifiedAssets(allocator: std.mem.Allocator) !void {
-    return api.saveAllModifiedAssets(allocator);
+    return api.saveAllModifiedAssets(allocator, null);
+}
+
+/// Save only modified assets and report progress.
+/// Saving can be canceled with `progress.cancel()` from other thread.
+/// Canceled save does not touch asset files, renames and moves are done only when save is not canceled.
+pub inline fn saveAllModifiedAssetsWithProgress(allocator: std.mem.Allocator, progress: *SaveProgress) !void {
+    return api.saveAllModifiedAssets(allocator, progress);
 }
 
 /// Save asset.
@@ -472,12 +521,13 @@ pub const AssetDBAPI = struct {
     createAsset: *const fn (asset_name: []const u8, asset_folder: cdb.ObjId, asset_obj: ?cdb.ObjId) ?cdb.ObjId,
     createImportedAsset: *const fn (asset_name: []const u8, asset_folder: cdb.ObjId, asset_obj: cdb.ObjId, imported_from: []const u8) ?cdb.ObjId,
     openAssetRootFolder: *const fn (asset_root_path: []const u8, allocator: std.mem.Allocator) anyerror!void,
+    cookAssetRootSnapshot: *const fn (asset_root_path: []const u8, allocator: std.mem.Allocator) anyerror!void,
     getRootFolder: *const fn () cdb.ObjId,
 
     isAssetModified: *const fn (asset: cdb.ObjId) bool,
     isProjectModified: *const fn () bool,
     saveAllAssets: *const fn (allocator: std.mem.Allocator) anyerror!void,
-    saveAllModifiedAssets: *const fn (allocator: std.mem.Allocator) anyerror!void,
+    saveAllModifiedAssets: *const fn (allocator: std.mem.Allocator, progress: ?*SaveProgress) anyerror!void,
     saveAsset: *const fn (allocator: std.mem.Allocator, asset: cdb.ObjId) anyerror!void,
     getTmpPath: *const fn ([]u8) anyerror!?[]u8,
 
@@ -90,6 +90,14 @@ pub const ChangedObjects = struct {
     objects: []ObjId,
 };
 
+/// Registered reader of type changes.
+/// Changes are kept until every consumer of type read them, consumer that fall behind whole journal get need_fullscan.
+pub const ChangeConsumer = struct {
+    db: DbId,
+    type_idx: TypeIdx,
+    idx: u32,
+};
+
 /// Opaqueue Object used for read/write operation
 pub const Obj = anyopaque;
 
@@ -373,6 +381,31 @@ pub inline fn writeCommit(writer: *Obj) !void {
     return api.writeCommit(writer);
 }
 
+/// Batch of writers committed together.
+pub const Transaction = anyopaque;
+
+/// Begin transaction. Transactions are pooled per thread.
+pub inline fn beginTransaction(db: DbId) !*Transaction {
+    return api.beginTransaction(db);
+}
+
+/// Get object writer owned by transaction. Writing same object again return same writer.
+pub inline fn transactionWriteObj(tx: *Transaction, obj: ObjId) ?*Obj {
+    return api.transactionWriteObj(tx, obj);
+}
+
+/// Commit all writers with one version increase and one changed objects entry per type.
+/// Transaction is released even if commit fail. Error before swap abort all writers, error from
+/// version propagation keep writers committed and instances/parents are updated on next gc.
+pub inline fn commitTransaction(tx: *Transaction) !void {
+    return api.commitTransaction(tx);
+}
+
+/// Drop all writers without commit.
+pub inline fn abortTransaction(tx: *Transaction) void {
+    api.abortTransaction(tx);
+}
+
 /// Retarget writer to another objid. Still need call commit
 pub inline fn retargetWrite(writer: *Obj, obj: ObjId) !void {
     return api.retargetWrite(writer, obj);
@@ -627,6 +660,18 @@ pub inline fn gc(allocator: std.mem.Allocator, db: DbId) !void {
     return try api.gc(db, allocator);
 }
 
+// Cache object that hold value for reads through prototypes so deep prototype chain cost one lookup.
+// Cache is invalidated by object version. Enable it before objects of type are read from more threads.
+pub inline fn enablePrototypeReadCache(db: DbId, type_idx: TypeIdx) !void {
+    return api.enablePrototypeReadCache(db, type_idx);
+}
+
+// Propagate versions to prototype instances and parents once per gc instead of on every commit.
+// Commited object version is increased immediately, instances and parents see new version after next gc.
+pub inline fn setDeferredVersionPropagation(db: DbId, enabled: bool) !void {
+    return api.setDeferredVersionPropagation(db, enabled);
+}
+
 /// Create object for type hash (create default object if exist)
 pub inline fn createObject(db: DbId, type_idx: TypeIdx) anyerror!ObjId {
     return api.createObject(db, type_idx);
@@ -674,10 +719,24 @@ pub inline fn getTypeHash(db: DbId, type_idx: TypeIdx) ?TypeHash {
     return api.getTypeHash(db, type_idx);
 }
 
+/// Result request fullscan if changes since since_version are no longer in journal, compacted or lost.
 pub inline fn getChangeObjects(allocator: std.mem.Allocator, db: DbId, type_idx: TypeIdx, since_version: TypeVersion) !ChangedObjects {
     return api.getChangeObjects(db, allocator, type_idx, since_version);
 }
 
+/// Same as getChangeObjects but move consumer watermark to since_version so older changes can be compacted.
+pub inline fn getConsumerChangeObjects(allocator: std.mem.Allocator, consumer: ChangeConsumer, since_version: TypeVersion) !ChangedObjects {
+    return api.getConsumerChangeObjects(allocator, consumer, since_version);
+}
+
+pub inline fn addChangeConsumer(db: DbId, type_idx: TypeIdx) !ChangeConsumer {
+    return api.addChangeConsumer(db, type_idx);
+}
+
+pub inline fn removeChangeConsumer(consumer: ChangeConsumer) void {
+    api.removeChangeConsumer(consumer);
+}
+
 pub inline fn getDefaultObject(db: DbId, type_idx: TypeIdx) ?ObjId {
     return api.getDefaultObject(db, type_idx);
 }
@@ -808,6 +867,9 @@ pub const CdbAPI = struct {
     hasTypeSubobject: *const fn (db: DbId, type_idx: TypeIdx) bool,
     getTypeHash: *const fn (db: DbId, type_idx: TypeIdx) ?TypeHash,
     getChangeObjects: *const fn (db: DbId, allocator: std.mem.Allocator, type_idx: TypeIdx, since_version: TypeVersion) anyerror!ChangedObjects,
+    getConsumerChangeObjects: *const fn (allocator: std.mem.Allocator, consumer: ChangeConsumer, since_version: TypeVersion) anyerror!ChangedObjects,
+    addChangeConsumer: *const fn (db: DbId, type_idx: TypeIdx) anyerror!ChangeConsumer,
+    removeChangeConsumer: *const fn (consumer: ChangeConsumer) void,
     getDefaultObject: *const fn (db: DbId, type_idx: TypeIdx) ?ObjId,
     getFirstObject: *const fn (db: DbId, type_idx: TypeIdx) ObjId,
     getAllObjectByType: *const fn (db: DbId, allocator: std.mem.Allocator, type_idx: TypeIdx) ?[]ObjId,
@@ -818,6 +880,12 @@ pub const CdbAPI = struct {
     getTypePropDef: *const fn (db: DbId, type_idx: TypeIdx) ?[]const PropDef,
     getTypePropDefIdx: *const fn (db: DbId, type_idx: TypeIdx, prop_name: []const u8) ?u32,
     gc: *const fn (db: DbId, allocator: std.mem.Allocator) anyerror!void,
+    setDeferredVersionPropagation: *const fn (db: DbId, enabled: bool) anyerror!void,
+    beginTransaction: *const fn (db: DbId) anyerror!*Transaction,
+    transactionWriteObj: *const fn (tx: *Transaction, obj: ObjId) ?*Obj,
+    commitTransaction: *const fn (tx: *Transaction) anyerror!void,
+    abortTransaction: *const fn (tx: *Transaction) void,
+    enablePrototypeReadCache: *const fn (db: DbId, type_idx: TypeIdx) anyerror!void,
     dump: *const fn (db: DbId) anyerror!void,
 
     getObjId: *const fn (dbidx: DbId, obj_uuid: uuid.Uuid) ?ObjId,
@@ -88,6 +88,22 @@ pub fn DAG(comptime T: type) type {
             }
         }
 
+        // Remove node and its edges to dependencies, nodes that depend on it keep their edges.
+        // Output is valid only after next build_all.
+        pub fn remove(self: *Self, name: T) void {
+            if (self.depends_on.fetchSwapRemove(name)) |kv| {
+                for (kv.value.keys()) |dep| {
+                    if (self.graph.getPtr(dep)) |dep_arr| _ = dep_arr.swapRemove(name);
+                }
+            }
+
+            if (self.graph.get(name)) |dep_arr| {
+                if (dep_arr.count() == 0) _ = self.graph.swapRemove(name);
+            }
+
+            _ = self.output.orderedRemove(name);
+        }
+
         // Build for all root nodes
         pub fn build_all(self: *Self) !void {
             const allocator = self.arena.allocator();
@@ -188,4 +204,34 @@ test "Can build and resolve graph2" {
 
     try std.testing.expectEqualSlices(u64, &[_]u64{ 4, 1, 2, 3 }, bag.output.keys());
 }
+
+test "Can patch graph" {
+    const allocator = std.testing.allocator;
+    var bag = DAG(u64).init(allocator);
+    defer bag.deinit();
+
+    try bag.add(1, &[_]u64{});
+    try bag.add(2, &[_]u64{1});
+    try bag.add(3, &[_]u64{2});
+
+    try bag.build_all();
+
+    // 2 no longer depend on 1 but on new 4.
+    bag.remove(2);
+    try bag.add(2, &[_]u64{4});
+    try bag.add(4, &[_]u64{});
+
+    try std.testing.expectEqualSlices(u64, &[_]u64{4}, bag.dependList(2).?);
+    try std.testing.expect(!bag.graph.get(1).?.contains(2));
+
+    // Removed leaf is gone from graph.
+    bag.remove(3);
+    try std.testing.expect(!bag.graph.contains(3));
+    try std.testing.expect(!bag.output.contains(3));
+
+    bag.output.clearRetainingCapacity();
+    try bag.build_all();
+    try std.testing.expectEqual(@as(usize, 3), bag.output.count());
+    try std.testing.expect(bag.output.getIndex(4).? < bag.output.getIndex(2).?);
+}
 //#endregion
@@ -164,7 +164,7 @@ pub const FrustumPlanes = struct {
         };
 
         for (&points) |*p| {
-            p.* = transform.mulVec(.fromF32x4(p.*)).toF32x4();
+            p.* = transform.mulVec(.fromF32x4(p.*)).add(transform.position).toF32x4();
         }
 
         for (0..6) |idx| {
@@ -173,7 +173,7 @@ pub const FrustumPlanes = struct {
             const plane_normal = self.p[idx].v;
 
             for (points) |point| {
-                if (zm.dot3(point, plane_normal)[0] > 0) {
+                if (zm.dot3(point, plane_normal)[0] + plane_normal[3] > 0) {
                     inside = true;
                     break;
                 }
@@ -0,0 +1,323 @@
+const std = @import("std");
+
+/// Concurrent hash map for small plain keys and values.
+///
+/// Keys are spread by hash to `shard_count` shards and every shard has own writer lock,
+/// so writers with different keys rarely meet on same mutex.
+/// Reads never lock: slot is published by release store of its state
+/// and published key/value is never rewritten. Removed slot become tombstone until shard is rehashed.
+///
+/// Readers announce itself in shard reader counter while they walk table. Counter has own cache line
+/// so readers do not bounce line with writer lock.
+/// Rehash swap shard table and free old one right away if shard has no reader, otherwise table is retired
+/// and `reclaim()` free it when its shard is seen without reader. No frame or thread assumption is needed.
+pub fn ConcurrentAutoHashMap(comptime K: type, comptime V: type, comptime shard_count: usize) type {
+    comptime std.debug.assert(std.math.isPowerOfTwo(shard_count));
+
+    return struct {
+        const Self = @This();
+
+        const min_capacity = 16;
+        const shard_bits: comptime_int = std.math.log2_int(usize, shard_count);
+
+        const hashFn = std.hash_map.getAutoHashFn(K, void);
+        const eqlFn = std.hash_map.getAutoEqlFn(K, void);
+
+        const SlotState = enum(u8) { empty, full, removed };
+
+        const Slot = struct {
+            state: std.atomic.Value(SlotState),
+            key: K,
+            value: V,
+        };
+
+        const Table = struct {
+            slots: []Slot,
+        };
+
+        const Retired = struct {
+            table: *Table,
+            shard_idx: usize,
+        };
+        const RetiredList = std.ArrayList(Retired);
+
+        const Shard = struct {
+            table: std.atomic.Value(?*Table) align(std.atomic.cache_line) = .init(null),
+            lock: std.Io.Mutex = .init,
+
+            // Readers walking table now.
+            readers: std.atomic.Value(usize) align(std.atomic.cache_line) = .init(0),
+
+            // Full slots.
+            count: usize = 0,
+
+            // Full and removed slots.
+            used: usize = 0,
+        };
+
+        shards: [shard_count]Shard = [_]Shard{.{}} ** shard_count,
+
+        retired_lock: std.Io.Mutex = .init,
+        retired: RetiredList = .empty,
+
+        pub const empty: Self = .{};
+
+        pub fn deinit(self: *Self, allocator: std.mem.Allocator) void {
+            for (&self.shards) |*shard| {
+                if (shard.table.raw) |table| freeTable(allocator, table);
+            }
+
+            for (self.retired.items) |retired| freeTable(allocator, retired.table);
+            self.retired.deinit(allocator);
+        }
+
+        pub fn get(self: *Self, key: K) ?V {
+            const hash = hashFn({}, key);
+            const shard = &self.shards[shardIdx(hash)];
+
+            // Announce before table load. Rehash check readers with RMW after it store new table,
+            // reader not counted by that check synchronize with it and load new table.
+            _ = shard.readers.fetchAdd(1, .acquire);
+            defer _ = shard.readers.fetchSub(1, .release);
+
+            const table = shard.table.load(.acquire) orelse return null;
+
+            const mask = table.slots.len - 1;
+            var idx = slotIdx(hash, mask);
+            for (0..table.slots.len) |_| {
+                const slot = &table.slots[idx];
+                switch (slot.state.load(.acquire)) {
+                    .empty => return null,
+                    .full => if (eqlFn({}, slot.key, key)) return slot.value,
+                    .removed => {},
+                }
+                idx = (idx + 1) & mask;
+            }
+            return null;
+        }
+
+        pub fn contains(self: *Self, key: K) bool {
+            return self.get(key) != null;
+        }
+
+        /// Insert or replace value for key.
+        pub fn put(self: *Self, io: std.Io, allocator: std.mem.Allocator, key: K, value: V) !void {
+            const hash = hashFn({}, key);
+            const shard = &self.shards[shardIdx(hash)];
+
+            shard.lock.lockUncancelable(io);
+            defer shard.lock.unlock(io);
+
+            try self.ensureUnusedCapacity(io, allocator, shard);
+            const table = shard.table.raw.?;
+
+            // New slot is after old in probe sequence so readers see old value until it is removed.
+            const old_slot = findFull(table, hash, key);
+            insertAssumeCapacity(table, hash, key, value);
+            shard.used += 1;
+
+            if (old_slot) |slot| {
+                slot.state.store(.removed, .release);
+            } else {
+                shard.count += 1;
+            }
+        }
+
+        /// Insert value if key is not in map.
+        /// Return existing value if key exists.
+        pub fn putIfAbsent(self: *Self, io: std.Io, allocator: std.mem.Allocator, key: K, value: V) !?V {
+            const hash = hashFn({}, key);
+            const shard = &self.shards[shardIdx(hash)];
+
+            shard.lock.lockUncancelable(io);
+            defer shard.lock.unlock(io);
+
+            if (shard.table.raw) |table| {
+                if (findFull(table, hash, key)) |slot| return slot.value;
+            }
+
+            try self.ensureUnusedCapacity(io, allocator, shard);
+            insertAssumeCapacity(shard.table.raw.?, hash, key, value);
+            shard.used += 1;
+            shard.count += 1;
+            return null;
+        }
+
+        pub fn fetchRemove(self: *Self, io: std.Io, key: K) ?V {
+            const hash = hashFn({}, key);
+            const shard = &self.shards[shardIdx(hash)];
+
+            shard.lock.lockUncancelable(io);
+            defer shard.lock.unlock(io);
+
+            const table = shard.table.raw orelse return null;
+            const slot = findFull(table, hash, key) orelse return null;
+            slot.state.store(.removed, .release);
+            shard.count -= 1;
+            return slot.value;
+        }
+
+        pub fn remove(self: *Self, io: std.Io, key: K) bool {
+            return self.fetchRemove(io, key) != null;
+        }
+
+        /// Number of keys. Shards are counted one by one so it is not snapshot under concurrent writes.
+        pub fn count(self: *Self, io: std.Io) usize {
+            var result: usize = 0;
+            for (&self.shards) |*shard| {
+                shard.lock.lockUncancelable(io);
+                defer shard.lock.unlock(io);
+                result += shard.count;
+            }
+            return result;
+        }
+
+        /// Free retired tables whose shard has no reader now. Rest stay for next reclaim.
+        pub fn reclaim(self: *Self, io: std.Io, allocator: std.mem.Allocator) void {
+            self.retired_lock.lockUncancelable(io);
+            defer self.retired_lock.unlock(io);
+
+            var idx: usize = 0;
+            while (idx < self.retired.items.len) {
+                const retired = self.retired.items[idx];
+                if (self.shards[retired.shard_idx].readers.load(.acquire) != 0) {
+                    idx += 1;
+                    continue;
+                }
+                freeTable(allocator, retired.table);
+                _ = self.retired.swapRemove(idx);
+            }
+        }
+
+        /// Number of tables waiting for reclaim.
+        pub fn retiredCount(self: *Self, io: std.Io) usize {
+            self.retired_lock.lockUncancelable(io);
+            defer self.retired_lock.unlock(io);
+            return self.retired.items.len;
+        }
+
+        inline fn shardIdx(hash: u64) usize {
+            if (shard_bits == 0) return 0 else return @intCast(hash >> (64 - shard_bits));
+        }
+
+        inline fn slotIdx(hash: u64, mask: usize) usize {
+            return @as(usize, @truncate(hash)) & mask;
+        }
+
+        fn findFull(table: *Table, hash: u64, key: K) ?*Slot {
+            const mask = table.slots.len - 1;
+            var idx = slotIdx(hash, mask);
+            for (0..table.slots.len) |_| {
+                const slot = &table.slots[idx];
+                switch (slot.state.raw) {
+                    .empty => return null,
+                    .full => if (eqlFn({}, slot.key, key)) return slot,
+                    .removed => {},
+                }
+                idx = (idx + 1) & mask;
+            }
+            return null;
+        }
+
+        // Removed slots are never reused, readers could see new key with old state.
+        fn insertAssumeCapacity(table: *Table, hash: u64, key: K, value: V) void {
+            const mask = table.slots.len - 1;
+            var idx = slotIdx(hash, mask);
+            while (table.slots[idx].state.raw != .empty) idx = (idx + 1) & mask;
+
+            const slot = &table.slots[idx];
+            slot.key = key;
+            slot.value = value;
+            slot.state.store(.full, .release);
+        }
+
+        // Keep load factor (with tombstones) under 3/4 so probing always hit empty slot.
+        fn ensureUnusedCapacity(self: *Self, io: std.Io, allocator: std.mem.Allocator, shard: *Shard) !void {
+            const old_table = shard.table.raw orelse {
+                shard.table.store(try allocTable(allocator, min_capacity), .release);
+                return;
+            };
+
+            if ((shard.used + 1) * 4 <= old_table.slots.len * 3) return;
+
+            const new_len = @max(min_capacity, try std.math.ceilPowerOfTwo(usize, (shard.count + 1) * 2));
+            const new_table = try allocTable(allocator, new_len);
+            errdefer freeTable(allocator, new_table);
+
+            for (old_table.slots) |*slot| {
+                if (slot.state.raw != .full) continue;
+                insertAssumeCapacity(new_table, hashFn({}, slot.key), slot.key, slot.value);
+            }
+
+            // Retire list is locked through swap so reserved slot can not be taken by other shard.
+            self.retired_lock.lockUncancelable(io);
+            defer self.retired_lock.unlock(io);
+            try self.retired.ensureUnusedCapacity(allocator, 1);
+
+            shard.table.store(new_table, .release);
+            shard.used = shard.count;
+
+            // RMW read latest counter. Reader that is not counted here increment after it and load new table.
+            if (shard.readers.fetchAdd(0, .acq_rel) == 0) {
+                freeTable(allocator, old_table);
+                return;
+            }
+
+            const shard_idx = (@intFromPtr(shard) - @intFromPtr(&self.shards)) / @sizeOf(Shard);
+            self.retired.appendAssumeCapacity(.{ .table = old_table, .shard_idx = shard_idx });
+        }
+
+        fn allocTable(allocator: std.mem.Allocator, len: usize) !*Table {
+            const table = try allocator.create(Table);
+            errdefer allocator.destroy(table);
+
+            table.slots = try allocator.alloc(Slot, len);
+            for (table.slots) |*slot| slot.state = .init(.empty);
+            return table;
+        }
+
+        fn freeTable(allocator: std.mem.Allocator, table: *Table) void {
+            allocator.free(table.slots);
+            allocator.destroy(table);
+        }
+    };
+}
+
+test "ConcurrentAutoHashMap: put, replace, remove and rehash" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var map: ConcurrentAutoHashMap(u64, u64, 4) = .empty;
+    defer map.deinit(allocator);
+
+    const key_count = 1000;
+
+    for (0..key_count) |key| try map.put(io, allocator, key, key * 2);
+    try std.testing.expectEqual(@as(usize, key_count), map.count(io));
+
+    for (0..key_count) |key| try std.testing.expectEqual(@as(?u64, key * 2), map.get(key));
+    try std.testing.expectEqual(@as(?u64, null), map.get(key_count));
+
+    // Replace
+    try map.put(io, allocator, 1, 42);
+    try std.testing.expectEqual(@as(?u64, 42), map.get(1));
+    try std.testing.expectEqual(@as(usize, key_count), map.count(io));
+
+    // Keep existing
+    try std.testing.expectEqual(@as(?u64, 42), try map.putIfAbsent(io, allocator, 1, 0));
+    try std.testing.expectEqual(@as(?u64, null), try map.putIfAbsent(io, allocator, key_count, 0));
+
+    // Remove and reinsert many times to rehash over tombstones
+    for (0..10) |_| {
+        for (0..key_count) |key| try std.testing.expect(map.remove(io, key));
+        try std.testing.expectEqual(@as(?u64, null), map.get(0));
+        for (0..key_count) |key| try map.put(io, allocator, key, key);
+        map.reclaim(io, allocator);
+    }
+
+    // Without reader old tables are freed on rehash or reclaim.
+    try std.testing.expectEqual(@as(usize, 0), map.retiredCount(io));
+
+    for (0..key_count) |key| try std.testing.expectEqual(@as(?u64, key), map.get(key));
+    try std.testing.expectEqual(@as(usize, key_count + 1), map.count(io));
+}
@@ -113,6 +113,9 @@ pub fn VirtualArray(comptime T: type) type {
         max_items: usize,
         items: []T,
 
+        // High-water mark of items reported by notifyAlloc.
+        used_items: std.atomic.Value(usize) = .init(0),
+
         pub fn init(max_items: usize) !Self {
             var new = Self{
                 .max_items = max_items,
@@ -175,13 +178,18 @@ pub fn VirtualArray(comptime T: type) type {
             self.reservation = &[_]u8{};
         }
 
+        /// Bytes backed by physical memory.
+        /// Windows commit whole reservation, elsewhere pages are committed on first touch so it's
+        /// page aligned high-water mark of allocated items.
         pub fn committed(self: *Self) usize {
-            return self.reservation.len - self.uncommitted;
+            if (builtin.os.tag == .windows) return self.reservation.len;
+
+            const used_bytes = self.used_items.load(.monotonic) * @sizeOf(T);
+            return @min(self.reservation.len, std.mem.alignForward(usize, used_bytes, std.heap.page_size_min));
         }
 
         pub fn notifyAlloc(self: *Self, num_items: usize) !void {
-            _ = self;
-            _ = num_items;
+            _ = self.used_items.fetchAdd(num_items, .monotonic);
         }
     };
 }
@@ -300,6 +308,255 @@ pub fn VirtualPool(comptime T: type) type {
     };
 }
 
+/// Growable array with stable item addresses and without max size.
+/// Chunk N hold `first_chunk_items << N` items so index lookup is one log2 and chunks are allocated only when needed.
+/// Every index hold `stride` items (stride is fixed at init) so variable sized records stay contiguous.
+/// Readers are lock-free, index must be ensured before first access.
+pub fn ChunkedArray(comptime T: type) type {
+    return struct {
+        const Self = @This();
+
+        pub const first_chunk_items = 1024;
+        const max_chunks = @bitSizeOf(usize) - std.math.log2_int(usize, first_chunk_items);
+
+        const Location = struct {
+            chunk: usize,
+            offset: usize,
+        };
+
+        allocator: std.mem.Allocator,
+        stride: usize,
+        chunks: [max_chunks]std.atomic.Value(?[*]T) = @splat(.init(null)),
+        committed_bytes: std.atomic.Value(usize) = .init(0),
+
+        pub fn init(allocator: std.mem.Allocator, stride: usize) Self {
+            return .{
+                .allocator = allocator,
+                .stride = stride,
+            };
+        }
+
+        pub fn deinit(self: *Self) void {
+            for (&self.chunks, 0..) |*chunk, chunk_idx| {
+                const ptr = chunk.load(.monotonic) orelse continue;
+                self.allocator.free(ptr[0 .. chunkItems(chunk_idx) * self.stride]);
+                chunk.store(null, .monotonic);
+            }
+            self.committed_bytes.store(0, .monotonic);
+        }
+
+        inline fn chunkItems(chunk_idx: usize) usize {
+            return @as(usize, first_chunk_items) << @intCast(chunk_idx);
+        }
+
+        inline fn locate(idx: usize) Location {
+            const chunk_idx = std.math.log2_int(usize, idx / first_chunk_items + 1);
+            const chunk_begin = ((@as(usize, 1) << @intCast(chunk_idx)) - 1) * first_chunk_items;
+            return .{ .chunk = chunk_idx, .offset = idx - chunk_begin };
+        }
+
+        /// Make index accessible. Thread-safe.
+        pub fn ensure(self: *Self, idx: usize) !void {
+            const loc = locate(idx);
+            if (self.chunks[loc.chunk].load(.acquire) != null) return;
+
+            if (self.stride == 0) return;
+
+            const len = chunkItems(loc.chunk) * self.stride;
+            const new_chunk = try self.allocator.alloc(T, len);
+
+            // Same as fresh virtual memory.
+            @memset(std.mem.sliceAsBytes(new_chunk), 0);
+
+            if (self.chunks[loc.chunk].cmpxchgStrong(null, new_chunk.ptr, .acq_rel, .acquire) != null) {
+                // Someone was faster.
+                self.allocator.free(new_chunk);
+                return;
+            }
+
+            _ = self.committed_bytes.fetchAdd(len * @sizeOf(T), .monotonic);
+        }
+
+        /// Pointer to item or null if index was never ensured.
+        pub inline fn getOrNull(self: *const Self, idx: usize) ?*T {
+            const loc = locate(idx);
+            const chunk = self.chunks[loc.chunk].load(.acquire) orelse return null;
+            return &chunk[loc.offset * self.stride];
+        }
+
+        pub inline fn get(self: *const Self, idx: usize) *T {
+            return self.getOrNull(idx).?;
+        }
+
+        /// All `stride` items for index.
+        pub inline fn getMany(self: *const Self, idx: usize) []T {
+            if (self.stride == 0) return &.{};
+            const loc = locate(idx);
+            const chunk = self.chunks[loc.chunk].load(.acquire).?;
+            const begin = loc.offset * self.stride;
+            return chunk[begin .. begin + self.stride];
+        }
+
+        pub fn committed(self: *const Self) usize {
+            return self.committed_bytes.load(.monotonic);
+        }
+    };
+}
+
+/// Same as VirtualPool but backed by ChunkedArray so there is no max item count.
+/// Every item can have `tail_words` words right after data (fixed at init) so variable sized
+/// records live in one block: [pool header][T][tail].
+pub fn ChunkedPool(comptime T: type) type {
+    return struct {
+        const Self = @This();
+
+        pub const Word = usize;
+
+        comptime {
+            std.debug.assert(@alignOf(T) <= @alignOf(Word));
+        }
+
+        const TagedIdx = packed struct(u64) {
+            tag: u32,
+            idx: u32,
+        };
+
+        const Header = struct {
+            next_free_idx: std.atomic.Value(TagedIdx),
+            idx: u32,
+            free: bool,
+        };
+
+        const header_words = std.mem.alignForward(usize, @sizeOf(Header), @sizeOf(Word)) / @sizeOf(Word);
+        const data_words = std.mem.alignForward(usize, @sizeOf(T), @sizeOf(Word)) / @sizeOf(Word);
+
+        /// Byte offset of tail from data pointer.
+        pub const tail_offset = data_words * @sizeOf(Word);
+
+        alocated_items: AtomicInt,
+        tail_words: usize,
+        mem: ChunkedArray(Word),
+
+        pub fn init(allocator: std.mem.Allocator) !Self {
+            return initWithTail(allocator, 0);
+        }
+
+        pub fn initWithTail(allocator: std.mem.Allocator, tail_words: usize) !Self {
+            var self = Self{
+                .alocated_items = AtomicInt.init(1),
+                .tail_words = tail_words,
+                .mem = ChunkedArray(Word).init(allocator, header_words + data_words + tail_words),
+            };
+
+            try self.mem.ensure(0);
+            const head = self.getHeader(0);
+            head.next_free_idx.store(.{ .tag = 0, .idx = 0 }, .monotonic);
+            head.free = true;
+
+            return self;
+        }
+
+        pub fn deinit(self: *Self) void {
+            self.mem.deinit();
+        }
+
+        inline fn getHeader(self: *Self, idx: usize) *Header {
+            return @ptrCast(@alignCast(self.mem.get(idx)));
+        }
+
+        inline fn headerOf(id: *T) *Header {
+            return @ptrFromInt(@intFromPtr(id) - header_words * @sizeOf(Word));
+        }
+
+        inline fn dataOf(header: *Header) *T {
+            return @ptrFromInt(@intFromPtr(header) + header_words * @sizeOf(Word));
+        }
+
+        pub inline fn index(self: *Self, id: *T) u32 {
+            _ = self;
+            return headerOf(id).idx;
+        }
+
+        pub inline fn get(self: *Self, idx: usize) *T {
+            std.debug.assert(idx != 0);
+            return dataOf(self.getHeader(idx));
+        }
+
+        /// Words stored after item data.
+        pub inline fn tail(self: *Self, id: *T) []Word {
+            const ptr: [*]Word = @ptrFromInt(@intFromPtr(id) + tail_offset);
+            return ptr[0..self.tail_words];
+        }
+
+        /// Item data and tail as one byte slice.
+        pub inline fn itemBytes(self: *Self, id: *T) []u8 {
+            const ptr: [*]u8 = @ptrCast(id);
+            return ptr[0 .. tail_offset + self.tail_words * @sizeOf(Word)];
+        }
+
+        /// Bytes of one item including pool header.
+        pub fn itemSize(self: *const Self) usize {
+            return self.mem.stride * @sizeOf(Word);
+        }
+
+        /// Count of item slots ever allocated including null item 0.
+        pub fn allocatedCount(self: *Self) u32 {
+            return self.alocated_items.load(.monotonic);
+        }
+
+        pub fn create(self: *Self, is_new: ?*bool) !*T {
+            const head = self.getHeader(0);
+
+            while (true) {
+                const next_free_idx = head.next_free_idx.load(.acquire);
+                if (next_free_idx.idx != 0) {
+                    if (is_new != null) is_new.?.* = false;
+
+                    var free_item = self.getHeader(next_free_idx.idx);
+                    const free_next_item_idx = free_item.next_free_idx.load(.acquire);
+
+                    const new_id = TagedIdx{ .tag = next_free_idx.tag +% 1, .idx = free_next_item_idx.idx };
+                    if (null == head.next_free_idx.cmpxchgWeak(next_free_idx, new_id, .release, .monotonic)) {
+                        free_item.free = false;
+                        return dataOf(free_item);
+                    }
+                } else {
+                    if (is_new != null) is_new.?.* = true;
+                    const idx = self.alocated_items.fetchAdd(1, .monotonic);
+                    try self.mem.ensure(idx);
+
+                    var item = self.getHeader(idx);
+                    item.idx = idx;
+                    item.free = false;
+
+                    return dataOf(item);
+                }
+            }
+        }
+
+        pub fn destroy(self: *Self, id: *T) void {
+            const head = self.getHeader(0);
+
+            const item = headerOf(id);
+            item.free = true;
+
+            while (true) {
+                const next_free_idx = head.next_free_idx.load(.acquire);
+                item.next_free_idx.store(next_free_idx, .monotonic);
+
+                const new_id = TagedIdx{ .tag = next_free_idx.tag +% 1, .idx = item.idx };
+                if (null == head.next_free_idx.cmpxchgWeak(next_free_idx, new_id, .release, .monotonic)) {
+                    break;
+                }
+            }
+        }
+
+        pub fn committed(self: *const Self) usize {
+            return self.mem.committed();
+        }
+    };
+}
+
 pub const TmpAllocatorPool = struct {
     const Self = @This();
     const InnerAllocator = std.heap.ArenaAllocator;
@@ -17,11 +17,13 @@ const profiler = cetech1.profiler;
 const public = cetech1.assetdb;
 
 const assetroot_fs = @import("assetdb_fs.zig");
+const assetdb_search = @import("assetdb_search.zig");
 
 const propIdx = cdb.propIdx;
 
 test {
     _ = std.testing.refAllDecls(@import("assetdb_test.zig"));
+    _ = std.testing.refAllDecls(assetdb_search);
 }
 
 const Uuid2ObjId = cetech1.AutoArrayHashMap(uuid.Uuid, cdb.ObjId);
@@ -82,6 +84,7 @@ const api = public.AssetDBAPI{
     .createAsset = createAsset,
     .createImportedAsset = createImportedAsset,
     .openAssetRootFolder = openAssetRootFolder,
+    .cookAssetRootSnapshot = cookAssetRootSnapshot,
     .getRootFolder = getRootFolder,
     .getTmpPath = getTmpPath,
     .isAssetModified = isObjModified,
@@ -123,6 +126,13 @@ var _io: std.Io = undefined;
 var _db: cdb.DbId = undefined;
 var _assetroot: public.AssetRootI = undefined;
 
+// Search index for filerAsset, updated from asset changes.
+var _search: assetdb_search.SearchIndex = undefined;
+var _search_lock: std.Io.Mutex = .init;
+var _search_changes: ?cdb.ChangeConsumer = null;
+var _search_version: cdb.TypeVersion = 0;
+var _search_root: cdb.ObjId = .{};
+
 // var AssetRootTypeIdx: cdb.TypeIdx = undefined;
 var AssetTypeIdx: cdb.TypeIdx = undefined;
 var FolderTypeIdx: cdb.TypeIdx = undefined;
@@ -220,64 +230,115 @@ pub fn init(io: std.Io, allocator: std.mem.Allocator) !void {
 
     _assetroot = try assetroot_fs_provider_i.create();
 
+    _search = assetdb_search.SearchIndex.init(allocator);
+    _search_changes = null;
+    _search_version = 0;
+    _search_root = .{};
+
     public.api = &api;
 }
 
 pub fn deinit() void {
+    if (_search_changes) |consumer| cdb.removeChangeConsumer(consumer);
+    _search.deinit();
+
     assetroot_fs_provider_i.destroy(_assetroot);
     cdb.destroyDb(_db);
 }
 
 fn filerAsset(allocator: std.mem.Allocator, filter: [:0]const u8, tags_filter: cdb.ObjId) !public.FilteredAssets {
-    var result = cetech1.ArrayList(public.FilteredAsset).empty;
-    var buff: [256:0]u8 = undefined;
-    var buff2: [256:0]u8 = undefined;
-    var buff3: [256:0]u8 = undefined;
-
-    var filter_set = cetech1.AutoArrayHashMap(cdb.ObjId, void).empty;
-    defer filter_set.deinit(allocator);
+    var zone_ctx = profiler.Zone(@src());
+    defer zone_ctx.End();
 
+    var filter_tags: []const cdb.ObjId = &.{};
+    defer allocator.free(filter_tags);
     if (cdb.readObj(tags_filter)) |filter_r| {
         if (public.TagsCdb.readRefSet(filter_r, .Tags, allocator)) |tags| {
-            defer allocator.free(tags);
-            for (tags) |tag| {
-                try filter_set.put(allocator, tag, {});
-            }
+            filter_tags = tags;
         }
     }
 
-    const set = try public.AssetRootCdb.readSubObjSet(cdb.readObj(getAssetRootObj()).?, .Assets, allocator);
-    if (set) |s| {
-        defer allocator.free(s);
-
-        for (s) |obj| {
-            if (obj.eql(getRootFolder())) continue;
-
-            if (filter_set.count() != 0) {
-                if (cdb.readObj(obj)) |asset_r| {
-                    if (public.AssetCdb.readRefSet(asset_r, .Tags, allocator)) |asset_tags| {
-                        defer allocator.free(asset_tags);
-
-                        var pass_n: u32 = 0;
-                        for (asset_tags) |tag| {
-                            if (filter_set.contains(tag)) pass_n += 1;
-                        }
-                        if (pass_n != filter_set.count()) continue;
-                    }
-                }
+    _search_lock.lockUncancelable(_io);
+    defer _search_lock.unlock(_io);
+
+    try updateSearchIndex(allocator);
+    return _search.search(allocator, filter, filter_tags);
+}
+
+fn updateSearchIndex(allocator: std.mem.Allocator) !void {
+    var zone_ctx = profiler.Zone(@src());
+    defer zone_ctx.End();
+
+    if (_search_changes == null) _search_changes = try cdb.addChangeConsumer(_db, AssetTypeIdx);
+
+    const changed = try cdb.getConsumerChangeObjects(allocator, _search_changes.?, _search_version);
+    defer allocator.free(changed.objects);
+    _search_version = changed.last_version;
+
+    // New asset root has all new objects.
+    const asset_root = getAssetRootObj();
+    const full_rebuild = changed.need_fullscan or !_search_root.eql(asset_root);
+
+    if (!full_rebuild) {
+        for (changed.objects) |asset| {
+            if (!cdb.isAlive(asset) or !cdb.getParent(asset).eql(asset_root)) {
+                _search.remove(asset);
+                continue;
             }
 
-            const path = try getFilePathForAsset(&buff3, obj);
+            // Folder rename or move change path of all assets inside.
+            if (isAssetFolder(asset)) {
+                if (_search.getPath(asset)) |old_path| try indexFolderSubtree(allocator, old_path);
+            }
 
-            const f = try std.fmt.bufPrintZ(&buff, "{s}", .{filter});
-            const p = try std.fmt.bufPrintZ(&buff2, "{s}", .{path});
+            try indexAsset(allocator, asset);
+        }
+        return;
+    }
+
+    _search.clear();
+    _search_root = asset_root;
+
+    const set = try public.AssetRootCdb.readSubObjSet(cdb.readObj(asset_root) orelse return, .Assets, allocator) orelse return;
+    defer allocator.free(set);
+    for (set) |asset| {
+        try indexAsset(allocator, asset);
+    }
+}
+
+// Reindex assets under folder indexed with old_path, put skip assets with same path.
+fn indexFolderSubtree(allocator: std.mem.Allocator, old_path: []const u8) !void {
+    // Folder path without extension is prefix of all assets inside.
+    const ext_idx = std.mem.lastIndexOfScalar(u8, old_path, '.') orelse return;
+
+    var prefix_buf: [256]u8 = undefined;
+    const prefix = try std.fmt.bufPrint(&prefix_buf, "{s}{c}", .{ old_path[0..ext_idx], std.fs.path.sep });
+
+    const inside = try _search.withPrefix(allocator, prefix);
+    defer allocator.free(inside);
 
-            const score = coreui.uiFilterPass(allocator, f, p, true) orelse continue;
-            try result.append(allocator, .{ .score = score, .obj = obj });
+    for (inside) |asset| {
+        if (!cdb.isAlive(asset)) {
+            _search.remove(asset);
+            continue;
         }
+        try indexAsset(allocator, asset);
     }
+}
+
+fn indexAsset(allocator: std.mem.Allocator, asset: cdb.ObjId) !void {
+    if (asset.eql(getRootFolder())) return;
+
+    const asset_r = cdb.readObj(asset) orelse return;
+    if (public.AssetCdb.readSubObj(asset_r, .Object) == null) return;
+
+    var buff: [256]u8 = undefined;
+    const path = try getFilePathForAsset(&buff, asset);
+
+    const tags: []const cdb.ObjId = public.AssetCdb.readRefSet(asset_r, .Tags, allocator) orelse &.{};
+    defer allocator.free(tags);
 
-    return result.toOwnedSlice(allocator);
+    try _search.put(asset, path, tags);
 }
 
 fn isRootFolder(asset: cdb.ObjId) bool {
@@ -384,6 +445,12 @@ fn openAssetRootFolder(asset_root_path: []const u8, allocator: std.mem.Allocator
     return _assetroot.openAssetRootFolder(_io, asset_root_path, allocator);
 }
 
+fn cookAssetRootSnapshot(asset_root_path: []const u8, allocator: std.mem.Allocator) !void {
+    var zone_ctx = profiler.Zone(@src());
+    defer zone_ctx.End();
+    return _assetroot.cookSnapshot(_io, asset_root_path, allocator);
+}
+
 fn setAssetNameAndFolder(asset_w: *cdb.Obj, name: []const u8, description: ?[]const u8, asset_folder: cdb.ObjId) !void {
     var buffer: [128]u8 = undefined;
 
@@ -441,11 +508,11 @@ pub fn saveAll(allocator: std.mem.Allocator) !void {
     try _assetroot.saveAll(_io, allocator);
 }
 
-pub fn saveAllModifiedAssets(allocator: std.mem.Allocator) !void {
+pub fn saveAllModifiedAssets(allocator: std.mem.Allocator, progress: ?*public.SaveProgress) !void {
     var zone_ctx = profiler.Zone(@src());
     defer zone_ctx.End();
 
-    try _assetroot.saveAllModifiedAssets(_io, allocator);
+    try _assetroot.saveAllModifiedAssets(_io, allocator, progress);
 }
 
 fn getPathForFolder(buff: []u8, from_folder: cdb.ObjId) ![]u8 {
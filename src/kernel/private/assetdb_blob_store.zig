@@ -0,0 +1,867 @@
+//! Content addressed blob store of asset root.
+//!
+//! Blob data are deduplicated by content hash and appended to few pack files.
+//! Index is append-only log of fixed records, every write that change something append one record,
+//! last record for key win. Packs are memory-mapped and reads return slices into mapped memory
+//! that are valid until store is closed, compact included.
+//! Pack mapping reserve MAX_PACK_SIZE up front so appended data are readable without remapping.
+//! Writes are not durable until `sync`, call it once per save batch before anything that reference blobs is committed.
+//! Removed or overwritten data stay in pack until `compact` rewrite live blobs to new packs and index.
+//! Rewritten store is built in sibling directory and swapped in with renames so crash leave old or new store.
+//! Store directory is created with first write.
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+const cetech1 = @import("cetech1");
+const cetech1_options = @import("cetech1_options");
+
+const log = std.log.scoped(.assetdb_blob_store);
+
+pub const DIR = "pack";
+const INDEX_FILENAME = "index.ct_pack_index";
+const PACK_EXTENSION = ".ct_pack";
+
+const MAGIC = "CTPI".*;
+const VERSION: u32 = 1;
+
+/// New pack is started if current is bigger.
+const MAX_PACK_SIZE = 64 * 1024 * 1024;
+
+/// `compactIfNeeded` rewrite store if dead data are at least this part of packs...
+const COMPACT_DEAD_RATIO = 0.5;
+/// ...and there is at least this much of them.
+const COMPACT_MIN_DEAD_BYTES = 1024 * 1024;
+/// Or if index has this many records per live blob.
+const COMPACT_RECORDS_PER_LIVE = 4;
+const COMPACT_MIN_RECORDS = 1024;
+
+const COMPACT_POSTFIX = ".compact";
+const OLD_POSTFIX = ".old";
+
+const NO_PACK = std.math.maxInt(u32);
+
+pub const ContentHash = [16]u8;
+
+pub fn contentHash(data: []const u8) ContentHash {
+    var hash: ContentHash = undefined;
+    std.crypto.hash.Blake3.hash(data, &hash, .{});
+    return hash;
+}
+
+/// Blob identity in asset.
+pub const Key = extern struct {
+    asset_uuid: [16]u8,
+    obj_hash: u32,
+    prop_hash: u32,
+};
+
+const Location = extern struct {
+    pack: u32,
+    _pad: u32 = 0,
+    offset: u64,
+    len: u64,
+
+    const removed = Location{ .pack = NO_PACK, .offset = 0, .len = 0 };
+
+    fn eql(a: Location, b: Location) bool {
+        return a.pack == b.pack and a.offset == b.offset and a.len == b.len;
+    }
+};
+
+const IndexHeader = extern struct {
+    magic: [4]u8,
+    version: u32,
+};
+
+const Record = extern struct {
+    key: Key,
+    content_hash: ContentHash,
+    location: Location,
+};
+
+const Mapping = []align(std.heap.page_size_min) const u8;
+
+/// Size of data and index, dead part is removed by `compact`.
+pub const Stats = struct {
+    pack_bytes: u64 = 0,
+    live_bytes: u64 = 0,
+    records: u64 = 0,
+    live_records: u64 = 0,
+
+    pub fn deadBytes(self: Stats) u64 {
+        return self.pack_bytes - self.live_bytes;
+    }
+};
+
+const Pack = struct {
+    file: std.Io.File,
+    size: u64,
+
+    // Reserved for whole pack, only first `loaded` bytes are valid.
+    map: Mapping = &.{},
+    loaded: u64 = 0,
+
+    // Written since last sync.
+    dirty: bool = false,
+};
+
+pub const BlobStore = struct {
+    const Self = @This();
+
+    allocator: std.mem.Allocator,
+    lock: std.Io.Mutex = .init,
+
+    parent_dir: std.Io.Dir,
+    sub_path: []const u8,
+
+    // Null until store directory exist.
+    dir: ?std.Io.Dir = null,
+    index_file: ?std.Io.File = null,
+    index_size: u64 = 0,
+    index_dirty: bool = false,
+    dir_dirty: bool = false,
+
+    packs: cetech1.ArrayList(Pack) = .empty,
+    refs: cetech1.AutoArrayHashMap(Key, Location) = .{},
+    contents: cetech1.AutoArrayHashMap(ContentHash, Location) = .{},
+
+    // Mappings of packs replaced by compact, slices returned by get stay valid until close.
+    retired: cetech1.ArrayList(Mapping) = .empty,
+
+    /// Open store in dir/sub_path. sub_path must outlive store.
+    pub fn open(io: std.Io, allocator: std.mem.Allocator, dir: std.Io.Dir, sub_path: []const u8) !Self {
+        var self = Self{
+            .allocator = allocator,
+            .parent_dir = try dir.openDir(io, ".", .{}),
+            .sub_path = sub_path,
+        };
+        errdefer self.parent_dir.close(io);
+
+        try self.recoverCompact(io);
+        try self.openExisting(io);
+        return self;
+    }
+
+    // Open store files if store directory exist.
+    fn openExisting(self: *Self, io: std.Io) !void {
+        var store_dir = self.parent_dir.openDir(io, self.sub_path, .{}) catch |err| switch (err) {
+            error.FileNotFound => return,
+            else => return err,
+        };
+
+        const index_file = store_dir.openFile(io, INDEX_FILENAME, .{ .mode = .read_write }) catch |err| {
+            store_dir.close(io);
+            return err;
+        };
+
+        self.dir = store_dir;
+        self.index_file = index_file;
+        errdefer {
+            self.closeFiles(io);
+            self.dir = null;
+            self.index_file = null;
+        }
+
+        self.index_size = try index_file.length(io);
+
+        // Packs are numbered from zero.
+        while (true) {
+            var name_buf: [32]u8 = undefined;
+            const name = packName(&name_buf, self.packs.items.len);
+            const file = store_dir.openFile(io, name, .{ .mode = .read_write }) catch |err| switch (err) {
+                error.FileNotFound => break,
+                else => return err,
+            };
+            self.packs.append(self.allocator, .{ .file = file, .size = try file.length(io) }) catch |err| {
+                file.close(io);
+                return err;
+            };
+        }
+
+        try self.readIndex(io);
+    }
+
+    pub fn close(self: *Self, io: std.Io) void {
+        self.closeFiles(io);
+        for (self.retired.items) |map| unmap(self.allocator, map);
+
+        self.packs.deinit(self.allocator);
+        self.refs.deinit(self.allocator);
+        self.contents.deinit(self.allocator);
+        self.retired.deinit(self.allocator);
+        self.parent_dir.close(io);
+    }
+
+    fn closeFiles(self: *Self, io: std.Io) void {
+        for (self.packs.items) |pack| {
+            unmap(self.allocator, pack.map);
+            pack.file.close(io);
+        }
+        self.packs.clearRetainingCapacity();
+        self.refs.clearRetainingCapacity();
+        self.contents.clearRetainingCapacity();
+
+        if (self.index_file) |f| f.close(io);
+        if (self.dir) |d| d.close(io);
+    }
+
+    /// Store data for key. Same content is stored only once.
+    pub fn put(self: *Self, io: std.Io, key: Key, data: []const u8) !void {
+        const hash = contentHash(data);
+
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        try self.ensureCreated(io);
+
+        const location = self.contents.get(hash) orelse blk: {
+            const loc = try self.appendData(io, data);
+            try self.contents.put(self.allocator, hash, loc);
+            break :blk loc;
+        };
+
+        if (self.refs.get(key)) |old| {
+            if (old.eql(location)) return;
+        }
+
+        try self.appendRecord(io, .{ .key = key, .content_hash = hash, .location = location });
+        try self.refs.put(self.allocator, key, location);
+    }
+
+    /// Get data for key. Result point to mapped pack and is valid until store is closed.
+    pub fn get(self: *Self, io: std.Io, key: Key) !?[]const u8 {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        const location = self.refs.get(key) orelse return null;
+        return try self.locationData(io, location);
+    }
+
+    fn locationData(self: *Self, io: std.Io, location: Location) ![]const u8 {
+        const pack = &self.packs.items[location.pack];
+
+        if (location.offset + location.len > pack.loaded) {
+            try self.load(io, pack);
+        }
+
+        return pack.map[location.offset..][0..location.len];
+    }
+
+    /// Flush packs and index written since last sync to disk.
+    pub fn sync(self: *Self, io: std.Io) !void {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        // Data first so index never point to data that are not on disk.
+        for (self.packs.items) |*pack| {
+            if (!pack.dirty) continue;
+            try pack.file.sync(io);
+            pack.dirty = false;
+        }
+
+        if (self.index_dirty) {
+            try self.index_file.?.sync(io);
+            self.index_dirty = false;
+        }
+
+        // New files in store dir. Directory can not be synced on all platforms so it is best effort.
+        if (self.dir_dirty) {
+            var dir_file = self.dir.?.openFile(io, ".", .{}) catch return;
+            defer dir_file.close(io);
+            dir_file.sync(io) catch {};
+            self.dir_dirty = false;
+        }
+    }
+
+    pub fn contains(self: *Self, io: std.Io, key: Key) bool {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+        return self.refs.contains(key);
+    }
+
+    /// Copy of keys of all live blobs. Caller own memory.
+    pub fn keys(self: *Self, io: std.Io, allocator: std.mem.Allocator) ![]Key {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+        return allocator.dupe(Key, self.refs.keys());
+    }
+
+    /// Remove all blobs of asset.
+    pub fn removeAsset(self: *Self, io: std.Io, asset_uuid: [16]u8) !void {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        var idx: usize = 0;
+        while (idx < self.refs.count()) {
+            const key = self.refs.keys()[idx];
+            if (!std.mem.eql(u8, &key.asset_uuid, &asset_uuid)) {
+                idx += 1;
+                continue;
+            }
+
+            try self.appendRecord(io, .{ .key = key, .content_hash = @splat(0), .location = .removed });
+            self.refs.swapRemoveAt(idx);
+        }
+    }
+
+    pub fn stats(self: *Self, io: std.Io) !Stats {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+        return self.statsLocked();
+    }
+
+    fn statsLocked(self: *Self) !Stats {
+        var result = Stats{
+            .records = (self.index_size -| @sizeOf(IndexHeader)) / @sizeOf(Record),
+            .live_records = self.refs.count(),
+        };
+        for (self.packs.items) |pack| result.pack_bytes += pack.size;
+
+        // Deduplicated data are counted once.
+        var live: cetech1.AutoArrayHashMap(Location, void) = .{};
+        defer live.deinit(self.allocator);
+        for (self.refs.values()) |location| {
+            if ((try live.getOrPut(self.allocator, location)).found_existing) continue;
+            result.live_bytes += location.len;
+        }
+
+        return result;
+    }
+
+    /// Compact store if dead data or index records are over limits. Return true if store was rewritten.
+    pub fn compactIfNeeded(self: *Self, io: std.Io) !bool {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        if (self.dir == null) return false;
+
+        const s = try self.statsLocked();
+        const dead_bytes = s.deadBytes();
+        const dead_data = dead_bytes >= COMPACT_MIN_DEAD_BYTES and
+            @as(f64, @floatFromInt(dead_bytes)) >= @as(f64, @floatFromInt(s.pack_bytes)) * COMPACT_DEAD_RATIO;
+        const dead_records = s.records >= COMPACT_MIN_RECORDS and s.records >= s.live_records * COMPACT_RECORDS_PER_LIVE;
+        if (!dead_data and !dead_records) return false;
+
+        try self.rewrite(io);
+        return true;
+    }
+
+    /// Copy live blobs to new packs and index and replace store with them.
+    /// Old packs stay mapped so slices returned by get are valid until close.
+    pub fn compact(self: *Self, io: std.Io) !void {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        if (self.dir == null) return;
+        try self.rewrite(io);
+    }
+
+    fn rewrite(self: *Self, io: std.Io) !void {
+        var compact_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const compact_path = try std.fmt.bufPrint(&compact_buf, "{s}" ++ COMPACT_POSTFIX, .{self.sub_path});
+
+        var old_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const old_path = try std.fmt.bufPrint(&old_buf, "{s}" ++ OLD_POSTFIX, .{self.sub_path});
+
+        try self.parent_dir.deleteTree(io, compact_path);
+
+        // Same put as normal write so data are deduplicated and index has one record per live blob.
+        {
+            errdefer self.parent_dir.deleteTree(io, compact_path) catch {};
+
+            var compacted = try BlobStore.open(io, self.allocator, self.parent_dir, compact_path);
+            defer compacted.close(io);
+
+            try compacted.ensureCreated(io);
+            for (self.refs.keys(), self.refs.values()) |key, location| {
+                try compacted.put(io, key, try self.locationData(io, location));
+            }
+            try compacted.sync(io);
+        }
+
+        // Files are closed before rename because open files block directory rename on some platforms.
+        for (self.packs.items) |pack| {
+            if (pack.map.len != 0) try self.retired.append(self.allocator, pack.map);
+            pack.file.close(io);
+        }
+        self.packs.clearRetainingCapacity();
+        self.refs.clearRetainingCapacity();
+        self.contents.clearRetainingCapacity();
+
+        if (self.index_file) |f| f.close(io);
+        if (self.dir) |d| d.close(io);
+        self.index_file = null;
+        self.dir = null;
+        self.index_size = 0;
+        self.index_dirty = false;
+        self.dir_dirty = false;
+
+        self.swapCompacted(io, compact_path, old_path) catch |err| {
+            // Store dir is old or compacted one, both are complete.
+            self.recoverCompact(io) catch {};
+            self.openExisting(io) catch {};
+            return err;
+        };
+
+        try self.openExisting(io);
+    }
+
+    fn swapCompacted(self: *Self, io: std.Io, compact_path: []const u8, old_path: []const u8) !void {
+        try self.parent_dir.rename(self.sub_path, self.parent_dir, old_path, io);
+        try self.parent_dir.rename(compact_path, self.parent_dir, self.sub_path, io);
+        try self.parent_dir.deleteTree(io, old_path);
+
+        // Directory can not be synced on all platforms so it is best effort.
+        var dir_file = self.parent_dir.openFile(io, ".", .{}) catch return;
+        defer dir_file.close(io);
+        dir_file.sync(io) catch {};
+    }
+
+    // Finish or drop compact interrupted by crash.
+    fn recoverCompact(self: *Self, io: std.Io) !void {
+        var compact_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const compact_path = try std.fmt.bufPrint(&compact_buf, "{s}" ++ COMPACT_POSTFIX, .{self.sub_path});
+
+        var old_buf: [std.fs.max_path_bytes]u8 = undefined;
+        const old_path = try std.fmt.bufPrint(&old_buf, "{s}" ++ OLD_POSTFIX, .{self.sub_path});
+
+        const has_store = blk: {
+            var store_dir = self.parent_dir.openDir(io, self.sub_path, .{}) catch |err| switch (err) {
+                error.FileNotFound => break :blk false,
+                else => return err,
+            };
+            store_dir.close(io);
+            break :blk true;
+        };
+
+        // Compacted store is synced before old one is renamed so missing store mean compacted one is complete.
+        if (!has_store) {
+            self.parent_dir.rename(compact_path, self.parent_dir, self.sub_path, io) catch |err| switch (err) {
+                error.FileNotFound => {},
+                else => return err,
+            };
+        }
+
+        try self.parent_dir.deleteTree(io, compact_path);
+        try self.parent_dir.deleteTree(io, old_path);
+    }
+
+    fn ensureCreated(self: *Self, io: std.Io) !void {
+        if (self.dir != null) return;
+
+        try self.parent_dir.createDirPath(io, self.sub_path);
+        var store_dir = try self.parent_dir.openDir(io, self.sub_path, .{});
+        errdefer store_dir.close(io);
+
+        const index_file = try store_dir.createFile(io, INDEX_FILENAME, .{ .read = true });
+        errdefer index_file.close(io);
+
+        const header = IndexHeader{ .magic = MAGIC, .version = VERSION };
+        try index_file.writePositionalAll(io, std.mem.asBytes(&header), 0);
+
+        self.dir = store_dir;
+        self.index_file = index_file;
+        self.index_size = @sizeOf(IndexHeader);
+        self.index_dirty = true;
+        self.dir_dirty = true;
+    }
+
+    fn readIndex(self: *Self, io: std.Io) !void {
+        const bytes = try self.allocator.alloc(u8, self.index_size);
+        defer self.allocator.free(bytes);
+        _ = try self.index_file.?.readPositionalAll(io, bytes, 0);
+
+        if (bytes.len < @sizeOf(IndexHeader)) return error.InvalidBlobIndex;
+        const header = std.mem.bytesToValue(IndexHeader, bytes[0..@sizeOf(IndexHeader)]);
+        if (!std.mem.eql(u8, &header.magic, &MAGIC) or header.version != VERSION) return error.InvalidBlobIndex;
+
+        // Partial record after crash is ignored and overwritten by next write.
+        const record_count = (bytes.len - @sizeOf(IndexHeader)) / @sizeOf(Record);
+        self.index_size = @sizeOf(IndexHeader) + record_count * @sizeOf(Record);
+
+        try self.refs.ensureTotalCapacity(self.allocator, record_count);
+        try self.contents.ensureTotalCapacity(self.allocator, record_count);
+
+        for (0..record_count) |idx| {
+            const offset = @sizeOf(IndexHeader) + idx * @sizeOf(Record);
+            const record = std.mem.bytesToValue(Record, bytes[offset..][0..@sizeOf(Record)]);
+
+            if (record.location.pack == NO_PACK) {
+                _ = self.refs.swapRemove(record.key);
+                continue;
+            }
+
+            // Index record can reach disk before pack data it point to, crash before sync leave it behind.
+            // Handle it like partial record, drop it with all after it.
+            // File is truncated so dropped records are not read again if next write is shorter.
+            if (record.location.pack >= self.packs.items.len or
+                record.location.offset + record.location.len > self.packs.items[record.location.pack].size)
+            {
+                log.warn("Blob index record {d} of {d} point past end of pack, index is truncated", .{ idx, record_count });
+                try self.index_file.?.setLength(io, offset);
+                self.index_size = offset;
+                break;
+            }
+
+            self.refs.putAssumeCapacity(record.key, record.location);
+            self.contents.putAssumeCapacity(record.content_hash, record.location);
+        }
+    }
+
+    fn appendRecord(self: *Self, io: std.Io, record: Record) !void {
+        try self.index_file.?.writePositionalAll(io, std.mem.asBytes(&record), self.index_size);
+        self.index_size += @sizeOf(Record);
+        self.index_dirty = true;
+    }
+
+    fn appendData(self: *Self, io: std.Io, data: []const u8) !Location {
+        if (self.packs.items.len == 0 or self.packs.items[self.packs.items.len - 1].size + data.len > MAX_PACK_SIZE) {
+            try self.createPack(io);
+        }
+
+        const pack_idx = self.packs.items.len - 1;
+        const pack = &self.packs.items[pack_idx];
+
+        const offset = pack.size;
+        try pack.file.writePositionalAll(io, data, offset);
+        pack.size += data.len;
+        pack.dirty = true;
+
+        return .{ .pack = @intCast(pack_idx), .offset = offset, .len = data.len };
+    }
+
+    fn createPack(self: *Self, io: std.Io) !void {
+        var name_buf: [32]u8 = undefined;
+        const name = packName(&name_buf, self.packs.items.len);
+
+        const file = try self.dir.?.createFile(io, name, .{ .read = true, .exclusive = true });
+        errdefer file.close(io);
+
+        try self.packs.append(self.allocator, .{ .file = file, .size = 0 });
+        self.dir_dirty = true;
+    }
+
+    // Make data appended since last load readable. Mapping is never replaced so returned slices stay valid.
+    fn load(self: *Self, io: std.Io, pack: *Pack) !void {
+        if (pack.map.len == 0) {
+            // Only empty pack can grow over MAX_PACK_SIZE and it grow only by one blob.
+            pack.map = try mapPack(self.allocator, pack.file, @max(pack.size, MAX_PACK_SIZE));
+        }
+        std.debug.assert(pack.size <= pack.map.len);
+
+        switch (builtin.os.tag) {
+            // Mapping is copy of pack, read only new part.
+            .windows => {
+                const map: []u8 = @constCast(pack.map);
+                _ = try pack.file.readPositionalAll(io, map[pack.loaded..pack.size], pack.loaded);
+            },
+            // Shared mapping see writes to file.
+            else => {},
+        }
+        pack.loaded = pack.size;
+    }
+};
+
+fn packName(buf: []u8, idx: usize) []const u8 {
+    return std.fmt.bufPrint(buf, "{d:0>4}" ++ PACK_EXTENSION, .{idx}) catch unreachable;
+}
+
+// Reserve `len` bytes for pack. Pages behind end of file are never touched.
+fn mapPack(allocator: std.mem.Allocator, file: std.Io.File, len: u64) !Mapping {
+    switch (builtin.os.tag) {
+        .windows => return allocator.alignedAlloc(u8, .fromByteUnits(std.heap.page_size_min), len),
+        else => return std.posix.mmap(
+            null,
+            len,
+            .{ .READ = true },
+            .{ .TYPE = .SHARED },
+            file.handle,
+            0,
+        ),
+    }
+}
+
+fn unmap(allocator: std.mem.Allocator, mapping: Mapping) void {
+    if (mapping.len == 0) return;
+    switch (builtin.os.tag) {
+        .windows => allocator.free(mapping),
+        else => std.posix.munmap(mapping),
+    }
+}
+
+test "assetdb_blob_store: Should put, dedup, remove and reopen" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const asset_a = Key{ .asset_uuid = @splat(1), .obj_hash = 1, .prop_hash = 2 };
+    const asset_a2 = Key{ .asset_uuid = @splat(1), .obj_hash = 1, .prop_hash = 3 };
+    const asset_b = Key{ .asset_uuid = @splat(2), .obj_hash = 1, .prop_hash = 2 };
+
+    {
+        var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+        defer store.close(io);
+
+        try store.put(io, asset_a, "hello blob");
+        try store.put(io, asset_b, "hello blob");
+        try store.put(io, asset_a2, "other blob");
+
+        try std.testing.expectEqualStrings("hello blob", (try store.get(io, asset_a)).?);
+        try std.testing.expectEqualStrings("hello blob", (try store.get(io, asset_b)).?);
+
+        // Same content is stored once.
+        try std.testing.expectEqual(@as(u64, "hello blob".len + "other blob".len), store.packs.items[0].size);
+
+        // Overwrite
+        try store.put(io, asset_a, "new blob");
+        try std.testing.expectEqualStrings("new blob", (try store.get(io, asset_a)).?);
+
+        try store.removeAsset(io, asset_b.asset_uuid);
+        try std.testing.expect(try store.get(io, asset_b) == null);
+
+        try store.sync(io);
+        try std.testing.expect(!store.index_dirty);
+        try std.testing.expect(!store.packs.items[0].dirty);
+    }
+
+    var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+    defer store.close(io);
+
+    try std.testing.expectEqualStrings("new blob", (try store.get(io, asset_a)).?);
+    try std.testing.expectEqualStrings("other blob", (try store.get(io, asset_a2)).?);
+    try std.testing.expect(try store.get(io, asset_b) == null);
+}
+
+test "assetdb_blob_store: Should truncate index at record past end of pack" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const key_a = Key{ .asset_uuid = @splat(1), .obj_hash = 1, .prop_hash = 1 };
+    const key_torn = Key{ .asset_uuid = @splat(2), .obj_hash = 1, .prop_hash = 1 };
+    const key_after = Key{ .asset_uuid = @splat(3), .obj_hash = 1, .prop_hash = 1 };
+    const key_b = Key{ .asset_uuid = @splat(4), .obj_hash = 1, .prop_hash = 1 };
+
+    {
+        var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+        defer store.close(io);
+        try store.put(io, key_a, "hello blob");
+        try store.sync(io);
+    }
+
+    // Records written without pack data, like crash before sync.
+    {
+        var index_file = try tmp_dir.dir.openFile(io, DIR ++ "/" ++ INDEX_FILENAME, .{ .mode = .read_write });
+        defer index_file.close(io);
+        const size = (try index_file.stat(io)).size;
+
+        const torn = Record{ .key = key_torn, .content_hash = contentHash("torn"), .location = .{ .pack = 0, .offset = "hello blob".len, .len = 4 } };
+        const after = Record{ .key = key_after, .content_hash = contentHash("hello blob"), .location = .{ .pack = 0, .offset = 0, .len = "hello blob".len } };
+        try index_file.writePositionalAll(io, std.mem.asBytes(&torn), size);
+        try index_file.writePositionalAll(io, std.mem.asBytes(&after), size + @sizeOf(Record));
+    }
+
+    {
+        var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+        defer store.close(io);
+
+        try std.testing.expectEqualStrings("hello blob", (try store.get(io, key_a)).?);
+        try std.testing.expect(try store.get(io, key_torn) == null);
+        try std.testing.expect(try store.get(io, key_after) == null);
+        try std.testing.expectEqual(@as(u64, @sizeOf(IndexHeader) + @sizeOf(Record)), store.index_size);
+
+        // Next write overwrite dropped records.
+        try store.put(io, key_b, "other blob");
+        try store.sync(io);
+    }
+
+    var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+    defer store.close(io);
+    try std.testing.expectEqualStrings("hello blob", (try store.get(io, key_a)).?);
+    try std.testing.expectEqualStrings("other blob", (try store.get(io, key_b)).?);
+    try std.testing.expect(try store.get(io, key_after) == null);
+}
+
+test "assetdb_blob_store: Should keep read slices valid while pack grow" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+    defer store.close(io);
+
+    const first_key = Key{ .asset_uuid = @splat(1), .obj_hash = 0, .prop_hash = 0 };
+    try store.put(io, first_key, "first blob");
+    const first = (try store.get(io, first_key)).?;
+    const map_ptr = store.packs.items[0].map.ptr;
+
+    var data_buf: [32]u8 = undefined;
+    for (1..1000) |idx| {
+        const key = Key{ .asset_uuid = @splat(1), .obj_hash = @intCast(idx), .prop_hash = 0 };
+        const data = try std.fmt.bufPrint(&data_buf, "blob data {d}", .{idx});
+        try store.put(io, key, data);
+        try std.testing.expectEqualStrings(data, (try store.get(io, key)).?);
+    }
+
+    // Pack is mapped once.
+    try std.testing.expectEqual(map_ptr, store.packs.items[0].map.ptr);
+    try std.testing.expectEqualStrings("first blob", first);
+}
+
+test "assetdb_blob_store: Should compact dead blobs" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    const asset_a = Key{ .asset_uuid = @splat(1), .obj_hash = 1, .prop_hash = 2 };
+    const asset_a2 = Key{ .asset_uuid = @splat(1), .obj_hash = 1, .prop_hash = 3 };
+    const asset_b = Key{ .asset_uuid = @splat(2), .obj_hash = 1, .prop_hash = 2 };
+
+    {
+        var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+        defer store.close(io);
+
+        // Nothing to compact.
+        try std.testing.expect(!try store.compactIfNeeded(io));
+
+        try store.put(io, asset_a, "old blob");
+        try store.put(io, asset_a2, "shared blob");
+        try store.put(io, asset_b, "shared blob");
+        try store.put(io, asset_b, "removed blob");
+        try store.put(io, asset_a, "new blob");
+        try store.removeAsset(io, asset_b.asset_uuid);
+        try store.sync(io);
+
+        const old_slice = (try store.get(io, asset_a)).?;
+
+        const before = try store.stats(io);
+        try std.testing.expectEqual(@as(u64, "old blob".len + "removed blob".len), before.deadBytes());
+        try std.testing.expectEqual(@as(u64, 6), before.records);
+
+        try store.compact(io);
+
+        const after = try store.stats(io);
+        try std.testing.expectEqual(@as(u64, 0), after.deadBytes());
+        try std.testing.expectEqual(@as(u64, "new blob".len + "shared blob".len), after.pack_bytes);
+        try std.testing.expectEqual(@as(u64, 2), after.records);
+
+        // Slices returned before compact stay valid until close.
+        try std.testing.expectEqualStrings("new blob", old_slice);
+
+        try std.testing.expectEqualStrings("new blob", (try store.get(io, asset_a)).?);
+        try std.testing.expectEqualStrings("shared blob", (try store.get(io, asset_a2)).?);
+        try std.testing.expect(try store.get(io, asset_b) == null);
+
+        // Store is writable after compact.
+        try store.put(io, asset_b, "after compact");
+        try store.sync(io);
+    }
+
+    // Leftover of interrupted compact is dropped.
+    try tmp_dir.dir.createDirPath(io, DIR ++ COMPACT_POSTFIX);
+
+    var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+    defer store.close(io);
+
+    try std.testing.expectEqualStrings("new blob", (try store.get(io, asset_a)).?);
+    try std.testing.expectEqualStrings("shared blob", (try store.get(io, asset_a2)).?);
+    try std.testing.expectEqualStrings("after compact", (try store.get(io, asset_b)).?);
+    try std.testing.expectError(error.FileNotFound, tmp_dir.dir.openDir(io, DIR ++ COMPACT_POSTFIX, .{}));
+}
+
+test "assetdb_blob_store: 100k small blobs per file vs packed" {
+    if (!cetech1_options.enable_bench) return error.SkipZigTest;
+
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    const blob_count = 100_000;
+    const blobs_per_asset = 100;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    var data_buf: [64]u8 = undefined;
+
+    // Per file, same steps as assetdb_fs did for every blob.
+    const file_write_ns = blk: {
+        const start = std.Io.Timestamp.now(io, .awake);
+        for (0..blob_count) |idx| {
+            var dir_buf: [64]u8 = undefined;
+            const dir_path = try std.fmt.bufPrint(&dir_buf, "files/{d}", .{idx / blobs_per_asset});
+            try tmp_dir.dir.createDirPath(io, dir_path);
+
+            var blob_dir = try tmp_dir.dir.openDir(io, dir_path, .{});
+            defer blob_dir.close(io);
+
+            var name_buf: [32]u8 = undefined;
+            const name = try std.fmt.bufPrint(&name_buf, "{x}", .{idx});
+            try blob_dir.writeFile(io, .{ .sub_path = name, .data = try std.fmt.bufPrint(&data_buf, "blob data {d}", .{idx}) });
+        }
+        break :blk start.durationTo(.now(io, .awake)).toNanoseconds();
+    };
+
+    const file_read_ns = blk: {
+        const start = std.Io.Timestamp.now(io, .awake);
+        for (0..blob_count) |idx| {
+            var dir_buf: [64]u8 = undefined;
+            const dir_path = try std.fmt.bufPrint(&dir_buf, "files/{d}", .{idx / blobs_per_asset});
+
+            var blob_dir = try tmp_dir.dir.openDir(io, dir_path, .{});
+            defer blob_dir.close(io);
+
+            var name_buf: [32]u8 = undefined;
+            const name = try std.fmt.bufPrint(&name_buf, "{x}", .{idx});
+
+            var blob_file = try blob_dir.openFile(io, name, .{});
+            defer blob_file.close(io);
+
+            const blob = try allocator.alloc(u8, try blob_file.length(io));
+            defer allocator.free(blob);
+            _ = try blob_file.readPositionalAll(io, blob, 0);
+        }
+        break :blk start.durationTo(.now(io, .awake)).toNanoseconds();
+    };
+
+    var store = try BlobStore.open(io, allocator, tmp_dir.dir, DIR);
+    defer store.close(io);
+
+    const pack_write_ns = blk: {
+        const start = std.Io.Timestamp.now(io, .awake);
+        for (0..blob_count) |idx| {
+            const key = Key{ .asset_uuid = @splat(@truncate(idx / blobs_per_asset)), .obj_hash = @intCast(idx), .prop_hash = 0 };
+            try store.put(io, key, try std.fmt.bufPrint(&data_buf, "blob data {d}", .{idx}));
+        }
+        break :blk start.durationTo(.now(io, .awake)).toNanoseconds();
+    };
+
+    const pack_read_ns = blk: {
+        const start = std.Io.Timestamp.now(io, .awake);
+        for (0..blob_count) |idx| {
+            const key = Key{ .asset_uuid = @splat(@truncate(idx / blobs_per_asset)), .obj_hash = @intCast(idx), .prop_hash = 0 };
+            const blob = (try store.get(io, key)).?;
+            try std.testing.expectEqualStrings(try std.fmt.bufPrint(&data_buf, "blob data {d}", .{idx}), blob);
+        }
+        break :blk start.durationTo(.now(io, .awake)).toNanoseconds();
+    };
+
+    std.debug.print(
+        "blob store: count={d} file write={d}ms read={d}ms pack write={d}ms read={d}ms\n",
+        .{
+            blob_count,
+            @divTrunc(file_write_ns, std.time.ns_per_ms),
+            @divTrunc(file_read_ns, std.time.ns_per_ms),
+            @divTrunc(pack_write_ns, std.time.ns_per_ms),
+            @divTrunc(pack_read_ns, std.time.ns_per_ms),
+        },
+    );
+}
@@ -18,8 +18,14 @@ const public = cetech1.assetdb;
 
 const propIdx = cdb.propIdx;
 
+const assetdb_snapshot = @import("assetdb_snapshot.zig");
+const assetdb_blob_store = @import("assetdb_blob_store.zig");
+const fswatch = @import("fswatch.zig");
+
 test {
     _ = std.testing.refAllDecls(@import("assetdb_test.zig"));
+    _ = std.testing.refAllDecls(assetdb_snapshot);
+    _ = std.testing.refAllDecls(assetdb_blob_store);
 }
 
 const Uuid2ObjId = cetech1.AutoArrayHashMap(uuid.Uuid, cdb.ObjId);
@@ -38,6 +44,8 @@ const AssetUuid2Depend = cetech1.AutoArrayHashMap(uuid.Uuid, UuidSet);
 const AssetObjIdVersion = cetech1.AutoArrayHashMap(cdb.ObjId, u64);
 const Uuid2Imported = cetech1.AutoArrayHashMap(uuid.Uuid, []const u8);
 const Imported2Uuid = std.StringArrayHashMapUnmanaged(uuid.Uuid);
+const Path2FileInfo = std.StringArrayHashMapUnmanaged(assetdb_snapshot.FileInfo);
+const Path2Parsed = std.StringArrayHashMapUnmanaged([]u8);
 const ToDeleteList = cetech1.ArraySet(cdb.ObjId);
 const UuidSet = cetech1.ArraySet(uuid.Uuid);
 
@@ -67,6 +75,12 @@ const ASSET_CURRENT_VERSION = std.SemanticVersion.parse(ASSET_CURRENT_VERSION_ST
 
 const PROJECT_FILENAME = "project." ++ public.ProjectCdb.name ++ ".json";
 const FOLDER_FILENAME = "." ++ public.FolderCdb.name ++ ".json";
+const SNAPSHOT_PATH = public.CT_TEMP_FOLDER ++ "/" ++ assetdb_snapshot.FILENAME;
+const MANIFEST_PATH = public.CT_TEMP_FOLDER ++ "/" ++ assetdb_snapshot.MANIFEST_FILENAME;
+const IMPORT_CACHE_PATH = public.CT_TEMP_FOLDER ++ "/" ++ "import_cache.json";
+
+// Max size of encoded values kept from analyze for import, rest is parsed again on import.
+const MAX_PARSED_BYTES = 64 * 1024 * 1024;
 
 // Type for root of all assets
 pub const AssetRootCdb = public.AssetRootCdb;
@@ -82,6 +96,17 @@ const WriteBlobFn = *const fn (
     allocator: std.mem.Allocator,
 ) anyerror!void;
 
+pub const BlobData = struct {
+    data: []const u8,
+
+    // Data are allocated with allocator. Otherwise they point to mapped memory.
+    owned: bool,
+
+    pub fn deinit(self: BlobData, allocator: std.mem.Allocator) void {
+        if (self.owned) allocator.free(self.data);
+    }
+};
+
 const ReadBlobFn = *const fn (
     io: std.Io,
     asset: cdb.ObjId,
@@ -90,7 +115,7 @@ const ReadBlobFn = *const fn (
     prop_hash: cetech1.StrId32,
     root_path: []const u8,
     allocator: std.mem.Allocator,
-) anyerror![]u8;
+) anyerror!BlobData;
 
 fn validateVersion(version: []const u8) !void {
     const v = try std.SemanticVersion.parse(version);
@@ -114,10 +139,21 @@ const AnalyzeInfo = struct {
 
     uuid2asset_uuid: Uuid2AssetUuid = .{},
     asset_uuid2depend: AssetUuid2Depend = .{},
+    asset_uuid2provide: AssetUuid2Depend = .{},
 
     uuid2imported_from: Uuid2Imported = .{},
     imported_from2uuid: Imported2Uuid = .{},
 
+    path2file_info: Path2FileInfo = .{},
+
+    // Encoded values parsed by analyze waiting for import.
+    path2parsed: Path2Parsed = .{},
+    parsed_bytes: usize = 0,
+    parsed_peak_bytes: usize = 0,
+
+    // Files that are not same as in manifest.
+    changed_files: std.atomic.Value(u32) = .init(0),
+
     _str_intern: cetech1.string.InternWithLock([]const u8) = undefined,
 
     pub fn init(allocator: std.mem.Allocator) !Self {
@@ -132,15 +168,23 @@ const AnalyzeInfo = struct {
         for (self.asset_uuid2depend.values()) |*depend| {
             depend.deinit(self.allocator);
         }
+        for (self.asset_uuid2provide.values()) |*provide| {
+            provide.deinit(self.allocator);
+        }
 
         self.path2folder.deinit(self.allocator);
         self.folder2path.deinit(self.allocator);
         self.uuid2asset_uuid.deinit(self.allocator);
         self.asset_uuid2path.deinit(self.allocator);
         self.asset_uuid2depend.deinit(self.allocator);
+        self.asset_uuid2provide.deinit(self.allocator);
         self.path2asset_uuid.deinit(self.allocator);
         self.uuid2imported_from.deinit(self.allocator);
         self.imported_from2uuid.deinit(self.allocator);
+        self.path2file_info.deinit(self.allocator);
+
+        for (self.path2parsed.values()) |parsed| self.allocator.free(parsed);
+        self.path2parsed.deinit(self.allocator);
 
         self._str_intern.deinit();
     }
@@ -153,15 +197,26 @@ const AnalyzeInfo = struct {
         for (self.asset_uuid2depend.values()) |*depend| {
             depend.deinit(self.allocator);
         }
+        for (self.asset_uuid2provide.values()) |*provide| {
+            provide.deinit(self.allocator);
+        }
 
         self.asset_uuid2path.clearRetainingCapacity();
         self.uuid2asset_uuid.clearRetainingCapacity();
         self.asset_uuid2depend.clearRetainingCapacity();
+        self.asset_uuid2provide.clearRetainingCapacity();
         self.path2asset_uuid.clearRetainingCapacity();
         self.path2folder.clearRetainingCapacity();
         self.folder2path.clearRetainingCapacity();
         self.uuid2imported_from.clearRetainingCapacity();
         self.imported_from2uuid.clearRetainingCapacity();
+        self.path2file_info.clearRetainingCapacity();
+        self.changed_files.store(0, .monotonic);
+
+        for (self.path2parsed.values()) |parsed| self.allocator.free(parsed);
+        self.path2parsed.clearRetainingCapacity();
+        self.parsed_bytes = 0;
+        self.parsed_peak_bytes = 0;
     }
 
     fn mapAssetPath(self: *Self, io: std.Io, path: []const u8, asset_uuid: uuid.Uuid) !void {
@@ -191,6 +246,53 @@ const AnalyzeInfo = struct {
         _ = self.path2asset_uuid.swapRemove(path_intern);
     }
 
+    /// Forget asset file on path. Return asset uuid if path is still path of asset, moved asset is already mapped to new path.
+    fn removeAssetFile(self: *Self, io: std.Io, path: []const u8) ?uuid.Uuid {
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+
+        const asset_uuid = (self.path2asset_uuid.fetchSwapRemove(path) orelse return null).value;
+        _ = self.path2file_info.swapRemove(path);
+
+        const current_path = self.asset_uuid2path.get(asset_uuid) orelse return null;
+        if (!std.mem.eql(u8, current_path, path)) return null;
+
+        _ = self.asset_uuid2path.swapRemove(asset_uuid);
+
+        if (self.asset_uuid2depend.fetchSwapRemove(asset_uuid)) |kv| {
+            var depend = kv.value;
+            depend.deinit(self.allocator);
+        }
+
+        if (self.asset_uuid2provide.fetchSwapRemove(asset_uuid)) |kv| {
+            var provide = kv.value;
+            for (provide.unmanaged.keys()) |provide_uuid| {
+                _ = self.uuid2asset_uuid.swapRemove(provide_uuid);
+            }
+            provide.deinit(self.allocator);
+        }
+
+        return asset_uuid;
+    }
+
+    fn getPathAsset(self: *Self, io: std.Io, path: []const u8) ?uuid.Uuid {
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+        return self.path2asset_uuid.get(path);
+    }
+
+    fn getFileInfo(self: *Self, io: std.Io, path: []const u8) ?assetdb_snapshot.FileInfo {
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+        return self.path2file_info.get(path);
+    }
+
+    fn getFolder(self: *Self, io: std.Io, path: []const u8) ?cdb.ObjId {
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+        return self.path2folder.get(path);
+    }
+
     fn mapFolderPath(self: *Self, io: std.Io, path: []const u8, folder_asset: cdb.ObjId) !void {
         self.file_info_lck.lockUncancelable(io);
         defer self.file_info_lck.unlock(io);
@@ -217,14 +319,23 @@ const AnalyzeInfo = struct {
         _ = self.folder2path.swapRemove(folder_asset);
     }
 
-    fn addAnalyzedFileInfo(self: *Self, io: std.Io, path: []const u8, asset_uuid: uuid.Uuid, depend_on: *UuidSet, provide_uuids: *UuidSet, imported_from: ?[]const u8) !void {
+    fn addAnalyzedFileInfo(self: *Self, io: std.Io, path: []const u8, asset_uuid: uuid.Uuid, depend_on: *UuidSet, provide_uuids: *UuidSet, imported_from: ?[]const u8, file_info: assetdb_snapshot.FileInfo) !void {
         log.debug("Add file info for path: {s}", .{path});
         try self.mapAssetPath(io, path, asset_uuid);
 
+        const path_intern = try self._str_intern.intern(io, path);
+
         // TODO
         self.file_info_lck.lockUncancelable(io);
         defer self.file_info_lck.unlock(io);
 
+        try self.path2file_info.put(self.allocator, path_intern, file_info);
+
+        if (self.asset_uuid2provide.getPtr(asset_uuid)) |provide| {
+            provide.deinit(self.allocator);
+        }
+        try self.asset_uuid2provide.put(self.allocator, asset_uuid, try provide_uuids.clone(self.allocator));
+
         for (provide_uuids.unmanaged.keys()) |provide_uuid| {
             try self.uuid2asset_uuid.put(self.allocator, provide_uuid, asset_uuid);
         }
@@ -241,6 +352,78 @@ const AnalyzeInfo = struct {
         }
     }
 
+    /// Take ownership of encoded value allocated with analyzer allocator.
+    fn putParsed(self: *Self, io: std.Io, path: []const u8, encoded: []u8) !void {
+        errdefer self.allocator.free(encoded);
+
+        const path_intern = try self._str_intern.intern(io, path);
+
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+
+        if (self.path2parsed.fetchSwapRemove(path_intern)) |old| {
+            self.parsed_bytes -= old.value.len;
+            self.allocator.free(old.value);
+        }
+
+        // Over budget import parse file again.
+        if (self.parsed_bytes + encoded.len > MAX_PARSED_BYTES) {
+            self.allocator.free(encoded);
+            return;
+        }
+
+        try self.path2parsed.put(self.allocator, path_intern, encoded);
+        self.parsed_bytes += encoded.len;
+        self.parsed_peak_bytes = @max(self.parsed_peak_bytes, self.parsed_bytes);
+    }
+
+    /// Caller own result and must free it with analyzer allocator.
+    fn takeParsed(self: *Self, io: std.Io, path: []const u8) ?[]u8 {
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+
+        const kv = self.path2parsed.fetchSwapRemove(path) orelse return null;
+        self.parsed_bytes -= kv.value.len;
+        return kv.value;
+    }
+
+    /// Write analyzed info for all asset files so next open analyze only changed files.
+    fn writeManifest(self: *Self, io: std.Io, root_dir: std.Io.Dir, allocator: std.mem.Allocator) !void {
+        var zone_ctx = profiler.Zone(@src());
+        defer zone_ctx.End();
+
+        var writer = assetdb_snapshot.Writer.init(allocator);
+        defer writer.deinit();
+
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+
+        for (self.asset_uuid2path.keys(), self.asset_uuid2path.values()) |asset_uuid, path| {
+            const file_info = self.path2file_info.get(path) orelse continue;
+            const depend_on = self.asset_uuid2depend.get(asset_uuid) orelse continue;
+            const provide = self.asset_uuid2provide.get(asset_uuid) orelse continue;
+
+            try writer.addAsset(
+                path,
+                asset_uuid,
+                file_info,
+                depend_on.unmanaged.keys(),
+                provide.unmanaged.keys(),
+                self.uuid2imported_from.get(asset_uuid),
+                null,
+                null,
+            );
+        }
+
+        try writer.writeFile(io, root_dir, MANIFEST_PATH);
+    }
+
+    fn getImportedFrom(self: *Self, io: std.Io, asset_uuid: uuid.Uuid) ?[]const u8 {
+        self.file_info_lck.lockUncancelable(io);
+        defer self.file_info_lck.unlock(io);
+        return self.uuid2imported_from.get(asset_uuid);
+    }
+
     pub fn addImportedAsset(self: *Self, io: std.Io, asset_uuid: uuid.Uuid, imported_from: []const u8) !void {
         // TODO
         self.file_info_lck.lockUncancelable(io);
@@ -251,12 +434,119 @@ const AnalyzeInfo = struct {
     }
 };
 
+/// Source file content hash and importer version of last successful import.
+/// Imported file that match it is not imported again because imported asset is already loaded.
+pub const ImportCache = struct {
+    const Self = @This();
+
+    pub const Entry = struct {
+        content_hash: u64,
+        version: u32,
+    };
+
+    const FileEntry = struct {
+        path: []const u8,
+        content_hash: u64,
+        version: u32,
+    };
+
+    allocator: std.mem.Allocator,
+    lock: std.Io.Mutex = .init,
+    entries: std.StringArrayHashMapUnmanaged(Entry) = .{},
+    dirty: bool = false,
+
+    pub fn init(allocator: std.mem.Allocator) Self {
+        return .{ .allocator = allocator };
+    }
+
+    pub fn deinit(self: *Self) void {
+        self.clear();
+        self.entries.deinit(self.allocator);
+    }
+
+    pub fn clear(self: *Self) void {
+        for (self.entries.keys()) |k| self.allocator.free(k);
+        self.entries.clearRetainingCapacity();
+        self.dirty = false;
+    }
+
+    pub fn isValid(self: *Self, io: std.Io, path: []const u8, entry: Entry) bool {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        const cached = self.entries.get(path) orelse return false;
+        return cached.content_hash == entry.content_hash and cached.version == entry.version;
+    }
+
+    pub fn put(self: *Self, io: std.Io, path: []const u8, entry: Entry) !void {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        const result = try self.entries.getOrPut(self.allocator, path);
+        if (!result.found_existing) {
+            result.key_ptr.* = self.allocator.dupe(u8, path) catch |err| {
+                self.entries.swapRemoveAt(result.index);
+                return err;
+            };
+        }
+        result.value_ptr.* = entry;
+        self.dirty = true;
+    }
+
+    pub fn load(self: *Self, io: std.Io, dir: std.Io.Dir, sub_path: []const u8) !void {
+        self.clear();
+
+        var file = dir.openFile(io, sub_path, .{ .mode = .read_only }) catch |err| switch (err) {
+            error.FileNotFound => return,
+            else => return err,
+        };
+        defer file.close(io);
+
+        var buffer: [4096]u8 = undefined;
+        var file_r = file.reader(io, &buffer);
+
+        var json_reader = std.json.Reader.init(self.allocator, &file_r.interface);
+        defer json_reader.deinit();
+
+        var parsed = try std.json.parseFromTokenSource([]const FileEntry, self.allocator, &json_reader, .{});
+        defer parsed.deinit();
+
+        for (parsed.value) |entry| {
+            try self.put(io, entry.path, .{ .content_hash = entry.content_hash, .version = entry.version });
+        }
+        self.dirty = false;
+    }
+
+    pub fn save(self: *Self, io: std.Io, dir: std.Io.Dir, sub_path: []const u8) !void {
+        self.lock.lockUncancelable(io);
+        defer self.lock.unlock(io);
+
+        var file = try dir.createFile(io, sub_path, .{});
+        defer file.close(io);
+
+        var buffer: [4096]u8 = undefined;
+        var bw = file.writer(io, &buffer);
+
+        var ws = std.json.Stringify{ .writer = &bw.interface, .options = .{ .whitespace = .indent_2 } };
+        try ws.beginArray();
+        for (self.entries.keys(), self.entries.values()) |path, entry| {
+            try ws.write(FileEntry{ .path = path, .content_hash = entry.content_hash, .version = entry.version });
+        }
+        try ws.endArray();
+        try bw.interface.flush();
+
+        self.dirty = false;
+    }
+};
+
 const AssetRootFS = struct {
     const Self = @This();
 
     allocator: std.mem.Allocator,
 
     analyzer: AnalyzeInfo,
+    import_cache: ImportCache,
+    blob_store: ?assetdb_blob_store.BlobStore = null,
 
     // Delete list
     assets_to_remove: ToDeleteList = .empty,
@@ -280,10 +570,18 @@ const AssetRootFS = struct {
     asset_root_folder: cdb.ObjId,
     asset_root_path: ?[]const u8,
 
+    // Watch
+    watch_id: ?fswatch.WatchId = null,
+    // Held by background save, watch events wait until save is done.
+    save_lock: std.Io.Mutex = .init,
+    written_hashes: std.StringArrayHashMapUnmanaged(u64) = .{},
+    written_hashes_lck: std.Io.Mutex = .init,
+
     pub fn init(io: std.Io, allocator: std.mem.Allocator) !Self {
         var self: Self = .{
             .allocator = allocator,
             .analyzer = try AnalyzeInfo.init(allocator),
+            .import_cache = .init(allocator),
 
             .asset_objid2version_lck = .init,
 
@@ -314,7 +612,12 @@ const AssetRootFS = struct {
     }
 
     pub fn deinit(self: *Self) void {
+        if (self.watch_id) |id| fswatch.unwatch(id);
+        self.written_hashes.deinit(self.allocator);
+
         self.analyzer.deinit();
+        self.import_cache.deinit();
+        self.closeBlobStore(_io);
 
         if (self.asset_root_path) |asset_root| {
             self.allocator.free(asset_root);
@@ -408,37 +711,241 @@ const AssetRootFS = struct {
     }
 
     // aaa
-    pub fn saveAllModifiedAssets(self: *Self, io: std.Io, allocator: std.mem.Allocator) !void {
+    pub fn saveAllModifiedAssets(self: *Self, io: std.Io, allocator: std.mem.Allocator, progress: ?*public.SaveProgress) !void {
         var zone_ctx = profiler.Zone(@src());
         defer zone_ctx.End();
 
+        self.save_lock.lockUncancelable(io);
+        defer self.save_lock.unlock(io);
+
         self.asset_root_lock.lockUncancelable(io);
         defer self.asset_root_lock.unlock(io);
 
+        const root_path = self.asset_root_path.?;
+
         const assets = (try AssetRootCdb.readSubObjSet(cdb.readObj(self.asset_root).?, .Assets, allocator)).?;
         defer allocator.free(assets);
 
-        var tasks = try TaskList.initCapacity(allocator, assets.len);
-        defer tasks.deinit(allocator);
+        var root_dir = try std.Io.Dir.cwd().openDir(io, root_path, .{});
+        defer root_dir.close(io);
+
+        // Only paths are resolved here, renames and moves are done in commit so cancel leave disk untouched.
+        var items = try cetech1.ArrayList(SaveItem).initCapacity(allocator, assets.len);
+        defer items.deinit(allocator);
 
         for (assets) |asset| {
             if (self.isToDeleted(asset)) continue;
             if (!self.isObjModified(asset)) continue;
 
-            if (self.saveAsset(io, allocator, self.asset_root_path.?, asset)) |export_task| {
-                if (export_task == .none) continue;
-                tasks.appendAssumeCapacity(export_task);
+            if (self.prepareSaveItem(io, asset)) |item| {
+                items.appendAssumeCapacity(item);
             } else |err| {
                 log.err("Could not save asset {}", .{err});
             }
         }
 
+        if (progress) |p| {
+            p.total.store(items.items.len, .release);
+            p.done.store(0, .release);
+        }
+
+        try root_dir.createDirPath(io, SAVE_STAGE_PATH);
+
+        // Serialize to stage files in parallel.
+        try task.parallelFor(
+            .{ .count = items.items.len, .grain_size = SAVE_BATCH_SIZE },
+            SaveRange.Ctx{ .io = io, .fs = self, .root_dir = root_dir, .root_path = root_path, .items = items.items, .progress = progress },
+            SaveRange,
+        );
+
+        const canceled = if (progress) |p| p.isCanceled() else false;
+
+        // Blobs referenced by written files must be on disk before files are replaced.
+        if (!canceled) {
+            if (self.blob_store) |*store| {
+                store.sync(io) catch |err| {
+                    log.err("Could not sync blob store {}", .{err});
+                    deleteStagedFiles(io, root_dir, items.items);
+                    return err;
+                };
+            }
+        }
+
+        if (canceled) {
+            deleteStagedFiles(io, root_dir, items.items);
+            return;
+        }
+
+        // Commit in order, move or rename first and then replace file with staged one.
+        // Failed item stay modified and is saved again next time.
+        var touched_dirs: std.StringArrayHashMapUnmanaged(void) = .{};
+        defer touched_dirs.deinit(allocator);
+
+        for (items.items, 0..) |item, idx| {
+            if (!item.written) continue;
+
+            var stage_buf: [std.fs.max_path_bytes]u8 = undefined;
+            const stage_path = try saveStagePath(&stage_buf, idx);
+
+            self.commitSaveItem(io, root_dir, item, stage_path, &touched_dirs, allocator) catch |err| {
+                log.err("Could not save asset {s}: {}", .{ item.file_path, err });
+                root_dir.deleteFile(io, stage_path) catch {};
+                continue;
+            };
+
+            self.markObjSaved(io, item.asset, item.version);
+            if (item.folder_path) |folder_path| {
+                try self.analyzer.mapFolderPath(io, folder_path, item.asset);
+            }
+            try self.analyzer.mapAssetPath(io, item.asset_path, try cdb.getOrCreateUuid(item.asset));
+        }
+
+        // One fsync per directory make renames durable.
+        for (touched_dirs.keys()) |dir_path| {
+            syncDir(io, root_dir, dir_path);
+        }
+
         try self.commitDeleteChanges(io, allocator);
 
-        task.waitMany(tasks.items);
+        // Overwritten and removed blobs are dead after commit.
+        self.compactBlobStore(io);
 
         self.asset_root_last_version = cdb.getVersion(self.asset_root);
     }
+
+    const SAVE_BATCH_SIZE = 8;
+
+    // Asset files are written here and moved to place on commit.
+    const SAVE_STAGE_PATH = public.CT_TEMP_FOLDER ++ "/" ++ "save";
+
+    fn saveStagePath(buf: []u8, idx: usize) ![]const u8 {
+        return std.fmt.bufPrint(buf, SAVE_STAGE_PATH ++ "/{d}.tmp", .{idx});
+    }
+
+    fn deleteStagedFiles(io: std.Io, root_dir: std.Io.Dir, items: []const SaveItem) void {
+        for (items, 0..) |item, idx| {
+            if (!item.written) continue;
+            var stage_buf: [std.fs.max_path_bytes]u8 = undefined;
+            root_dir.deleteFile(io, saveStagePath(&stage_buf, idx) catch continue) catch {};
+        }
+    }
+
+    const SaveItem = struct {
+        asset: cdb.ObjId,
+        version: u64,
+
+        // Path used for asset path map.
+        asset_path: []const u8,
+
+        // Path of written file.
+        file_path: []const u8,
+
+        // Only for folder.
+        folder_path: ?[]const u8 = null,
+
+        // Read under analyzer lock here, save tasks does not touch analyzer maps.
+        imported_from: ?[]const u8 = null,
+
+        written: bool = false,
+    };
+
+    fn prepareSaveItem(self: *Self, io: std.Io, asset: cdb.ObjId) !SaveItem {
+        var buff: [128]u8 = undefined;
+        const asset_path = try self.analyzer._str_intern.intern(io, try self.getFilenamePathForAsset(&buff, asset));
+
+        if (public.isAssetFolder(asset)) {
+            var folder_buff: [128]u8 = undefined;
+            const sub_path = try public.getPathForFolder(&folder_buff, asset);
+            const folder_path = if (sub_path.len != 0) sub_path else ".";
+
+            var path_buff: [std.fs.max_path_bytes]u8 = undefined;
+            const file_path = if (sub_path.len != 0) try std.fmt.bufPrint(&path_buff, "{s}/{s}", .{ sub_path, FOLDER_FILENAME }) else FOLDER_FILENAME;
+
+            return .{
+                .asset = asset,
+                .version = cdb.getVersion(asset),
+                .asset_path = asset_path,
+                .file_path = try self.analyzer._str_intern.intern(io, file_path),
+                .folder_path = try self.analyzer._str_intern.intern(io, folder_path),
+            };
+        }
+
+        return .{
+            .asset = asset,
+            .version = cdb.getVersion(asset),
+            .asset_path = asset_path,
+            .file_path = asset_path,
+            .imported_from = self.analyzer.getImportedFrom(io, try cdb.getOrCreateUuid(asset)),
+        };
+    }
+
+    fn commitSaveItem(
+        self: *Self,
+        io: std.Io,
+        root_dir: std.Io.Dir,
+        item: SaveItem,
+        stage_path: []const u8,
+        touched_dirs: *std.StringArrayHashMapUnmanaged(void),
+        allocator: std.mem.Allocator,
+    ) !void {
+        if (item.folder_path) |folder_path| {
+            if (self.analyzer.getFolderPath(io, item.asset)) |old_path| {
+                if (!std.mem.eql(u8, old_path, folder_path)) {
+                    try touched_dirs.put(allocator, std.fs.path.dirname(old_path) orelse ".", {});
+                }
+            }
+            _ = try self.moveFolder(io, root_dir, item.asset, if (std.mem.eql(u8, folder_path, ".")) "" else folder_path);
+        } else {
+            if (self.analyzer.getAssetPath(io, try cdb.getOrCreateUuid(item.asset))) |old_path| {
+                if (!std.mem.eql(u8, old_path, item.asset_path)) {
+                    try touched_dirs.put(allocator, std.fs.path.dirname(old_path) orelse ".", {});
+                }
+            }
+            try self.moveAsset(io, root_dir, item.asset, item.asset_path);
+        }
+
+        const dir_path = std.fs.path.dirname(item.file_path) orelse ".";
+        try root_dir.createDirPath(io, dir_path);
+        try self.renameWrittenFile(io, root_dir, stage_path, item.file_path, allocator);
+        try touched_dirs.put(allocator, dir_path, {});
+    }
+
+    const SaveRange = struct {
+        const Ctx = struct {
+            io: std.Io,
+            fs: *Self,
+            root_dir: std.Io.Dir,
+            root_path: []const u8,
+            items: []SaveItem,
+            progress: ?*public.SaveProgress,
+        };
+
+        pub fn exec(ctx: Ctx, range: cetech1.task.Range) !void {
+            var zone_ctx = profiler.ZoneN(@src(), "SaveRange");
+            defer zone_ctx.End();
+
+            const allocator = try tempalloc.create();
+            defer tempalloc.destroy(allocator);
+
+            for (ctx.items[range.begin..range.end], range.begin..) |*item, idx| {
+                if (ctx.progress) |p| {
+                    if (p.isCanceled()) return;
+                }
+
+                var stage_buf: [std.fs.max_path_bytes]u8 = undefined;
+                const stage_path = try saveStagePath(&stage_buf, idx);
+
+                if (writeObjFileAt(ctx.io, ctx.root_dir, ctx.root_path, item.asset, stage_path, item.imported_from, true, allocator)) {
+                    item.written = true;
+                } else |err| {
+                    log.err("Could not save asset {s}: {}", .{ item.file_path, err });
+                }
+
+                if (ctx.progress) |p| _ = p.done.fetchAdd(1, .release);
+            }
+        }
+    };
+
     // aaa
     pub fn saveAsAllAssets(self: *Self, io: std.Io, allocator: std.mem.Allocator, path: []const u8) !void {
         var zone_ctx = profiler.Zone(@src());
@@ -507,9 +1014,9 @@ const AssetRootFS = struct {
         var zone_ctx = profiler.Zone(@src());
         defer zone_ctx.End();
 
-        if (self.asset_root_path) |asset_root| {
-            self.allocator.free(asset_root);
-        }
+        const old_root_path = self.asset_root_path;
+        defer if (old_root_path) |p| self.allocator.free(p);
+
         if (std.fs.path.isAbsolute(asset_root_path)) {
             self.asset_root_path = try self.allocator.dupe(u8, asset_root_path);
         } else {
@@ -519,74 +1026,171 @@ const AssetRootFS = struct {
             self.asset_root_path = try self.allocator.dupe(u8, real_root_path);
         }
 
+        // Same root is opened again, only files changed since last open are imported.
+        const reopen = if (old_root_path) |p| !self.asset_root.isEmpty() and self.blob_store != null and std.mem.eql(u8, p, self.asset_root_path.?) else false;
+
         var root_dir = try std.Io.Dir.openDirAbsolute(io, self.asset_root_path.?, .{ .iterate = true });
         defer root_dir.close(io);
 
         try root_dir.createDirPath(io, public.CT_TEMP_FOLDER);
 
-        if (!self.asset_root.isEmpty()) {
-            cdb.destroyObject(self.asset_root);
+        if (reopen) {
+            _blob_store = .{ .root_path = self.asset_root_path.?, .store = &self.blob_store.? };
+        } else {
+            self.closeBlobStore(io);
+            self.blob_store = try assetdb_blob_store.BlobStore.open(io, self.allocator, root_dir, BLOB_DIR ++ "/" ++ assetdb_blob_store.DIR);
+            _blob_store = .{ .root_path = self.asset_root_path.?, .store = &self.blob_store.? };
+        }
 
-            // Force GC
-            try cdb.gc(allocator, _db);
+        // Cooked snapshot replace json parsing for unchanged assets.
+        var snapshot = assetdb_snapshot.Snapshot.open(io, self.allocator, root_dir, SNAPSHOT_PATH) catch |err| blk: {
+            if (err != error.FileNotFound) log.warn("Could not open asset snapshot: {}", .{err});
+            break :blk null;
+        };
+        defer if (snapshot) |*s| s.close(self.allocator);
 
-            self.asset_root = try public.AssetRootCdb.createObject(_db);
-        }
+        _snapshot = if (snapshot) |*s| s else null;
+        defer _snapshot = null;
+
+        // Manifest with analyze info from last open.
+        var manifest = assetdb_snapshot.Snapshot.open(io, self.allocator, root_dir, MANIFEST_PATH) catch |err| blk: {
+            if (err != error.FileNotFound) log.warn("Could not open asset manifest: {}", .{err});
+            break :blk null;
+        };
+        defer if (manifest) |*m| m.close(self.allocator);
+
+        _manifest = if (manifest) |*m| m else null;
+        defer _manifest = null;
+
+        self.import_cache.load(io, root_dir, IMPORT_CACHE_PATH) catch |err| {
+            log.warn("Could not load import cache: {}", .{err});
+            self.import_cache.clear();
+        };
 
-        // asset root folder
-        self.asset_root_folder = try self.getOrCreateFolder(io, self.allocator, root_dir, root_dir, null, null);
-        try self.addAssetToRoot(io, self.asset_root_folder);
         const root_path = try root_dir.realPathFileAlloc(io, ".", allocator);
         defer allocator.free(root_path);
-        log.info("Asset root dir {s}", .{root_path});
 
-        // project asset
-        // TODO: SHIT
-        var project_asset: ?cdb.ObjId = null;
-        if (!existRootProjectAsset(io, root_dir)) {
-            const project_obj = try public.ProjectCdb.createObject(_db);
-            const pa = public.createAsset("project", self.asset_root_folder, project_obj).?;
-            const save_task = try self.saveAsset(io, allocator, self.asset_root_path.?, pa);
-            task.wait(save_task);
+        if (reopen) {
+            try self.reopenChangedAssets(io, root_path, root_dir, allocator);
         } else {
-            project_asset = try self.loadProject(io, allocator, _db, asset_root_path, self.asset_root_folder);
+            try self.openAllAssets(io, asset_root_path, root_path, root_dir, allocator);
         }
 
-        try self.analyzer.resetAnalyzedFileInfo(io);
-        self.reset(io);
+        // Rewrite manifest only if something changed so unchanged project is only stat-ed.
+        const manifest_asset_count = if (manifest) |m| m.assets.len else 0;
+        const analyze_changed = self.analyzer.changed_files.load(.monotonic) != 0 or manifest_asset_count != self.analyzer.asset_uuid2path.count();
+        if (analyze_changed) {
+            self.analyzer.writeManifest(io, root_dir, allocator) catch |err| {
+                log.warn("Could not write asset manifest: {}", .{err});
+            };
+        }
 
-        // TODO: SHIT
-        if (project_asset) |a| {
-            self.markObjSaved(io, a, cdb.getVersion(a));
+        if (!reopen or analyze_changed) {
+            try self.writeAssetGraphMD(io);
         }
 
-        // Roor folder
-        try self.analyzer.path2folder.put(self.allocator, try self.analyzer._str_intern.intern(io, "."), self.asset_root_folder);
-        self.markObjSaved(io, self.asset_root_folder, cdb.getVersion(self.asset_root_folder));
+        // Resave obj version
+        const all_asset_copy = try allocator.dupe(cdb.ObjId, self.asset_objid2version.keys());
+        defer allocator.free(all_asset_copy);
+        for (all_asset_copy) |obj| {
+            try self.asset_objid2version.put(self.allocator, obj, cdb.getVersion(obj));
+        }
 
         var tasks = TaskList.empty;
         defer tasks.deinit(allocator);
-        try self.analyzeFolder(io, root_path, root_dir, self.asset_root_folder, &tasks, allocator);
+        try self.importFolder(io, root_path, root_dir, self.asset_root_folder, &tasks, allocator);
         task.waitMany(tasks.items);
 
+        if (self.import_cache.dirty) {
+            self.import_cache.save(io, root_dir, IMPORT_CACHE_PATH) catch |err| {
+                log.warn("Could not save import cache: {}", .{err});
+            };
+        }
+
+        self.asset_root_last_version = cdb.getVersion(self.asset_root);
+
+        // Reload assets changed outside of editor.
+        if (self.watch_id) |id| fswatch.unwatch(id);
+        self.watch_id = fswatch.watch(self.asset_root_path.?, .{}, self, onAssetRootChanged) catch |err| blk: {
+            log.warn("Could not watch asset root {s}: {}", .{ self.asset_root_path.?, err });
+            break :blk null;
+        };
+
+        const impls = try apidb.getImpl(allocator, public.AssetRootOpenedI);
+        defer allocator.free(impls);
+        for (impls) |iface| {
+            if (iface.opened) |opened| {
+                try opened();
+            }
+        }
+    }
+
+    // Destroy old asset root and import everything.
+    fn openAllAssets(self: *Self, io: std.Io, asset_root_path: []const u8, root_path: []const u8, root_dir: std.Io.Dir, allocator: std.mem.Allocator) !void {
+        var zone_ctx = profiler.Zone(@src());
+        defer zone_ctx.End();
+
+        if (!self.asset_root.isEmpty()) {
+            cdb.destroyObject(self.asset_root);
+
+            // Force GC
+            try cdb.gc(allocator, _db);
+
+            self.asset_root = try public.AssetRootCdb.createObject(_db);
+        }
+
+        // asset root folder
+        self.asset_root_folder = try self.getOrCreateFolder(io, self.allocator, root_dir, root_dir, null, null);
+        try self.addAssetToRoot(io, self.asset_root_folder);
+        log.info("Asset root dir {s}", .{root_path});
+
+        // project asset
+        // TODO: SHIT
+        var project_asset: ?cdb.ObjId = null;
+        if (!existRootProjectAsset(io, root_dir)) {
+            const project_obj = try public.ProjectCdb.createObject(_db);
+            const pa = public.createAsset("project", self.asset_root_folder, project_obj).?;
+            const save_task = try self.saveAsset(io, allocator, self.asset_root_path.?, pa);
+            task.wait(save_task);
+        } else {
+            project_asset = try self.loadProject(io, allocator, _db, asset_root_path, self.asset_root_folder);
+        }
+
+        try self.analyzer.resetAnalyzedFileInfo(io);
+        self.reset(io);
+
+        // TODO: SHIT
+        if (project_asset) |a| {
+            self.markObjSaved(io, a, cdb.getVersion(a));
+        }
+
+        // Roor folder
+        try self.analyzer.path2folder.put(self.allocator, try self.analyzer._str_intern.intern(io, "."), self.asset_root_folder);
+        self.markObjSaved(io, self.asset_root_folder, cdb.getVersion(self.asset_root_folder));
+
+        var tasks = TaskList.empty;
+        defer tasks.deinit(allocator);
+        try self.analyzeFolder(io, root_path, root_dir, self.asset_root_folder, &tasks, allocator);
+        task.waitMany(tasks.items);
+
+        log.debug("Analyzed {d} assets, {d} changed, parsed values kept for import {d} bytes", .{
+            self.analyzer.asset_uuid2path.count(),
+            self.analyzer.changed_files.load(.monotonic),
+            self.analyzer.parsed_peak_bytes,
+        });
+        _parsed_peak_bytes.store(self.analyzer.parsed_peak_bytes, .monotonic);
+
         try self.asset_dag.reset();
         for (self.analyzer.asset_uuid2depend.keys(), self.analyzer.asset_uuid2depend.values()) |asset_uuid, depends| {
             var depend_asset = UuidSet.empty;
             defer depend_asset.deinit(allocator);
 
-            for (depends.unmanaged.keys()) |depend_uuid| {
-                const d = self.analyzer.uuid2asset_uuid.get(depend_uuid).?;
-                if (std.mem.eql(u8, &d.bytes, &asset_uuid.bytes)) continue;
-                _ = try depend_asset.add(allocator, d);
-            }
-
+            try self.collectAssetDepends(asset_uuid, depends, &depend_asset, allocator);
             try self.asset_dag.add(asset_uuid, depend_asset.unmanaged.keys());
         }
 
         try self.asset_dag.build_all();
 
-        try self.writeAssetGraphMD(io);
-
         if (false) {
             for (self.asset_dag.output.keys()) |output| {
                 log.debug("Loader plan {s}", .{self.analyzer.asset_uuid2path.get(output).?});
@@ -599,7 +1203,223 @@ const AssetRootFS = struct {
             }
         }
 
-        for (self.asset_dag.output.keys()) |asset_uuid| {
+        try self.importCdbAssets(io, root_dir, &self.asset_dag);
+    }
+
+    // Diff asset files on disk with analyzed info from last open.
+    // Changed and added assets are analyzed and imported again, removed ones are destroyed
+    // and asset DAG is patched only for them. Unsaved changes are dropped same as on full open.
+    fn reopenChangedAssets(self: *Self, io: std.Io, root_path: []const u8, root_dir: std.Io.Dir, allocator: std.mem.Allocator) !void {
+        var zone_ctx = profiler.Zone(@src());
+        defer zone_ctx.End();
+
+        self.analyzer.changed_files.store(0, .monotonic);
+        self.assets_to_remove.clearRetainingCapacity();
+        self.folders_to_remove.clearRetainingCapacity();
+
+        var on_disk: std.StringArrayHashMapUnmanaged(void) = .{};
+        defer on_disk.deinit(allocator);
+
+        var changed: std.StringArrayHashMapUnmanaged(void) = .{};
+        defer changed.deinit(allocator);
+
+        try self.diffFolder(io, root_dir, root_dir, ".", &on_disk, &changed, allocator);
+        try self.dropUnsavedAssets(io, &on_disk, &changed, allocator);
+
+        // Analyze first so asset moved while closed is mapped to new path before old path is removed.
+        var tasks = TaskList.empty;
+        defer tasks.deinit(allocator);
+        for (changed.keys()) |path| {
+            const Task = struct {
+                fi: *Self,
+                root_dir_path: []const u8,
+                path: []const u8,
+                allocator: std.mem.Allocator,
+                io: std.Io,
+                pub fn exec(s: *@This()) !void {
+                    s.fi.analyzeFile(s.io, s.allocator, s.root_dir_path, s.path) catch |err| {
+                        log.err("Could not analyze asset {s}: {}", .{ s.path, err });
+                        return;
+                    };
+                }
+            };
+
+            try tasks.append(allocator, try task.schedule(
+                cetech1.task.TaskID.none,
+                Task{ .fi = self, .path = path, .allocator = allocator, .io = io, .root_dir_path = root_path },
+                .{},
+            ));
+        }
+        task.waitMany(tasks.items);
+
+        // Patch DAG for changed assets, import order is resolved only between them.
+        var changed_assets = UuidSet.empty;
+        defer changed_assets.deinit(allocator);
+        for (changed.keys()) |path| {
+            if (std.mem.eql(u8, path, PROJECT_FILENAME)) continue;
+            const asset_uuid = self.analyzer.getPathAsset(io, path) orelse continue;
+            _ = try changed_assets.add(allocator, asset_uuid);
+        }
+
+        var import_dag = cetech1.dag.DAG(uuid.Uuid).init(allocator);
+        defer import_dag.deinit();
+
+        for (changed_assets.unmanaged.keys()) |asset_uuid| {
+            var depend_asset = UuidSet.empty;
+            defer depend_asset.deinit(allocator);
+
+            if (self.analyzer.asset_uuid2depend.get(asset_uuid)) |depends| {
+                try self.collectAssetDepends(asset_uuid, depends, &depend_asset, allocator);
+            }
+
+            self.asset_dag.remove(asset_uuid);
+            try self.asset_dag.add(asset_uuid, depend_asset.unmanaged.keys());
+
+            var changed_depend = UuidSet.empty;
+            defer changed_depend.deinit(allocator);
+            for (depend_asset.unmanaged.keys()) |d| {
+                if (changed_assets.contains(d)) _ = try changed_depend.add(allocator, d);
+            }
+            try import_dag.add(asset_uuid, changed_depend.unmanaged.keys());
+        }
+
+        try import_dag.build_all();
+
+        if (changed.contains(PROJECT_FILENAME)) {
+            _ = try self.loadProject(io, allocator, _db, self.asset_root_path.?, self.asset_root_folder);
+        }
+
+        try self.importCdbAssets(io, root_dir, &import_dag);
+
+        // Removed files
+        var removed: cetech1.ArrayList([]const u8) = .empty;
+        defer removed.deinit(allocator);
+        {
+            self.analyzer.file_info_lck.lockUncancelable(io);
+            defer self.analyzer.file_info_lck.unlock(io);
+
+            for (self.analyzer.path2file_info.keys()) |path| {
+                if (!on_disk.contains(path)) try removed.append(allocator, path);
+            }
+        }
+
+        for (removed.items) |path| {
+            const asset_uuid = self.analyzer.getPathAsset(io, path);
+            self.removeFile(io, path) catch |err| {
+                log.err("Could not remove {s}: {}", .{ path, err });
+            };
+
+            if (asset_uuid) |u| {
+                if (self.analyzer.getAssetPath(io, u) == null) self.asset_dag.remove(u);
+            }
+        }
+
+        // Removed folders
+        var folders: cetech1.ArrayList([]const u8) = .empty;
+        defer folders.deinit(allocator);
+        {
+            self.analyzer.file_info_lck.lockUncancelable(io);
+            defer self.analyzer.file_info_lck.unlock(io);
+            try folders.appendSlice(allocator, self.analyzer.path2folder.keys());
+        }
+
+        for (folders.items) |folder_path| {
+            self.removeMissingFolder(io, root_dir, folder_path, allocator) catch |err| {
+                log.err("Could not remove folder {s}: {}", .{ folder_path, err });
+            };
+        }
+
+        log.info("Asset root dir {s} reopened, {d} changed and {d} removed files", .{ root_path, changed.count(), removed.items.len });
+    }
+
+    // Collect asset files in dir, files that differ from analyzed info are changed.
+    // Folders created since last open are created.
+    fn diffFolder(
+        self: *Self,
+        io: std.Io,
+        root_dir: std.Io.Dir,
+        dir: std.Io.Dir,
+        dir_path: []const u8,
+        on_disk: *std.StringArrayHashMapUnmanaged(void),
+        changed: *std.StringArrayHashMapUnmanaged(void),
+        allocator: std.mem.Allocator,
+    ) !void {
+        var iterator = dir.iterate();
+        while (try iterator.next(io)) |entry| {
+            // Skip . files
+            if (std.mem.startsWith(u8, entry.name, ".")) continue;
+
+            var path_buf: [std.fs.max_path_bytes]u8 = undefined;
+            const path = if (std.mem.eql(u8, dir_path, "."))
+                try self.analyzer._str_intern.intern(io, entry.name)
+            else
+                try self.analyzer._str_intern.intern(io, try std.fmt.bufPrint(&path_buf, "{s}" ++ std.fs.path.sep_str ++ "{s}", .{ dir_path, entry.name }));
+
+            if (entry.kind == .file) {
+                const extension = std.fs.path.extension(entry.name);
+                if (!std.mem.startsWith(u8, extension, CT_ASSETS_FILE_PREFIX)) continue;
+
+                try on_disk.put(allocator, path, {});
+
+                const stat = try dir.statFile(io, entry.name, .{});
+                if (self.analyzer.getFileInfo(io, path)) |info| {
+                    if (info.size == stat.size and info.mtime == assetdb_snapshot.mtimeNs(stat.mtime)) continue;
+                }
+
+                try changed.put(allocator, path, {});
+            } else if (entry.kind == .directory) {
+                _ = try self.getOrCreateFolderForPath(io, root_dir, path, allocator);
+
+                var sub_dir = try dir.openDir(io, entry.name, .{ .iterate = true });
+                defer sub_dir.close(io);
+                try self.diffFolder(io, root_dir, sub_dir, path, on_disk, changed, allocator);
+            }
+        }
+    }
+
+    // Assets modified in memory are read again from disk, never saved ones are destroyed.
+    fn dropUnsavedAssets(
+        self: *Self,
+        io: std.Io,
+        on_disk: *const std.StringArrayHashMapUnmanaged(void),
+        changed: *std.StringArrayHashMapUnmanaged(void),
+        allocator: std.mem.Allocator,
+    ) !void {
+        const assets = (try AssetRootCdb.readSubObjSet(cdb.readObj(self.asset_root).?, .Assets, allocator)).?;
+        defer allocator.free(assets);
+
+        for (assets) |asset| {
+            if (asset.eql(self.asset_root_folder)) continue;
+
+            if (public.isAssetFolder(asset)) {
+                if (self.analyzer.getFolderPath(io, asset) == null) cdb.destroyObject(asset);
+                continue;
+            }
+
+            const path = self.analyzer.getAssetPath(io, try cdb.getOrCreateUuid(asset)) orelse {
+                cdb.destroyObject(asset);
+                continue;
+            };
+
+            if (!self.isObjModified(asset) or !on_disk.contains(path)) continue;
+            try changed.put(allocator, path, {});
+        }
+    }
+
+    // Asset level dependencies, object uuids are resolved to assets that provide them.
+    fn collectAssetDepends(self: *Self, asset_uuid: uuid.Uuid, depends: UuidSet, out: *UuidSet, allocator: std.mem.Allocator) !void {
+        for (depends.unmanaged.keys()) |depend_uuid| {
+            const d = self.analyzer.uuid2asset_uuid.get(depend_uuid) orelse continue;
+            if (std.mem.eql(u8, &d.bytes, &asset_uuid.bytes)) continue;
+            _ = try out.add(allocator, d);
+        }
+    }
+
+    // Import cdb assets in DAG order, asset wait for import of assets it depend on.
+    fn importCdbAssets(self: *Self, io: std.Io, root_dir: std.Io.Dir, dag: *cetech1.dag.DAG(uuid.Uuid)) !void {
+        self.tmp_taskid_map.clearRetainingCapacity();
+
+        for (dag.output.keys()) |asset_uuid| {
             const asset_path = self.analyzer.asset_uuid2path.get(asset_uuid).?;
             const filename = std.fs.path.basename(asset_path);
             // const extension = std.fs.path.extension(asset_path);
@@ -610,7 +1430,7 @@ const AssetRootFS = struct {
             if (std.mem.eql(u8, filename, PROJECT_FILENAME)) continue;
 
             var prereq = cetech1.task.TaskID.none;
-            const depeds = self.asset_dag.dependList(asset_uuid);
+            const depeds = dag.dependList(asset_uuid);
             if (depeds != null) {
                 self.tmp_depend_array.clearRetainingCapacity();
                 for (depeds.?) |d| {
@@ -624,7 +1444,7 @@ const AssetRootFS = struct {
             }
 
             const copy_dir = try root_dir.openDir(io, dirname, .{});
-            if (self.importCdbAsset(io, _db, prereq, copy_dir, parent_folder, filename, null)) |import_task| {
+            if (self.importCdbAsset(io, _db, prereq, copy_dir, parent_folder, filename, asset_path, null)) |import_task| {
                 try self.tmp_taskid_map.put(self.allocator, asset_uuid, import_task);
             } else |err| {
                 log.err("Could not import cdb asset {s}: {}", .{ asset_path, err });
@@ -635,25 +1455,126 @@ const AssetRootFS = struct {
 
         // const sync_job = try task.combine(self.tmp_taskid_map.values());
         task.waitMany(self.tmp_taskid_map.values());
+    }
 
-        // Resave obj version
-        const all_asset_copy = try allocator.dupe(cdb.ObjId, self.asset_objid2version.keys());
-        defer allocator.free(all_asset_copy);
-        for (all_asset_copy) |obj| {
-            try self.asset_objid2version.put(self.allocator, obj, cdb.getVersion(obj));
+    fn compactBlobStore(self: *Self, io: std.Io) void {
+        if (self.blob_store) |*store| {
+            const compacted = store.compactIfNeeded(io) catch |err| {
+                log.warn("Could not compact blob store {}", .{err});
+                return;
+            };
+            if (compacted) log.debug("Blob store compacted", .{});
         }
+    }
 
-        tasks.clearRetainingCapacity();
-        try self.importFolder(io, root_path, root_dir, self.asset_root_folder, &tasks, allocator);
-        task.waitMany(tasks.items);
+    fn closeBlobStore(self: *Self, io: std.Io) void {
+        self.compactBlobStore(io);
+        if (self.blob_store) |*store| {
+            _blob_store = null;
+            store.close(io);
+            self.blob_store = null;
+        }
+    }
 
-        self.asset_root_last_version = cdb.getVersion(self.asset_root);
+    /// Cook all json assets and blobs under asset root to binary snapshot in temp folder.
+    pub fn cookSnapshot(self: *Self, io: std.Io, asset_root_path: []const u8, allocator: std.mem.Allocator) !void {
+        var zone_ctx = profiler.Zone(@src());
+        defer zone_ctx.End();
 
-        const impls = try apidb.getImpl(allocator, public.AssetRootOpenedI);
-        defer allocator.free(impls);
-        for (impls) |iface| {
-            if (iface.opened) |opened| {
-                try opened();
+        var root_dir = try std.Io.Dir.cwd().openDir(io, asset_root_path, .{ .iterate = true });
+        defer root_dir.close(io);
+
+        var writer = assetdb_snapshot.Writer.init(allocator);
+        defer writer.deinit();
+
+        try self.cookSnapshotFolder(io, allocator, &writer, root_dir, null);
+
+        // Blobs of opened root are in use, other root store is opened only for cook.
+        // Per file blobs of old asset roots are not cooked, they are read from files.
+        if (blobStoreFor(asset_root_path)) |store| {
+            try cookBlobs(io, allocator, &writer, store);
+        } else {
+            var store = try assetdb_blob_store.BlobStore.open(io, allocator, root_dir, BLOB_DIR ++ "/" ++ assetdb_blob_store.DIR);
+            defer store.close(io);
+            try cookBlobs(io, allocator, &writer, &store);
+        }
+
+        try root_dir.createDirPath(io, public.CT_TEMP_FOLDER);
+        try writer.writeFile(io, root_dir, SNAPSHOT_PATH);
+
+        log.info("Cooked asset snapshot with {d} assets and {d} blobs", .{ writer.assets.items.len, writer.blobs.items.len });
+    }
+
+    fn cookBlobs(io: std.Io, allocator: std.mem.Allocator, writer: *assetdb_snapshot.Writer, store: *assetdb_blob_store.BlobStore) !void {
+        // Cook is good time to drop dead blobs so they are not read again.
+        _ = try store.compactIfNeeded(io);
+
+        const keys = try store.keys(io, allocator);
+        defer allocator.free(keys);
+
+        for (keys) |key| {
+            const data = (try store.get(io, key)) orelse continue;
+            try writer.addBlob(key, data);
+        }
+    }
+
+    fn cookSnapshotFolder(self: *Self, io: std.Io, allocator: std.mem.Allocator, writer: *assetdb_snapshot.Writer, dir: std.Io.Dir, dir_path: ?[]const u8) !void {
+        var iterator = dir.iterate();
+        while (try iterator.next(io)) |entry| {
+            // Skip . files
+            if (std.mem.startsWith(u8, entry.name, ".")) continue;
+
+            const path = if (dir_path) |p| try std.fs.path.join(allocator, &.{ p, entry.name }) else try allocator.dupe(u8, entry.name);
+            defer allocator.free(path);
+
+            if (entry.kind == .file) {
+                const extension = std.fs.path.extension(entry.name);
+                if (!std.mem.startsWith(u8, extension, CT_ASSETS_FILE_PREFIX)) continue;
+
+                var file = try dir.openFile(io, entry.name, .{ .mode = .read_only });
+                defer file.close(io);
+
+                const stat = try file.stat(io);
+
+                const content = try allocator.alloc(u8, stat.size);
+                defer allocator.free(content);
+                _ = try file.readPositionalAll(io, content, 0);
+
+                const encoded = try assetdb_snapshot.encodeJson(allocator, content);
+                defer allocator.free(encoded);
+
+                const value = try assetdb_snapshot.ValueView.init(encoded);
+
+                try validateVersion(try (try value.get(JSON_ASSET_VERSION)).?.str());
+
+                const asset_uuid = uuid.fromStr(try (try value.get(JSON_ASSET_UUID_TOKEN)).?.str()).?;
+                const imported_from = if (try value.get(JSON_IMPORTED_FROM)) |v| try v.str() else null;
+
+                var depend_on = UuidSet.empty;
+                defer depend_on.deinit(allocator);
+
+                var provide_uuids = UuidSet.empty;
+                defer provide_uuids.deinit(allocator);
+
+                try self.analyzFromView(value, allocator, &depend_on, &provide_uuids);
+
+                const image = try cookCdbImage(allocator, value);
+                defer if (image) |i| allocator.free(i);
+
+                try writer.addAsset(
+                    path,
+                    asset_uuid,
+                    .init(stat, content),
+                    depend_on.unmanaged.keys(),
+                    provide_uuids.unmanaged.keys(),
+                    imported_from,
+                    encoded,
+                    image,
+                );
+            } else if (entry.kind == .directory) {
+                var sub_dir = try dir.openDir(io, entry.name, .{ .iterate = true });
+                defer sub_dir.close(io);
+                try self.cookSnapshotFolder(io, allocator, writer, sub_dir, path);
             }
         }
     }
@@ -671,36 +1592,31 @@ const AssetRootFS = struct {
         defer root_dir.close(io);
 
         if (!public.isAssetFolder(asset)) {
-            const a_uuid = try cdb.getOrCreateUuid(asset);
-            if (self.analyzer.getAssetPath(io, a_uuid)) |old_path| {
-                // rename or move.
-                if (!std.mem.eql(u8, old_path, new_path)) {
-                    // Rename
-                    if (std.fs.path.dirname(new_path)) |dir| {
-                        try root_dir.createDirPath(io, dir);
-                    }
-
-                    try root_dir.rename(old_path, root_dir, new_path, io);
-                    try self.analyzer.unmapAssetPath(io, old_path, a_uuid);
-                }
-            }
+            try self.moveAsset(io, root_dir, asset, new_path);
         }
 
         const taskid = try self.exportCdbAsset(io, _db, root_path, new_path, asset);
         return taskid;
     }
 
-    // aaa
-    pub fn saveFolderObj(self: *Self, io: std.Io, allocator: std.mem.Allocator, folder_asset: cdb.ObjId, root_path: []const u8) !void {
-        var zone_ctx = profiler.Zone(@src());
-        defer zone_ctx.End();
-
-        var buff: [128]u8 = undefined;
-        const sub_path = try public.getPathForFolder(&buff, folder_asset);
+    fn moveAsset(self: *Self, io: std.Io, root_dir: std.Io.Dir, asset: cdb.ObjId, new_path: []const u8) !void {
+        const a_uuid = try cdb.getOrCreateUuid(asset);
+        if (self.analyzer.getAssetPath(io, a_uuid)) |old_path| {
+            // rename or move.
+            if (!std.mem.eql(u8, old_path, new_path)) {
+                // Rename
+                if (std.fs.path.dirname(new_path)) |dir| {
+                    try root_dir.createDirPath(io, dir);
+                }
 
-        var root_dir = try std.Io.Dir.cwd().openDir(io, root_path, .{});
-        defer root_dir.close(io);
+                try root_dir.rename(old_path, root_dir, new_path, io);
+                try self.analyzer.unmapAssetPath(io, old_path, a_uuid);
+            }
+        }
+    }
 
+    // Return folder path used for folder path map.
+    fn moveFolder(self: *Self, io: std.Io, root_dir: std.Io.Dir, folder_asset: cdb.ObjId, sub_path: []const u8) ![]const u8 {
         const new_path = if (sub_path.len != 0) sub_path else ".";
         if (self.analyzer.getFolderPath(io, folder_asset)) |old_path| {
             // rename or move.
@@ -716,30 +1632,29 @@ const AssetRootFS = struct {
             try root_dir.createDirPath(io, sub_path);
         }
 
-        const path = try std.fs.path.join(allocator, &.{ sub_path, FOLDER_FILENAME });
-        defer allocator.free(path);
+        return new_path;
+    }
 
-        var obj_file = try root_dir.createFile(io, path, .{});
-        defer obj_file.close(io);
+    // aaa
+    pub fn saveFolderObj(self: *Self, io: std.Io, allocator: std.mem.Allocator, folder_asset: cdb.ObjId, root_path: []const u8) !void {
+        var zone_ctx = profiler.Zone(@src());
+        defer zone_ctx.End();
 
-        var buffer: [4096]u8 = undefined;
+        var buff: [128]u8 = undefined;
+        const sub_path = try public.getPathForFolder(&buff, folder_asset);
 
-        var bw = obj_file.writer(io, &buffer);
-        const writer = &bw.interface;
-        defer writer.flush() catch undefined;
+        var root_dir = try std.Io.Dir.cwd().openDir(io, root_path, .{});
+        defer root_dir.close(io);
+
+        const new_path = try self.moveFolder(io, root_dir, folder_asset, sub_path);
+
+        const path = try std.fs.path.join(allocator, &.{ sub_path, FOLDER_FILENAME });
+        defer allocator.free(path);
 
         log.info("Creating folder asset in {s}.", .{sub_path});
 
-        try writeCdbObjJson(
-            io,
-            folder_asset,
-            writer,
-            folder_asset,
-            WriteBlobToFile,
-            root_path,
-            allocator,
-            null,
-        );
+        try writeObjFileTmp(io, root_dir, root_path, folder_asset, path, null, false, allocator);
+        try self.commitWrittenTmpFile(io, root_dir, path, allocator);
 
         self.markObjSaved(io, folder_asset, cdb.getVersion(folder_asset));
         try self.analyzer.mapFolderPath(io, new_path, folder_asset);
@@ -786,6 +1701,7 @@ const AssetRootFS = struct {
                 var buff: [128]u8 = undefined;
                 const path = try public.getPathForFolder(&buff, folder);
                 try root_dir.deleteTree(io, path);
+                try self.analyzer.unmapFolderPath(io, path, folder);
 
                 // Blob
                 const references = try cdb.getReferencerSet(allocator, public.getObjForAsset(folder).?);
@@ -810,10 +1726,12 @@ const AssetRootFS = struct {
                 const blob_dir_path = try std.fs.path.join(allocator, &.{ BLOB_DIR, extension });
                 defer allocator.free(blob_dir_path);
                 try root_dir.deleteTree(io, blob_dir_path);
+                if (self.blob_store) |*store| try store.removeAsset(io, (try cdb.getOrCreateUuid(asset)).bytes);
 
                 // asset
                 const path = try self.getFilenamePathForAsset(&buff, asset);
                 try root_dir.deleteTree(io, path);
+                _ = self.analyzer.removeAssetFile(io, path);
                 cdb.destroyObject(asset);
             }
         }
@@ -867,33 +1785,27 @@ const AssetRootFS = struct {
 
         var dir = try std.Io.Dir.cwd().openDir(io, asset_root_path, .{});
 
-        var asset_file = dir.openFile(io, PROJECT_FILENAME, .{ .mode = .read_only }) catch |err| {
-            log.err("Could not load {s} {}", .{ PROJECT_FILENAME, err });
-            return err;
-        };
-        defer asset_file.close(io);
-
-        var buffer: [4096]u8 = undefined;
-        var asset_reader = asset_file.reader(io, &buffer);
-        const asset_r = &asset_reader.interface;
-
-        const asset = readAssetFromReader(
+        const asset = readAssetFile(
             io,
-            asset_r,
+            dir,
+            PROJECT_FILENAME,
+            PROJECT_FILENAME,
+            null,
             "project",
             asset_root_folder,
             asset_root_path,
-            ReadBlobFromFile,
             allocator,
         ) catch |err| {
-            log.err("Could not read asset {}", .{err});
+            log.err("Could not read asset {s} {}", .{ PROJECT_FILENAME, err });
             return err;
         };
 
-        self.addAssetToRoot(io, asset) catch |err| {
-            log.err("Could not add asset to root {}", .{err});
-            return err;
-        };
+        if (!cdb.getParent(asset).eql(self.asset_root)) {
+            self.addAssetToRoot(io, asset) catch |err| {
+                log.err("Could not add asset to root {}", .{err});
+                return err;
+            };
+        }
 
         // Save current version to assedb.
         self.markObjSaved(io, asset, cdb.getVersion(asset));
@@ -944,6 +1856,7 @@ const AssetRootFS = struct {
         dir: std.Io.Dir,
         folder: cdb.ObjId,
         filename: []const u8,
+        path: []const u8,
         reimport_to: ?cdb.ObjId,
     ) !cetech1.task.TaskID {
         _ = reimport_to;
@@ -954,6 +1867,7 @@ const AssetRootFS = struct {
             dir: std.Io.Dir,
             folder: cdb.ObjId,
             filename: []const u8,
+            path: []const u8,
 
             pub fn exec(self: *@This()) !void {
                 var zone_ctx = profiler.Zone(@src());
@@ -968,36 +1882,32 @@ const AssetRootFS = struct {
 
                 log.debug("Importing cdb asset {s}", .{full_path});
 
-                var asset_file = self.dir.openFile(self.io, self.filename, .{ .mode = .read_only }) catch |err| {
-                    log.err("Could not import asset {}", .{err});
-                    return;
-                };
-
-                defer asset_file.close(self.io);
                 defer self.dir.close(self.io);
 
-                var buffer: [4096]u8 = undefined;
+                const parsed = self.assetroot_fs.analyzer.takeParsed(self.io, self.path);
+                defer if (parsed) |p| self.assetroot_fs.analyzer.allocator.free(p);
 
-                var rb = asset_file.reader(self.io, &buffer);
-                const asset_reader = &rb.interface;
-
-                const asset = readAssetFromReader(
+                const asset = readAssetFile(
                     self.io,
-                    asset_reader,
+                    self.dir,
+                    self.filename,
+                    self.path,
+                    parsed,
                     std.fs.path.stem(std.fs.path.stem(self.filename)),
                     self.folder,
                     self.assetroot_fs.asset_root_path.?,
-                    ReadBlobFromFile,
                     allocator,
                 ) catch |err| {
                     log.err("Could not import asset {}", .{err});
                     return;
                 };
 
-                self.assetroot_fs.addAssetToRoot(self.io, asset) catch |err| {
-                    log.err("Could not add asset to root {}", .{err});
-                    return;
-                };
+                if (!cdb.getParent(asset).eql(self.assetroot_fs.asset_root)) {
+                    self.assetroot_fs.addAssetToRoot(self.io, asset) catch |err| {
+                        log.err("Could not add asset to root {}", .{err});
+                        return;
+                    };
+                }
 
                 // Save current version to assedb.
                 self.assetroot_fs.markObjSaved(self.io, asset, cdb.getVersion(asset));
@@ -1012,6 +1922,7 @@ const AssetRootFS = struct {
                 .dir = dir,
                 .folder = folder,
                 .filename = filename,
+                .path = path,
                 .assetroot_fs = selff,
             },
             .{},
@@ -1030,28 +1941,11 @@ const AssetRootFS = struct {
             try root_dir.createDirPath(io, dir_path.?);
         }
 
-        var obj_file = try root_dir.createFile(io, sub_path, .{});
-        defer obj_file.close(io);
-
-        var buffer: [4096]u8 = undefined;
-
-        var bw = obj_file.writer(io, &buffer);
-        const writer = &bw.interface;
-        defer writer.flush() catch undefined;
-
-        const imported_from = self.analyzer.uuid2imported_from.get(try cdb.getOrCreateUuid(obj));
+        const imported_from = self.analyzer.getImportedFrom(io, try cdb.getOrCreateUuid(obj));
 
         //const folder = public.Asset.readRef( _db.readObj(obj).?, .Folder).?;
-        try writeCdbObjJson(
-            io,
-            obj,
-            writer,
-            obj,
-            WriteBlobToFile,
-            root_path,
-            allocator,
-            imported_from,
-        );
+        try writeObjFileTmp(io, root_dir, root_path, obj, sub_path, imported_from, false, allocator);
+        try self.commitWrittenTmpFile(io, root_dir, sub_path, allocator);
     }
 
     fn exportCdbAsset(
@@ -1109,10 +2003,299 @@ const AssetRootFS = struct {
                 .root_path = root_path,
                 .assetroot_fs = selff,
             },
-            .{},
+            .{ .priority = .background },
         );
     }
 
+    // Run importer for one file, skip it if import cache say that it is up to date.
+    fn importFile(
+        self: *Self,
+        io: std.Io,
+        root_dir_path: []const u8,
+        path: []const u8,
+        filename: []const u8,
+        folder: cdb.ObjId,
+        asset_io: *const public.AssetIOI,
+        allocator: std.mem.Allocator,
+    ) !void {
+        const dirname = std.fs.path.dirname(path).?;
+        var copy_dir = try std.Io.Dir.openDirAbsolute(io, dirname, .{});
+        defer copy_dir.close(io);
+
+        const imported_from = blk: {
+            if (self.analyzer.imported_from2uuid.get(filename)) |asset_uuid| {
+                break :blk cdb.getObjId(_db, asset_uuid).?;
+            }
+
+            break :blk null;
+        };
+
+        const relative_path = try std.fs.path.relative(allocator, ".", null, root_dir_path, path);
+        defer allocator.free(relative_path);
+
+        // Skip import if imported asset is loaded and made from same source.
+        const cache_entry: ?ImportCache.Entry = if (asset_io.import_cache_version) |version| .{
+            .content_hash = try hashFile(io, copy_dir, filename, allocator),
+            .version = version,
+        } else null;
+
+        if (cache_entry) |entry| {
+            if (imported_from != null and self.import_cache.isValid(io, relative_path, entry)) {
+                log.debug("Import of {s} is up to date", .{relative_path});
+                return;
+            }
+        }
+
+        const version_before = if (imported_from) |asset| cdb.getVersion(asset) else 0;
+
+        const import_task = try asset_io.import_asset.?(io, _db, .none, copy_dir, folder, filename, imported_from);
+        task.wait(import_task);
+
+        // Importer run in own task and errors are not propagated here,
+        // so import is valid only if it created or changed imported asset.
+        if (cache_entry) |entry| {
+            const imported_asset = if (self.analyzer.imported_from2uuid.get(filename)) |asset_uuid| cdb.getObjId(_db, asset_uuid) else null;
+            if (imported_asset) |asset| {
+                if (imported_from == null or cdb.getVersion(asset) != version_before) {
+                    try self.import_cache.put(io, relative_path, entry);
+                }
+            }
+        }
+    }
+
+    // Move file written by us to path and remember its content hash so watcher does not reload it.
+    // Hash is used instead of mtime because mtime resolution can hide edit made right after save.
+    // Hash is put before rename under lock taken by isWrittenByUs so watcher never see new file without it.
+    fn renameWrittenFile(self: *Self, io: std.Io, root_dir: std.Io.Dir, written_path: []const u8, path: []const u8, allocator: std.mem.Allocator) !void {
+        const content_hash = try hashFile(io, root_dir, written_path, allocator);
+        const path_intern = try self.analyzer._str_intern.intern(io, path);
+
+        self.written_hashes_lck.lockUncancelable(io);
+        defer self.written_hashes_lck.unlock(io);
+
+        try self.written_hashes.put(self.allocator, path_intern, content_hash);
+        errdefer _ = self.written_hashes.swapRemove(path_intern);
+
+        try root_dir.rename(written_path, root_dir, path, io);
+    }
+
+    fn commitWrittenTmpFile(self: *Self, io: std.Io, root_dir: std.Io.Dir, path: []const u8, allocator: std.mem.Allocator) !void {
+        var tmp_buf: [std.fs.max_path_bytes]u8 = undefined;
+        try self.renameWrittenFile(io, root_dir, try tmpPath(&tmp_buf, path), path, allocator);
+    }
+
+    // Events are coalesced per path so entry is consumed by first event after write.
+    fn isWrittenByUs(self: *Self, io: std.Io, root_dir: std.Io.Dir, path: []const u8, allocator: std.mem.Allocator) !bool {
+        const written = blk: {
+            self.written_hashes_lck.lockUncancelable(io);
+            defer self.written_hashes_lck.unlock(io);
+            const kv = self.written_hashes.fetchSwapRemove(path) orelse return false;
+            break :blk kv.value;
+        };
+
+        return written == try hashFile(io, root_dir, path, allocator);
+    }
+
+    fn onAssetRootChanged(ctx: ?*anyopaque, root_path: []const u8, events: []const fswatch.Event) anyerror!void {
+        var zone_ctx = profiler.Zone(@src());
+        defer zone_ctx.End();
+
+        const self: *Self = @ptrCast(@alignCast(ctx.?));
+
+        // Save read asset root and delete lists from other thread, do not block main thread and get events again later.
+        if (!self.save_lock.tryLock()) return error.WatchBusy;
+        defer self.save_lock.unlock(_io);
+
+        const allocator = try tempalloc.create();
+        defer tempalloc.destroy(allocator);
+
+        var root_dir = try std.Io.Dir.openDirAbsolute(_io, root_path, .{});
+        defer root_dir.close(_io);
+
+        // Changed files first so asset moved outside of editor is mapped to new path before old path is removed.
+        for (events) |event| {
+            if (event.kind != .changed) continue;
+            self.reimportFile(_io, root_dir, root_path, event.path, allocator) catch |err| {
+                log.err("Could not reload {s}: {}", .{ event.path, err });
+            };
+        }
+
+        for (events) |event| {
+            switch (event.kind) {
+                .changed => continue,
+                .removed => self.removeFile(_io, event.path) catch |err| {
+                    log.err("Could not remove {s}: {}", .{ event.path, err });
+                },
+                .dir_removed => self.removeDirFiles(_io, event.path, allocator) catch |err| {
+                    log.err("Could not remove files in {s}: {}", .{ event.path, err });
+                },
+            }
+        }
+
+        // Folder is removed when all its files are removed.
+        for (events) |event| {
+            const dir_path = switch (event.kind) {
+                .changed => continue,
+                .removed => std.fs.path.dirname(event.path) orelse ".",
+                .dir_removed => event.path,
+            };
+            self.removeMissingFolder(_io, root_dir, dir_path, allocator) catch |err| {
+                log.err("Could not remove folder of {s}: {}", .{ event.path, err });
+            };
+        }
+
+        if (self.import_cache.dirty) {
+            self.import_cache.save(_io, root_dir, IMPORT_CACHE_PATH) catch |err| {
+                log.warn("Could not save import cache: {}", .{err});
+            };
+        }
+    }
+
+    // Reload json asset or run importer for file changed outside of editor.
+    fn reimportFile(self: *Self, io: std.Io, root_dir: std.Io.Dir, root_path: []const u8, path: []const u8, allocator: std.mem.Allocator) !void {
+        if (std.mem.endsWith(u8, path, TMP_POSTFIX)) return;
+
+        _ = root_dir.statFile(io, path, .{}) catch |err| switch (err) {
+            error.FileNotFound => return,
+            else => return err,
+        };
+        if (try self.isWrittenByUs(io, root_dir, path, allocator)) return;
+
+        const filename = std.fs.path.basename(path);
+        const dirname = std.fs.path.dirname(path) orelse ".";
+
+        const folder = try self.getOrCreateFolderForPath(io, root_dir, dirname, allocator);
+
+        const extension = std.fs.path.extension(filename);
+
+        if (std.mem.eql(u8, extension, CT_ASSETS_FILE_PREFIX)) {
+            if (std.mem.eql(u8, filename, FOLDER_FILENAME) or std.mem.eql(u8, filename, PROJECT_FILENAME)) return;
+
+            log.info("Reloading asset {s}", .{path});
+
+            var dir = try root_dir.openDir(io, dirname, .{});
+            defer dir.close(io);
+
+            const asset = try readAssetFile(
+                io,
+                dir,
+                filename,
+                path,
+                null,
+                std.fs.path.stem(std.fs.path.stem(filename)),
+                folder,
+                root_path,
+                allocator,
+            );
+
+            if (!cdb.getParent(asset).eql(self.asset_root)) {
+                try self.addAssetToRoot(io, asset);
+            }
+
+            try self.analyzer.mapAssetPath(io, path, try cdb.getOrCreateUuid(asset));
+            self.markObjSaved(io, asset, cdb.getVersion(asset));
+            return;
+        }
+
+        const asset_io = public.findFirstAssetIOForImport(filename, extension) orelse return;
+
+        log.info("Reimporting {s}", .{path});
+
+        const full_path = try std.fs.path.join(allocator, &.{ root_path, path });
+        defer allocator.free(full_path);
+
+        try self.importFile(io, root_path, full_path, try self.analyzer._str_intern.intern(io, filename), folder, asset_io, allocator);
+    }
+
+    // Asset file removed outside of editor, asset is removed from db.
+    fn removeFile(self: *Self, io: std.Io, path: []const u8) !void {
+        if (std.mem.endsWith(u8, path, TMP_POSTFIX)) return;
+
+        const asset_uuid = self.analyzer.removeAssetFile(io, path) orelse return;
+        const asset = cdb.getObjId(_db, asset_uuid) orelse return;
+
+        log.info("Asset file {s} removed outside of editor, removing asset", .{path});
+
+        _ = self.assets_to_remove.remove(asset);
+        cdb.destroyObject(asset);
+    }
+
+    // Dir removed or moved outside of editor, watch report only dir so remove every asset file under it.
+    fn removeDirFiles(self: *Self, io: std.Io, dir_path: []const u8, allocator: std.mem.Allocator) !void {
+        var paths: cetech1.ArrayList([]const u8) = .empty;
+        defer paths.deinit(allocator);
+
+        {
+            self.analyzer.file_info_lck.lockUncancelable(io);
+            defer self.analyzer.file_info_lck.unlock(io);
+
+            for (self.analyzer.path2asset_uuid.keys()) |path| {
+                const in_dir = std.mem.startsWith(u8, path, dir_path) and path.len > dir_path.len and path[dir_path.len] == '/';
+                if (!in_dir) continue;
+                try paths.append(allocator, path);
+            }
+        }
+
+        for (paths.items) |path| try self.removeFile(io, path);
+    }
+
+    // Folder removed outside of editor, folder asset and its subfolders are removed from db.
+    fn removeMissingFolder(self: *Self, io: std.Io, root_dir: std.Io.Dir, dir_path: []const u8, allocator: std.mem.Allocator) !void {
+        if (std.mem.eql(u8, dir_path, ".")) return;
+
+        if (root_dir.statFile(io, dir_path, .{})) |_| {
+            return;
+        } else |err| switch (err) {
+            error.FileNotFound => {},
+            else => return err,
+        }
+
+        const RemovedFolder = struct { path: []const u8, folder: cdb.ObjId };
+        var removed: cetech1.ArrayList(RemovedFolder) = .empty;
+        defer removed.deinit(allocator);
+
+        {
+            self.analyzer.file_info_lck.lockUncancelable(io);
+            defer self.analyzer.file_info_lck.unlock(io);
+
+            for (self.analyzer.path2folder.keys(), self.analyzer.path2folder.values()) |path, folder| {
+                const is_subfolder = std.mem.startsWith(u8, path, dir_path) and (path.len == dir_path.len or path[dir_path.len] == '/');
+                if (!is_subfolder) continue;
+                try removed.append(allocator, .{ .path = path, .folder = folder });
+            }
+        }
+
+        for (removed.items) |item| {
+            log.info("Folder {s} removed outside of editor, removing folder", .{item.path});
+
+            try self.analyzer.unmapFolderPath(io, item.path, item.folder);
+            _ = self.folders_to_remove.remove(item.folder);
+            cdb.destroyObject(item.folder);
+        }
+    }
+
+    // Folder created outside of editor, folder assets are created for missing folders in path.
+    fn getOrCreateFolderForPath(self: *Self, io: std.Io, root_dir: std.Io.Dir, dir_path: []const u8, allocator: std.mem.Allocator) !cdb.ObjId {
+        if (self.analyzer.getFolder(io, dir_path)) |folder| return folder;
+
+        const parent_path = std.fs.path.dirname(dir_path) orelse ".";
+        const parent_folder = try self.getOrCreateFolderForPath(io, root_dir, parent_path, allocator);
+
+        var parent_dir = try root_dir.openDir(io, parent_path, .{});
+        defer parent_dir.close(io);
+
+        const name = std.fs.path.basename(dir_path);
+        var dir = try parent_dir.openDir(io, name, .{});
+        defer dir.close(io);
+
+        log.info("Folder {s} created outside of editor", .{dir_path});
+
+        const folder_asset = try self.getOrCreateFolder(io, allocator, parent_dir, dir, name, parent_folder);
+        try self.analyzer.mapFolderPath(io, dir_path, folder_asset);
+        try self.addAssetToRoot(io, folder_asset);
+        return folder_asset;
+    }
+
     fn importFolder(self: *Self, io: std.Io, root_dir_path: []const u8, root_dir: std.Io.Dir, parent_folder: cdb.ObjId, tasks: *TaskList, allocator: std.mem.Allocator) !void {
         var zone_ctx = profiler.Zone(@src());
         defer zone_ctx.End();
@@ -1130,36 +2313,23 @@ const AssetRootFS = struct {
 
                 const Task = struct {
                     fi: *AssetRootFS,
+                    root_dir_path: []const u8,
                     path: [:0]const u8,
                     filename: []const u8,
                     folder: cdb.ObjId,
-                    allocator: std.mem.Allocator,
-                    io: std.Io,
-                    asset_io: *const public.AssetIOI,
-                    pub fn exec(s: *@This()) !void {
-                        defer s.allocator.free(s.path);
-
-                        const dirname = std.fs.path.dirname(s.path).?;
-                        const filename = std.fs.path.basename(s.path);
-                        var copy_dir = try std.Io.Dir.openDirAbsolute(s.io, dirname, .{});
-                        defer copy_dir.close(s.io);
-
-                        const imported_from = blk: {
-                            if (s.fi.analyzer.imported_from2uuid.get(filename)) |asset_uuid| {
-                                break :blk cdb.getObjId(_db, asset_uuid).?;
-                            }
-
-                            break :blk null;
-                        };
-                        const import_task = try s.asset_io.import_asset.?(s.io, _db, .none, copy_dir, s.folder, s.filename, imported_from);
-
-                        task.wait(import_task);
+                    allocator: std.mem.Allocator,
+                    io: std.Io,
+                    asset_io: *const public.AssetIOI,
+                    pub fn exec(s: *@This()) !void {
+                        defer s.allocator.free(s.path);
+                        try s.fi.importFile(s.io, s.root_dir_path, s.path, s.filename, s.folder, s.asset_io, s.allocator);
                     }
                 };
                 const task_id = try task.schedule(
                     cetech1.task.TaskID.none,
                     Task{
                         .fi = self,
+                        .root_dir_path = root_dir_path,
                         .path = try root_dir.realPathFileAlloc(io, entry.name, allocator),
                         .allocator = allocator,
                         .io = io,
@@ -1198,34 +2368,97 @@ const AssetRootFS = struct {
         var file = try std.Io.Dir.openFileAbsolute(io, full_path, .{ .mode = .read_only });
         defer file.close(io);
 
-        var buffer: [4096]u8 = undefined;
-        var file_r = file.reader(io, &buffer);
-        const reader = &file_r.interface;
+        const stat = try file.stat(io);
 
-        var json_reader = std.json.Reader.init(allocator, reader);
-        defer json_reader.deinit();
+        // Unchanged file is known from manifest, only stat is needed.
+        if (_manifest) |manifest| {
+            if (manifest.findAsset(path)) |entry| {
+                if (manifest.isFresh(entry, stat)) {
+                    return self.analyzeFileFromSnapshot(io, allocator, manifest, entry, path, manifest.fileInfo(entry));
+                }
+            }
+        }
 
-        var parsed = try std.json.parseFromTokenSource(std.json.Value, allocator, &json_reader, .{ .parse_numbers = false });
-        defer parsed.deinit();
+        _ = self.analyzer.changed_files.fetchAdd(1, .monotonic);
+
+        if (_snapshot) |snapshot| {
+            if (snapshot.findAsset(path)) |entry| {
+                if (snapshot.isFresh(entry, stat)) {
+                    return self.analyzeFileFromSnapshot(io, allocator, snapshot, entry, path, snapshot.fileInfo(entry));
+                }
+            }
+        }
+
+        const content = try allocator.alloc(u8, stat.size);
+        defer allocator.free(content);
+        _ = try file.readPositionalAll(io, content, 0);
+
+        const file_info = assetdb_snapshot.FileInfo.init(stat, content);
+
+        // File is only touched, content is same.
+        if (_manifest) |manifest| {
+            if (manifest.findAsset(path)) |entry| {
+                if (manifest.isSameContent(entry, content)) {
+                    return self.analyzeFileFromSnapshot(io, allocator, manifest, entry, path, file_info);
+                }
+            }
+        }
+
+        // Encode straight from tokens, import use same bytes so file is parsed only once.
+        const encoded = try assetdb_snapshot.encodeJson(self.analyzer.allocator, content);
+        var encoded_owned = true;
+        defer if (encoded_owned) self.analyzer.allocator.free(encoded);
 
-        const version_str = parsed.value.object.get(JSON_ASSET_VERSION).?;
+        const value = try assetdb_snapshot.ValueView.init(encoded);
 
-        try validateVersion(version_str.string);
+        const version_str = (try value.get(JSON_ASSET_VERSION)).?;
+
+        try validateVersion(try version_str.str());
+
+        const asset_uuid_str = (try value.get(JSON_ASSET_UUID_TOKEN)).?;
+        const asset_uuid = uuid.fromStr(try asset_uuid_str.str()).?;
+
+        const imported_from = try value.get(JSON_IMPORTED_FROM);
+        const imported_from_str = if (imported_from) |v| try self.analyzer._str_intern.intern(io, try v.str()) else null;
+
+        var depend_on = UuidSet.empty;
+        defer depend_on.deinit(allocator);
+
+        var provide_uuids = UuidSet.empty;
+        defer provide_uuids.deinit(allocator);
 
-        const asset_uuid_str = parsed.value.object.get(JSON_ASSET_UUID_TOKEN).?;
-        const asset_uuid = uuid.fromStr(asset_uuid_str.string).?;
+        try self.analyzFromView(value, allocator, &depend_on, &provide_uuids);
+        try self.analyzer.addAnalyzedFileInfo(io, path, asset_uuid, &depend_on, &provide_uuids, imported_from_str, file_info);
 
-        const imported_from = parsed.value.object.get(JSON_IMPORTED_FROM);
-        const imported_from_str = if (imported_from) |v| try self.analyzer._str_intern.intern(io, v.string) else null;
+        // Keep compact form for import.
+        encoded_owned = false;
+        try self.analyzer.putParsed(io, path, encoded);
+    }
 
+    fn analyzeFileFromSnapshot(
+        self: *Self,
+        io: std.Io,
+        allocator: std.mem.Allocator,
+        snapshot: *const assetdb_snapshot.Snapshot,
+        entry: *const assetdb_snapshot.AssetEntry,
+        path: []const u8,
+        file_info: assetdb_snapshot.FileInfo,
+    ) !void {
         var depend_on = UuidSet.empty;
         defer depend_on.deinit(allocator);
+        for (0..snapshot.uuidCount(entry.depend_on)) |idx| {
+            _ = try depend_on.add(allocator, snapshot.uuidAt(entry.depend_on, idx));
+        }
 
         var provide_uuids = UuidSet.empty;
         defer provide_uuids.deinit(allocator);
+        for (0..snapshot.uuidCount(entry.provide)) |idx| {
+            _ = try provide_uuids.add(allocator, snapshot.uuidAt(entry.provide, idx));
+        }
+
+        const imported_from_str = if (snapshot.importedFrom(entry)) |v| try self.analyzer._str_intern.intern(io, v) else null;
 
-        try self.analyzFromJsonValue(parsed.value, allocator, &depend_on, &provide_uuids);
-        try self.analyzer.addAnalyzedFileInfo(io, path, asset_uuid, &depend_on, &provide_uuids, imported_from_str);
+        try self.analyzer.addAnalyzedFileInfo(io, path, .{ .bytes = entry.asset_uuid }, &depend_on, &provide_uuids, imported_from_str, file_info);
     }
 
     fn analyzeFolder(self: *Self, io: std.Io, root_dir_path: []const u8, root_dir: std.Io.Dir, parent_folder: cdb.ObjId, tasks: *TaskList, allocator: std.mem.Allocator) !void {
@@ -1296,24 +2529,25 @@ const AssetRootFS = struct {
         }
     }
 
-    fn analyzFromJsonValue(self: *Self, parsed: std.json.Value, allocator: std.mem.Allocator, depend_on: *UuidSet, provide_uuids: *UuidSet) !void {
-        const obj_uuid_str = parsed.object.get(JSON_UUID_TOKEN).?;
-        const obj_uuid = uuid.fromStr(obj_uuid_str.string).?;
-        const obj_type = parsed.object.get(JSON_TYPE_NAME_TOKEN).?;
-        const obj_type_hash = cetech1.strId32(obj_type.string);
+    fn analyzFromView(self: *Self, parsed: assetdb_snapshot.ValueView, allocator: std.mem.Allocator, depend_on: *UuidSet, provide_uuids: *UuidSet) !void {
+        const obj_uuid_str = try (try parsed.get(JSON_UUID_TOKEN)).?.str();
+        const obj_uuid = uuid.fromStr(obj_uuid_str).?;
+        const obj_type = try (try parsed.get(JSON_TYPE_NAME_TOKEN)).?.str();
+        const obj_type_hash = cetech1.strId32(obj_type);
         const obj_type_idx = cdb.getTypeIdx(_db, obj_type_hash).?;
 
         _ = try provide_uuids.add(allocator, obj_uuid);
 
-        const prototype_uuid = parsed.object.get(JSON_PROTOTYPE_UUID);
+        const prototype_uuid = try parsed.get(JSON_PROTOTYPE_UUID);
         if (prototype_uuid) |proto_uuid| {
-            _ = try depend_on.add(allocator, uuid.fromStr(proto_uuid.string).?);
+            _ = try depend_on.add(allocator, uuid.fromStr(try proto_uuid.str()).?);
         }
 
-        const tags = parsed.object.get(JSON_TAGS_TOKEN);
+        const tags = try parsed.get(JSON_TAGS_TOKEN);
         if (tags) |tags_array| {
-            for (tags_array.array.items) |value| {
-                var ref_link = std.mem.splitAny(u8, value.string, ":");
+            var tags_it = try tags_array.arrayIterator();
+            while (try tags_it.next()) |value| {
+                var ref_link = std.mem.splitAny(u8, try value.str(), ":");
                 const ref_type = cetech1.strId32(ref_link.first());
                 const ref_uuid = uuid.fromStr(ref_link.next().?).?;
                 _ = ref_type;
@@ -1323,37 +2557,41 @@ const AssetRootFS = struct {
 
         const prop_defs = cdb.getTypePropDef(_db, obj_type_idx).?;
 
-        const keys = parsed.object.keys();
-        for (keys) |k| {
+        var fields = try parsed.objectIterator();
+        while (try fields.next()) |field| {
+            const k = field.key;
+
             // Skip private fields
             if (std.mem.startsWith(u8, k, "__")) continue;
             if (std.mem.endsWith(u8, k, JSON_REMOVED_POSTFIX)) continue;
             if (std.mem.endsWith(u8, k, JSON_INSTANTIATE_POSTFIX)) continue;
 
-            const value = parsed.object.get(k).?;
+            const value = field.value;
 
             const prop_idx = cdb.getTypePropDefIdx(_db, obj_type_idx, k) orelse continue;
             const prop_def = prop_defs[prop_idx];
 
             switch (prop_def.type) {
                 cdb.PropType.SUBOBJECT => {
-                    try self.analyzFromJsonValue(value, allocator, depend_on, provide_uuids);
+                    try self.analyzFromView(value, allocator, depend_on, provide_uuids);
                 },
                 cdb.PropType.REFERENCE => {
-                    var ref_link = std.mem.splitAny(u8, value.string, ":");
+                    var ref_link = std.mem.splitAny(u8, try value.str(), ":");
                     const ref_type = cetech1.strId32(ref_link.first());
                     const ref_uuid = uuid.fromStr(ref_link.next().?).?;
                     _ = ref_type;
                     _ = try depend_on.add(allocator, ref_uuid);
                 },
                 cdb.PropType.SUBOBJECT_SET => {
-                    for (value.array.items) |subobj_item| {
-                        try self.analyzFromJsonValue(subobj_item, allocator, depend_on, provide_uuids);
+                    var items_it = try value.arrayIterator();
+                    while (try items_it.next()) |subobj_item| {
+                        try self.analyzFromView(subobj_item, allocator, depend_on, provide_uuids);
                     }
                 },
                 cdb.PropType.REFERENCE_SET => {
-                    for (value.array.items) |ref| {
-                        var ref_link = std.mem.splitAny(u8, ref.string, ":");
+                    var items_it = try value.arrayIterator();
+                    while (try items_it.next()) |ref| {
+                        var ref_link = std.mem.splitAny(u8, try ref.str(), ":");
                         const ref_type = cetech1.strId32(ref_link.first());
                         const ref_uuid = uuid.fromStr(ref_link.next().?).?;
                         _ = ref_type;
@@ -1392,7 +2630,7 @@ const AssetRootFS = struct {
                 name orelse "",
                 parent_folder orelse .{},
                 self.asset_root_path.?,
-                ReadBlobFromFile,
+                ReadBlob,
                 allocator,
             );
 
@@ -1453,6 +2691,62 @@ const AssetRootFS = struct {
     }
 };
 
+const TMP_POSTFIX = ".tmp";
+
+fn tmpPath(buff: []u8, path: []const u8) ![]const u8 {
+    return std.fmt.bufPrint(buff, "{s}" ++ TMP_POSTFIX, .{path});
+}
+
+/// Write object as json to `path` with tmp postfix.
+/// Use `commitWrittenTmpFile` to replace `path` so nobody see half written asset.
+fn writeObjFileTmp(
+    io: std.Io,
+    root_dir: std.Io.Dir,
+    root_path: []const u8,
+    obj: cdb.ObjId,
+    path: []const u8,
+    imported_from: ?[]const u8,
+    sync: bool,
+    allocator: std.mem.Allocator,
+) !void {
+    var tmp_buf: [std.fs.max_path_bytes]u8 = undefined;
+    try writeObjFileAt(io, root_dir, root_path, obj, try tmpPath(&tmp_buf, path), imported_from, sync, allocator);
+}
+
+/// Write object as json to `file_path`, file is deleted on error.
+fn writeObjFileAt(
+    io: std.Io,
+    root_dir: std.Io.Dir,
+    root_path: []const u8,
+    obj: cdb.ObjId,
+    file_path: []const u8,
+    imported_from: ?[]const u8,
+    sync: bool,
+    allocator: std.mem.Allocator,
+) !void {
+    var obj_file = try root_dir.createFile(io, file_path, .{});
+    defer obj_file.close(io);
+    errdefer root_dir.deleteFile(io, file_path) catch {};
+
+    var buffer: [4096]u8 = undefined;
+    var bw = obj_file.writer(io, &buffer);
+    const writer = &bw.interface;
+
+    try writeCdbObjJson(io, obj, writer, obj, WriteBlob, root_path, allocator, imported_from);
+    try writer.flush();
+
+    if (sync) try obj_file.sync(io);
+}
+
+// Make renames in dir durable. Directory can not be synced on all platforms so it is best effort.
+fn syncDir(io: std.Io, root_dir: std.Io.Dir, dir_path: []const u8) void {
+    var dir_file = root_dir.openFile(io, dir_path, .{}) catch return;
+    defer dir_file.close(io);
+    dir_file.sync(io) catch |err| {
+        log.warn("Could not sync dir {s}: {}", .{ dir_path, err });
+    };
+}
+
 pub fn writeCdbObjJson(
     io: std.Io,
     obj: cdb.ObjId,
@@ -1874,23 +3168,78 @@ pub fn readAssetFromReader(
     var zone_ctx = profiler.Zone(@src());
     defer zone_ctx.End();
 
-    var json_reader = std.json.Reader.init(allocator, reader);
-    defer json_reader.deinit();
-    var parsed = try std.json.parseFromTokenSource(std.json.Value, allocator, &json_reader, .{ .parse_numbers = false });
-    defer parsed.deinit();
+    // Import read only compact form so json and snapshot share one path.
+    // Encode straight from token stream, std.json.Value tree is never built.
+    const encoded = try assetdb_snapshot.encodeJsonReader(allocator, reader);
+    defer allocator.free(encoded);
+
+    return readAssetFromView(io, try assetdb_snapshot.ValueView.init(encoded), null, asset_name, asset_folder, asset_root_path, read_blob, allocator);
+}
+
+/// Read asset from value parsed by analyze, from cooked snapshot if it is fresh for path or parse json file.
+fn readAssetFile(
+    io: std.Io,
+    dir: std.Io.Dir,
+    sub_path: []const u8,
+    path: []const u8,
+    parsed: ?[]const u8,
+    asset_name: []const u8,
+    asset_folder: cdb.ObjId,
+    asset_root_path: []const u8,
+    allocator: std.mem.Allocator,
+) !cdb.ObjId {
+    if (parsed) |encoded| {
+        return readAssetFromView(io, try assetdb_snapshot.ValueView.init(encoded), null, asset_name, asset_folder, asset_root_path, ReadBlob, allocator);
+    }
+
+    var asset_file = try dir.openFile(io, sub_path, .{ .mode = .read_only });
+    defer asset_file.close(io);
+
+    if (_snapshot) |snapshot| {
+        if (snapshot.findAsset(path)) |entry| {
+            if (snapshot.isFresh(entry, try asset_file.stat(io))) {
+                _ = _snapshot_reads.fetchAdd(1, .monotonic);
+                return readAssetFromView(io, try snapshot.valueView(entry), snapshot.image(entry), asset_name, asset_folder, asset_root_path, ReadBlobFromSnapshot, allocator);
+            }
+        }
+    }
+
+    var buffer: [4096]u8 = undefined;
+    var rb = asset_file.reader(io, &buffer);
+
+    return readAssetFromReader(
+        io,
+        &rb.interface,
+        asset_name,
+        asset_folder,
+        asset_root_path,
+        ReadBlob,
+        allocator,
+    );
+}
 
-    const version = parsed.value.object.get(JSON_ASSET_VERSION).?;
-    try validateVersion(version.string);
+fn readAssetFromView(
+    io: std.Io,
+    value: assetdb_snapshot.ValueView,
+    image: ?[]const u8,
+    asset_name: []const u8,
+    asset_folder: cdb.ObjId,
+    asset_root_path: []const u8,
+    read_blob: ReadBlobFn,
+    allocator: std.mem.Allocator,
+) !cdb.ObjId {
+    const version = (try value.get(JSON_ASSET_VERSION)).?;
+    try validateVersion(try version.str());
 
-    const asset_uuid_str = parsed.value.object.get(JSON_ASSET_UUID_TOKEN).?;
-    const asset_uuid = uuid.fromStr(asset_uuid_str.string).?;
+    const asset_uuid_str = (try value.get(JSON_ASSET_UUID_TOKEN)).?;
+    const asset_uuid = uuid.fromStr(try asset_uuid_str.str()).?;
 
     const asset = try cdb.getOrCreate(_db, asset_uuid, public.AssetCdb.typeIdx(_db));
 
     var desc: ?[]const u8 = null;
-    const desc_value = parsed.value.object.get(JSON_DESCRIPTION_TOKEN);
+    const desc_value = try value.get(JSON_DESCRIPTION_TOKEN);
     if (desc_value) |asset_desc| {
-        desc = asset_desc.string;
+        desc = try asset_desc.str();
     }
 
     {
@@ -1901,9 +3250,10 @@ pub fn readAssetFromReader(
 
     const asset_w = cdb.writeObj(asset).?;
 
-    if (parsed.value.object.get(JSON_TAGS_TOKEN)) |tags| {
-        for (tags.array.items) |tag| {
-            var ref_link = std.mem.splitAny(u8, tag.string, ":");
+    if (try value.get(JSON_TAGS_TOKEN)) |tags| {
+        var tags_it = try tags.arrayIterator();
+        while (try tags_it.next()) |tag| {
+            var ref_link = std.mem.splitAny(u8, try tag.str(), ":");
             const ref_type = cetech1.strId32(ref_link.first());
             const ref_type_idx = cdb.getTypeIdx(_db, ref_type).?;
             const ref_uuid = uuid.fromStr(ref_link.next().?).?;
@@ -1913,7 +3263,9 @@ pub fn readAssetFromReader(
         }
     }
 
-    const asset_obj = try readCdbObjFromJsonValue(io, parsed.value, asset, read_blob, asset_root_path, allocator);
+    const image_obj = if (image) |i| try readCdbImage(io, i, asset, read_blob, asset_root_path, allocator) else null;
+    if (image_obj != null) _ = _snapshot_image_reads.fetchAdd(1, .monotonic);
+    const asset_obj = image_obj orelse try readCdbObjFromView(io, value, asset, read_blob, asset_root_path, allocator);
 
     const asset_obj_w = cdb.writeObj(asset_obj).?;
     try public.AssetCdb.setSubObj(asset_w, .Object, asset_obj_w);
@@ -1923,39 +3275,22 @@ pub fn readAssetFromReader(
     return asset;
 }
 
-fn readObjFromJson(
-    comptime Reader: type,
-    reader: Reader,
-    read_blob: ReadBlobFn,
-    allocator: std.mem.Allocator,
-) !cdb.ObjId {
-    var zone_ctx = profiler.Zone(@src());
-    defer zone_ctx.End();
-
-    var json_reader = std.json.reader(allocator, reader);
-    defer json_reader.deinit();
-    var parsed = try std.json.parseFromTokenSource(std.json.Value, allocator, &json_reader, .{ .parse_numbers = false });
-    defer parsed.deinit();
-    const obj = try readCdbObjFromJsonValue(parsed.value, .{}, read_blob, allocator);
-    return obj;
-}
-
-fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId, read_blob: ReadBlobFn, asset_root_path: []const u8, allocator: std.mem.Allocator) !cdb.ObjId {
+fn readCdbObjFromView(io: std.Io, parsed: assetdb_snapshot.ValueView, asset: cdb.ObjId, read_blob: ReadBlobFn, asset_root_path: []const u8, allocator: std.mem.Allocator) !cdb.ObjId {
     var zone_ctx = profiler.Zone(@src());
     defer zone_ctx.End();
 
-    const obj_uuid_str = parsed.object.get(JSON_UUID_TOKEN).?;
-    const obj_uuid = uuid.fromStr(obj_uuid_str.string).?;
-    const obj_type = parsed.object.get(JSON_TYPE_NAME_TOKEN).?;
-    const obj_type_hash = cetech1.strId32(obj_type.string);
+    const obj_uuid_str = try (try parsed.get(JSON_UUID_TOKEN)).?.str();
+    const obj_uuid = uuid.fromStr(obj_uuid_str).?;
+    const obj_type = try (try parsed.get(JSON_TYPE_NAME_TOKEN)).?.str();
+    const obj_type_hash = cetech1.strId32(obj_type);
     const obj_type_idx = cdb.getTypeIdx(_db, obj_type_hash).?;
 
-    const prototype_uuid = parsed.object.get(JSON_PROTOTYPE_UUID);
+    const prototype_uuid = try parsed.get(JSON_PROTOTYPE_UUID);
     var obj: ?cdb.ObjId = null;
     if (prototype_uuid == null) {
         obj = try cdb.createEmptyObject(_db, obj_type_idx);
     } else {
-        const prototype_obj = try cdb.getOrCreate(_db, uuid.fromStr(prototype_uuid.?.string).?, obj_type_idx);
+        const prototype_obj = try cdb.getOrCreate(_db, uuid.fromStr(try prototype_uuid.?.str()).?, obj_type_idx);
         obj = try cdb.createObjectFromPrototype(prototype_obj);
     }
 
@@ -1963,60 +3298,62 @@ fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId,
 
     const prop_defs = cdb.getTypePropDef(_db, obj_type_idx).?;
 
-    const keys = parsed.object.keys();
-    for (keys) |k| {
+    var fields = try parsed.objectIterator();
+    while (try fields.next()) |field| {
+        const k = field.key;
+
         // Skip private fields
         if (std.mem.startsWith(u8, k, "__")) continue;
         if (std.mem.endsWith(u8, k, JSON_REMOVED_POSTFIX)) continue;
         if (std.mem.endsWith(u8, k, JSON_INSTANTIATE_POSTFIX)) continue;
 
-        const value = parsed.object.get(k).?;
+        const value = field.value;
 
         const prop_idx = cdb.getTypePropDefIdx(_db, obj_type_idx, k) orelse continue;
         const prop_def = prop_defs[prop_idx];
 
         switch (prop_def.type) {
             cdb.PropType.BOOL => {
-                cdb.setValue(bool, obj_w, prop_idx, value.bool);
+                cdb.setValue(bool, obj_w, prop_idx, try value.boolean());
             },
             cdb.PropType.U64 => {
-                cdb.setValue(u64, obj_w, prop_idx, try std.fmt.parseInt(u64, value.number_string, 10));
+                cdb.setValue(u64, obj_w, prop_idx, try std.fmt.parseInt(u64, try value.str(), 10));
             },
             cdb.PropType.I64 => {
-                cdb.setValue(i64, obj_w, prop_idx, try std.fmt.parseInt(i64, value.number_string, 10));
+                cdb.setValue(i64, obj_w, prop_idx, try std.fmt.parseInt(i64, try value.str(), 10));
             },
             cdb.PropType.U32 => {
-                cdb.setValue(u32, obj_w, prop_idx, try std.fmt.parseInt(u32, value.number_string, 10));
+                cdb.setValue(u32, obj_w, prop_idx, try std.fmt.parseInt(u32, try value.str(), 10));
             },
             cdb.PropType.I32 => {
-                cdb.setValue(i32, obj_w, prop_idx, try std.fmt.parseInt(i32, value.number_string, 10));
+                cdb.setValue(i32, obj_w, prop_idx, try std.fmt.parseInt(i32, try value.str(), 10));
             },
             cdb.PropType.F64 => {
-                cdb.setValue(f64, obj_w, prop_idx, try std.fmt.parseFloat(f64, value.number_string));
+                cdb.setValue(f64, obj_w, prop_idx, try std.fmt.parseFloat(f64, try value.str()));
             },
             cdb.PropType.F32 => {
-                cdb.setValue(f32, obj_w, prop_idx, try std.fmt.parseFloat(f32, value.number_string));
+                cdb.setValue(f32, obj_w, prop_idx, try std.fmt.parseFloat(f32, try value.str()));
             },
             cdb.PropType.STR => {
                 var buffer: [128]u8 = undefined;
-                const str = try std.fmt.bufPrintZ(&buffer, "{s}", .{value.string});
+                const str = try std.fmt.bufPrintZ(&buffer, "{s}", .{try value.str()});
                 try cdb.setStr(obj_w, prop_idx, str);
             },
             cdb.PropType.BLOB => {
-                const blob = try read_blob(io, asset, obj_type.string, obj_uuid, .fromStr(prop_def.name), asset_root_path, allocator);
-                defer allocator.free(blob);
-                const true_blob = try cdb.createBlob(obj_w, prop_idx, blob.len);
-                @memcpy(true_blob.?, blob);
+                const blob = try read_blob(io, asset, obj_type, obj_uuid, .fromStr(prop_def.name), asset_root_path, allocator);
+                defer blob.deinit(allocator);
+                const true_blob = try cdb.createBlob(obj_w, prop_idx, blob.data.len);
+                @memcpy(true_blob.?, blob.data);
             },
             cdb.PropType.SUBOBJECT => {
-                const subobj = try readCdbObjFromJsonValue(io, value, asset, read_blob, asset_root_path, allocator);
+                const subobj = try readCdbObjFromView(io, value, asset, read_blob, asset_root_path, allocator);
 
                 const subobj_w = cdb.writeObj(subobj).?;
                 try cdb.setSubObj(obj_w, prop_idx, subobj_w);
                 try cdb.writeCommit(subobj_w);
             },
             cdb.PropType.REFERENCE => {
-                var ref_link = std.mem.splitAny(u8, value.string, ":");
+                var ref_link = std.mem.splitAny(u8, try value.str(), ":");
                 const ref_type = cetech1.strId32(ref_link.first());
                 const ref_uuid = uuid.fromStr(ref_link.next().?).?;
 
@@ -2025,17 +3362,25 @@ fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId,
                 try cdb.setRef(obj_w, prop_idx, ref_obj);
             },
             cdb.PropType.SUBOBJECT_SET => {
-                for (value.array.items) |subobj_item| {
-                    const subobj = try readCdbObjFromJsonValue(io, subobj_item, asset, read_blob, asset_root_path, allocator);
+                // Commit all set items at once.
+                const tx = try cdb.beginTransaction(_db);
+                {
+                    errdefer cdb.abortTransaction(tx);
 
-                    const subobj_w = cdb.writeObj(subobj).?;
-                    try cdb.addSubObjToSet(obj_w, prop_idx, &.{subobj_w});
-                    try cdb.writeCommit(subobj_w);
+                    var items = try value.arrayIterator();
+                    while (try items.next()) |subobj_item| {
+                        const subobj = try readCdbObjFromView(io, subobj_item, asset, read_blob, asset_root_path, allocator);
+
+                        const subobj_w = cdb.transactionWriteObj(tx, subobj).?;
+                        try cdb.addSubObjToSet(obj_w, prop_idx, &.{subobj_w});
+                    }
                 }
+                try cdb.commitTransaction(tx);
             },
             cdb.PropType.REFERENCE_SET => {
-                for (value.array.items) |ref| {
-                    var ref_link = std.mem.splitAny(u8, ref.string, ":");
+                var refs = try value.arrayIterator();
+                while (try refs.next()) |ref| {
+                    var ref_link = std.mem.splitAny(u8, try ref.str(), ":");
                     const ref_type = cetech1.strId32(ref_link.first());
                     const ref_uuid = uuid.fromStr(ref_link.next().?).?;
 
@@ -2047,10 +3392,11 @@ fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId,
                     var buff: [128]u8 = undefined;
                     const field_name = try std.fmt.bufPrint(&buff, "{s}" ++ JSON_REMOVED_POSTFIX, .{prop_def.name});
 
-                    const removed_fiedl = parsed.object.get(field_name);
+                    const removed_fiedl = try parsed.get(field_name);
                     if (removed_fiedl != null) {
-                        for (removed_fiedl.?.array.items) |ref| {
-                            var ref_link = std.mem.splitAny(u8, ref.string, ":");
+                        var removed_refs = try removed_fiedl.?.arrayIterator();
+                        while (try removed_refs.next()) |ref| {
+                            var ref_link = std.mem.splitAny(u8, try ref.str(), ":");
                             const ref_type = cetech1.strId32(ref_link.first());
                             const ref_uuid = uuid.fromStr(ref_link.next().?).?;
 
@@ -2072,10 +3418,11 @@ fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId,
                     var field_name = try std.fmt.bufPrint(&buff, "{s}" ++ JSON_INSTANTIATE_POSTFIX, .{prop_def.name});
 
                     if (prop_def.type == .SUBOBJECT_SET) {
-                        const inisiated = parsed.object.get(field_name);
+                        const inisiated = try parsed.get(field_name);
                         if (inisiated != null) {
-                            for (inisiated.?.array.items) |subobj_item| {
-                                const subobj = try readCdbObjFromJsonValue(io, subobj_item, asset, read_blob, asset_root_path, allocator);
+                            var inisiated_items = try inisiated.?.arrayIterator();
+                            while (try inisiated_items.next()) |subobj_item| {
+                                const subobj = try readCdbObjFromView(io, subobj_item, asset, read_blob, asset_root_path, allocator);
                                 const subobj_w = cdb.writeObj(subobj).?;
                                 try cdb.addSubObjToSet(obj_w, @truncate(prop_idx), &.{subobj_w});
 
@@ -2089,10 +3436,11 @@ fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId,
                     }
 
                     field_name = try std.fmt.bufPrint(&buff, "{s}" ++ JSON_REMOVED_POSTFIX, .{prop_def.name});
-                    const removed = parsed.object.get(field_name);
+                    const removed = try parsed.get(field_name);
                     if (removed != null) {
-                        for (removed.?.array.items) |ref| {
-                            var ref_link = std.mem.splitAny(u8, ref.string, ":");
+                        var removed_refs = try removed.?.arrayIterator();
+                        while (try removed_refs.next()) |ref| {
+                            var ref_link = std.mem.splitAny(u8, try ref.str(), ":");
                             const ref_type = cetech1.strId32(ref_link.first());
                             const ref_uuid = uuid.fromStr(ref_link.next().?).?;
 
@@ -2113,20 +3461,284 @@ fn readCdbObjFromJsonValue(io: std.Io, parsed: std.json.Value, asset: cdb.ObjId,
         }
     }
 
+    return commitReadObj(obj_w, obj.?, obj_uuid, obj_type);
+}
+
+// New object get uuid, existing one is retargeted to read data.
+fn commitReadObj(obj_w: *cdb.Obj, obj: cdb.ObjId, obj_uuid: uuid.Uuid, obj_type: []const u8) !cdb.ObjId {
     const existed_object = cdb.getObjId(_db, obj_uuid);
 
     if (existed_object == null) {
         try cdb.writeCommit(obj_w);
-        try cdb.setUuid(obj_uuid, obj.?);
-        //log.debug("Creating new obj {s}:{s}.", .{ obj_type.string, obj_uuid_str.string });
+        try cdb.setUuid(obj_uuid, obj);
+        //log.debug("Creating new obj {s}:{f}.", .{ obj_type, obj_uuid });
     } else {
         try cdb.retargetWrite(obj_w, existed_object.?);
         try cdb.writeCommit(obj_w);
-        cdb.destroyObject(obj.?);
-        log.debug("Retargeting obj {s}:{s}.", .{ obj_type.string, obj_uuid_str.string });
+        cdb.destroyObject(obj);
+        log.debug("Retargeting obj {s}:{f}.", .{ obj_type, obj_uuid });
+    }
+
+    return existed_object orelse obj;
+}
+
+// Cooked cdb object image, snapshot store it next to json value.
+// Values are parsed and property names resolved to indexes on cook so load only set properties.
+// Layout is native endian: [type count u32][type hash u32, schema hash u64]* [object]
+// object: [uuid 16B][type hash u32][prop count u32] and [prop idx u32][value] for every property.
+// Objects with prototype are not cooked and asset is read from json value.
+
+fn typeSchemaHash(prop_defs: []const cdb.PropDef) u64 {
+    var hasher = std.hash.Wyhash.init(0);
+    for (prop_defs) |prop_def| {
+        hasher.update(prop_def.name);
+        hasher.update(std.mem.asBytes(&prop_def.type));
+    }
+    return hasher.final();
+}
+
+fn appendImageValue(allocator: std.mem.Allocator, image: *cetech1.ByteList, comptime T: type, value: T) !void {
+    try image.appendSlice(allocator, std.mem.asBytes(&value));
+}
+
+/// Cook image of asset object or null if it can not be cooked.
+fn cookCdbImage(allocator: std.mem.Allocator, asset_value: assetdb_snapshot.ValueView) !?[]u8 {
+    var objects: cetech1.ByteList = .empty;
+    defer objects.deinit(allocator);
+
+    var types: cetech1.AutoArrayHashMap(u32, u64) = .{};
+    defer types.deinit(allocator);
+
+    if (!try cookCdbObjImage(allocator, &objects, &types, asset_value)) return null;
+
+    var image: cetech1.ByteList = .empty;
+    errdefer image.deinit(allocator);
+
+    try appendImageValue(allocator, &image, u32, @intCast(types.count()));
+    for (types.keys(), types.values()) |type_hash, schema_hash| {
+        try appendImageValue(allocator, &image, u32, type_hash);
+        try appendImageValue(allocator, &image, u64, schema_hash);
+    }
+    try image.appendSlice(allocator, objects.items);
+
+    return try image.toOwnedSlice(allocator);
+}
+
+fn cookCdbObjImage(allocator: std.mem.Allocator, image: *cetech1.ByteList, types: *cetech1.AutoArrayHashMap(u32, u64), parsed: assetdb_snapshot.ValueView) !bool {
+    if (try parsed.get(JSON_PROTOTYPE_UUID) != null) return false;
+
+    const obj_uuid = uuid.fromStr(try ((try parsed.get(JSON_UUID_TOKEN)) orelse return false).str()) orelse return false;
+    const obj_type_hash = cetech1.strId32(try ((try parsed.get(JSON_TYPE_NAME_TOKEN)) orelse return false).str());
+    const obj_type_idx = cdb.getTypeIdx(_db, obj_type_hash) orelse return false;
+    const prop_defs = cdb.getTypePropDef(_db, obj_type_idx).?;
+
+    try types.put(allocator, obj_type_hash.id, typeSchemaHash(prop_defs));
+
+    try image.appendSlice(allocator, &obj_uuid.bytes);
+    try appendImageValue(allocator, image, u32, obj_type_hash.id);
+
+    // Patched after fields.
+    const count_pos = image.items.len;
+    try appendImageValue(allocator, image, u32, 0);
+    var prop_count: u32 = 0;
+
+    var fields = try parsed.objectIterator();
+    while (try fields.next()) |field| {
+        // Skip private fields
+        if (std.mem.startsWith(u8, field.key, "__")) continue;
+        if (std.mem.endsWith(u8, field.key, JSON_REMOVED_POSTFIX)) continue;
+        if (std.mem.endsWith(u8, field.key, JSON_INSTANTIATE_POSTFIX)) continue;
+
+        const prop_idx = cdb.getTypePropDefIdx(_db, obj_type_idx, field.key) orelse continue;
+        const value = field.value;
+
+        switch (prop_defs[prop_idx].type) {
+            .BOOL, .U64, .I64, .U32, .I32, .F64, .F32, .STR, .BLOB, .SUBOBJECT, .REFERENCE, .SUBOBJECT_SET, .REFERENCE_SET => {},
+            else => continue,
+        }
+
+        try appendImageValue(allocator, image, u32, prop_idx);
+        prop_count += 1;
+
+        switch (prop_defs[prop_idx].type) {
+            .BOOL => try image.append(allocator, @intFromBool(try value.boolean())),
+            .U64 => try appendImageValue(allocator, image, u64, try std.fmt.parseInt(u64, try value.str(), 10)),
+            .I64 => try appendImageValue(allocator, image, i64, try std.fmt.parseInt(i64, try value.str(), 10)),
+            .U32 => try appendImageValue(allocator, image, u32, try std.fmt.parseInt(u32, try value.str(), 10)),
+            .I32 => try appendImageValue(allocator, image, i32, try std.fmt.parseInt(i32, try value.str(), 10)),
+            .F64 => try appendImageValue(allocator, image, f64, try std.fmt.parseFloat(f64, try value.str())),
+            .F32 => try appendImageValue(allocator, image, f32, try std.fmt.parseFloat(f32, try value.str())),
+            .STR => {
+                const str = try value.str();
+                try appendImageValue(allocator, image, u32, @intCast(str.len));
+                try image.appendSlice(allocator, str);
+            },
+            // Blob is read from blob store by property name.
+            .BLOB => {},
+            .SUBOBJECT => if (!try cookCdbObjImage(allocator, image, types, value)) return false,
+            .REFERENCE => if (!try cookImageRef(allocator, image, try value.str())) return false,
+            .SUBOBJECT_SET => {
+                try appendImageValue(allocator, image, u32, value.len);
+                var items = try value.arrayIterator();
+                while (try items.next()) |item| {
+                    if (!try cookCdbObjImage(allocator, image, types, item)) return false;
+                }
+            },
+            .REFERENCE_SET => {
+                try appendImageValue(allocator, image, u32, value.len);
+                var refs = try value.arrayIterator();
+                while (try refs.next()) |ref| {
+                    if (!try cookImageRef(allocator, image, try ref.str())) return false;
+                }
+            },
+            else => unreachable,
+        }
+    }
+
+    @memcpy(image.items[count_pos..][0..@sizeOf(u32)], std.mem.asBytes(&prop_count));
+    return true;
+}
+
+// Reference "type_name:uuid" as type hash and uuid.
+fn cookImageRef(allocator: std.mem.Allocator, image: *cetech1.ByteList, ref_str: []const u8) !bool {
+    var ref_link = std.mem.splitAny(u8, ref_str, ":");
+    const ref_type = cetech1.strId32(ref_link.first());
+    const ref_uuid = uuid.fromStr(ref_link.next() orelse return false) orelse return false;
+    if (cdb.getTypeIdx(_db, ref_type) == null) return false;
+
+    try appendImageValue(allocator, image, u32, ref_type.id);
+    try image.appendSlice(allocator, &ref_uuid.bytes);
+    return true;
+}
+
+const ImageReader = struct {
+    data: []const u8,
+    pos: usize = 0,
+
+    fn take(self: *ImageReader, len: usize) ![]const u8 {
+        if (len > self.data.len - self.pos) return error.InvalidSnapshot;
+        const bytes = self.data[self.pos..][0..len];
+        self.pos += len;
+        return bytes;
+    }
+
+    fn read(self: *ImageReader, comptime T: type) !T {
+        return std.mem.bytesToValue(T, (try self.take(@sizeOf(T)))[0..@sizeOf(T)]);
+    }
+
+    fn readUuid(self: *ImageReader) !uuid.Uuid {
+        return .{ .bytes = (try self.take(16))[0..16].* };
+    }
+
+    fn readRef(self: *ImageReader) !cdb.ObjId {
+        const ref_type_idx = cdb.getTypeIdx(_db, .{ .id = try self.read(u32) }) orelse return error.InvalidSnapshot;
+        return cdb.getOrCreate(_db, try self.readUuid(), ref_type_idx);
+    }
+};
+
+/// Read asset object from cooked image or return null if types changed since cook.
+fn readCdbImage(io: std.Io, image: []const u8, asset: cdb.ObjId, read_blob: ReadBlobFn, asset_root_path: []const u8, allocator: std.mem.Allocator) !?cdb.ObjId {
+    var reader = ImageReader{ .data = image };
+
+    // Check all types before any object is created.
+    const type_count = try reader.read(u32);
+    for (0..type_count) |_| {
+        const type_hash = try reader.read(u32);
+        const schema_hash = try reader.read(u64);
+        const type_idx = cdb.getTypeIdx(_db, .{ .id = type_hash }) orelse return null;
+        if (typeSchemaHash(cdb.getTypePropDef(_db, type_idx).?) != schema_hash) return null;
+    }
+
+    return try readCdbObjFromImage(io, &reader, asset, read_blob, asset_root_path, allocator);
+}
+
+fn readCdbObjFromImage(io: std.Io, reader: *ImageReader, asset: cdb.ObjId, read_blob: ReadBlobFn, asset_root_path: []const u8, allocator: std.mem.Allocator) !cdb.ObjId {
+    var zone_ctx = profiler.Zone(@src());
+    defer zone_ctx.End();
+
+    const obj_uuid = try reader.readUuid();
+    const obj_type_idx = cdb.getTypeIdx(_db, .{ .id = try reader.read(u32) }) orelse return error.InvalidSnapshot;
+    const obj_type = cdb.getTypeName(_db, obj_type_idx).?;
+    const prop_defs = cdb.getTypePropDef(_db, obj_type_idx).?;
+
+    const obj = try cdb.createEmptyObject(_db, obj_type_idx);
+    const obj_w = cdb.writeObj(obj).?;
+
+    const prop_count = try reader.read(u32);
+    for (0..prop_count) |_| {
+        const prop_idx = try reader.read(u32);
+        if (prop_idx >= prop_defs.len) return error.InvalidSnapshot;
+        const prop_def = prop_defs[prop_idx];
+
+        switch (prop_def.type) {
+            cdb.PropType.BOOL => cdb.setValue(bool, obj_w, prop_idx, try reader.read(u8) != 0),
+            cdb.PropType.U64 => cdb.setValue(u64, obj_w, prop_idx, try reader.read(u64)),
+            cdb.PropType.I64 => cdb.setValue(i64, obj_w, prop_idx, try reader.read(i64)),
+            cdb.PropType.U32 => cdb.setValue(u32, obj_w, prop_idx, try reader.read(u32)),
+            cdb.PropType.I32 => cdb.setValue(i32, obj_w, prop_idx, try reader.read(i32)),
+            cdb.PropType.F64 => cdb.setValue(f64, obj_w, prop_idx, try reader.read(f64)),
+            cdb.PropType.F32 => cdb.setValue(f32, obj_w, prop_idx, try reader.read(f32)),
+            cdb.PropType.STR => {
+                var buffer: [128]u8 = undefined;
+                const str = try std.fmt.bufPrintZ(&buffer, "{s}", .{try reader.take(try reader.read(u32))});
+                try cdb.setStr(obj_w, prop_idx, str);
+            },
+            cdb.PropType.BLOB => {
+                const blob = try read_blob(io, asset, obj_type, obj_uuid, .fromStr(prop_def.name), asset_root_path, allocator);
+                defer blob.deinit(allocator);
+                const true_blob = try cdb.createBlob(obj_w, prop_idx, blob.data.len);
+                @memcpy(true_blob.?, blob.data);
+            },
+            cdb.PropType.SUBOBJECT => {
+                const subobj = try readCdbObjFromImage(io, reader, asset, read_blob, asset_root_path, allocator);
+
+                const subobj_w = cdb.writeObj(subobj).?;
+                try cdb.setSubObj(obj_w, prop_idx, subobj_w);
+                try cdb.writeCommit(subobj_w);
+            },
+            cdb.PropType.REFERENCE => try cdb.setRef(obj_w, prop_idx, try reader.readRef()),
+            cdb.PropType.SUBOBJECT_SET => {
+                // Commit all set items at once.
+                const tx = try cdb.beginTransaction(_db);
+                {
+                    errdefer cdb.abortTransaction(tx);
+
+                    const item_count = try reader.read(u32);
+                    for (0..item_count) |_| {
+                        const subobj = try readCdbObjFromImage(io, reader, asset, read_blob, asset_root_path, allocator);
+
+                        const subobj_w = cdb.transactionWriteObj(tx, subobj).?;
+                        try cdb.addSubObjToSet(obj_w, prop_idx, &.{subobj_w});
+                    }
+                }
+                try cdb.commitTransaction(tx);
+            },
+            cdb.PropType.REFERENCE_SET => {
+                const ref_count = try reader.read(u32);
+                for (0..ref_count) |_| {
+                    try cdb.addRefToSet(obj_w, prop_idx, &.{try reader.readRef()});
+                }
+            },
+            else => return error.InvalidSnapshot,
+        }
     }
 
-    return existed_object orelse obj.?;
+    return commitReadObj(obj_w, obj, obj_uuid, obj_type);
+}
+
+fn hashFile(io: std.Io, dir: std.Io.Dir, sub_path: []const u8, allocator: std.mem.Allocator) !u64 {
+    var file = try dir.openFile(io, sub_path, .{ .mode = .read_only });
+    defer file.close(io);
+
+    const content = try allocator.alloc(u8, try file.length(io));
+    defer allocator.free(content);
+    _ = try file.readPositionalAll(io, content, 0);
+
+    return assetdb_snapshot.contentHash(content);
+}
+
+fn blobFileName(buf: []u8, obj_uuid: uuid.Uuid, prop_hash: cetech1.StrId32) ![]const u8 {
+    return std.fmt.bufPrint(buf, "{x}{x}", .{ cetech1.strId32(&obj_uuid.bytes).id, prop_hash.id });
 }
 
 fn WriteBlobToFile(
@@ -2156,7 +3768,7 @@ fn WriteBlobToFile(
     try root_dir.createDirPath(io, blob_dir_path);
 
     var blob_file_name_buf: [128]u8 = undefined;
-    const blob_file_name = try std.fmt.bufPrint(&blob_file_name_buf, "{x}{x}", .{ cetech1.strId32(&obj_uuid.bytes).id, prop_hash.id });
+    const blob_file_name = try blobFileName(&blob_file_name_buf, obj_uuid, prop_hash);
 
     var blob_dir = try root_dir.openDir(io, blob_dir_path, .{});
     defer blob_dir.close(io);
@@ -2171,7 +3783,7 @@ fn ReadBlobFromFile(
     prop_hash: cetech1.StrId32,
     root_path: []const u8,
     allocator: std.mem.Allocator,
-) anyerror![]u8 {
+) anyerror!BlobData {
     _ = type_name;
     var zone_ctx = profiler.Zone(@src());
     defer zone_ctx.End();
@@ -2186,7 +3798,7 @@ fn ReadBlobFromFile(
     defer root_dir.close(io);
 
     var blob_file_name_buf: [128]u8 = undefined;
-    const blob_file_name = try std.fmt.bufPrint(&blob_file_name_buf, "{x}{x}", .{ cetech1.strId32(&obj_uuid.bytes).id, prop_hash.id });
+    const blob_file_name = try blobFileName(&blob_file_name_buf, obj_uuid, prop_hash);
 
     var blob_dir = try root_dir.openDir(io, blob_dir_path, .{});
     defer blob_dir.close(io);
@@ -2197,7 +3809,77 @@ fn ReadBlobFromFile(
 
     const blob = try allocator.alloc(u8, size);
     _ = try blob_file.readPositionalAll(io, blob, 0);
-    return blob;
+    return .{ .data = blob, .owned = true };
+}
+
+fn blobKey(asset: cdb.ObjId, obj_uuid: uuid.Uuid, prop_hash: cetech1.StrId32) !assetdb_blob_store.Key {
+    return .{
+        .asset_uuid = (try cdb.getOrCreateUuid(asset)).bytes,
+        .obj_hash = cetech1.strId32(&obj_uuid.bytes).id,
+        .prop_hash = prop_hash.id,
+    };
+}
+
+/// Opened asset root blob store if root_path is its root.
+fn blobStoreFor(root_path: []const u8) ?*assetdb_blob_store.BlobStore {
+    const opened = _blob_store orelse return null;
+    if (!std.mem.eql(u8, opened.root_path, root_path)) return null;
+    return opened.store;
+}
+
+fn WriteBlob(
+    io: std.Io,
+    blob: []const u8,
+    asset: cdb.ObjId,
+    type_name: []const u8,
+    obj_uuid: uuid.Uuid,
+    prop_hash: cetech1.StrId32,
+    root_path: []const u8,
+    allocator: std.mem.Allocator,
+) anyerror!void {
+    const store = blobStoreFor(root_path) orelse return WriteBlobToFile(io, blob, asset, type_name, obj_uuid, prop_hash, root_path, allocator);
+
+    var zone_ctx = profiler.Zone(@src());
+    defer zone_ctx.End();
+
+    try store.put(io, try blobKey(asset, obj_uuid, prop_hash), blob);
+}
+
+/// Read blob from blob store or from per file blob of old asset roots.
+fn ReadBlob(
+    io: std.Io,
+    asset: cdb.ObjId,
+    type_name: []const u8,
+    obj_uuid: uuid.Uuid,
+    prop_hash: cetech1.StrId32,
+    root_path: []const u8,
+    allocator: std.mem.Allocator,
+) anyerror!BlobData {
+    if (blobStoreFor(root_path)) |store| {
+        if (try store.get(io, try blobKey(asset, obj_uuid, prop_hash))) |data| {
+            return .{ .data = data, .owned = false };
+        }
+    }
+
+    return ReadBlobFromFile(io, asset, type_name, obj_uuid, prop_hash, root_path, allocator);
+}
+
+fn ReadBlobFromSnapshot(
+    io: std.Io,
+    asset: cdb.ObjId,
+    type_name: []const u8,
+    obj_uuid: uuid.Uuid,
+    prop_hash: cetech1.StrId32,
+    root_path: []const u8,
+    allocator: std.mem.Allocator,
+) anyerror!BlobData {
+    if (_snapshot) |snapshot| {
+        if (snapshot.findBlob(try blobKey(asset, obj_uuid, prop_hash))) |blob| {
+            return .{ .data = blob, .owned = false };
+        }
+    }
+
+    return ReadBlob(io, asset, type_name, obj_uuid, prop_hash, root_path, allocator);
 }
 
 const assetroot_fs_vt = public.AssetRootI.VTable.implement(AssetRootFS);
@@ -2220,6 +3902,34 @@ var _allocator: std.mem.Allocator = undefined;
 var _io: std.Io = undefined;
 var _db: cdb.DbId = undefined;
 
+// Valid only while asset root is opening.
+var _snapshot: ?*const assetdb_snapshot.Snapshot = null;
+var _manifest: ?*const assetdb_snapshot.Snapshot = null;
+
+// Assets read from cooked snapshot instead of json.
+var _snapshot_reads: std.atomic.Value(usize) = .init(0);
+
+// Asset objects read from cooked cdb image.
+var _snapshot_image_reads: std.atomic.Value(usize) = .init(0);
+
+pub fn snapshotImageReadCount() usize {
+    return _snapshot_image_reads.load(.monotonic);
+}
+
+pub fn snapshotReadCount() usize {
+    return _snapshot_reads.load(.monotonic);
+}
+
+// Peak bytes of encoded values kept between analyze and import of last opened root.
+var _parsed_peak_bytes: std.atomic.Value(usize) = .init(0);
+
+pub fn parsedPeakBytes() usize {
+    return _parsed_peak_bytes.load(.monotonic);
+}
+
+// Blob store of opened asset root.
+var _blob_store: ?struct { root_path: []const u8, store: *assetdb_blob_store.BlobStore } = null;
+
 pub fn init(allocator: std.mem.Allocator, io: std.Io, db: cdb.DbId) !void {
     _allocator = allocator;
     _io = io;
@@ -0,0 +1,557 @@
+//! Search index of assets used by `filerAsset`.
+//!
+//! Every asset is document with lowercase path and tags.
+//! Path 1, 2 and 3 char grams and tags have posting lists of documents. Query take shortest posting list as candidates
+//! and verify them with real match, so posting lists can keep stale documents after update or remove.
+//! Stale postings are dropped when they outnumber live ones.
+//! Tokens are matched as substrings first, if nothing match candidates with all token chars are matched fuzzy (as subsequence).
+
+const std = @import("std");
+
+const cetech1 = @import("cetech1");
+const cetech1_options = @import("cetech1_options");
+const cdb = cetech1.cdb;
+
+const public = cetech1.assetdb;
+
+const DocId = u32;
+const PostingList = cetech1.ArrayList(DocId);
+
+const MAX_TOKENS = 16;
+const MAX_FILTER_LEN = 256;
+const GRAM_LEN = 3;
+
+const Doc = struct {
+    obj: cdb.ObjId,
+    path: []u8,
+    tags: []cdb.ObjId,
+    char_mask: u64,
+    postings: u32,
+    alive: bool,
+};
+
+const MatchMode = enum {
+    substring,
+    fuzzy,
+};
+
+pub const SearchIndex = struct {
+    const Self = @This();
+
+    allocator: std.mem.Allocator,
+
+    docs: cetech1.ArrayList(Doc) = .empty,
+    free_docs: cetech1.ArrayList(DocId) = .empty,
+    obj2doc: cetech1.AutoArrayHashMap(cdb.ObjId, DocId) = .empty,
+
+    grams: cetech1.AutoArrayHashMap(u32, PostingList) = .empty,
+    tags: cetech1.AutoArrayHashMap(cdb.ObjId, PostingList) = .empty,
+
+    live_postings: usize = 0,
+    stale_postings: usize = 0,
+
+    pub fn init(allocator: std.mem.Allocator) Self {
+        return .{ .allocator = allocator };
+    }
+
+    pub fn deinit(self: *Self) void {
+        self.clear();
+        self.docs.deinit(self.allocator);
+        self.free_docs.deinit(self.allocator);
+        self.obj2doc.deinit(self.allocator);
+        self.grams.deinit(self.allocator);
+        self.tags.deinit(self.allocator);
+    }
+
+    pub fn clear(self: *Self) void {
+        for (self.docs.items) |*doc| {
+            if (doc.alive) self.freeDoc(doc);
+        }
+        self.docs.clearRetainingCapacity();
+        self.free_docs.clearRetainingCapacity();
+        self.obj2doc.clearRetainingCapacity();
+
+        for (self.grams.values()) |*list| list.deinit(self.allocator);
+        self.grams.clearRetainingCapacity();
+
+        for (self.tags.values()) |*list| list.deinit(self.allocator);
+        self.tags.clearRetainingCapacity();
+
+        self.live_postings = 0;
+        self.stale_postings = 0;
+    }
+
+    pub fn count(self: Self) usize {
+        return self.obj2doc.count();
+    }
+
+    pub fn contains(self: Self, obj: cdb.ObjId) bool {
+        return self.obj2doc.contains(obj);
+    }
+
+    /// Lowercase path of indexed asset.
+    pub fn getPath(self: Self, obj: cdb.ObjId) ?[]const u8 {
+        const doc_id = self.obj2doc.get(obj) orelse return null;
+        return self.docs.items[doc_id].path;
+    }
+
+    /// Assets with path that start with prefix (case insensitive).
+    pub fn withPrefix(self: *Self, allocator: std.mem.Allocator, prefix: []const u8) ![]cdb.ObjId {
+        var result = cetech1.ArrayList(cdb.ObjId).empty;
+        errdefer result.deinit(allocator);
+
+        var lower_buf: [MAX_FILTER_LEN]u8 = undefined;
+        if (prefix.len > lower_buf.len) return error.PrefixTooLong;
+        const lower_prefix = std.ascii.lowerString(&lower_buf, prefix);
+
+        var candidates: ?[]const DocId = null;
+        if (!self.tokenPostings(lower_prefix, &candidates)) return result.toOwnedSlice(allocator);
+
+        if (candidates) |docs| {
+            // Posting list can have same doc more times.
+            var seen = try std.DynamicBitSetUnmanaged.initEmpty(allocator, self.docs.items.len);
+            defer seen.deinit(allocator);
+
+            for (docs) |doc_id| {
+                if (seen.isSet(doc_id)) continue;
+                seen.set(doc_id);
+
+                const doc = &self.docs.items[doc_id];
+                if (!doc.alive or !std.mem.startsWith(u8, doc.path, lower_prefix)) continue;
+                try result.append(allocator, doc.obj);
+            }
+        } else {
+            for (self.docs.items) |*doc| {
+                if (!doc.alive or !std.mem.startsWith(u8, doc.path, lower_prefix)) continue;
+                try result.append(allocator, doc.obj);
+            }
+        }
+
+        return result.toOwnedSlice(allocator);
+    }
+
+    /// Add or update asset.
+    pub fn put(self: *Self, obj: cdb.ObjId, path: []const u8, tags: []const cdb.ObjId) !void {
+        if (self.obj2doc.get(obj)) |doc_id| {
+            const doc = &self.docs.items[doc_id];
+            if (std.ascii.eqlIgnoreCase(doc.path, path) and eqlTags(doc.tags, tags)) return;
+            self.retireDoc(doc_id);
+            _ = self.obj2doc.swapRemove(obj);
+        }
+
+        const lower_path = try std.ascii.allocLowerString(self.allocator, path);
+        errdefer self.allocator.free(lower_path);
+
+        const doc_tags = try self.allocator.dupe(cdb.ObjId, tags);
+        errdefer self.allocator.free(doc_tags);
+
+        const doc_id: DocId = self.free_docs.pop() orelse blk: {
+            _ = try self.docs.addOne(self.allocator);
+            break :blk @intCast(self.docs.items.len - 1);
+        };
+
+        self.docs.items[doc_id] = .{
+            .obj = obj,
+            .path = lower_path,
+            .tags = doc_tags,
+            .char_mask = charMask(lower_path),
+            .postings = 0,
+            .alive = true,
+        };
+
+        try self.obj2doc.put(self.allocator, obj, doc_id);
+        try self.addPostings(doc_id);
+
+        if (self.stale_postings > self.live_postings + 1024) try self.compact();
+    }
+
+    pub fn remove(self: *Self, obj: cdb.ObjId) void {
+        const kv = self.obj2doc.fetchSwapRemove(obj) orelse return;
+        self.retireDoc(kv.value);
+    }
+
+    /// Find assets that match all tokens in filter and have all tags.
+    /// Lower score is better.
+    pub fn search(self: *Self, allocator: std.mem.Allocator, filter: []const u8, tags_filter: []const cdb.ObjId) !public.FilteredAssets {
+        var result = cetech1.ArrayList(public.FilteredAsset).empty;
+        errdefer result.deinit(allocator);
+
+        var lower_buf: [MAX_FILTER_LEN]u8 = undefined;
+        const lower_filter = std.ascii.lowerString(&lower_buf, filter[0..@min(filter.len, lower_buf.len)]);
+
+        var tokens_buf: [MAX_TOKENS][]const u8 = undefined;
+        var tokens_len: usize = 0;
+        var split = std.mem.tokenizeScalar(u8, lower_filter, ' ');
+        while (split.next()) |token| {
+            if (tokens_len == tokens_buf.len) break;
+            tokens_buf[tokens_len] = token;
+            tokens_len += 1;
+        }
+        const tokens = tokens_buf[0..tokens_len];
+
+        // Shortest tag posting list. Missing tag means nothing can match.
+        var tag_candidates: ?[]const DocId = null;
+        for (tags_filter) |tag| {
+            const list = self.tags.get(tag) orelse return result.toOwnedSlice(allocator);
+            if (tag_candidates == null or list.items.len < tag_candidates.?.len) tag_candidates = list.items;
+        }
+
+        // Shortest gram posting list. Missing gram means no substring match.
+        var candidates = tag_candidates;
+        var substring_possible = true;
+        for (tokens) |token| {
+            if (!self.tokenPostings(token, &candidates)) {
+                substring_possible = false;
+                break;
+            }
+        }
+
+        if (substring_possible) {
+            try self.collect(allocator, &result, candidates, tokens, tags_filter, .substring);
+            if (result.items.len != 0 or tokens.len == 0) return result.toOwnedSlice(allocator);
+        }
+
+        // Fuzzy match need all token chars in path, so shortest char posting list bound candidates.
+        var fuzzy_candidates = tag_candidates;
+        for (tokens) |token| {
+            for (token) |c| {
+                const list = self.grams.get(gram(&[_]u8{c})) orelse return result.toOwnedSlice(allocator);
+                if (fuzzy_candidates == null or list.items.len < fuzzy_candidates.?.len) fuzzy_candidates = list.items;
+            }
+        }
+
+        try self.collect(allocator, &result, fuzzy_candidates, tokens, tags_filter, .fuzzy);
+        return result.toOwnedSlice(allocator);
+    }
+
+    // Update shortest posting list with grams of token. Return false if some gram is not indexed.
+    // Shorter token than gram is looked up as whole because all 1 and 2 char grams are indexed.
+    fn tokenPostings(self: *const Self, token: []const u8, shortest: *?[]const DocId) bool {
+        if (token.len == 0) return true;
+
+        const n = @min(token.len, GRAM_LEN);
+        for (0..token.len - n + 1) |i| {
+            const list = self.grams.get(gram(token[i..][0..n])) orelse return false;
+            if (shortest.* == null or list.items.len < shortest.*.?.len) shortest.* = list.items;
+        }
+        return true;
+    }
+
+    fn collect(
+        self: *Self,
+        allocator: std.mem.Allocator,
+        result: *cetech1.ArrayList(public.FilteredAsset),
+        candidates: ?[]const DocId,
+        tokens: []const []const u8,
+        tags_filter: []const cdb.ObjId,
+        mode: MatchMode,
+    ) !void {
+        var query_mask: u64 = 0;
+        for (tokens) |token| query_mask |= charMask(token);
+
+        if (candidates) |docs| {
+            // Posting list can have same doc more times.
+            var seen = try std.DynamicBitSetUnmanaged.initEmpty(allocator, self.docs.items.len);
+            defer seen.deinit(allocator);
+
+            for (docs) |doc_id| {
+                if (seen.isSet(doc_id)) continue;
+                seen.set(doc_id);
+                try self.matchDoc(allocator, result, doc_id, query_mask, tokens, tags_filter, mode);
+            }
+        } else {
+            for (0..self.docs.items.len) |doc_id| {
+                try self.matchDoc(allocator, result, @intCast(doc_id), query_mask, tokens, tags_filter, mode);
+            }
+        }
+    }
+
+    fn matchDoc(
+        self: *Self,
+        allocator: std.mem.Allocator,
+        result: *cetech1.ArrayList(public.FilteredAsset),
+        doc_id: DocId,
+        query_mask: u64,
+        tokens: []const []const u8,
+        tags_filter: []const cdb.ObjId,
+        mode: MatchMode,
+    ) !void {
+        const doc = &self.docs.items[doc_id];
+        if (!doc.alive) return;
+        if (doc.char_mask & query_mask != query_mask) return;
+
+        for (tags_filter) |tag| {
+            if (!containsTag(doc.tags, tag)) return;
+        }
+
+        // Prefer shorter paths.
+        var score: f64 = @as(f64, @floatFromInt(doc.path.len)) / 10000.0;
+        for (tokens) |token| {
+            score += switch (mode) {
+                .substring => rankSubstring(doc.path, token),
+                .fuzzy => rankFuzzy(doc.path, token),
+            } orelse return;
+        }
+
+        try result.append(allocator, .{ .score = score, .obj = doc.obj });
+    }
+
+    fn addPostings(self: *Self, doc_id: DocId) !void {
+        const doc = &self.docs.items[doc_id];
+
+        for (0..doc.path.len) |i| {
+            for (1..@min(GRAM_LEN, doc.path.len - i) + 1) |n| {
+                const entry = try self.grams.getOrPut(self.allocator, gram(doc.path[i..][0..n]));
+                if (!entry.found_existing) entry.value_ptr.* = .empty;
+
+                // Same gram more times in path.
+                const list = entry.value_ptr;
+                if (list.items.len != 0 and list.items[list.items.len - 1] == doc_id) continue;
+
+                try list.append(self.allocator, doc_id);
+                doc.postings += 1;
+            }
+        }
+
+        for (doc.tags) |tag| {
+            const entry = try self.tags.getOrPut(self.allocator, tag);
+            if (!entry.found_existing) entry.value_ptr.* = .empty;
+            try entry.value_ptr.append(self.allocator, doc_id);
+            doc.postings += 1;
+        }
+
+        self.live_postings += doc.postings;
+    }
+
+    // Postings are not removed here, query skip dead docs.
+    fn retireDoc(self: *Self, doc_id: DocId) void {
+        const doc = &self.docs.items[doc_id];
+        self.live_postings -= doc.postings;
+        self.stale_postings += doc.postings;
+        self.freeDoc(doc);
+        doc.alive = false;
+        self.free_docs.append(self.allocator, doc_id) catch {};
+    }
+
+    fn freeDoc(self: *Self, doc: *Doc) void {
+        self.allocator.free(doc.path);
+        self.allocator.free(doc.tags);
+    }
+
+    // Rebuild posting lists from live docs.
+    fn compact(self: *Self) !void {
+        for (self.grams.values()) |*list| list.clearRetainingCapacity();
+        for (self.tags.values()) |*list| list.clearRetainingCapacity();
+
+        self.live_postings = 0;
+        self.stale_postings = 0;
+
+        for (self.docs.items, 0..) |*doc, doc_id| {
+            if (!doc.alive) continue;
+            doc.postings = 0;
+            try self.addPostings(@intCast(doc_id));
+        }
+    }
+};
+
+// Gram chars with gram length in top byte, so 1, 2 and 3 char grams share one map.
+inline fn gram(chars: []const u8) u32 {
+    std.debug.assert(chars.len != 0 and chars.len <= GRAM_LEN);
+    var key: u32 = 0;
+    for (chars) |c| key = key << 8 | c;
+    return @as(u32, @intCast(chars.len)) << 24 | key;
+}
+
+// Bit for every char in string. Collisions only let more docs to real match.
+fn charMask(str: []const u8) u64 {
+    var mask: u64 = 0;
+    for (str) |c| {
+        if (c == ' ') continue;
+        mask |= @as(u64, 1) << @intCast(c & 63);
+    }
+    return mask;
+}
+
+fn isWordStart(path: []const u8, idx: usize) bool {
+    if (idx == 0) return true;
+    return switch (path[idx - 1]) {
+        '/', '_', '.', '-', ' ' => true,
+        else => false,
+    };
+}
+
+// 0 for match on word start, 1 for match inside word.
+fn rankSubstring(path: []const u8, token: []const u8) ?f64 {
+    var best: ?f64 = null;
+    var pos: usize = 0;
+    while (std.mem.indexOfPos(u8, path, pos, token)) |idx| : (pos = idx + 1) {
+        if (isWordStart(path, idx)) return 0;
+        best = 1;
+    }
+    return best;
+}
+
+// Token chars in order, gaps between them make score worse.
+fn rankFuzzy(path: []const u8, token: []const u8) ?f64 {
+    var gaps: usize = 0;
+    var pos: usize = 0;
+    for (token, 0..) |c, i| {
+        const idx = std.mem.indexOfScalarPos(u8, path, pos, c) orelse return null;
+        if (i != 0) gaps += idx - pos;
+        pos = idx + 1;
+    }
+    return 2 + @as(f64, @floatFromInt(gaps)) / @as(f64, @floatFromInt(path.len));
+}
+
+fn eqlTags(a: []const cdb.ObjId, b: []const cdb.ObjId) bool {
+    if (a.len != b.len) return false;
+    for (a, b) |x, y| {
+        if (!x.eql(y)) return false;
+    }
+    return true;
+}
+
+fn containsTag(tags: []const cdb.ObjId, tag: cdb.ObjId) bool {
+    for (tags) |t| {
+        if (t.eql(tag)) return true;
+    }
+    return false;
+}
+
+test "assetdb_search: Should find, update and remove assets" {
+    var index = SearchIndex.init(std.testing.allocator);
+    defer index.deinit();
+
+    const foo: cdb.ObjId = .{ .id = 1 };
+    const bar: cdb.ObjId = .{ .id = 2 };
+    const tag: cdb.ObjId = .{ .id = 3 };
+
+    try index.put(foo, "core/Foo_Shader.ct_foo_asset", &.{tag});
+    try index.put(bar, "core/bar.ct_bar_asset", &.{});
+
+    {
+        const result = try index.search(std.testing.allocator, "SHADER", &.{});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+
+    // Tags
+    {
+        const result = try index.search(std.testing.allocator, "core", &.{tag});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+
+    // Fuzzy fallback
+    {
+        const result = try index.search(std.testing.allocator, "fshd", &.{});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+
+    // Word start is better
+    {
+        const result = try index.search(std.testing.allocator, "s", &.{});
+        defer std.testing.allocator.free(result);
+        std.sort.insertion(public.FilteredAsset, result, {}, public.FilteredAsset.lessThan);
+        try std.testing.expectEqual(@as(usize, 2), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+
+    // Short token use gram postings
+    {
+        const result = try index.search(std.testing.allocator, "sh", &.{});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+
+    // Fuzzy candidates need all token chars
+    {
+        const result = try index.search(std.testing.allocator, "fshdz", &.{});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 0), result.len);
+    }
+
+    {
+        const result = try index.withPrefix(std.testing.allocator, "Core/");
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 2), result.len);
+    }
+
+    // Rename
+    try index.put(foo, "core/baz.ct_foo_asset", &.{});
+    {
+        const result = try index.search(std.testing.allocator, "shader", &.{});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 0), result.len);
+    }
+
+    index.remove(bar);
+    {
+        const result = try index.search(std.testing.allocator, "", &.{});
+        defer std.testing.allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+}
+
+test "assetdb_search: 100k assets benchmark" {
+    if (!cetech1_options.enable_bench) return error.SkipZigTest;
+
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var index = SearchIndex.init(allocator);
+    defer index.deinit();
+
+    const folders = [_][]const u8{ "core", "core/shaders", "editor/icons", "game/levels", "game/props" };
+    const types = [_][]const u8{ "ct_texture", "ct_shader", "ct_entity", "ct_graph" };
+    const asset_count = 100_000;
+
+    var tags: [8]cdb.ObjId = undefined;
+    for (&tags, 0..) |*tag, i| tag.* = .{ .id = @intCast(asset_count + 1 + i) };
+
+    var prng = std.Random.DefaultPrng.init(1);
+    const random = prng.random();
+
+    const build_start = std.Io.Timestamp.now(io, .awake);
+    for (0..asset_count) |i| {
+        var path_buf: [256]u8 = undefined;
+        const path = try std.fmt.bufPrint(&path_buf, "{s}/asset_{x}_{d}.{s}", .{
+            folders[i % folders.len],
+            random.int(u32),
+            i,
+            types[i % types.len],
+        });
+        try index.put(.{ .id = @intCast(i + 1) }, path, tags[i % tags.len ..][0..1]);
+    }
+    const build_ns = build_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    const queries = [_][]const u8{ "asset_1234", "shaders 4242", "levels ct_graph", "a", "zzzz" };
+    const rounds = 100;
+
+    for (queries) |query| {
+        var found: usize = 0;
+        const start = std.Io.Timestamp.now(io, .awake);
+        for (0..rounds) |_| {
+            const result = try index.search(allocator, query, &.{});
+            found = result.len;
+            allocator.free(result);
+        }
+        const query_ns = start.durationTo(.now(io, .awake)).toNanoseconds();
+
+        std.debug.print(
+            "asset search: assets={d} build={d}ms query=\"{s}\" found={d} time={d}us\n",
+            .{ asset_count, @divTrunc(build_ns, std.time.ns_per_ms), query, found, @divTrunc(query_ns, rounds * std.time.ns_per_us) },
+        );
+    }
+
+    // Tag only.
+    const result = try index.search(allocator, "", &.{tags[0]});
+    defer allocator.free(result);
+    try std.testing.expectEqual(@as(usize, asset_count / tags.len), result.len);
+}
@@ -0,0 +1,844 @@
+//! Binary snapshot of asset root.
+//!
+//! Cooked from json assets (source of truth) to one file in asset root temp folder.
+//! On open file is memory-mapped and asset values are read from it with ValueView without json parsing
+//! or decoding to std.json.Value, strings point directly to mapped memory.
+//! Every asset remember size, mtime and content hash of json file so changed files fallback to json.
+//! Asset can have cooked cdb object image next to value, image is opaque here and is made by assetdb_fs.
+//! Blobs are copied from asset root blob store and keyed same as in store.
+//! Same format without values and blobs is used as analysis manifest that is written on every open.
+//! Layout is native endian including encoded values, file cooked on other endian fail version check and is not used:
+//! [Header][AssetEntry sorted by path][BlobEntry sorted by key][data]
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+const cetech1 = @import("cetech1");
+const uuid = cetech1.uuid;
+
+const assetdb_blob_store = @import("assetdb_blob_store.zig");
+
+const native_endian = builtin.cpu.arch.endian();
+
+pub const FILENAME = "assets.ct_snapshot";
+pub const MANIFEST_FILENAME = "assets.ct_manifest";
+
+const MAGIC = "CTSN".*;
+const VERSION: u32 = 4;
+
+/// Identity of asset file content.
+pub const FileInfo = struct {
+    size: u64,
+    mtime: i64,
+    content_hash: u64,
+
+    pub fn init(stat: std.Io.File.Stat, content: []const u8) FileInfo {
+        return .{ .size = stat.size, .mtime = mtimeNs(stat.mtime), .content_hash = contentHash(content) };
+    }
+};
+
+pub fn contentHash(content: []const u8) u64 {
+    return std.hash.Wyhash.hash(0, content);
+}
+
+/// Range in data section.
+pub const Span = extern struct {
+    offset: u64 = 0,
+    len: u64 = 0,
+};
+
+const Header = extern struct {
+    magic: [4]u8,
+    version: u32,
+    asset_count: u64,
+    blob_count: u64,
+    data_offset: u64,
+    data_size: u64,
+};
+
+pub const AssetEntry = extern struct {
+    asset_uuid: [16]u8,
+    path: Span,
+    imported_from: Span,
+    has_imported_from: u64,
+    file_size: u64,
+    file_mtime: i64,
+    content_hash: u64,
+    depend_on: Span,
+    provide: Span,
+    has_value: u64,
+    value: Span,
+    has_image: u64,
+    image: Span,
+};
+
+pub const BlobKey = assetdb_blob_store.Key;
+
+pub const BlobEntry = extern struct {
+    key: BlobKey,
+    data: Span,
+};
+
+// Encoded std.json.Value tag, lengths are u32.
+// Containers store item count and byte size of items so they can be skipped without walking.
+pub const Tag = enum(u8) {
+    null_value,
+    bool_false,
+    bool_true,
+    number_string,
+    string,
+    array,
+    object,
+};
+
+/// Encode json value to compact binary form used in snapshot.
+pub fn encodeValue(allocator: std.mem.Allocator, value: std.json.Value) ![]u8 {
+    var writer = Writer.init(allocator);
+    defer writer.deinit();
+    try writer.writeValue(value);
+    return writer.data.toOwnedSlice(allocator);
+}
+
+/// Encode json text to compact binary form straight from token stream without std.json.Value tree.
+pub fn encodeJson(allocator: std.mem.Allocator, json: []const u8) ![]u8 {
+    var scanner = std.json.Scanner.initCompleteInput(allocator, json);
+    defer scanner.deinit();
+
+    var writer = Writer.init(allocator);
+    defer writer.deinit();
+    try writer.writeJson(allocator, &scanner);
+    return writer.data.toOwnedSlice(allocator);
+}
+
+/// Same as encodeJson but read json from reader.
+pub fn encodeJsonReader(allocator: std.mem.Allocator, reader: *std.Io.Reader) ![]u8 {
+    var json_reader = std.json.Reader.init(allocator, reader);
+    defer json_reader.deinit();
+
+    var writer = Writer.init(allocator);
+    defer writer.deinit();
+    try writer.writeJson(allocator, &json_reader);
+    return writer.data.toOwnedSlice(allocator);
+}
+
+/// Decode value encoded by encodeValue. Containers are allocated with allocator (use arena), strings point to bytes.
+pub fn decodeValue(allocator: std.mem.Allocator, bytes: []const u8) !std.json.Value {
+    var reader = ValueReader{ .data = bytes };
+    return reader.readValue(allocator);
+}
+
+/// Read only view of value encoded by encodeValue.
+/// Navigate encoded bytes directly without allocation, strings point to bytes.
+pub const ValueView = struct {
+    const Self = @This();
+
+    tag: Tag,
+
+    // String bytes or encoded items of container.
+    payload: []const u8,
+
+    // Item count of container.
+    len: u32 = 0,
+
+    pub fn init(bytes: []const u8) !Self {
+        var reader = ValueReader{ .data = bytes };
+        return reader.readView();
+    }
+
+    pub fn isNull(self: Self) bool {
+        return self.tag == .null_value;
+    }
+
+    /// String or number as string.
+    pub fn str(self: Self) ![]const u8 {
+        if (self.tag != .string and self.tag != .number_string) return error.InvalidSnapshot;
+        return self.payload;
+    }
+
+    pub fn boolean(self: Self) !bool {
+        return switch (self.tag) {
+            .bool_true => true,
+            .bool_false => false,
+            else => error.InvalidSnapshot,
+        };
+    }
+
+    /// Linear lookup, objects are small and nested containers are skipped by size.
+    pub fn get(self: Self, key: []const u8) !?Self {
+        var it = try self.objectIterator();
+        while (try it.next()) |entry| {
+            if (std.mem.eql(u8, entry.key, key)) return entry.value;
+        }
+        return null;
+    }
+
+    pub fn objectIterator(self: Self) !ObjectIterator {
+        if (self.tag != .object) return error.InvalidSnapshot;
+        return .{ .reader = .{ .data = self.payload }, .remaining = self.len };
+    }
+
+    pub fn arrayIterator(self: Self) !ArrayIterator {
+        if (self.tag != .array) return error.InvalidSnapshot;
+        return .{ .reader = .{ .data = self.payload }, .remaining = self.len };
+    }
+
+    pub const ObjectEntry = struct {
+        key: []const u8,
+        value: ValueView,
+    };
+
+    pub const ObjectIterator = struct {
+        reader: ValueReader,
+        remaining: u32,
+
+        pub fn next(self: *ObjectIterator) !?ObjectEntry {
+            if (self.remaining == 0) return null;
+            self.remaining -= 1;
+            const key = try self.reader.readStr();
+            return .{ .key = key, .value = try self.reader.readView() };
+        }
+    };
+
+    pub const ArrayIterator = struct {
+        reader: ValueReader,
+        remaining: u32,
+
+        pub fn next(self: *ArrayIterator) !?ValueView {
+            if (self.remaining == 0) return null;
+            self.remaining -= 1;
+            return try self.reader.readView();
+        }
+    };
+};
+
+pub fn mtimeNs(mtime: std.Io.Timestamp) i64 {
+    return @truncate(mtime.nanoseconds);
+}
+
+pub const Writer = struct {
+    const Self = @This();
+
+    allocator: std.mem.Allocator,
+    assets: cetech1.ArrayList(AssetEntry) = .empty,
+    blobs: cetech1.ArrayList(BlobEntry) = .empty,
+    data: cetech1.ByteList = .empty,
+
+    pub fn init(allocator: std.mem.Allocator) Self {
+        return .{ .allocator = allocator };
+    }
+
+    pub fn deinit(self: *Self) void {
+        self.assets.deinit(self.allocator);
+        self.blobs.deinit(self.allocator);
+        self.data.deinit(self.allocator);
+    }
+
+    pub fn addAsset(
+        self: *Self,
+        path: []const u8,
+        asset_uuid: uuid.Uuid,
+        file_info: FileInfo,
+        depend_on: []const uuid.Uuid,
+        provide: []const uuid.Uuid,
+        imported_from: ?[]const u8,
+        value: ?[]const u8,
+        image: ?[]const u8,
+    ) !void {
+        // Value is already encoded with encodeJson/encodeValue.
+        const value_begin = self.data.items.len;
+        if (value) |v| try self.data.appendSlice(self.allocator, v);
+        const value_end = self.data.items.len;
+
+        try self.assets.append(self.allocator, .{
+            .asset_uuid = asset_uuid.bytes,
+            .path = try self.addData(path),
+            .imported_from = try self.addData(imported_from orelse ""),
+            .has_imported_from = @intFromBool(imported_from != null),
+            .file_size = file_info.size,
+            .file_mtime = file_info.mtime,
+            .content_hash = file_info.content_hash,
+            .depend_on = try self.addUuids(depend_on),
+            .provide = try self.addUuids(provide),
+            .has_value = @intFromBool(value != null),
+            .value = .{ .offset = value_begin, .len = value_end - value_begin },
+            .has_image = @intFromBool(image != null),
+            .image = try self.addData(image orelse ""),
+        });
+    }
+
+    pub fn addBlob(self: *Self, key: BlobKey, data: []const u8) !void {
+        try self.blobs.append(self.allocator, .{
+            .key = key,
+            .data = try self.addData(data),
+        });
+    }
+
+    pub fn writeFile(self: *Self, io: std.Io, dir: std.Io.Dir, sub_path: []const u8) !void {
+        std.sort.pdq(AssetEntry, self.assets.items, self.data.items, assetLessThan);
+        std.sort.pdq(BlobEntry, self.blobs.items, {}, blobLessThan);
+
+        const assets_bytes = std.mem.sliceAsBytes(self.assets.items);
+        const blobs_bytes = std.mem.sliceAsBytes(self.blobs.items);
+
+        const header = Header{
+            .magic = MAGIC,
+            .version = VERSION,
+            .asset_count = self.assets.items.len,
+            .blob_count = self.blobs.items.len,
+            .data_offset = @sizeOf(Header) + assets_bytes.len + blobs_bytes.len,
+            .data_size = self.data.items.len,
+        };
+
+        // Write to tmp and rename so mapped old file is never truncated.
+        const tmp_path = try std.fmt.allocPrint(self.allocator, "{s}.tmp", .{sub_path});
+        defer self.allocator.free(tmp_path);
+
+        {
+            var file = try dir.createFile(io, tmp_path, .{});
+            defer file.close(io);
+
+            var buffer: [4096]u8 = undefined;
+            var fw = file.writer(io, &buffer);
+            const writer = &fw.interface;
+
+            try writer.writeAll(std.mem.asBytes(&header));
+            try writer.writeAll(assets_bytes);
+            try writer.writeAll(blobs_bytes);
+            try writer.writeAll(self.data.items);
+            try writer.flush();
+        }
+
+        try dir.rename(tmp_path, dir, sub_path, io);
+    }
+
+    fn addData(self: *Self, bytes: []const u8) !Span {
+        const offset = self.data.items.len;
+        try self.data.appendSlice(self.allocator, bytes);
+        return .{ .offset = offset, .len = bytes.len };
+    }
+
+    fn addUuids(self: *Self, uuids: []const uuid.Uuid) !Span {
+        const offset = self.data.items.len;
+        for (uuids) |u| try self.data.appendSlice(self.allocator, &u.bytes);
+        return .{ .offset = offset, .len = self.data.items.len - offset };
+    }
+
+    fn writeTag(self: *Self, tag: Tag) !void {
+        try self.data.append(self.allocator, @intFromEnum(tag));
+    }
+
+    fn writeLen(self: *Self, len: usize) !void {
+        var buf: [4]u8 = undefined;
+        std.mem.writeInt(u32, &buf, @intCast(len), native_endian);
+        try self.data.appendSlice(self.allocator, &buf);
+    }
+
+    fn writeStr(self: *Self, str: []const u8) !void {
+        try self.writeLen(str.len);
+        try self.data.appendSlice(self.allocator, str);
+    }
+
+    // Item count and placeholder for byte size, return position of size.
+    fn beginContainer(self: *Self, tag: Tag, len: usize) !usize {
+        try self.writeTag(tag);
+        try self.writeLen(len);
+        const size_pos = self.data.items.len;
+        try self.writeLen(0);
+        return size_pos;
+    }
+
+    fn endContainer(self: *Self, size_pos: usize) void {
+        const size = self.data.items.len - size_pos - 4;
+        std.mem.writeInt(u32, self.data.items[size_pos..][0..4], @intCast(size), native_endian);
+    }
+
+    fn writeValue(self: *Self, value: std.json.Value) anyerror!void {
+        switch (value) {
+            .null => try self.writeTag(.null_value),
+            .bool => |v| try self.writeTag(if (v) .bool_true else .bool_false),
+            .integer => |v| {
+                var buf: [32]u8 = undefined;
+                try self.writeTag(.number_string);
+                try self.writeStr(try std.fmt.bufPrint(&buf, "{d}", .{v}));
+            },
+            .float => |v| {
+                var buf: [64]u8 = undefined;
+                try self.writeTag(.number_string);
+                try self.writeStr(try std.fmt.bufPrint(&buf, "{d}", .{v}));
+            },
+            .number_string => |v| {
+                try self.writeTag(.number_string);
+                try self.writeStr(v);
+            },
+            .string => |v| {
+                try self.writeTag(.string);
+                try self.writeStr(v);
+            },
+            .array => |v| {
+                const size_pos = try self.beginContainer(.array, v.items.len);
+                for (v.items) |item| try self.writeValue(item);
+                self.endContainer(size_pos);
+            },
+            .object => |v| {
+                const size_pos = try self.beginContainer(.object, v.count());
+                for (v.keys(), v.values()) |k, item| {
+                    try self.writeStr(k);
+                    try self.writeValue(item);
+                }
+                self.endContainer(size_pos);
+            },
+        }
+    }
+
+    // Open container while encoding from tokens, count and size are patched on end.
+    const OpenContainer = struct {
+        count_pos: usize,
+        count: u32 = 0,
+        is_object: bool,
+        expect_key: bool = false,
+    };
+
+    /// Encode one json document from std.json.Scanner or std.json.Reader.
+    /// Numbers are kept as strings same as parse_numbers = false.
+    pub fn writeJson(self: *Self, token_allocator: std.mem.Allocator, source: anytype) !void {
+        var stack: cetech1.ArrayList(OpenContainer) = .empty;
+        defer stack.deinit(self.allocator);
+
+        while (true) {
+            const token = try source.nextAlloc(token_allocator, .alloc_if_needed);
+            defer switch (token) {
+                .allocated_number, .allocated_string => |v| token_allocator.free(v),
+                else => {},
+            };
+
+            switch (token) {
+                .end_of_document => break,
+                .object_end, .array_end => {
+                    const container = stack.pop() orelse return error.SyntaxError;
+                    std.mem.writeInt(u32, self.data.items[container.count_pos..][0..4], container.count, native_endian);
+                    const size = self.data.items.len - container.count_pos - 8;
+                    std.mem.writeInt(u32, self.data.items[container.count_pos + 4 ..][0..4], @intCast(size), native_endian);
+                    continue;
+                },
+                else => {},
+            }
+
+            if (stack.items.len != 0) {
+                const top = &stack.items[stack.items.len - 1];
+
+                // Object key, value follow it.
+                if (top.is_object and top.expect_key) {
+                    switch (token) {
+                        .string, .allocated_string => |k| try self.writeStr(k),
+                        else => return error.SyntaxError,
+                    }
+                    top.count += 1;
+                    top.expect_key = false;
+                    continue;
+                }
+
+                if (top.is_object) top.expect_key = true else top.count += 1;
+            }
+
+            switch (token) {
+                .null => try self.writeTag(.null_value),
+                .true => try self.writeTag(.bool_true),
+                .false => try self.writeTag(.bool_false),
+                .number, .allocated_number => |v| {
+                    try self.writeTag(.number_string);
+                    try self.writeStr(v);
+                },
+                .string, .allocated_string => |v| {
+                    try self.writeTag(.string);
+                    try self.writeStr(v);
+                },
+                .object_begin, .array_begin => {
+                    const is_object = token == .object_begin;
+                    try self.writeTag(if (is_object) .object else .array);
+                    try stack.append(self.allocator, .{ .count_pos = self.data.items.len, .is_object = is_object, .expect_key = is_object });
+                    try self.writeLen(0);
+                    try self.writeLen(0);
+                },
+                else => return error.SyntaxError,
+            }
+        }
+
+        if (stack.items.len != 0) return error.UnexpectedEndOfInput;
+    }
+
+    fn assetLessThan(data: []const u8, a: AssetEntry, b: AssetEntry) bool {
+        return std.mem.lessThan(u8, spanBytes(data, a.path), spanBytes(data, b.path));
+    }
+
+    fn blobLessThan(_: void, a: BlobEntry, b: BlobEntry) bool {
+        return blobOrder(a.key, b.key) == .lt;
+    }
+};
+
+fn spanValid(data: []const u8, span: Span) bool {
+    return span.offset <= data.len and span.len <= data.len - span.offset;
+}
+
+fn spanBytes(data: []const u8, span: Span) []const u8 {
+    return data[span.offset..][0..span.len];
+}
+
+fn blobOrder(a: BlobKey, b: BlobKey) std.math.Order {
+    return std.mem.order(u8, std.mem.asBytes(&a), std.mem.asBytes(&b));
+}
+
+pub const Snapshot = struct {
+    const Self = @This();
+
+    bytes: []align(std.heap.page_size_min) const u8,
+    mapped: bool,
+
+    assets: []const AssetEntry,
+    blobs: []const BlobEntry,
+    data: []const u8,
+
+    pub fn open(io: std.Io, allocator: std.mem.Allocator, dir: std.Io.Dir, sub_path: []const u8) !Self {
+        var file = try dir.openFile(io, sub_path, .{ .mode = .read_only });
+        defer file.close(io);
+
+        const size = try file.length(io);
+        if (size < @sizeOf(Header)) return error.InvalidSnapshot;
+
+        var self = Self{
+            .bytes = undefined,
+            .mapped = builtin.os.tag != .windows,
+            .assets = &.{},
+            .blobs = &.{},
+            .data = &.{},
+        };
+
+        switch (builtin.os.tag) {
+            .windows => {
+                const bytes = try allocator.alignedAlloc(u8, .fromByteUnits(std.heap.page_size_min), size);
+                errdefer allocator.free(bytes);
+                _ = try file.readPositionalAll(io, bytes, 0);
+                self.bytes = bytes;
+            },
+            else => {
+                self.bytes = try std.posix.mmap(
+                    null,
+                    size,
+                    .{ .READ = true },
+                    .{ .TYPE = .PRIVATE },
+                    file.handle,
+                    0,
+                );
+            },
+        }
+        errdefer self.close(allocator);
+
+        const header: *const Header = @ptrCast(self.bytes.ptr);
+        if (!std.mem.eql(u8, &header.magic, &MAGIC) or header.version != VERSION) return error.InvalidSnapshot;
+
+        const assets_size = std.math.mul(u64, header.asset_count, @sizeOf(AssetEntry)) catch return error.InvalidSnapshot;
+        const blobs_size = std.math.mul(u64, header.blob_count, @sizeOf(BlobEntry)) catch return error.InvalidSnapshot;
+        const entries_end = std.math.add(u64, @sizeOf(Header) + assets_size, blobs_size) catch return error.InvalidSnapshot;
+        if (header.data_offset != entries_end) return error.InvalidSnapshot;
+        if (header.data_offset > size or size - header.data_offset != header.data_size) return error.InvalidSnapshot;
+
+        const assets_ptr: [*]const AssetEntry = @ptrCast(@alignCast(self.bytes.ptr + @sizeOf(Header)));
+        const blobs_ptr: [*]const BlobEntry = @ptrCast(@alignCast(self.bytes.ptr + @sizeOf(Header) + assets_size));
+
+        self.assets = assets_ptr[0..header.asset_count];
+        self.blobs = blobs_ptr[0..header.blob_count];
+        self.data = self.bytes[header.data_offset..];
+
+        // Check every span once so accessors can slice without checks.
+        for (self.assets) |*entry| {
+            if (!spanValid(self.data, entry.path)) return error.InvalidSnapshot;
+            if (!spanValid(self.data, entry.imported_from)) return error.InvalidSnapshot;
+            if (!spanValid(self.data, entry.depend_on) or entry.depend_on.len % @sizeOf([16]u8) != 0) return error.InvalidSnapshot;
+            if (!spanValid(self.data, entry.provide) or entry.provide.len % @sizeOf([16]u8) != 0) return error.InvalidSnapshot;
+            if (!spanValid(self.data, entry.value)) return error.InvalidSnapshot;
+            if (!spanValid(self.data, entry.image)) return error.InvalidSnapshot;
+        }
+        for (self.blobs) |*entry| {
+            if (!spanValid(self.data, entry.data)) return error.InvalidSnapshot;
+        }
+
+        return self;
+    }
+
+    pub fn close(self: *Self, allocator: std.mem.Allocator) void {
+        if (self.mapped) {
+            std.posix.munmap(@constCast(self.bytes));
+        } else {
+            allocator.free(self.bytes);
+        }
+    }
+
+    pub fn findAsset(self: *const Self, path: []const u8) ?*const AssetEntry {
+        var left: usize = 0;
+        var right: usize = self.assets.len;
+        while (left < right) {
+            const mid = left + (right - left) / 2;
+            const entry = &self.assets[mid];
+            switch (std.mem.order(u8, path, self.str(entry.path))) {
+                .eq => return entry,
+                .lt => right = mid,
+                .gt => left = mid + 1,
+            }
+        }
+        return null;
+    }
+
+    /// Json file has same size and mtime as cooked one.
+    pub fn isFresh(self: *const Self, entry: *const AssetEntry, stat: std.Io.File.Stat) bool {
+        _ = self;
+        return entry.file_size == stat.size and entry.file_mtime == mtimeNs(stat.mtime);
+    }
+
+    /// Json file was only touched, content is same as cooked one.
+    pub fn isSameContent(self: *const Self, entry: *const AssetEntry, content: []const u8) bool {
+        _ = self;
+        return entry.file_size == content.len and entry.content_hash == contentHash(content);
+    }
+
+    pub fn fileInfo(self: *const Self, entry: *const AssetEntry) FileInfo {
+        _ = self;
+        return .{ .size = entry.file_size, .mtime = entry.file_mtime, .content_hash = entry.content_hash };
+    }
+
+    pub fn hasValue(self: *const Self, entry: *const AssetEntry) bool {
+        _ = self;
+        return entry.has_value != 0;
+    }
+
+    /// Cooked cdb object image of asset.
+    pub fn image(self: *const Self, entry: *const AssetEntry) ?[]const u8 {
+        if (entry.has_image == 0) return null;
+        return self.str(entry.image);
+    }
+
+    pub fn findBlob(self: *const Self, key: BlobKey) ?[]const u8 {
+        var left: usize = 0;
+        var right: usize = self.blobs.len;
+        while (left < right) {
+            const mid = left + (right - left) / 2;
+            const entry = &self.blobs[mid];
+            switch (blobOrder(key, entry.key)) {
+                .eq => return self.str(entry.data),
+                .lt => right = mid,
+                .gt => left = mid + 1,
+            }
+        }
+        return null;
+    }
+
+    pub fn str(self: *const Self, span: Span) []const u8 {
+        return spanBytes(self.data, span);
+    }
+
+    pub fn uuidCount(self: *const Self, span: Span) usize {
+        _ = self;
+        return span.len / @sizeOf([16]u8);
+    }
+
+    pub fn uuidAt(self: *const Self, span: Span, idx: usize) uuid.Uuid {
+        return .{ .bytes = self.str(span)[idx * @sizeOf([16]u8) ..][0..16].* };
+    }
+
+    pub fn importedFrom(self: *const Self, entry: *const AssetEntry) ?[]const u8 {
+        if (entry.has_imported_from == 0) return null;
+        return self.str(entry.imported_from);
+    }
+
+    /// Decode asset value. Containers are allocated with allocator (use arena), strings are not copied.
+    pub fn decodeValue(self: *const Self, allocator: std.mem.Allocator, entry: *const AssetEntry) !std.json.Value {
+        if (entry.has_value == 0) return error.InvalidSnapshot;
+        return decodeValue(allocator, self.str(entry.value));
+    }
+
+    /// View of asset value without decoding.
+    pub fn valueView(self: *const Self, entry: *const AssetEntry) !ValueView {
+        if (entry.has_value == 0) return error.InvalidSnapshot;
+        return ValueView.init(self.str(entry.value));
+    }
+};
+
+const ValueReader = struct {
+    const Self = @This();
+
+    data: []const u8,
+    pos: usize = 0,
+
+    fn take(self: *Self, len: usize) ![]const u8 {
+        if (len > self.data.len - self.pos) return error.InvalidSnapshot;
+        const bytes = self.data[self.pos..][0..len];
+        self.pos += len;
+        return bytes;
+    }
+
+    fn readLen(self: *Self) !u32 {
+        return std.mem.readInt(u32, (try self.take(4))[0..4], native_endian);
+    }
+
+    fn readStr(self: *Self) ![]const u8 {
+        return self.take(try self.readLen());
+    }
+
+    fn readTag(self: *Self) !Tag {
+        const raw_tag = (try self.take(1))[0];
+        if (raw_tag > @intFromEnum(Tag.object)) return error.InvalidSnapshot;
+        return @enumFromInt(raw_tag);
+    }
+
+    fn readView(self: *Self) !ValueView {
+        const tag = try self.readTag();
+        switch (tag) {
+            .null_value, .bool_false, .bool_true => return .{ .tag = tag, .payload = &.{} },
+            .number_string, .string => return .{ .tag = tag, .payload = try self.readStr() },
+            .array, .object => {
+                const len = try self.readLen();
+                return .{ .tag = tag, .len = len, .payload = try self.readStr() };
+            },
+        }
+    }
+
+    fn readValue(self: *Self, allocator: std.mem.Allocator) anyerror!std.json.Value {
+        return decodeView(allocator, try self.readView());
+    }
+};
+
+fn decodeView(allocator: std.mem.Allocator, view: ValueView) anyerror!std.json.Value {
+    switch (view.tag) {
+        .null_value => return .null,
+        .bool_false => return .{ .bool = false },
+        .bool_true => return .{ .bool = true },
+        .number_string => return .{ .number_string = view.payload },
+        .string => return .{ .string = view.payload },
+        .array => {
+            var array = try std.json.Array.initCapacity(allocator, view.len);
+            var it = try view.arrayIterator();
+            while (try it.next()) |item| array.appendAssumeCapacity(try decodeView(allocator, item));
+            return .{ .array = array };
+        },
+        .object => {
+            const keys = try allocator.alloc([]const u8, view.len);
+            const values = try allocator.alloc(std.json.Value, view.len);
+            var it = try view.objectIterator();
+            for (keys, values) |*k, *v| {
+                const entry = (try it.next()).?;
+                k.* = entry.key;
+                v.* = try decodeView(allocator, entry.value);
+            }
+            return .{ .object = try std.json.ObjectMap.init(allocator, keys, values) };
+        },
+    }
+}
+
+test "assetdb_snapshot: Should encode and decode json value" {
+    const allocator = std.testing.allocator;
+
+    const json =
+        \\{"__uuid": "018b5846-c2d5-712f-bb12-9d9d15321ecb", "u64": 42, "f32": 1.5, "bool": true,
+        \\ "none": null, "set": [{"str": "foo"}, {"str": "bar"}], "esc": "a\nb", "empty": {}}
+    ;
+
+    var parsed = try std.json.parseFromSlice(std.json.Value, allocator, json, .{ .parse_numbers = false });
+    defer parsed.deinit();
+
+    const encoded = try encodeJson(allocator, json);
+    defer allocator.free(encoded);
+
+    // Token stream encoding is same as encoding of parsed value.
+    const encoded_value = try encodeValue(allocator, parsed.value);
+    defer allocator.free(encoded_value);
+    try std.testing.expectEqualSlices(u8, encoded_value, encoded);
+
+    var writer = Writer.init(allocator);
+    defer writer.deinit();
+
+    const asset_uuid = uuid.Uuid{ .bytes = .{1} ** 16 };
+    const depend = [_]uuid.Uuid{.{ .bytes = .{2} ** 16 }};
+    const file_info = FileInfo{ .size = json.len, .mtime = 20, .content_hash = contentHash(json) };
+    const blob_key = BlobKey{ .asset_uuid = asset_uuid.bytes, .obj_hash = 1, .prop_hash = 2 };
+    try writer.addAsset("b.json", asset_uuid, file_info, &depend, &.{}, null, null, null);
+    try writer.addAsset("a.json", asset_uuid, file_info, &.{}, &depend, "a.png", encoded, "image");
+    try writer.addBlob(blob_key, "hello blob");
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try writer.writeFile(std.testing.io, tmp_dir.dir, FILENAME);
+
+    var snapshot = try Snapshot.open(std.testing.io, allocator, tmp_dir.dir, FILENAME);
+    defer snapshot.close(allocator);
+
+    try std.testing.expect(snapshot.findAsset("c.json") == null);
+
+    const a = snapshot.findAsset("a.json").?;
+    try std.testing.expectEqualStrings("a.png", snapshot.importedFrom(a).?);
+    try std.testing.expectEqual(@as(usize, 1), snapshot.uuidCount(a.provide));
+    try std.testing.expect(snapshot.isSameContent(a, json));
+    try std.testing.expect(!snapshot.isSameContent(a, "{}"));
+
+    const b = snapshot.findAsset("b.json").?;
+    try std.testing.expect(snapshot.importedFrom(b) == null);
+    try std.testing.expect(!snapshot.hasValue(b));
+    try std.testing.expect(snapshot.image(b) == null);
+    try std.testing.expectEqualStrings("image", snapshot.image(a).?);
+    try std.testing.expectEqual(depend[0], snapshot.uuidAt(b.depend_on, 0));
+
+    try std.testing.expectEqualStrings("hello blob", snapshot.findBlob(blob_key).?);
+    try std.testing.expect(snapshot.findBlob(.{ .asset_uuid = asset_uuid.bytes, .obj_hash = 1, .prop_hash = 3 }) == null);
+
+    var arena = std.heap.ArenaAllocator.init(allocator);
+    defer arena.deinit();
+    const value = try snapshot.decodeValue(arena.allocator(), a);
+
+    try std.testing.expectEqualStrings("42", value.object.get("u64").?.number_string);
+    try std.testing.expectEqualStrings("1.5", value.object.get("f32").?.number_string);
+    try std.testing.expect(value.object.get("bool").?.bool);
+    try std.testing.expect(value.object.get("none").? == .null);
+    try std.testing.expectEqualStrings("bar", value.object.get("set").?.array.items[1].object.get("str").?.string);
+
+    const standalone = try decodeValue(arena.allocator(), encoded);
+    try std.testing.expectEqualStrings("018b5846-c2d5-712f-bb12-9d9d15321ecb", standalone.object.get("__uuid").?.string);
+
+    // View read same values without decoding.
+    const view = try ValueView.init(encoded);
+    try std.testing.expectEqualStrings("42", try (try view.get("u64")).?.str());
+    try std.testing.expect(try (try view.get("bool")).?.boolean());
+    try std.testing.expect((try view.get("none")).?.isNull());
+    try std.testing.expect(try view.get("missing") == null);
+    try std.testing.expectEqualStrings("a\nb", try (try view.get("esc")).?.str());
+    try std.testing.expectEqual(@as(u32, 0), (try view.get("empty")).?.len);
+
+    var set_it = try (try view.get("set")).?.arrayIterator();
+    try std.testing.expectEqualStrings("foo", try (try (try set_it.next()).?.get("str")).?.str());
+    try std.testing.expectEqualStrings("bar", try (try (try set_it.next()).?.get("str")).?.str());
+    try std.testing.expect(try set_it.next() == null);
+
+    // Snapshot value is same view.
+    try std.testing.expectEqualStrings("1.5", try (try (try snapshot.valueView(a)).get("f32")).?.str());
+}
+
+test "assetdb_snapshot: Should reject span out of data" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var writer = Writer.init(allocator);
+    defer writer.deinit();
+
+    const file_info = FileInfo{ .size = 0, .mtime = 0, .content_hash = 0 };
+    try writer.addAsset("a.json", .{ .bytes = .{1} ** 16 }, file_info, &.{}, &.{}, null, null, null);
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    try writer.writeFile(io, tmp_dir.dir, FILENAME);
+
+    // Corrupt path length of first asset.
+    {
+        var file = try tmp_dir.dir.openFile(io, FILENAME, .{ .mode = .read_write });
+        defer file.close(io);
+        const bad_len: u64 = 1 << 40;
+        try file.writePositionalAll(io, std.mem.asBytes(&bad_len), @sizeOf(Header) + @offsetOf(AssetEntry, "path") + @offsetOf(Span, "len"));
+    }
+
+    try std.testing.expectError(error.InvalidSnapshot, Snapshot.open(io, allocator, tmp_dir.dir, FILENAME));
+}
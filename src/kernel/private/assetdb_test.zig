@@ -12,8 +12,10 @@ const uuid_private = @import("uuid.zig");
 const assetdb_private = @import("assetdb.zig");
 const assetdbfs_private = @import("assetdb_fs.zig");
 const metrics_private = @import("metrics.zig");
+const fswatch_private = @import("fswatch.zig");
 
 const cetech1 = @import("cetech1");
+const cetech1_options = @import("cetech1_options");
 const cdb = cetech1.cdb;
 const public = cetech1.assetdb;
 const propIdx = cdb.propIdx;
@@ -41,6 +43,20 @@ pub fn WriteBlobToNull(
     _ = root_path;
 }
 
+fn expectBlobInPack(root_dir: []const u8, data: []const u8) !void {
+    const path = try std.fs.path.join(std.testing.allocator, &.{ root_dir, assetdb_private.BLOB_DIR, "pack", "0000.ct_pack" });
+    defer std.testing.allocator.free(path);
+
+    var pack_file = try std.Io.Dir.cwd().openFile(std.testing.io, path, .{});
+    defer pack_file.close(std.testing.io);
+
+    const pack = try std.testing.allocator.alloc(u8, try pack_file.length(std.testing.io));
+    defer std.testing.allocator.free(pack);
+    _ = try pack_file.readPositionalAll(std.testing.io, pack, 0);
+
+    try std.testing.expect(std.mem.indexOf(u8, pack, data) != null);
+}
+
 pub fn ReadBlobFromNull(
     io: std.Io,
     asset: cdb.ObjId,
@@ -49,7 +65,7 @@ pub fn ReadBlobFromNull(
     prop_hash: cetech1.StrId32,
     root_path: []const u8,
     allocator: std.mem.Allocator,
-) anyerror![]u8 {
+) anyerror!assetdbfs_private.BlobData {
     _ = io;
     _ = asset;
     _ = type_name;
@@ -57,7 +73,7 @@ pub fn ReadBlobFromNull(
     _ = prop_hash;
     _ = root_path;
     _ = allocator;
-    return &.{};
+    return .{ .data = &.{}, .owned = false };
 }
 
 fn testInit() !void {
@@ -66,6 +82,7 @@ fn testInit() !void {
     try apidb_private.init(std.testing.allocator);
     try metrics_private.init(std.testing.allocator);
     try cdb_private.init(std.testing.io, std.testing.allocator);
+    try fswatch_private.init(std.testing.io, std.testing.allocator);
     try assetdb_private.registerToApi();
     try task_private.start(null);
     try cdb_types_private.registerToApi();
@@ -78,6 +95,7 @@ fn testDeinit() void {
     task_private.deinit();
     tempalloc_private.deinit();
     metrics_private.deinit();
+    fswatch_private.deinit();
 }
 
 test "asset: Should save asset to json" {
@@ -949,15 +967,8 @@ test "asset: Should revive asset" {
         (try f).close(std.testing.io);
     }
 
-    // Original asset blob dir does not exist
-    {
-        const path = try std.fs.path.join(std.testing.allocator, &.{ root_dir, assetdb_private.BLOB_DIR, asset_uuid_str });
-        defer std.testing.allocator.free(path);
-
-        var d = std.Io.Dir.cwd().openDir(std.testing.io, path, .{});
-        try std.testing.expect(d != std.Io.Dir.OpenError.FileNotFound);
-        (try d).close(std.testing.io);
-    }
+    // Asset blob is in blob store
+    try expectBlobInPack(root_dir, "hello blob");
 }
 
 test "asset: Should create asset without asset root" {
@@ -1011,15 +1022,8 @@ test "asset: Should create asset without asset root" {
         (try f).close(std.testing.io);
     }
 
-    // Original asset blob dir does not exist
-    {
-        const path = try std.fs.path.join(std.testing.allocator, &.{ root_dir, assetdb_private.BLOB_DIR, asset_uuid_str });
-        defer std.testing.allocator.free(path);
-
-        var d = std.Io.Dir.cwd().openDir(std.testing.io, path, .{});
-        try std.testing.expect(d != std.Io.Dir.OpenError.FileNotFound);
-        (try d).close(std.testing.io);
-    }
+    // Asset blob is in blob store
+    try expectBlobInPack(root_dir, "hello blob");
 }
 
 test "asset: Should create folder without asset root" {
@@ -1076,15 +1080,8 @@ test "asset: Should create folder without asset root" {
         (try f).close(std.testing.io);
     }
 
-    // Original asset blob dir does not exist
-    {
-        const path = try std.fs.path.join(std.testing.allocator, &.{ root_dir, assetdb_private.BLOB_DIR, asset_uuid_str });
-        defer std.testing.allocator.free(path);
-
-        var d = std.Io.Dir.cwd().openDir(std.testing.io, path, .{});
-        try std.testing.expect(d != std.Io.Dir.OpenError.FileNotFound);
-        (try d).close(std.testing.io);
-    }
+    // Asset blob is in blob store
+    try expectBlobInPack(root_dir, "hello blob");
 }
 
 test "asset: Should rename folder" {
@@ -1460,3 +1457,572 @@ test "asset: Should get new valid name for asset" {
 
     try std.testing.expectEqualStrings("foo2", name);
 }
+
+test "asset: fixtures import throughput" {
+    if (!cetech1_options.enable_bench) return error.SkipZigTest;
+
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    _ = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    const roots = [_][]const u8{
+        "fixtures/test_asset",
+        "fixtures/test_explorer",
+        "fixtures/test_move",
+        "fixtures/test_property",
+    };
+    const rounds = 10;
+
+    for (roots) |root| {
+        const start = std.Io.Timestamp.now(io, .awake);
+        for (0..rounds) |_| {
+            try public.openAssetRootFolder(root, allocator);
+        }
+        const open_ns = start.durationTo(.now(io, .awake)).toNanoseconds();
+
+        std.debug.print(
+            "asset import: root={s} open={d}us parsed_peak={d}B workers={d}\n",
+            .{ root, @divTrunc(open_ns, rounds * std.time.ns_per_us), assetdbfs_private.parsedPeakBytes(), cetech1.task.getThreadNum() },
+        );
+    }
+
+    // Last opened root is resolvable by uuid.
+    try std.testing.expect(cdb.getObjId(db, uuid_private.fromStr("018e4b5a-5fe3-7e1a-bf5b-10df8c083e9f").?) != null);
+}
+
+test "asset: Should open asset root from cooked snapshot" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    _ = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    const root = "fixtures/test_asset";
+    const rounds = 10;
+
+    std.Io.Dir.cwd().deleteFile(io, root ++ "/" ++ public.CT_TEMP_FOLDER ++ "/assets.ct_snapshot") catch {};
+
+    const json_reads = assetdbfs_private.snapshotReadCount();
+    const json_start = std.Io.Timestamp.now(io, .awake);
+    for (0..rounds) |_| {
+        try public.openAssetRootFolder(root, allocator);
+    }
+    const json_ns = json_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    // Without snapshot everything is read from json.
+    try std.testing.expectEqual(json_reads, assetdbfs_private.snapshotReadCount());
+
+    try public.cookAssetRootSnapshot(root, allocator);
+    defer std.Io.Dir.cwd().deleteFile(io, root ++ "/" ++ public.CT_TEMP_FOLDER ++ "/assets.ct_snapshot") catch undefined;
+
+    const snapshot_reads = assetdbfs_private.snapshotReadCount();
+    const image_reads = assetdbfs_private.snapshotImageReadCount();
+    const snapshot_start = std.Io.Timestamp.now(io, .awake);
+    for (0..rounds) |_| {
+        try public.openAssetRootFolder(root, allocator);
+    }
+    const snapshot_ns = snapshot_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    // Every open read assets from snapshot.
+    try std.testing.expect(assetdbfs_private.snapshotReadCount() - snapshot_reads >= rounds);
+
+    // Assets without prototype are read from cooked cdb image.
+    try std.testing.expect(assetdbfs_private.snapshotImageReadCount() - image_reads >= rounds);
+
+    if (cetech1_options.enable_bench) {
+        std.debug.print(
+            "asset snapshot: root={s} json={d}us snapshot={d}us\n",
+            .{ root, @divTrunc(json_ns, rounds * std.time.ns_per_us), @divTrunc(snapshot_ns, rounds * std.time.ns_per_us) },
+        );
+    }
+
+    const foo_obj = cdb.getObjId(db, uuid_private.fromStr("018b5846-c2d5-712f-bb12-9d9d15321ecb").?);
+    try std.testing.expect(foo_obj != null);
+
+    const foo_r = cdb.readObj(foo_obj.?).?;
+    try std.testing.expectEqual(@as(u64, 2222), cdb.readValue(u64, foo_r, propIdx(cetech1.cdb_types.BigTypeProps.U64)));
+    try std.testing.expectEqual(@as(f32, 30), cdb.readValue(f32, foo_r, propIdx(cetech1.cdb_types.BigTypeProps.F32)));
+    try std.testing.expectEqualStrings("foo", cdb.readStr(foo_r, propIdx(cetech1.cdb_types.BigTypeProps.Str)).?);
+    const subobj_set = (try cdb.readSubObjSet(foo_r, propIdx(cetech1.cdb_types.BigTypeProps.SubobjectSet), allocator)).?;
+    defer allocator.free(subobj_set);
+    try std.testing.expectEqual(@as(usize, 2), subobj_set.len);
+
+    const blob = cdb.readBlob(foo_r, propIdx(cetech1.cdb_types.BigTypeProps.Blob));
+    try std.testing.expectEqualSlices(u8, "hello blob", blob);
+}
+
+test "asset: Should reopen unchanged asset root from manifest" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    _ = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    const root = "fixtures/test_asset";
+    const manifest_path = root ++ "/" ++ public.CT_TEMP_FOLDER ++ "/assets.ct_manifest";
+
+    std.Io.Dir.cwd().deleteFile(io, manifest_path) catch {};
+
+    // First open analyze all files and write manifest.
+    try public.openAssetRootFolder(root, allocator);
+    const manifest_stat = try std.Io.Dir.cwd().statFile(io, manifest_path, .{});
+
+    // Nothing changed so manifest is not rewritten.
+    try public.openAssetRootFolder(root, allocator);
+    const reopen_stat = try std.Io.Dir.cwd().statFile(io, manifest_path, .{});
+    try std.testing.expectEqual(manifest_stat.mtime.nanoseconds, reopen_stat.mtime.nanoseconds);
+    try std.testing.expectEqual(manifest_stat.inode, reopen_stat.inode);
+
+    const foo_obj = cdb.getObjId(db, uuid_private.fromStr("018b5846-c2d5-712f-bb12-9d9d15321ecb").?);
+    try std.testing.expect(foo_obj != null);
+    try std.testing.expect(cdb.getObjId(db, uuid_private.fromStr("018b5846-c2d5-7c82-82b4-525348222242").?) != null);
+}
+
+test "asset: Should save and load import cache" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+
+    var cache = assetdbfs_private.ImportCache.init(allocator);
+    defer cache.deinit();
+
+    const entry = assetdbfs_private.ImportCache.Entry{ .content_hash = std.math.maxInt(u64) - 1, .version = 1 };
+
+    try std.testing.expect(!cache.isValid(io, "scripts/foo.luau", entry));
+    try cache.put(io, "scripts/foo.luau", entry);
+    try std.testing.expect(cache.dirty);
+    try cache.save(io, tmp_dir.dir, "import_cache.json");
+
+    var loaded = assetdbfs_private.ImportCache.init(allocator);
+    defer loaded.deinit();
+    try loaded.load(io, tmp_dir.dir, "import_cache.json");
+
+    try std.testing.expect(!loaded.dirty);
+    try std.testing.expect(loaded.isValid(io, "scripts/foo.luau", entry));
+
+    // Changed content or importer version invalidate entry.
+    try std.testing.expect(!loaded.isValid(io, "scripts/foo.luau", .{ .content_hash = 1, .version = 1 }));
+    try std.testing.expect(!loaded.isValid(io, "scripts/foo.luau", .{ .content_hash = entry.content_hash, .version = 2 }));
+}
+
+test "asset: Should save modified assets with progress and cancel" {
+    try testInit();
+    defer testDeinit();
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    var tmp_dir = std.testing.tmpDir(.{ .iterate = true });
+    defer tmp_dir.cleanup();
+    const root_dir = try tmp_dir.dir.realPathFileAlloc(std.testing.io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_dir);
+
+    const asset_type_hash = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    var assets: [16]cdb.ObjId = undefined;
+    for (&assets, 0..) |*asset, idx| {
+        var name_buf: [32]u8 = undefined;
+        const name = try std.fmt.bufPrint(&name_buf, "foo{d}", .{idx});
+        asset.* = public.createAsset(name, public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    }
+    try public.saveAllAssets(allocator);
+
+    for (assets) |asset| {
+        const w = cdb.writeObj(asset).?;
+        try cetech1.assetdb.AssetCdb.setStr(w, .Description, "changed");
+        try cdb.writeCommit(w);
+    }
+
+    // Canceled save does not write anything
+    {
+        var progress: public.SaveProgress = .{};
+        progress.cancel();
+        try public.saveAllModifiedAssetsWithProgress(allocator, &progress);
+
+        try std.testing.expectEqual(assets.len, progress.total.load(.acquire));
+        try std.testing.expectEqual(@as(usize, 0), progress.done.load(.acquire));
+        for (assets) |asset| try std.testing.expect(public.isAssetModified(asset));
+
+        var f = try tmp_dir.dir.openFile(std.testing.io, "foo0.ct_foo_asset.json", .{});
+        defer f.close(std.testing.io);
+        var buf: [4096]u8 = undefined;
+        const n = try f.readPositionalAll(std.testing.io, &buf, 0);
+        try std.testing.expect(std.mem.indexOf(u8, buf[0..n], "changed") == null);
+    }
+
+    // Save all
+    {
+        var progress: public.SaveProgress = .{};
+        try public.saveAllModifiedAssetsWithProgress(allocator, &progress);
+
+        try std.testing.expectEqual(assets.len, progress.done.load(.acquire));
+        try std.testing.expectEqual(@as(f32, 1), progress.fraction());
+        for (assets) |asset| try std.testing.expect(!public.isAssetModified(asset));
+
+        var f = try tmp_dir.dir.openFile(std.testing.io, "foo0.ct_foo_asset.json", .{});
+        defer f.close(std.testing.io);
+        var buf: [4096]u8 = undefined;
+        const n = try f.readPositionalAll(std.testing.io, &buf, 0);
+        try std.testing.expect(std.mem.indexOf(u8, buf[0..n], "changed") != null);
+    }
+
+    // No temp file left
+    var it = tmp_dir.dir.iterate();
+    while (try it.next(std.testing.io)) |entry| {
+        try std.testing.expect(!std.mem.endsWith(u8, entry.name, ".tmp"));
+    }
+}
+
+test "asset: Should not rename asset on disk when save is canceled" {
+    try testInit();
+    defer testDeinit();
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    var tmp_dir = std.testing.tmpDir(.{ .iterate = true });
+    defer tmp_dir.cleanup();
+    const root_dir = try tmp_dir.dir.realPathFileAlloc(std.testing.io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_dir);
+
+    const asset_type_hash = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    const asset = public.createAsset("foo", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    try public.saveAllAssets(allocator);
+
+    {
+        const w = cdb.writeObj(asset).?;
+        try cetech1.assetdb.AssetCdb.setStr(w, .Name, "bar");
+        try cdb.writeCommit(w);
+    }
+
+    // Canceled save keep old file and does not create new one.
+    {
+        var progress: public.SaveProgress = .{};
+        progress.cancel();
+        try public.saveAllModifiedAssetsWithProgress(allocator, &progress);
+
+        try std.testing.expect(public.isAssetModified(asset));
+
+        var f = try tmp_dir.dir.openFile(std.testing.io, "foo.ct_foo_asset.json", .{});
+        f.close(std.testing.io);
+        try std.testing.expectError(error.FileNotFound, tmp_dir.dir.openFile(std.testing.io, "bar.ct_foo_asset.json", .{}));
+
+        // No staged file left
+        var stage_dir = try tmp_dir.dir.openDir(std.testing.io, public.CT_TEMP_FOLDER ++ "/save", .{ .iterate = true });
+        defer stage_dir.close(std.testing.io);
+        var it = stage_dir.iterate();
+        try std.testing.expect(try it.next(std.testing.io) == null);
+    }
+
+    // Next save do rename.
+    {
+        try public.saveAllModifiedAssets(allocator);
+        try std.testing.expect(!public.isAssetModified(asset));
+
+        try std.testing.expectError(error.FileNotFound, tmp_dir.dir.openFile(std.testing.io, "foo.ct_foo_asset.json", .{}));
+        var f = try tmp_dir.dir.openFile(std.testing.io, "bar.ct_foo_asset.json", .{});
+        f.close(std.testing.io);
+    }
+}
+
+test "asset: Should filter assets by search index" {
+    try testInit();
+    defer testDeinit();
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_dir = try tmp_dir.dir.realPathFileAlloc(std.testing.io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_dir);
+
+    const asset_type_hash = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    const foo = public.createAsset("foo_shader", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    const bar = public.createAsset("bar", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+
+    {
+        const result = try public.filerAsset(allocator, "shader", .{});
+        defer allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(foo));
+    }
+
+    // Index follow asset changes.
+    {
+        const w = cdb.writeObj(bar).?;
+        try cetech1.assetdb.AssetCdb.setStr(w, .Name, "bar_shader");
+        try cdb.writeCommit(w);
+    }
+
+    {
+        const result = try public.filerAsset(allocator, "shader", .{});
+        defer allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 2), result.len);
+    }
+
+    // Folder rename update assets inside.
+    const folder = public.getAssetForObj(try public.createNewFolder(db, public.getRootFolder(), "core")).?;
+    const baz = public.createAsset("baz", folder, try cdb.createObject(db, asset_type_hash)).?;
+
+    {
+        const result = try public.filerAsset(allocator, "core", .{});
+        defer allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 2), result.len);
+    }
+
+    {
+        const w = cdb.writeObj(folder).?;
+        try cetech1.assetdb.AssetCdb.setStr(w, .Name, "engine");
+        try cdb.writeCommit(w);
+    }
+
+    {
+        const result = try public.filerAsset(allocator, "core", .{});
+        defer allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 0), result.len);
+    }
+
+    {
+        const result = try public.filerAsset(allocator, "engine baz", .{});
+        defer allocator.free(result);
+        try std.testing.expectEqual(@as(usize, 1), result.len);
+        try std.testing.expect(result[0].obj.eql(baz));
+    }
+}
+
+test "asset: Should reload asset changed outside of editor" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_dir = try tmp_dir.dir.realPathFileAlloc(io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_dir);
+
+    const asset_type_hash = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    const asset = public.createAsset("foo", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    {
+        const w = cdb.writeObj(asset).?;
+        try cetech1.assetdb.AssetCdb.setStr(w, .Description, "saved");
+        try cdb.writeCommit(w);
+    }
+    try public.saveAllAssets(allocator);
+
+    // Own save does not reload asset. Reload would replace unsaved change with saved one.
+    {
+        const w = cdb.writeObj(asset).?;
+        try cetech1.assetdb.AssetCdb.setStr(w, .Description, "unsaved");
+        try cdb.writeCommit(w);
+    }
+    for (0..10) |_| {
+        try fswatch_private.update(allocator);
+        try std.Io.sleep(io, .fromNanoseconds(10 * std.time.ns_per_ms), .awake);
+    }
+    try std.testing.expectEqualStrings("unsaved", cetech1.assetdb.AssetCdb.readStr(cdb.readObj(asset).?, .Description).?);
+    try std.testing.expect(public.isAssetModified(asset));
+
+    // Edit file outside
+    {
+        var buf: [4096]u8 = undefined;
+        const content = blk: {
+            var f = try tmp_dir.dir.openFile(io, "foo.ct_foo_asset.json", .{});
+            defer f.close(io);
+            const n = try f.readPositionalAll(io, &buf, 0);
+            break :blk buf[0..n];
+        };
+
+        var out_buf: [4096]u8 = undefined;
+        const size = std.mem.replacementSize(u8, content, "saved", "edited");
+        _ = std.mem.replace(u8, content, "saved", "edited", &out_buf);
+
+        var f = try tmp_dir.dir.createFile(io, "foo.ct_foo_asset.json", .{});
+        defer f.close(io);
+        try f.writePositionalAll(io, out_buf[0..size], 0);
+    }
+
+    const deadline = std.Io.Timestamp.now(io, .awake).nanoseconds + 5 * std.time.ns_per_s;
+    while (std.Io.Timestamp.now(io, .awake).nanoseconds < deadline) {
+        try fswatch_private.update(allocator);
+        const desc = cetech1.assetdb.AssetCdb.readStr(cdb.readObj(asset).?, .Description) orelse "";
+        if (std.mem.eql(u8, desc, "edited")) break;
+        try std.Io.sleep(io, .fromNanoseconds(10 * std.time.ns_per_ms), .awake);
+    }
+
+    const desc = cetech1.assetdb.AssetCdb.readStr(cdb.readObj(asset).?, .Description) orelse "";
+    try std.testing.expectEqualStrings("edited", desc);
+    try std.testing.expect(!public.isAssetModified(asset));
+}
+
+test "asset: Should reopen same root only with changed assets" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_dir = try tmp_dir.dir.realPathFileAlloc(io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_dir);
+
+    const asset_type_hash = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    const foo = public.createAsset("foo", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    const bar = public.createAsset("bar", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    const baz = public.createAsset("baz", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    try public.saveAllAssets(allocator);
+
+    // Change tree while closed, bar is removed and baz moved to new folder.
+    try tmp_dir.dir.deleteFile(io, "bar.ct_foo_asset.json");
+    try tmp_dir.dir.createDirPath(io, "sub");
+    try tmp_dir.dir.rename("baz.ct_foo_asset.json", tmp_dir.dir, "sub/baz.ct_foo_asset.json", io);
+
+    // Unsaved asset is dropped.
+    const unsaved = public.createAsset("unsaved", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    // Unchanged asset is kept as is.
+    try std.testing.expect(cdb.isAlive(foo));
+    try std.testing.expect(public.getAssetByPath("foo.ct_foo_asset.json").?.eql(foo));
+
+    try std.testing.expect(!cdb.isAlive(bar));
+    try std.testing.expect(public.getAssetByPath("bar.ct_foo_asset.json") == null);
+
+    try std.testing.expect(!cdb.isAlive(unsaved));
+
+    const moved = public.getAssetByPath("sub/baz.ct_foo_asset.json").?;
+    try std.testing.expect(public.getAssetByPath("baz.ct_foo_asset.json") == null);
+    try std.testing.expect(moved.eql(baz));
+
+    const folder = cetech1.assetdb.AssetCdb.readRef(cdb.readObj(moved).?, .Folder).?;
+    try std.testing.expect(public.isAssetFolder(folder));
+    try std.testing.expect(!folder.eql(public.getRootFolder()));
+}
+
+test "asset: Should sync asset moved and removed outside of editor" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const allocator = try tempalloc.create();
+    defer tempalloc.destroy(allocator);
+
+    try assetdb_private.init(std.testing.io, std.testing.allocator);
+    defer assetdb_private.deinit();
+    const db = assetdb_private.getDb();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_dir = try tmp_dir.dir.realPathFileAlloc(io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_dir);
+
+    const asset_type_hash = try cetech1.cdb_types.addBigType(db, "ct_foo_asset", null);
+
+    try public.openAssetRootFolder(root_dir, allocator);
+
+    const asset = public.createAsset("foo", public.getRootFolder(), try cdb.createObject(db, asset_type_hash)).?;
+    try public.saveAllAssets(allocator);
+
+    // Move to new folder outside, folder asset is created for it.
+    try tmp_dir.dir.createDirPath(io, "bar");
+    try tmp_dir.dir.rename("foo.ct_foo_asset.json", tmp_dir.dir, "bar/foo.ct_foo_asset.json", io);
+
+    var deadline = std.Io.Timestamp.now(io, .awake).nanoseconds + 5 * std.time.ns_per_s;
+    while (std.Io.Timestamp.now(io, .awake).nanoseconds < deadline) {
+        try fswatch_private.update(allocator);
+        if (public.getAssetByPath("bar/foo.ct_foo_asset.json") != null and public.getAssetByPath("foo.ct_foo_asset.json") == null) break;
+        try std.Io.sleep(io, .fromNanoseconds(10 * std.time.ns_per_ms), .awake);
+    }
+
+    try std.testing.expect(public.getAssetByPath("foo.ct_foo_asset.json") == null);
+    try std.testing.expect(public.getAssetByPath("bar/foo.ct_foo_asset.json").?.eql(asset));
+
+    const folder = cetech1.assetdb.AssetCdb.readRef(cdb.readObj(asset).?, .Folder).?;
+    try std.testing.expect(public.isAssetFolder(folder));
+    try std.testing.expect(!folder.eql(public.getRootFolder()));
+
+    // Remove folder outside, asset and folder are removed.
+    try tmp_dir.dir.deleteTree(io, "bar");
+
+    deadline = std.Io.Timestamp.now(io, .awake).nanoseconds + 5 * std.time.ns_per_s;
+    while (std.Io.Timestamp.now(io, .awake).nanoseconds < deadline) {
+        try fswatch_private.update(allocator);
+        if (!cdb.isAlive(asset) and !cdb.isAlive(folder)) break;
+        try std.Io.sleep(io, .fromNanoseconds(10 * std.time.ns_per_ms), .awake);
+    }
+
+    try std.testing.expect(!cdb.isAlive(asset));
+    try std.testing.expect(!cdb.isAlive(folder));
+    try std.testing.expect(public.getAssetByPath("bar/foo.ct_foo_asset.json") == null);
+}
@@ -13,7 +13,7 @@ const uuid = cetech1.uuid;
 
 const apidb = cetech1.apidb;
 const profiler = @import("profiler.zig");
-const task = @import("task.zig");
+const task = cetech1.task;
 
 const cdb_test = @import("cdb_test.zig");
 
@@ -31,7 +31,7 @@ const Blob = struct { b: []u8 };
 const IdSet = cetech1.ArraySet(public.ObjId);
 const ReferencerIdSet = cetech1.AutoArrayHashMap(public.ObjId, u32);
 const PrototypeInstanceSet = cetech1.ArraySet(public.ObjId);
-const IdSetPool = cetech1.heap.VirtualPool(ObjIdSet);
+const IdSetPool = cetech1.heap.ChunkedPool(ObjIdSet);
 const OverridesSet = std.bit_set.IntegerBitSet(MAX_PROPERIES_IN_OBJECT);
 
 const AtomicInt32 = std.atomic.Value(u32);
@@ -49,17 +49,38 @@ const PropertyTypeAspectMap = cetech1.AutoArrayHashMap(PropertyAspectPair, *anyo
 const OnObjIdDestroyed = *const fn (db: public.DbId, objects: []public.ObjId) void;
 const OnObjIdDestroyMap = cetech1.ArraySet(OnObjIdDestroyed);
 
-const ChangedObjectsSet = cetech1.ArraySet(public.ObjId);
-const ChangedObjectMap = cetech1.AutoArrayHashMap(public.TypeVersion, ChangedObjectsSet);
-
-const ChangedObjects = struct {
+// Ring buffered change journal of one type.
+// Entries are sorted by version, head is oldest.
+// Entries that every consumer has read are compacted on gc, without consumers they live until ring is full.
+// Reader behind dropped entries, compacted or lost, must do fullscan.
+const ChangeJournal = struct {
     const Self = @This();
 
+    const Entry = struct {
+        version: public.TypeVersion,
+        obj: public.ObjId,
+    };
+
+    const initial_capacity = 256;
+    const max_capacity = 64 * 1024;
+
     allocator: std.mem.Allocator,
-    map: ChangedObjectMap = .{},
-    max_version: u32 = 0,
     lck: std.Io.Mutex = .init,
 
+    entries: []Entry = &.{},
+    head: usize = 0,
+    len: usize = 0,
+
+    // Reader with since_version <= lost_version missed some entries and must do fullscan.
+    lost_version: public.TypeVersion = 0,
+
+    // Entries <= compacted_version were dropped after every consumer read them.
+    // Reader behind it must do fullscan.
+    compacted_version: public.TypeVersion = 0,
+
+    // Consumer watermarks (consumer read everything before watermark), null is free slot.
+    watermarks: cetech1.ArrayList(?public.TypeVersion) = .empty,
+
     pub fn init(allocator: std.mem.Allocator) Self {
         return .{
             .allocator = allocator,
@@ -67,41 +88,240 @@ const ChangedObjects = struct {
     }
 
     pub fn deinit(self: *Self) void {
-        for (self.map.values()) |*values| {
-            values.deinit(self.allocator);
+        self.allocator.free(self.entries);
+        self.watermarks.deinit(self.allocator);
+    }
+
+    inline fn at(self: *const Self, idx: usize) *Entry {
+        return &self.entries[(self.head + idx) & (self.entries.len - 1)];
+    }
+
+    fn resize(self: *Self, capacity: usize) !void {
+        const new_entries = try self.allocator.alloc(Entry, capacity);
+        for (0..self.len) |idx| {
+            new_entries[idx] = self.at(idx).*;
         }
 
-        self.map.deinit(self.allocator);
+        self.allocator.free(self.entries);
+        self.entries = new_entries;
+        self.head = 0;
     }
 
-    pub fn addChangedObjects(self: *Self, io: std.Io, version: public.TypeVersion, objects: []const public.ObjId) !void {
+    fn popOldest(self: *Self, lost: bool) void {
+        const version = self.at(0).version;
+        if (lost) {
+            self.lost_version = @max(self.lost_version, version);
+        } else {
+            self.compacted_version = @max(self.compacted_version, version);
+        }
+
+        self.head = (self.head + 1) & (self.entries.len - 1);
+        self.len -= 1;
+    }
+
+    // Entry is lost if some consumer has not read it yet.
+    // Without consumers nobody keep track so overwritten entry is lost for plain readers.
+    fn isUnread(self: *const Self, version: public.TypeVersion) bool {
+        var has_consumer = false;
+        for (self.watermarks.items) |watermark| {
+            const w = watermark orelse continue;
+            if (w <= version) return true;
+            has_consumer = true;
+        }
+        return !has_consumer;
+    }
+
+    /// Never fail so change can not be silently lost.
+    /// If journal can not grow oldest entries are dropped as when ring is full.
+    pub fn addChangedObjects(self: *Self, io: std.Io, version: public.TypeVersion, objects: []const public.ObjId) void {
         self.lck.lockUncancelable(io);
         defer self.lck.unlock(io);
 
-        const result = try self.map.getOrPut(self.allocator, version);
-        if (!result.found_existing) {
-            result.value_ptr.* = .empty;
+        for (objects) |obj| {
+            if (self.len == self.entries.len) {
+                var grown = false;
+                if (self.entries.len < max_capacity) {
+                    if (self.resize(@max(initial_capacity, self.entries.len * 2))) {
+                        grown = true;
+                    } else |err| {
+                        log.warn("Could not grow change journal: {}", .{err});
+                    }
+                }
+
+                if (!grown) {
+                    // Nothing to drop so this change is lost, readers from this version must do fullscan.
+                    if (self.len == 0) {
+                        self.lost_version = @max(self.lost_version, version);
+                        return;
+                    }
+
+                    // Slowest consumer fall off the ring.
+                    self.popOldest(self.isUnread(self.at(0).version));
+                }
+            }
+
+            // Writers can race on type version, keep journal sorted.
+            const entry_version = if (self.len != 0) @max(version, self.at(self.len - 1).version) else version;
+            self.at(self.len).* = .{ .version = entry_version, .obj = obj };
+            self.len += 1;
         }
+    }
 
-        for (objects) |obj| {
-            _ = try result.value_ptr.add(self.allocator, obj);
+    pub fn addConsumer(self: *Self, io: std.Io, version: public.TypeVersion) !u32 {
+        self.lck.lockUncancelable(io);
+        defer self.lck.unlock(io);
+
+        for (self.watermarks.items, 0..) |*watermark, idx| {
+            if (watermark.* != null) continue;
+            watermark.* = version;
+            return @truncate(idx);
         }
 
-        self.max_version = @max(self.max_version, version);
+        try self.watermarks.append(self.allocator, version);
+        return @truncate(self.watermarks.items.len - 1);
     }
 
-    pub fn getSince(self: *Self, io: std.Io, allocator: std.mem.Allocator, since_version: public.TypeVersion, last_version: public.TypeVersion) ![]public.ObjId {
+    pub fn removeConsumer(self: *Self, io: std.Io, consumer: u32) void {
         self.lck.lockUncancelable(io);
         defer self.lck.unlock(io);
 
-        var output = public.ObjIdList.empty;
+        self.watermarks.items[consumer] = null;
+    }
+
+    /// Drop entries that every consumer has read.
+    pub fn compact(self: *Self, io: std.Io) !void {
+        self.lck.lockUncancelable(io);
+        defer self.lck.unlock(io);
 
-        for (since_version..last_version) |version| {
-            const objects = self.map.get(@intCast(version)) orelse continue;
-            try output.appendSlice(allocator, objects.unmanaged.keys());
+        var min_watermark: ?public.TypeVersion = null;
+        for (self.watermarks.items) |watermark| {
+            const w = watermark orelse continue;
+            min_watermark = if (min_watermark) |m| @min(m, w) else w;
         }
 
-        return output.toOwnedSlice(allocator);
+        const watermark = min_watermark orelse return;
+
+        while (self.len != 0 and self.at(0).version < watermark) {
+            self.popOldest(false);
+        }
+
+        // Give back memory after burst of changes.
+        if (self.entries.len > initial_capacity and self.len <= self.entries.len / 4) {
+            try self.resize(self.entries.len / 2);
+        }
+    }
+
+    /// Objects changed in [since_version, last_version) or null if some of them are no longer in journal.
+    /// If consumer is set its watermark is moved to since_version.
+    pub fn getSince(self: *Self, io: std.Io, allocator: std.mem.Allocator, consumer: ?u32, since_version: public.TypeVersion, last_version: public.TypeVersion) !?[]public.ObjId {
+        self.lck.lockUncancelable(io);
+        defer self.lck.unlock(io);
+
+        if (consumer) |c| self.watermarks.items[c] = since_version;
+
+        if (since_version <= self.lost_version) return null;
+
+        // Reader behind compaction missed compacted entries.
+        if (since_version <= self.compacted_version) return null;
+
+        // Lower bound for since_version.
+        var begin: usize = 0;
+        var end: usize = self.len;
+        while (begin < end) {
+            const mid = begin + (end - begin) / 2;
+            if (self.at(mid).version < since_version) begin = mid + 1 else end = mid;
+        }
+
+        var output = public.ObjIdList.empty;
+        for (begin..self.len) |idx| {
+            const entry = self.at(idx);
+            if (entry.version >= last_version) break;
+            try output.append(allocator, entry.obj);
+        }
+
+        return try output.toOwnedSlice(allocator);
+    }
+};
+
+// Writers committed together.
+const TransactionWriterMap = cetech1.AutoArrayHashMap(public.ObjId, *Object);
+pub const Transaction = struct {
+    db: *Db,
+    writers: TransactionWriterMap = .{},
+
+    // Scratch for commit, reused with transaction.
+    ids: public.ObjIdList = .empty,
+
+    // Next free transaction in thread pool.
+    next: ?*Transaction = null,
+};
+
+// Per thread free list of transactions so begin/commit does not allocate after warmup.
+// Generation guard list that survive deinit/init on same thread.
+threadlocal var _tx_free_list: ?*Transaction = null;
+threadlocal var _tx_free_list_generation: u32 = 0;
+var _tx_generation: u32 = 0;
+var _tx_all: cetech1.ArrayList(*Transaction) = .empty;
+var _tx_all_lock: std.Io.Mutex = .init;
+
+fn acquireTransaction(db: *Db) !*Transaction {
+    if (_tx_free_list_generation != _tx_generation) {
+        _tx_free_list = null;
+        _tx_free_list_generation = _tx_generation;
+    }
+
+    if (_tx_free_list) |tx| {
+        _tx_free_list = tx.next;
+        tx.db = db;
+        tx.next = null;
+        return tx;
+    }
+
+    const tx = try _allocator.create(Transaction);
+    errdefer _allocator.destroy(tx);
+    tx.* = .{ .db = db };
+
+    _tx_all_lock.lockUncancelable(_io);
+    defer _tx_all_lock.unlock(_io);
+    try _tx_all.append(_allocator, tx);
+
+    return tx;
+}
+
+fn releaseTransaction(tx: *Transaction) void {
+    tx.writers.clearRetainingCapacity();
+    tx.ids.clearRetainingCapacity();
+
+    if (_tx_free_list_generation != _tx_generation) {
+        _tx_free_list = null;
+        _tx_free_list_generation = _tx_generation;
+    }
+
+    tx.next = _tx_free_list;
+    _tx_free_list = tx;
+}
+
+fn deinitTransactionPool() void {
+    for (_tx_all.items) |tx| {
+        tx.writers.deinit(_allocator);
+        tx.ids.deinit(_allocator);
+        _allocator.destroy(tx);
+    }
+    _tx_all.deinit(_allocator);
+    _tx_all = .empty;
+    _tx_generation +%= 1;
+}
+
+const TypeGcRange = struct {
+    const Ctx = struct {
+        io: std.Io,
+        storages: []const *TypeStorage,
+    };
+
+    pub fn exec(ctx: Ctx, range: task.Range) !void {
+        for (ctx.storages[range.begin..range.end]) |storage| {
+            try storage.gcRelease(ctx.io);
+        }
     }
 };
 
@@ -130,7 +350,26 @@ const PropertyValue = usize;
 //     };
 // }
 
-//TODO: Optimize memory footprint
+const ObjectPool = cetech1.heap.ChunkedPool(Object);
+
+// Resolved prototype source object for every property.
+// Sources are stored right after header in ProtoReadCachePool.
+const ProtoReadCache = struct {
+    owner: public.ObjId,
+};
+const ProtoReadCachePool = cetech1.heap.ChunkedPool(ProtoReadCache);
+
+// Source is stored as objid tagged with object version in one word so entry can not be torn
+// and entry resolved for older version is never used. Prototype chain is always same type so
+// type and db are taken from instance.
+const ProtoReadEntry = packed struct(u64) {
+    version: u32 = 0,
+    id: u24 = 0,
+    gen: public.ObjIdGen = 0,
+};
+const ProtoReadSource = std.atomic.Value(ProtoReadEntry);
+
+// Object header and property values are one block in ObjectPool: [pool header][Object][props]
 pub const Object = struct {
     const Self = @This();
 
@@ -138,9 +377,6 @@ pub const Object = struct {
     // ObjId can have multiple object because write clone entire object.
     objid: public.ObjId = .{},
 
-    // Property memory.
-    props_mem: []PropertyValue = undefined,
-
     // Parent id and prop idx.
     parent: public.ObjId = .{},
     parent_prop_idx: u32 = 0,
@@ -153,8 +389,11 @@ pub const Object = struct {
 
     version: AtomicInt64,
 
+    // Lazy created if type has prototype read cache enabled.
+    proto_cache: std.atomic.Value(?*ProtoReadCache) = .init(null),
+
     pub fn getPropPtr(self: *Self, comptime T: type, prop_idx: usize) *T {
-        const ptr = &self.props_mem[prop_idx];
+        const ptr: *PropertyValue = @ptrFromInt(@intFromPtr(self) + ObjectPool.tail_offset + prop_idx * @sizeOf(PropertyValue));
         std.debug.assert(std.mem.isAligned(@intFromPtr(ptr), @alignOf(T)));
         return @ptrCast(@alignCast(ptr));
     }
@@ -214,9 +453,12 @@ pub const ObjIdSet = struct {
 pub const TypeStorage = struct {
     const Self = @This();
 
-    // TODO: For now allocate minimal object count, need better usage of vram on windows.
-    const MAX_OBJECTS = 100_000; // TODO: From max ID
-    const MAX_OBJIDSETS = 100_000;
+    // objid2refs and prototype2instances are guarded by lock stripes selected by object id.
+    // Per object lock cost memory for every object and real contention is low.
+    const INDEX_LOCK_STRIPES = 64;
+    const IndexLock = struct {
+        mutex: std.Io.Mutex align(std.atomic.cache_line) = .init,
+    };
 
     allocator: std.mem.Allocator,
     db: *Db,
@@ -230,25 +472,26 @@ pub const TypeStorage = struct {
     //props_size: usize,
 
     version: public.TypeVersion = 1,
-    changed_objs: ChangedObjects,
+    changed_objs: ChangeJournal,
 
     default_obj: public.ObjId = .{},
 
-    // Per ObjectId data
+    // Per ObjectId data, grow in chunks as ids are allocated.
     objid_pool: cetech1.heap.IdPool(u32),
-    objid2obj: cetech1.heap.VirtualArray(?*Object),
-    objid_ref_count: cetech1.heap.VirtualArray(AtomicInt32),
-    //objid_version: cetech1.heap.VirtualArray(AtomicInt64),
-    objid_gen: cetech1.heap.VirtualArray(public.ObjIdGen),
-    objid2refs: cetech1.heap.VirtualArray(ReferencerIdSet),
-    objid2refs_lock: cetech1.heap.VirtualArray(std.Io.Mutex), //TODO: without lock?
-    prototype2instances: cetech1.heap.VirtualArray(PrototypeInstanceSet),
-    prototype2instances_lock: cetech1.heap.VirtualArray(std.Io.Mutex), //TODO: without lock?
-
-    // Per Object data
-    object_pool: cetech1.heap.VirtualPool(Object),
-    // Memory fro object property memory (properties memory)
-    objs_mem: cetech1.heap.VirtualArray(PropertyValue), // NOTE: move memory after object? . [[Object1][padding][props_mem1]]...[[ObjectN][props_memN]]
+    objid2obj: cetech1.heap.ChunkedArray(?*Object),
+    objid_ref_count: cetech1.heap.ChunkedArray(AtomicInt32),
+    //objid_version: cetech1.heap.ChunkedArray(AtomicInt64),
+    objid_gen: cetech1.heap.ChunkedArray(public.ObjIdGen),
+    objid2refs: cetech1.heap.ChunkedArray(ReferencerIdSet),
+    objid2refs_locks: [INDEX_LOCK_STRIPES]IndexLock = @splat(.{}),
+    prototype2instances: cetech1.heap.ChunkedArray(PrototypeInstanceSet),
+    prototype2instances_locks: [INDEX_LOCK_STRIPES]IndexLock = @splat(.{}),
+
+    // Per Object data, props_def.len property values are stored right after object.
+    object_pool: ObjectPool,
+
+    // Optional cache for reads through prototypes chain.
+    proto_cache_pool: std.atomic.Value(?*ProtoReadCachePool) = .init(null),
 
     // Queue for objects to delete in GC phase
     to_free_queue: ToFreeIdQueue,
@@ -277,6 +520,15 @@ pub const TypeStorage = struct {
     read_counter: *f64 = undefined,
     write_commit_counter: *f64 = undefined,
     writers_counter: *f64 = undefined,
+    committed_counter: *f64 = undefined,
+    gc_time_counter: *f64 = undefined,
+
+    // Duration of last gc.
+    gc_ns: i96 = 0,
+
+    // GC scratch. gcCollect fill it for all types serially and gcRelease consume it per type in parallel.
+    gc_destroyed_ids: public.ObjIdList = .empty,
+    gc_release_objs: cetech1.ArrayList(*Object) = .empty,
 
     pub fn init(allocator: std.mem.Allocator, db: *Db, type_idx: public.TypeIdx, name: []const u8, props_def: []const public.PropDef) !Self {
         var contain_set = false;
@@ -304,25 +556,22 @@ pub const TypeStorage = struct {
             .allocator = allocator,
             .contain_set = contain_set,
             .contain_subobject = contain_subobject,
-            .changed_objs = ChangedObjects.init(allocator),
-            .object_pool = try cetech1.heap.VirtualPool(Object).init(allocator, MAX_OBJECTS),
+            .changed_objs = ChangeJournal.init(allocator),
+            .object_pool = try ObjectPool.initWithTail(allocator, props_def.len),
 
             .objid_pool = cetech1.heap.IdPool(u32).init(allocator),
-            .objid2obj = try cetech1.heap.VirtualArray(?*Object).init(MAX_OBJECTS),
-            .objid_gen = try cetech1.heap.VirtualArray(public.ObjIdGen).init(MAX_OBJECTS),
-            .objid_ref_count = try cetech1.heap.VirtualArray(AtomicInt32).init(MAX_OBJECTS),
-            //.objid_version = try cetech1.heap.VirtualArray(AtomicInt64).init(MAX_OBJECTS),
-            .objid2refs = try cetech1.heap.VirtualArray(ReferencerIdSet).init(MAX_OBJECTS),
-            .objid2refs_lock = try cetech1.heap.VirtualArray(std.Io.Mutex).init(MAX_OBJECTS),
-            .prototype2instances = try cetech1.heap.VirtualArray(PrototypeInstanceSet).init(MAX_OBJECTS),
-            .prototype2instances_lock = try cetech1.heap.VirtualArray(std.Io.Mutex).init(MAX_OBJECTS),
+            .objid2obj = .init(allocator, 1),
+            .objid_gen = .init(allocator, 1),
+            .objid_ref_count = .init(allocator, 1),
+            //.objid_version = .init(allocator, 1),
+            .objid2refs = .init(allocator, 1),
+            .prototype2instances = .init(allocator, 1),
 
-            .objs_mem = try cetech1.heap.VirtualArray(PropertyValue).init(MAX_OBJECTS * props_def.len),
 
             .to_free_queue = ToFreeIdQueue.init(),
             .to_free_obj_node_pool = ToFreeIdQueueNodePool.init(allocator),
 
-            .idset_pool = if (contain_set) try IdSetPool.init(allocator, MAX_OBJIDSETS) else undefined,
+            .idset_pool = if (contain_set) try IdSetPool.init(allocator) else undefined,
 
             .aspect_map = .{},
             .strid2aspectname = .{},
@@ -339,6 +588,8 @@ pub const TypeStorage = struct {
         ts.read_counter = try metrics.getCounter(try std.fmt.bufPrint(&buf, "cdb/{s}/{s}/readers", .{ db.name, name }));
         ts.write_commit_counter = try metrics.getCounter(try std.fmt.bufPrint(&buf, "cdb/{s}/{s}/commits", .{ db.name, name }));
         ts.writers_counter = try metrics.getCounter(try std.fmt.bufPrint(&buf, "cdb/{s}/{s}/writers", .{ db.name, name }));
+        ts.committed_counter = try metrics.getCounter(try std.fmt.bufPrint(&buf, "cdb/{s}/{s}/committed_bytes", .{ db.name, name }));
+        ts.gc_time_counter = try metrics.getCounter(try std.fmt.bufPrint(&buf, "cdb/{s}/{s}/gc_ms", .{ db.name, name }));
 
         return ts;
     }
@@ -346,49 +597,60 @@ pub const TypeStorage = struct {
     pub fn deinit(self: *Self) void {
         if (self.contain_set) {
             // idx 0 is null element
-            for (self.idset_pool.allocatedItems()) |*obj| {
-                obj.data.deinit(self.allocator);
+            for (1..self.idset_pool.allocatedCount()) |idx| {
+                self.idset_pool.get(idx).deinit(self.allocator);
             }
+            self.idset_pool.deinit();
         }
 
         // idx 0 is null element
-        for (self.objid2refs.items[1..self.objid_pool.count.raw]) |*obj| {
-            obj.deinit(self.allocator);
-        }
-
-        // idx 0 is null element
-        for (self.prototype2instances.items[1..self.objid_pool.count.raw]) |*obj| {
-            obj.deinit(self.allocator);
+        for (1..self.objid_pool.count.raw) |idx| {
+            self.objid2refs.get(idx).deinit(self.allocator);
+            self.prototype2instances.get(idx).deinit(self.allocator);
         }
 
         self.object_pool.deinit();
+        if (self.proto_cache_pool.load(.monotonic)) |pool| {
+            pool.deinit();
+            self.allocator.destroy(pool);
+        }
         self.objid_pool.deinit();
         self.to_free_obj_node_pool.deinit();
-        self.idset_pool.deinit();
         self.objid2obj.deinit();
-        self.objs_mem.deinit();
+        self.objid_ref_count.deinit();
         self.aspect_map.deinit(self.allocator);
         self.strid2aspectname.deinit(self.allocator);
         self.property_aspect_map.deinit(self.allocator);
 
         self.objid2refs.deinit();
-        self.objid2refs_lock.deinit();
         self.objid_gen.deinit();
         self.prototype2instances.deinit();
-        self.prototype2instances_lock.deinit();
         self.changed_objs.deinit();
 
+        self.gc_destroyed_ids.deinit(self.allocator);
+        self.gc_release_objs.deinit(self.allocator);
+
         _allocator.free(self.props_def);
     }
 
-    fn notifyAlloc(self: *Self) !void {
-        try self.objid2obj.notifyAlloc(1);
-        try self.objid_ref_count.notifyAlloc(1);
-        //try self.objid_version.notifyAlloc(1);
-        try self.objid2refs.notifyAlloc(1);
-        try self.objid2refs_lock.notifyAlloc(1);
-        try self.prototype2instances.notifyAlloc(1);
-        try self.prototype2instances_lock.notifyAlloc(1);
+    fn ensureObjId(self: *Self, id: u32) !void {
+        try self.objid2obj.ensure(id);
+        try self.objid_gen.ensure(id);
+        try self.objid_ref_count.ensure(id);
+        //try self.objid_version.ensure(id);
+        try self.objid2refs.ensure(id);
+        try self.prototype2instances.ensure(id);
+    }
+
+    pub fn committedBytes(self: *Self) usize {
+        return self.objid2obj.committed() +
+            self.objid_gen.committed() +
+            self.objid_ref_count.committed() +
+            self.objid2refs.committed() +
+            self.prototype2instances.committed() +
+            self.object_pool.committed() +
+            (if (self.proto_cache_pool.load(.monotonic)) |pool| pool.committed() else 0) +
+            (if (self.contain_set) self.idset_pool.committed() else 0);
     }
 
     pub fn isTypeHashValidForProperty(self: *Self, prop_idx: u32, type_idx: public.TypeIdx) bool {
@@ -404,24 +666,22 @@ pub const TypeStorage = struct {
         const id = self.objid_pool.create(io, &is_new);
 
         if (is_new) {
-            try self.notifyAlloc();
-            self.objid_gen.items[id] = 1;
+            try self.ensureObjId(id);
+            self.objid_gen.get(id).* = 1;
         }
 
-        const gen = self.objid_gen.items[id];
+        const gen = self.objid_gen.get(id).*;
 
-        self.objid_ref_count.items[id] = AtomicInt32.init(1);
+        self.objid_ref_count.get(id).* = AtomicInt32.init(1);
         //self.objid_version.items[id] = AtomicInt64.init(1);
 
         if (is_new) {
-            self.objid2refs.items[id] = .{};
-            self.prototype2instances.items[id] = .empty;
+            self.objid2refs.get(id).* = .{};
+            self.prototype2instances.get(id).* = .empty;
         } else {
-            self.objid2refs.items[id].clearRetainingCapacity();
-            self.prototype2instances.items[id].clearRetainingCapacity();
+            self.objid2refs.get(id).clearRetainingCapacity();
+            self.prototype2instances.get(id).clearRetainingCapacity();
         }
-        self.objid2refs_lock.items[id] = std.Io.Mutex.init;
-        self.prototype2instances_lock.items[id] = std.Io.Mutex.init;
 
         return .{
             .id = @as(u24, @truncate(id)),
@@ -434,16 +694,26 @@ pub const TypeStorage = struct {
     pub fn increaseVersion(self: *Self, io: std.Io, obj: public.ObjId) void {
         var obj_ptr = self.db.getObjectPtr(obj).?;
         _ = obj_ptr.version.fetchAdd(1, .monotonic);
-        self.changed_objs.addChangedObjects(io, self.version, &.{obj}) catch undefined;
+        self.changed_objs.addChangedObjects(io, self.version, &.{obj});
+        self.version += 1;
+    }
+
+    // One type version and one journal entry batch for all objects.
+    pub fn increaseVersionMany(self: *Self, io: std.Io, objs: []const public.ObjId) void {
+        for (objs) |obj| {
+            var obj_ptr = self.db.getObjectPtr(obj).?;
+            _ = obj_ptr.version.fetchAdd(1, .monotonic);
+        }
+        self.changed_objs.addChangedObjects(io, self.version, objs);
         self.version += 1;
     }
 
     pub fn increaseReference(self: *Self, obj: public.ObjId) void {
-        _ = self.objid_ref_count.items[obj.id].fetchAdd(1, .monotonic);
+        _ = self.objid_ref_count.get(obj.id).fetchAdd(1, .monotonic);
     }
 
     pub fn decreaseReferenceToFree(self: *Self, io: std.Io, object: *Object) !void {
-        var ref_count = &self.objid_ref_count.items[object.objid.id];
+        var ref_count = self.objid_ref_count.get(object.objid.id);
 
         if (ref_count.raw == 0) return; // TODO: need this?
         //std.debug.assert(ref_count.value != 0);
@@ -452,12 +722,12 @@ pub const TypeStorage = struct {
             _ = ref_count.load(.acquire);
 
             try self.addToFreeQueue(io, object);
-            self.objid_gen.items[object.objid.id] = @addWithOverflow(self.objid_gen.items[object.objid.id], 1)[0];
+            self.objid_gen.get(object.objid.id).* = @addWithOverflow(self.objid_gen.get(object.objid.id).*, 1)[0];
         }
     }
 
     fn decreaseReferenceFree(self: *Self, io: std.Io, object: *Object, destroyed_objid: *public.ObjIdList, allocator: std.mem.Allocator) anyerror!u32 {
-        var ref_count = &self.objid_ref_count.items[object.objid.id];
+        var ref_count = self.objid_ref_count.get(object.objid.id);
 
         if (ref_count.raw == 0) return 0; // TODO: need this?
         //std.debug.assert(ref_count.value != 0);
@@ -492,25 +762,16 @@ pub const TypeStorage = struct {
         //        var zone_ctx = profiler.ztracy.Zone(@src());
         //        defer zone_ctx.End();
 
-        var new = false;
-        var obj = self.object_pool.create(&new);
-
-        if (self.props_def.len != 0 and new) {
-            try self.objs_mem.notifyAlloc(self.props_def.len);
-        }
-
-        const begin_idx = self.props_def.len * self.object_pool.index(obj);
-        const obj_mem: []PropertyValue = self.objs_mem.items[begin_idx .. begin_idx + self.props_def.len];
+        var obj = try self.object_pool.create(null);
 
         obj.* = Object{
             .objid = id orelse .{},
-            .props_mem = obj_mem,
             .parent_prop_idx = 0,
-            .overrides_set = if (new) OverridesSet.initEmpty() else obj.*.overrides_set,
+            .overrides_set = OverridesSet.initEmpty(),
             .version = AtomicInt64.init(1),
         };
 
-        @memset(obj.props_mem, 0);
+        @memset(self.object_pool.tail(obj), 0);
 
         // init sets
         if (init_props) {
@@ -545,7 +806,7 @@ pub const TypeStorage = struct {
 
     pub fn allocateObjIdSet(self: *Self) !*ObjIdSet {
         var is_new = false;
-        const array = self.idset_pool.create(&is_new);
+        const array = try self.idset_pool.create(&is_new);
 
         if (is_new) array.* = .{};
 
@@ -589,7 +850,7 @@ pub const TypeStorage = struct {
         const id = try self.allocateObjId(io);
         var obj = try self.allocateObject(id, true);
 
-        self.objid2obj.items[id.id] = obj;
+        self.objid2obj.get(id.id).* = obj;
         obj.parent = .{};
 
         // try self.changed_objs.addChangedObjects(self.version, &.{id});
@@ -634,7 +895,7 @@ pub const TypeStorage = struct {
         //        var zone_ctx = profiler.ztracy.Zone(@src());
         //        defer zone_ctx.End();
 
-        const true_obj = self.objid2obj.items[obj.id];
+        const true_obj = self.objid2obj.get(obj.id).*;
         if (true_obj == null) return;
         try self.decreaseReferenceToFree(io, true_obj.?);
     }
@@ -644,23 +905,19 @@ pub const TypeStorage = struct {
         //        defer zone_ctx.End();
 
         const obj_id = if (!create_new) obj.objid else try self.allocateObjId(io);
-        var new_obj = try self.allocateObject(obj_id, false);
+        var new_obj = try self.object_pool.create(null);
 
-        if (!create_new) {
-            new_obj.prototype = obj.prototype;
-            new_obj.parent = obj.parent;
-            new_obj.parent_prop_idx = obj.parent_prop_idx;
-            new_obj.version = obj.version;
-        }
+        // Header and properties are one block so copy is one memcpy.
+        @memcpy(self.object_pool.itemBytes(new_obj), self.object_pool.itemBytes(obj));
+        new_obj.proto_cache = .init(null);
 
-        new_obj.overrides_set = obj.overrides_set;
-
-        // var it = obj.overrides_set.iterator(.{});
-        // while (it.next()) |value| {
-        //     new_obj.overrides_set.setValue(value, obj.overrides_set.isSet(value));
-        // }
-
-        @memcpy(new_obj.props_mem, obj.props_mem);
+        if (create_new) {
+            new_obj.objid = obj_id;
+            new_obj.prototype = .{};
+            new_obj.parent = .{};
+            new_obj.parent_prop_idx = 0;
+            new_obj.version = AtomicInt64.init(1);
+        }
 
         // Patch old nonsimple value to new location
         for (self.props_def, 0..) |prop_def, idx| {
@@ -752,7 +1009,7 @@ pub const TypeStorage = struct {
         }
 
         if (create_new) {
-            self.objid2obj.items[new_obj.objid.id] = new_obj;
+            self.objid2obj.get(new_obj.objid.id).* = new_obj;
         }
 
         return new_obj;
@@ -762,7 +1019,7 @@ pub const TypeStorage = struct {
         //        var zone_ctx = profiler.ztracy.Zone(@src());
         //        defer zone_ctx.End();
 
-        const is_writer = self.objid2obj.items[obj.objid.id] != obj;
+        const is_writer = self.objid2obj.get(obj.objid.id).* != obj;
 
         var free_objects: u32 = 1;
         for (self.props_def, 0..) |prop_def, idx| {
@@ -773,12 +1030,6 @@ pub const TypeStorage = struct {
                 //         self.allocator.free(true_ptr.*);
                 //     }
                 // },
-                .BLOB => {
-                    const true_ptr = obj.getPropPtr(?*Blob, idx);
-                    if (true_ptr.*) |blob| {
-                        self.destroyBlob(blob);
-                    }
-                },
                 .SUBOBJECT => {
                     const subobj = obj.getPropPtr(public.ObjId, idx);
                     const subobj_ptr = self.db.getObjectPtr(subobj.*) orelse continue;
@@ -802,7 +1053,6 @@ pub const TypeStorage = struct {
                             //free_objects += try storage.decreaseReferenceFree(subobj_ptr, destroyed_objid, tmp_allocator);
                         }
                     }
-                    try self.destroyObjIdSet(true_ptr.*);
                 },
                 .REFERENCE => {
                     const ref = obj.getPropPtr(public.ObjId, idx);
@@ -825,7 +1075,6 @@ pub const TypeStorage = struct {
                         }
                         //free_objects += try storage.decreaseReferenceFree(ref_ptr, destroyed_objid, tmp_allocator);
                     }
-                    try self.destroyObjIdSet(true_ptr.*);
                 },
 
                 else => continue,
@@ -834,7 +1083,7 @@ pub const TypeStorage = struct {
 
         // Destroy objid
         if (!is_writer) {
-            var ref_set_clone = try self.objid2refs.items[obj.objid.id].clone(allocator);
+            var ref_set_clone = try self.cloneObjIdReferencers(io, allocator, obj.objid);
             defer ref_set_clone.deinit(allocator);
 
             const referencers = ref_set_clone.keys();
@@ -855,7 +1104,7 @@ pub const TypeStorage = struct {
             if (!obj.parent.isEmpty()) {
                 const parent_obj = self.db.getObjectPtr(obj.parent);
                 var storage = self.db.getTypeStorage(obj.parent).?;
-                const ref_count = &storage.objid_ref_count.items[obj.parent.id];
+                const ref_count = storage.objid_ref_count.get(obj.parent.id);
                 if (ref_count.raw != 0) {
                     switch (storage.props_def[obj.parent_prop_idx].type) {
                         public.PropType.SUBOBJECT => try self.db.clearSubObj(io, @ptrCast(parent_obj.?), obj.parent_prop_idx),
@@ -870,20 +1119,51 @@ pub const TypeStorage = struct {
                 self.removePrototypeInstance(io, obj.prototype, obj.objid);
             }
 
-            //self.objid_gen.items[obj.objid.id] = @addWithOverflow(self.objid_gen.items[obj.objid.id], 1)[0];
+            //self.objid_gen.get(obj.objid.id).* = @addWithOverflow(self.objid_gen.get(obj.objid.id).*, 1)[0];
+
+            // Instances can have cached this object as read source, invalidate before id is reused.
+            self.increaseInstancesVersion(io, obj.objid);
 
             try self.freeObjId(io, obj.objid);
-            self.objid2obj.items[obj.objid.id] = null;
+            self.objid2obj.get(obj.objid.id).* = null;
             try destroyed_objid.append(allocator, obj.objid);
         }
 
-        obj.overrides_set.setRangeValue(std.bit_set.Range{ .start = 0, .end = self.props_def.len }, false);
-        self.object_pool.destroy(obj);
+        // Memory is released in gcRelease.
+        try self.gc_release_objs.append(self.allocator, obj);
 
         return free_objects;
     }
 
-    pub fn gc(self: *Self, io: std.Io, allocator: std.mem.Allocator) !u32 {
+    // Free memory owned by object. Touch only this type.
+    fn releaseObject(self: *Self, obj: *Object) !void {
+        for (self.props_def, 0..) |prop_def, idx| {
+            switch (prop_def.type) {
+                .BLOB => {
+                    const true_ptr = obj.getPropPtr(?*Blob, idx);
+                    if (true_ptr.*) |blob| {
+                        self.destroyBlob(blob);
+                    }
+                },
+                .SUBOBJECT_SET, .REFERENCE_SET => {
+                    const true_ptr = obj.getPropPtr(*ObjIdSet, idx);
+                    try self.destroyObjIdSet(true_ptr.*);
+                },
+                else => continue,
+            }
+        }
+
+        if (obj.proto_cache.load(.monotonic)) |cache| {
+            self.proto_cache_pool.load(.monotonic).?.destroy(cache);
+        }
+
+        obj.overrides_set.setRangeValue(std.bit_set.Range{ .start = 0, .end = self.props_def.len }, false);
+        self.object_pool.destroy(obj);
+    }
+
+    /// Free queued objects and fix ref counts, referencers and parents in other types.
+    /// Write into other types so must run serially for all types.
+    pub fn gcCollect(self: *Self, io: std.Io) !u32 {
         var zone_ctx = profiler.ztracy.Zone(@src());
         defer zone_ctx.End();
 
@@ -891,40 +1171,43 @@ pub const TypeStorage = struct {
             zone_ctx.Name(&self.gc_name);
         }
 
-        var destroyed_ids = public.ObjIdList.empty;
-        defer destroyed_ids.deinit(allocator);
-
-        var changed_ids = public.ObjIdList.empty;
-        defer changed_ids.deinit(allocator);
+        const start = std.Io.Timestamp.now(io, .awake);
+        defer self.gc_ns += start.durationTo(.now(io, .awake)).toNanoseconds();
 
         var free_objects: u32 = 0;
         while (self.to_free_queue.pop(io)) |node| {
-            try changed_ids.append(allocator, node.data.objid);
-
-            free_objects += try self.freeObject(io, node.data, &destroyed_ids, allocator);
+            free_objects += try self.freeObject(io, node.data, &self.gc_destroyed_ids, self.allocator);
             self.to_free_obj_node_pool.destroy(io, node);
         }
 
-        try self.changed_objs.addChangedObjects(io, self.version, destroyed_ids.items);
+        return free_objects;
+    }
 
-        // Remove UUID
-        {
-            self.db.uuid2objid_lock.lockUncancelable(_io);
-            defer self.db.uuid2objid_lock.unlock(_io);
-            for (destroyed_ids.items) |obj| {
-                const obj_uuid = self.db.objid2uuid.get(obj) orelse continue;
-                _ = self.db.uuid2objid.swapRemove(obj_uuid);
-                _ = self.db.objid2uuid.swapRemove(obj);
-            }
+    /// Release memory of collected objects and compact change journal.
+    /// Touch only this type so can run in parallel with release of other types.
+    pub fn gcRelease(self: *Self, io: std.Io) !void {
+        var zone_ctx = profiler.ztracy.Zone(@src());
+        defer zone_ctx.End();
+
+        if (profiler.profiler_enabled) {
+            zone_ctx.Name(&self.gc_name);
         }
 
-        self.db.callOnObjIdDestroyed(destroyed_ids.items);
+        const start = std.Io.Timestamp.now(io, .awake);
+        defer self.gc_ns += start.durationTo(.now(io, .awake)).toNanoseconds();
 
-        if (destroyed_ids.items.len != 0) {
-            self.version += 1;
+        for (self.gc_release_objs.items) |obj| {
+            try self.releaseObject(obj);
         }
+        self.gc_release_objs.clearRetainingCapacity();
 
-        return free_objects;
+        const destroyed = self.gc_destroyed_ids.items;
+        self.changed_objs.addChangedObjects(io, self.version, destroyed);
+        try self.changed_objs.compact(io);
+
+        if (destroyed.len != 0) {
+            self.version += 1;
+        }
     }
 
     pub fn readGeneric(self: *Self, obj: *public.Obj, prop_idx: u32, prop_type: public.PropType) []const u8 {
@@ -940,10 +1223,7 @@ pub const TypeStorage = struct {
 
         // If exist prototype and prop is not override read from prototype.
         if (!true_obj.prototype.isEmpty() and !true_obj.overrides_set.isSet(prop_idx)) {
-            const prototype_obj = self.db.getObjectPtr(true_obj.prototype);
-            if (prototype_obj) |proto_obj| {
-                return readGeneric(self, @ptrCast(proto_obj), prop_idx, prop_type);
-            }
+            true_obj = self.getPrototypeSource(true_obj, prop_idx);
         }
 
         const true_ptr = true_obj.getPropPtr(u8, prop_idx);
@@ -951,6 +1231,69 @@ pub const TypeStorage = struct {
         return ptr[0..@sizeOf(PropertyValue)];
     }
 
+    // Object in prototype chain that hold value of property.
+    fn resolvePrototypeSource(self: *Self, obj: *Object, prop_idx: u32) *Object {
+        var source = obj;
+        while (!source.prototype.isEmpty() and !source.overrides_set.isSet(prop_idx)) {
+            source = self.db.getObjectPtr(source.prototype) orelse break;
+        }
+        return source;
+    }
+
+    fn getPrototypeSource(self: *Self, obj: *Object, prop_idx: u32) *Object {
+        // Deferred propagation does not increase instance versions so cache can not be validated.
+        const pool = self.proto_cache_pool.load(.acquire) orelse return self.resolvePrototypeSource(obj, prop_idx);
+        if (self.db.defer_version_propagation) return self.resolvePrototypeSource(obj, prop_idx);
+
+        // Version is read before resolve so entry from racing resolve is tagged with older version.
+        const obj_version: u32 = @truncate(obj.version.load(.acquire));
+
+        const cache = obj.proto_cache.load(.acquire) orelse blk: {
+            const new_cache = pool.create(null) catch return self.resolvePrototypeSource(obj, prop_idx);
+            new_cache.owner = obj.objid;
+            @memset(pool.tail(new_cache), 0);
+
+            if (obj.proto_cache.cmpxchgStrong(null, new_cache, .acq_rel, .acquire)) |winner| {
+                pool.destroy(new_cache);
+                break :blk winner.?;
+            }
+            break :blk new_cache;
+        };
+
+        const sources: []ProtoReadSource = @ptrCast(pool.tail(cache));
+
+        // Version bump from increaseVersionToAll or prototype destroy invalidate all sources.
+        const entry = sources[prop_idx].load(.acquire);
+        if (entry.id != 0 and entry.version == obj_version) {
+            const source_objid = public.ObjId{ .id = entry.id, .gen = entry.gen, .type_idx = obj.objid.type_idx, .db = obj.objid.db };
+            if (self.db.getObjectPtr(source_objid)) |source| {
+                // Slot can be reused by other object, check identity and recheck version.
+                if (source.objid.id == entry.id and source.objid.gen == entry.gen and
+                    @as(u32, @truncate(obj.version.load(.acquire))) == obj_version)
+                {
+                    return source;
+                }
+            }
+        }
+
+        const source = self.resolvePrototypeSource(obj, prop_idx);
+        sources[prop_idx].store(.{ .version = obj_version, .id = source.objid.id, .gen = source.objid.gen }, .release);
+        return source;
+    }
+
+    pub fn enablePrototypeReadCache(self: *Self) !void {
+        if (self.proto_cache_pool.load(.acquire) != null) return;
+
+        const pool = try self.allocator.create(ProtoReadCachePool);
+        errdefer self.allocator.destroy(pool);
+        pool.* = try ProtoReadCachePool.initWithTail(self.allocator, self.props_def.len);
+
+        if (self.proto_cache_pool.cmpxchgStrong(null, pool, .acq_rel, .acquire) != null) {
+            pool.deinit();
+            self.allocator.destroy(pool);
+        }
+    }
+
     pub fn readTT(self: *Self, comptime T: type, obj: *public.Obj, prop_idx: u32, prop_type: public.PropType) T {
         const value_ptr = self.readGeneric(obj, prop_idx, prop_type);
         const typed_ptr: *const T = @ptrCast(@alignCast(value_ptr.ptr));
@@ -1028,55 +1371,111 @@ pub const TypeStorage = struct {
         return new_subobj;
     }
 
+    fn indexLock(locks: *[INDEX_LOCK_STRIPES]IndexLock, id: u32) *std.Io.Mutex {
+        return &locks[id % INDEX_LOCK_STRIPES].mutex;
+    }
+
     pub fn addPrototypeInstance(self: *Self, io: std.Io, prototype: public.ObjId, instance: public.ObjId) !void {
-        var lock = &self.prototype2instances_lock.items[prototype.id];
+        var lock = indexLock(&self.prototype2instances_locks, prototype.id);
         lock.lockUncancelable(io);
         defer lock.unlock(io);
-        _ = try self.prototype2instances.items[prototype.id].add(self.allocator, instance);
+        _ = try self.prototype2instances.get(prototype.id).add(self.allocator, instance);
     }
 
     pub fn removePrototypeInstance(self: *Self, io: std.Io, prototype: public.ObjId, instance: public.ObjId) void {
-        var lock = &self.prototype2instances_lock.items[prototype.id];
+        var lock = indexLock(&self.prototype2instances_locks, prototype.id);
         lock.lockUncancelable(io);
         defer lock.unlock(io);
-        _ = self.prototype2instances.items[prototype.id].remove(instance);
+        _ = self.prototype2instances.get(prototype.id).remove(instance);
+    }
+
+    pub fn hasPrototypeInstances(self: *Self, io: std.Io, prototype: public.ObjId) bool {
+        var lock = indexLock(&self.prototype2instances_locks, prototype.id);
+        lock.lockUncancelable(io);
+        defer lock.unlock(io);
+        return self.prototype2instances.get(prototype.id).cardinality() != 0;
+    }
+
+    /// Append not yet visited instances of prototype to output.
+    pub fn appendPrototypeInstances(self: *Self, io: std.Io, prototype: public.ObjId, allocator: std.mem.Allocator, visited: *IdSet, output: *public.ObjIdList) !void {
+        var lock = indexLock(&self.prototype2instances_locks, prototype.id);
+        lock.lockUncancelable(io);
+        defer lock.unlock(io);
+
+        for (self.prototype2instances.get(prototype.id).unmanaged.keys()) |instance| {
+            if (!try visited.add(allocator, instance)) continue;
+            try output.append(allocator, instance);
+        }
+    }
+
+    fn increaseInstancesVersion(self: *Self, io: std.Io, prototype: public.ObjId) void {
+        var lock = indexLock(&self.prototype2instances_locks, prototype.id);
+        lock.lockUncancelable(io);
+        defer lock.unlock(io);
+
+        for (self.prototype2instances.get(prototype.id).unmanaged.keys()) |instance| {
+            const instance_obj = self.db.getObjectPtr(instance) orelse continue;
+            _ = instance_obj.version.fetchAdd(1, .release);
+        }
     }
 
     pub fn addObjIdReferencer(self: *Self, io: std.Io, objid: public.ObjId, referencer: public.ObjId, referencer_prop_idx: u32) !void {
-        var lock = &self.objid2refs_lock.items[objid.id];
+        var lock = indexLock(&self.objid2refs_locks, objid.id);
         lock.lockUncancelable(io);
         defer lock.unlock(io);
 
-        try self.objid2refs.items[objid.id].put(self.allocator, referencer, referencer_prop_idx);
+        try self.objid2refs.get(objid.id).put(self.allocator, referencer, referencer_prop_idx);
     }
 
     pub fn removeObjIdReferencer(self: *Self, io: std.Io, objid: public.ObjId, referencer: public.ObjId) void {
-        var lock = &self.objid2refs_lock.items[objid.id];
+        var lock = indexLock(&self.objid2refs_locks, objid.id);
         lock.lockUncancelable(io);
         defer lock.unlock(io);
 
-        _ = self.objid2refs.items[objid.id].swapRemove(referencer);
+        _ = self.objid2refs.get(objid.id).swapRemove(referencer);
+    }
+
+    pub fn cloneObjIdReferencers(self: *Self, io: std.Io, allocator: std.mem.Allocator, objid: public.ObjId) !ReferencerIdSet {
+        var lock = indexLock(&self.objid2refs_locks, objid.id);
+        lock.lockUncancelable(io);
+        defer lock.unlock(io);
+
+        return self.objid2refs.get(objid.id).clone(allocator);
     }
 
     pub fn tranferObjIdReferencer(self: *Self, io: std.Io, from_objid: public.ObjId, to_objid: public.ObjId) !void {
-        var lock_from = &self.objid2refs_lock.items[from_objid.id];
-        var lock_to = &self.objid2refs_lock.items[to_objid.id];
-        lock_from.lockUncancelable(io);
-        lock_to.lockUncancelable(io);
-        defer lock_from.unlock(io);
-        defer lock_to.unlock(io);
-
-        var it = self.objid2refs.items[from_objid.id].iterator();
+        // Lock stripes in index order so two transfers can not deadlock.
+        const from_stripe = from_objid.id % INDEX_LOCK_STRIPES;
+        const to_stripe = to_objid.id % INDEX_LOCK_STRIPES;
+
+        var lock_first = &self.objid2refs_locks[@min(from_stripe, to_stripe)].mutex;
+        lock_first.lockUncancelable(io);
+        defer lock_first.unlock(io);
+
+        if (from_stripe != to_stripe) {
+            var lock_second = &self.objid2refs_locks[@max(from_stripe, to_stripe)].mutex;
+            lock_second.lockUncancelable(io);
+            defer lock_second.unlock(io);
+            try self.copyObjIdReferencers(from_objid, to_objid);
+        } else {
+            try self.copyObjIdReferencers(from_objid, to_objid);
+        }
+    }
+
+    fn copyObjIdReferencers(self: *Self, from_objid: public.ObjId, to_objid: public.ObjId) !void {
+        var it = self.objid2refs.get(from_objid.id).iterator();
         while (it.next()) |kv| {
-            try self.objid2refs.items[to_objid.id].put(self.allocator, kv.key_ptr.*, kv.value_ptr.*);
+            try self.objid2refs.get(to_objid.id).put(self.allocator, kv.key_ptr.*, kv.value_ptr.*);
         }
     }
 };
 
 const StringIntern = cetech1.string.InternWithLock([:0]const u8);
 
-const Uuid2ObjId = cetech1.AutoArrayHashMap(uuid.Uuid, public.ObjId);
-const ObjId2Uuid = cetech1.AutoArrayHashMap(public.ObjId, uuid.Uuid);
+// Import workers resolve uuids concurrently so maps are sharded with lock-free reads.
+const UUID_MAP_SHARDS = 64;
+const Uuid2ObjId = cetech1.ConcurrentAutoHashMap(uuid.Uuid, public.ObjId, UUID_MAP_SHARDS);
+const ObjId2Uuid = cetech1.ConcurrentAutoHashMap(public.ObjId, uuid.Uuid, UUID_MAP_SHARDS);
 
 pub const Db = struct {
     const Self = @This();
@@ -1109,9 +1508,13 @@ pub const Db = struct {
     metrics_init: bool = false,
 
     // UUID maping
-    uuid2objid: Uuid2ObjId = .{},
-    objid2uuid: ObjId2Uuid = .{},
-    uuid2objid_lock: std.Io.Mutex = .init,
+    uuid2objid: Uuid2ObjId = .empty,
+    objid2uuid: ObjId2Uuid = .empty,
+
+    // Objects with increased version that still need propagation to instances and parents.
+    defer_version_propagation: bool = false,
+    pending_versions: IdSet = .empty,
+    pending_versions_lock: std.Io.Mutex = .init,
 
     pub fn init(allocator: std.mem.Allocator, idx: public.DbId, name: [:0]const u8) !Db {
         var self: @This() = .{
@@ -1158,6 +1561,7 @@ pub const Db = struct {
 
         self.uuid2objid.deinit(self.allocator);
         self.objid2uuid.deinit(self.allocator);
+        self.pending_versions.deinit(self.allocator);
     }
 
     pub fn readersCount(self: *Self) usize {
@@ -1194,11 +1598,57 @@ pub const Db = struct {
         var zone_ctx = profiler.ztracy.ZoneN(@src(), "CDB:GC");
         defer zone_ctx.End();
 
+        try self.flushVersions(io);
+
+        // Ref counts, referencers and parents of other types are fixed serially.
         self.free_objects = 0;
-        for (self.typestorage_map.values()) |type_storage| {
-            //if (type_storage.to_free_queue.isEmpty()) continue;
-            self.free_objects += try self.getTypeStorageByTypeIdx(type_storage).?.gc(io, allocator);
+        for (self.typestorage_map.values()) |type_idx| {
+            const storage = self.getTypeStorageByTypeIdx(type_idx).?;
+            storage.gc_ns = 0;
+            if (storage.to_free_queue.isEmpty(io)) continue;
+            self.free_objects += try storage.gcCollect(io);
+        }
+
+        // Only types with garbage release memory, rest only compact change journal.
+        var storages = cetech1.ArrayList(*TypeStorage).empty;
+        defer storages.deinit(allocator);
+        for (self.typestorage_map.values()) |type_idx| {
+            const storage = self.getTypeStorageByTypeIdx(type_idx).?;
+            if (storage.gc_release_objs.items.len == 0 and storage.gc_destroyed_ids.items.len == 0) {
+                try storage.changed_objs.compact(io);
+                continue;
+            }
+            try storages.append(allocator, storage);
         }
+        defer for (storages.items) |storage| storage.gc_destroyed_ids.clearRetainingCapacity();
+
+        // Release touch only pools and journal of own type so types are independent.
+        try task.parallelFor(
+            .{ .count = storages.items.len, .grain_size = 1 },
+            TypeGcRange.Ctx{ .io = io, .storages = storages.items },
+            TypeGcRange,
+        );
+
+        var destroyed_count: usize = 0;
+        for (storages.items) |storage| destroyed_count += storage.gc_destroyed_ids.items.len;
+
+        if (destroyed_count != 0) {
+            var destroyed_ids = try public.ObjIdList.initCapacity(allocator, destroyed_count);
+            defer destroyed_ids.deinit(allocator);
+            for (storages.items) |storage| destroyed_ids.appendSliceAssumeCapacity(storage.gc_destroyed_ids.items);
+
+            // Remove UUID
+            for (destroyed_ids.items) |obj| {
+                const obj_uuid = self.objid2uuid.fetchRemove(io, obj) orelse continue;
+                _ = self.uuid2objid.remove(io, obj_uuid);
+            }
+
+            self.callOnObjIdDestroyed(destroyed_ids.items);
+        }
+
+        // Free retired uuid tables that have no reader now.
+        self.uuid2objid.reclaim(io, self.allocator);
+        self.objid2uuid.reclaim(io, self.allocator);
 
         self.objids_alocated = 0;
         for (self.typestorage_map.values()) |type_map| {
@@ -1225,6 +1675,8 @@ pub const Db = struct {
                 storage.read_counter.* = @floatFromInt(storage.read_obj_count.raw);
                 storage.writers_counter.* = @floatFromInt(storage.writers_created_count.raw);
                 storage.write_commit_counter.* = @floatFromInt(storage.write_commit_count.raw);
+                storage.committed_counter.* = @floatFromInt(storage.committedBytes());
+                storage.gc_time_counter.* = @as(f64, @floatFromInt(storage.gc_ns)) / std.time.ns_per_ms;
             }
         }
 
@@ -1266,7 +1718,8 @@ pub const Db = struct {
         if (obj.isEmpty()) return null;
 
         const storage = self.getTypeStorage(obj) orelse return null;
-        return storage.objid2obj.items[obj.id];
+        const obj_ptr = storage.objid2obj.getOrNull(obj.id) orelse return null;
+        return obj_ptr.*;
     }
 
     fn getParent(self: *Self, obj: public.ObjId) public.ObjId {
@@ -1388,18 +1841,7 @@ pub const Db = struct {
 
         const storage = try self.getOrCreateTypeStorage(type_hash, name, prop_defs);
 
-        const all_vm_size = (storage.object_pool.mem.reservation.len +
-            storage.idset_pool.mem.reservation.len +
-            storage.objs_mem.reservation.len +
-            storage.objid2obj.reservation.len +
-            storage.objid_ref_count.reservation.len +
-            //storage.objid_version.reservation.len +
-            storage.objid2refs.reservation.len +
-            storage.objid2refs_lock.reservation.len +
-            storage.prototype2instances.reservation.len +
-            storage.prototype2instances_lock.reservation.len);
-
-        log.debug("Register type {s}: {d}|{d}|{d}MB", .{ name, storage.type_idx.idx, type_hash.id, all_vm_size / 1000000 });
+        log.debug("Register type {s}: {d}|{d}|{d}KB", .{ name, storage.type_idx.idx, type_hash.id, storage.committedBytes() / 1000 });
 
         return storage.type_idx;
     }
@@ -1423,27 +1865,38 @@ pub const Db = struct {
         return storate.type_hash;
     }
 
-    pub fn getChangeObjects(self: *Self, io: std.Io, allocator: std.mem.Allocator, type_idx: public.TypeIdx, since_version: public.TypeVersion) !public.ChangedObjects {
+    pub fn getChangeObjects(self: *Self, io: std.Io, allocator: std.mem.Allocator, type_idx: public.TypeIdx, consumer: ?u32, since_version: public.TypeVersion) !public.ChangedObjects {
         const type_storage = self.getTypeStorageByTypeIdx(type_idx).?;
-        if (since_version == 0) return public.ChangedObjects{
-            .need_fullscan = true,
-            .last_version = type_storage.version,
-            .objects = try allocator.alloc(public.ObjId, 0),
-        };
+        const last_version = type_storage.version;
 
-        const objs = try type_storage.changed_objs.getSince(io, allocator, since_version, type_storage.version);
+        const objs = if (since_version == 0) null else try type_storage.changed_objs.getSince(io, allocator, consumer, since_version, last_version);
 
         return public.ChangedObjects{
-            .need_fullscan = false,
-            .last_version = type_storage.version,
-            .objects = objs,
+            .need_fullscan = objs == null,
+            .last_version = last_version,
+            .objects = objs orelse try allocator.alloc(public.ObjId, 0),
         };
     }
 
+    pub fn addChangeConsumer(self: *Self, io: std.Io, type_idx: public.TypeIdx) !public.ChangeConsumer {
+        const type_storage = self.getTypeStorageByTypeIdx(type_idx).?;
+        return .{
+            .db = self.idx,
+            .type_idx = type_idx,
+            .idx = try type_storage.changed_objs.addConsumer(io, type_storage.version),
+        };
+    }
+
+    pub fn removeChangeConsumer(self: *Self, io: std.Io, consumer: public.ChangeConsumer) void {
+        const type_storage = self.getTypeStorageByTypeIdx(consumer.type_idx).?;
+        type_storage.changed_objs.removeConsumer(io, consumer.idx);
+    }
+
     pub fn isAlive(self: *Self, obj: public.ObjId) bool {
         if (obj.isEmpty()) return false;
         const type_storage = self.getTypeStorageByTypeIdx(obj.type_idx).?;
-        return type_storage.objid_gen.items[obj.id] == obj.gen;
+        const gen = type_storage.objid_gen.getOrNull(obj.id) orelse return false;
+        return gen.* == obj.gen;
     }
 
     pub fn getRelation(self: *Self, top_level_obj: public.ObjId, obj: public.ObjId, prop_idx: u32, in_set_obj: ?public.ObjId) public.ObjRelation {
@@ -1657,36 +2110,208 @@ pub const Db = struct {
 
         _ = try storage.decreaseReferenceToFree(io, new_obj);
 
-        const old_obj = storage.objid2obj.items[new_obj.objid.id].?;
-        storage.objid2obj.items[new_obj.objid.id] = new_obj;
+        const old_obj = storage.objid2obj.get(new_obj.objid.id).*.?;
+        storage.objid2obj.get(new_obj.objid.id).* = new_obj;
         storage.addToFreeQueue(io, old_obj) catch undefined;
 
         self.increaseVersionToAll(io, new_obj);
     }
 
+    /// Writers are cloned from type object_pool and not from per-thread pool because committed writer
+    /// become live object and is freed by gc, per-thread buffer would need copy back on every commit.
+    pub fn beginTransaction(self: *Self) !*Transaction {
+        return acquireTransaction(self);
+    }
+
+    /// Writer for object in transaction. Same object return same writer.
+    pub fn transactionWriterObj(self: *Self, io: std.Io, tx: *Transaction, obj: public.ObjId) ?*public.Obj {
+        if (tx.writers.get(obj)) |writer| return @ptrCast(writer);
+
+        tx.writers.ensureUnusedCapacity(_allocator, 1) catch |err| {
+            log.err("Could not crate writer {}", .{err});
+            return null;
+        };
+
+        const writer = self.writerObj(io, obj) orelse return null;
+        tx.writers.putAssumeCapacity(obj, toObjFromObjO(writer));
+        return writer;
+    }
+
+    /// Swap all writers and increase versions once per type.
+    /// Only reservation can fail before first swap and then transaction is aborted.
+    /// After swap writers are always committed. If version propagation fail roots are queued for
+    /// next flushVersions and error is returned so instances and parents can see old version until gc.
+    pub fn commitTransaction(self: *Self, io: std.Io, tx: *Transaction) !void {
+        var zone_ctx = profiler.ztracy.ZoneN(@src(), "CDB:commitTransaction");
+        defer zone_ctx.End();
+
+        // Reserve before first swap so grouping and deferred queue can not fail in the middle.
+        tx.ids.ensureTotalCapacity(_allocator, tx.writers.count()) catch |err| {
+            self.abortTransaction(io, tx);
+            return err;
+        };
+
+        // Lock is hold through swaps so other commits can not consume reserved capacity.
+        const deferred = self.defer_version_propagation;
+        if (deferred) {
+            self.pending_versions_lock.lockUncancelable(io);
+            self.pending_versions.ensureTotalCapacity(self.allocator, self.pending_versions.cardinality() + tx.writers.count()) catch |err| {
+                self.pending_versions_lock.unlock(io);
+                self.abortTransaction(io, tx);
+                return err;
+            };
+        }
+        defer releaseTransaction(tx);
+        defer if (deferred) self.pending_versions_lock.unlock(io);
+
+        for (tx.writers.values()) |new_obj| {
+            var storage = self.getTypeStorage(new_obj.objid).?;
+            _ = storage.write_commit_count.fetchAdd(1, .monotonic);
+
+            storage.decreaseReferenceToFree(io, new_obj) catch undefined;
+
+            const old_obj = storage.objid2obj.get(new_obj.objid.id).*.?;
+            storage.objid2obj.get(new_obj.objid.id).* = new_obj;
+            storage.addToFreeQueue(io, old_obj) catch undefined;
+        }
+
+        // Group by type, transactions touch only few types.
+        const objids = tx.writers.keys();
+        for (objids, 0..) |first, idx| {
+            const seen = for (objids[0..idx]) |prev| {
+                if (prev.type_idx.idx == first.type_idx.idx) break true;
+            } else false;
+            if (seen) continue;
+
+            tx.ids.clearRetainingCapacity();
+            for (objids[idx..]) |obj| {
+                if (obj.type_idx.idx == first.type_idx.idx) tx.ids.appendAssumeCapacity(obj);
+            }
+            self.getTypeStorageByTypeIdx(first.type_idx).?.increaseVersionMany(io, tx.ids.items);
+        }
+
+        if (deferred) {
+            for (objids) |obj| self.pending_versions.unmanaged.putAssumeCapacity(obj, {});
+            return;
+        }
+
+        self.propagateVersion(io, objids) catch |err| {
+            self.pending_versions_lock.lockUncancelable(io);
+            defer self.pending_versions_lock.unlock(io);
+            for (objids) |obj| _ = self.pending_versions.add(self.allocator, obj) catch break;
+            return err;
+        };
+    }
+
+    /// Destroy all writers without commit.
+    pub fn abortTransaction(self: *Self, io: std.Io, tx: *Transaction) void {
+        defer releaseTransaction(tx);
+
+        for (tx.writers.values()) |writer| {
+            var storage = self.getTypeStorage(writer.objid).?;
+            const obj = storage.objid2obj.get(writer.objid.id).*.?;
+
+            // Reference from writerObj.
+            storage.decreaseReferenceToFree(io, obj) catch undefined;
+            storage.addToFreeQueue(io, writer) catch |err| {
+                log.err("Could not free aborted writer {}", .{err});
+            };
+        }
+    }
+
     pub fn increaseVersionToAll(self: *Self, io: std.Io, obj: *Object) void {
-        // TODO: no recursion
-        //        var zone_ctx = profiler.ztracy.Zone(@src());
-        //        defer zone_ctx.End();
         std.debug.assert(obj.objid.id != obj.parent.id or obj.objid.type_idx.idx != obj.parent.type_idx.idx);
 
         var storage = self.getTypeStorage(obj.objid).?;
         storage.increaseVersion(io, obj.objid);
 
-        // increase version for instances if any
-        var instances = storage.prototype2instances.items[obj.objid.id];
-        for (instances.unmanaged.keys()) |instance| {
-            self.increaseVersionToAll(io, self.getObjectPtr(instance).?);
+        if (self.defer_version_propagation) {
+            self.pending_versions_lock.lockUncancelable(io);
+            defer self.pending_versions_lock.unlock(io);
+
+            _ = self.pending_versions.add(self.allocator, obj.objid) catch |err| {
+                log.err("Could not defer version propagation {}", .{err});
+            };
+            return;
         }
 
-        // increase version for parent
-        if (obj.parent.id != 0) {
-            if (self.getObjectPtr(obj.parent)) |r| {
-                self.increaseVersionToAll(io, r);
+        self.propagateVersion(io, &.{obj.objid}) catch |err| {
+            log.err("Could not propagate version {}", .{err});
+        };
+    }
+
+    /// Increase version of all instances and parents of already increased roots.
+    /// Every object is increased once even if is reachable from more roots.
+    fn propagateVersion(self: *Self, io: std.Io, roots: []const public.ObjId) !void {
+        // Most commits touch objects without parent and instances so skip scratch allocation.
+        const need_walk = for (roots) |root| {
+            const obj = self.getObjectPtr(root) orelse continue;
+            if (obj.parent.id != 0) break true;
+            if (self.getTypeStorage(root).?.hasPrototypeInstances(io, root)) break true;
+        } else false;
+        if (!need_walk) return;
+
+        var visited = IdSet.empty;
+        defer visited.deinit(self.allocator);
+
+        var stack = public.ObjIdList.empty;
+        defer stack.deinit(self.allocator);
+
+        for (roots) |root| {
+            _ = try visited.add(self.allocator, root);
+        }
+        try stack.appendSlice(self.allocator, roots);
+
+        while (stack.pop()) |objid| {
+            const obj = self.getObjectPtr(objid) orelse continue;
+            const storage = self.getTypeStorage(objid).?;
+
+            // increase version for instances if any
+            const instances_begin = stack.items.len;
+            try storage.appendPrototypeInstances(io, objid, self.allocator, &visited, &stack);
+
+            var idx = instances_begin;
+            while (idx < stack.items.len) {
+                const instance = stack.items[idx];
+                if (self.getObjectPtr(instance) == null) {
+                    _ = stack.swapRemove(idx);
+                    continue;
+                }
+
+                self.getTypeStorage(instance).?.increaseVersion(io, instance);
+                idx += 1;
+            }
+
+            // increase version for parent
+            if (obj.parent.id != 0) {
+                if (!try visited.add(self.allocator, obj.parent)) continue;
+                if (self.getObjectPtr(obj.parent) == null) continue;
+
+                self.getTypeStorage(obj.parent).?.increaseVersion(io, obj.parent);
+                try stack.append(self.allocator, obj.parent);
             }
         }
     }
 
+    /// Propagate versions deferred from commits since last flush. Called before gc.
+    pub fn flushVersions(self: *Self, io: std.Io) !void {
+        var zone_ctx = profiler.ztracy.ZoneN(@src(), "CDB:flushVersions");
+        defer zone_ctx.End();
+
+        self.pending_versions_lock.lockUncancelable(io);
+        defer self.pending_versions_lock.unlock(io);
+
+        if (self.pending_versions.cardinality() == 0) return;
+
+        try self.propagateVersion(io, self.pending_versions.unmanaged.keys());
+        self.pending_versions.clearRetainingCapacity();
+    }
+
+    pub fn setDeferredVersionPropagation(self: *Self, io: std.Io, enabled: bool) !void {
+        if (!enabled) try self.flushVersions(io);
+        self.defer_version_propagation = enabled;
+    }
+
     pub fn readObj(self: *Self, obj: public.ObjId) ?*public.Obj {
         const true_obj = self.getObjectPtr(obj);
         const storage = self.getTypeStorage(obj) orelse return null;
@@ -2207,8 +2832,10 @@ pub const Db = struct {
     pub fn getFirstObject(self: *Self, type_idx: public.TypeIdx) public.ObjId {
         const storage = self.getTypeStorageByTypeIdx(type_idx).?;
         for (1..storage.objid_pool.count.raw) |idx| {
-            if (storage.objid2obj.items[idx] == null) continue;
-            return .{ .id = @intCast(idx), .gen = storage.objid_gen.items[idx], .type_idx = type_idx, .db = self.idx };
+            // Id can be allocated but its chunk not yet ensured.
+            const obj_ptr = storage.objid2obj.getOrNull(idx) orelse continue;
+            if (obj_ptr.* == null) continue;
+            return .{ .id = @intCast(idx), .gen = storage.objid_gen.get(idx).*, .type_idx = type_idx, .db = self.idx };
         }
 
         return .{};
@@ -2218,11 +2845,13 @@ pub const Db = struct {
         const storage = self.getTypeStorageByTypeIdx(type_idx).?;
         var result = public.ObjIdList.empty;
         for (1..storage.objid_pool.count.raw) |idx| {
-            if (storage.objid2obj.items[idx] == null) continue;
+            // Id can be allocated but its chunk not yet ensured.
+            const obj_ptr = storage.objid2obj.getOrNull(idx) orelse continue;
+            if (obj_ptr.* == null) continue;
 
             result.append(allocator, .{
                 .id = @intCast(idx),
-                .gen = storage.objid_gen.items[idx],
+                .gen = storage.objid_gen.get(idx).*,
                 .type_idx = type_idx,
                 .db = self.idx,
             }) catch {
@@ -2236,7 +2865,12 @@ pub const Db = struct {
 
     pub fn getReferencerSet(self: *Self, allocator: std.mem.Allocator, obj: public.ObjId) ![]public.ObjId {
         var storage = self.getTypeStorage(obj).?;
-        const keys = storage.objid2refs.items[obj.id].keys();
+
+        var lock = TypeStorage.indexLock(&storage.objid2refs_locks, obj.id);
+        lock.lockUncancelable(_io);
+        defer lock.unlock(_io);
+
+        const keys = storage.objid2refs.get(obj.id).keys();
         const new_set = try allocator.alloc(public.ObjId, keys.len);
         @memcpy(new_set, keys);
         return new_set;
@@ -2260,33 +2894,39 @@ pub const Db = struct {
         return false;
     }
 
-    pub fn getObjId(self: *Self, io: std.Io, obj_uuid: uuid.Uuid) ?public.ObjId {
-        self.uuid2objid_lock.lockUncancelable(io);
-        defer self.uuid2objid_lock.unlock(io);
+    pub fn getObjId(self: *Self, obj_uuid: uuid.Uuid) ?public.ObjId {
         return self.uuid2objid.get(obj_uuid);
     }
 
-    pub fn getUuid(self: *Self, io: std.Io, obj: public.ObjId) ?uuid.Uuid {
-        self.uuid2objid_lock.lockUncancelable(io);
-        defer self.uuid2objid_lock.unlock(io);
+    pub fn getUuid(self: *Self, obj: public.ObjId) ?uuid.Uuid {
         return self.objid2uuid.get(obj);
     }
 
     pub fn mapUuidObjid(self: *Self, io: std.Io, obj_uuid: uuid.Uuid, objid: public.ObjId) !void {
-        self.uuid2objid_lock.lockUncancelable(io);
-        defer self.uuid2objid_lock.unlock(io);
-        try self.uuid2objid.put(self.allocator, obj_uuid, objid);
-        try self.objid2uuid.put(self.allocator, objid, obj_uuid);
+        try self.uuid2objid.put(io, self.allocator, obj_uuid, objid);
+        try self.objid2uuid.put(io, self.allocator, objid, obj_uuid);
     }
 
     fn getOrCreateUuid(self: *Self, io: std.Io, obj: public.ObjId) !uuid.Uuid {
-        var obj_uuid = self.getUuid(io, obj);
-        if (obj_uuid != null) {
-            return obj_uuid.?;
+        if (self.getUuid(obj)) |obj_uuid| return obj_uuid;
+
+        const new_uuid = uuid.newUUID7();
+        if (try self.objid2uuid.putIfAbsent(io, self.allocator, obj, new_uuid)) |obj_uuid| return obj_uuid;
+        try self.uuid2objid.put(io, self.allocator, new_uuid, obj);
+        return new_uuid;
+    }
+
+    /// Only one object is created for uuid even if more workers ask for same uuid at once.
+    pub fn getOrCreate(self: *Self, io: std.Io, obj_uuid: uuid.Uuid, type_idx: public.TypeIdx) !public.ObjId {
+        if (self.getObjId(obj_uuid)) |obj| return obj;
+
+        const obj = try self.createObject(io, type_idx);
+        if (try self.uuid2objid.putIfAbsent(io, self.allocator, obj_uuid, obj)) |existing_obj| {
+            self.destroyObject(io, obj);
+            return existing_obj;
         }
-        obj_uuid = uuid.newUUID7();
-        try self.mapUuidObjid(io, obj_uuid.?, obj);
-        return obj_uuid.?;
+        try self.objid2uuid.put(io, self.allocator, obj, obj_uuid);
+        return obj;
     }
 
     pub fn createObjectWithUuid(self: *Self, io: std.Io, type_idx: public.TypeIdx, with_uuid: uuid.Uuid) !public.ObjId {
@@ -2317,6 +2957,7 @@ pub fn init(io: std.Io, allocator: std.mem.Allocator) !void {
 }
 
 pub fn deinit() void {
+    deinitTransactionPool();
     _db_pool.deinit();
 }
 
@@ -2400,6 +3041,9 @@ const api = public.CdbAPI{
     .hasTypeSubobject = hasTypeSubobjectFn,
     .getTypeHash = getTypeHashFn,
     .getChangeObjects = getChangeObjectsFn,
+    .getConsumerChangeObjects = getConsumerChangeObjectsFn,
+    .addChangeConsumer = addChangeConsumerFn,
+    .removeChangeConsumer = removeChangeConsumerFn,
     .getDefaultObject = getDefaultObjectFn,
     .getFirstObject = getFirstObjectFn,
     .getAllObjectByType = getAllObjectByTypeFn,
@@ -2410,6 +3054,12 @@ const api = public.CdbAPI{
     .getTypeName = getTypeNameFn,
     .getTypePropDefIdx = getTypePropDefIdxFn,
     .gc = gcFn,
+    .beginTransaction = beginTransactionFn,
+    .transactionWriteObj = transactionWriteObjFn,
+    .commitTransaction = commitTransactionFn,
+    .abortTransaction = abortTransactionFn,
+    .enablePrototypeReadCache = enablePrototypeReadCacheFn,
+    .setDeferredVersionPropagation = setDeferredVersionPropagationFn,
     .dump = dumpFn,
 
     .getObjId = getObjId,
@@ -2422,11 +3072,12 @@ const api = public.CdbAPI{
 
 fn getObjId(dbidx: public.DbId, obj_uuid: uuid.Uuid) ?public.ObjId {
     var db = getDbFromIdx(dbidx);
-    return db.getObjId(_io, obj_uuid);
+    return db.getObjId(obj_uuid);
 }
 
 fn getOrCreate(dbidx: public.DbId, obj_uuid: uuid.Uuid, type_idx: public.TypeIdx) !public.ObjId {
-    return getObjId(dbidx, obj_uuid) orelse try createObjectWithUuid(dbidx, type_idx, obj_uuid);
+    var db = getDbFromIdx(dbidx);
+    return db.getOrCreate(_io, obj_uuid, type_idx);
 }
 
 fn createObjectWithUuid(dbidx: public.DbId, type_idx: public.TypeIdx, obj_uuid: uuid.Uuid) !public.ObjId {
@@ -2546,6 +3197,22 @@ fn writeCommitFn(writer: *public.Obj) !void {
     var db = getDbFromObj(writer);
     return db.writerCommit(_io, writer);
 }
+fn beginTransactionFn(dbidx: public.DbId) !*public.Transaction {
+    var db = getDbFromIdx(dbidx);
+    return @ptrCast(try db.beginTransaction());
+}
+fn transactionWriteObjFn(tx: *public.Transaction, obj: public.ObjId) ?*public.Obj {
+    const true_tx: *Transaction = @ptrCast(@alignCast(tx));
+    return true_tx.db.transactionWriterObj(_io, true_tx, obj);
+}
+fn commitTransactionFn(tx: *public.Transaction) !void {
+    const true_tx: *Transaction = @ptrCast(@alignCast(tx));
+    return true_tx.db.commitTransaction(_io, true_tx);
+}
+fn abortTransactionFn(tx: *public.Transaction) void {
+    const true_tx: *Transaction = @ptrCast(@alignCast(tx));
+    true_tx.db.abortTransaction(_io, true_tx);
+}
 fn retargetWriteFn(writer: *public.Obj, obj: public.ObjId) !void {
     var db = getDbFromObj(writer);
     return db.retargetWriter(_io, writer, obj);
@@ -2695,6 +3362,16 @@ fn gcFn(dbidx: public.DbId, allocator: std.mem.Allocator) !void {
     return db.gc(_io, allocator);
 }
 
+fn enablePrototypeReadCacheFn(dbidx: public.DbId, type_idx: public.TypeIdx) !void {
+    var db = getDbFromIdx(dbidx);
+    return db.getTypeStorageByTypeIdx(type_idx).?.enablePrototypeReadCache();
+}
+
+fn setDeferredVersionPropagationFn(dbidx: public.DbId, enabled: bool) !void {
+    var db = getDbFromIdx(dbidx);
+    return db.setDeferredVersionPropagation(_io, enabled);
+}
+
 fn dumpFn(dbidx: public.DbId) !void {
     var real_db = getDbFromIdx(dbidx);
 
@@ -2783,7 +3460,19 @@ fn getTypeHashFn(dbidx: public.DbId, type_idx: public.TypeIdx) ?public.TypeHash
 }
 fn getChangeObjectsFn(dbidx: public.DbId, allocator: std.mem.Allocator, type_idx: public.TypeIdx, since_version: public.TypeVersion) !public.ChangedObjects {
     var db = getDbFromIdx(dbidx);
-    return db.getChangeObjects(_io, allocator, type_idx, since_version);
+    return db.getChangeObjects(_io, allocator, type_idx, null, since_version);
+}
+fn getConsumerChangeObjectsFn(allocator: std.mem.Allocator, consumer: public.ChangeConsumer, since_version: public.TypeVersion) !public.ChangedObjects {
+    var db = getDbFromIdx(consumer.db);
+    return db.getChangeObjects(_io, allocator, consumer.type_idx, consumer.idx, since_version);
+}
+fn addChangeConsumerFn(dbidx: public.DbId, type_idx: public.TypeIdx) !public.ChangeConsumer {
+    var db = getDbFromIdx(dbidx);
+    return db.addChangeConsumer(_io, type_idx);
+}
+fn removeChangeConsumerFn(consumer: public.ChangeConsumer) void {
+    var db = getDbFromIdx(consumer.db);
+    db.removeChangeConsumer(_io, consumer);
 }
 fn isAliveFn(obj: public.ObjId) bool {
     if (obj.isEmpty()) return false;
@@ -2887,5 +3576,71 @@ test "cdb: Test alocate/free idset" {
     try storage.destroyObjIdSet(array);
 }
 
+test "cdb: Change journal compact by watermarks and fall off ring" {
+    const io = std.testing.io;
+    const allocator = std.testing.allocator;
+
+    var journal = ChangeJournal.init(allocator);
+    defer journal.deinit();
+
+    const obj = public.ObjId{ .type_idx = .{ .idx = 0 }, .id = 1 };
+    const consumer = try journal.addConsumer(io, 1);
+
+    for (1..11) |version| {
+        journal.addChangedObjects(io, @intCast(version), &.{obj});
+    }
+
+    const all = (try journal.getSince(io, allocator, consumer, 1, 11)).?;
+    defer allocator.free(all);
+    try std.testing.expectEqual(@as(usize, 10), all.len);
+
+    // Consumer read everything before version 6.
+    const newer = (try journal.getSince(io, allocator, consumer, 6, 11)).?;
+    defer allocator.free(newer);
+    try std.testing.expectEqual(@as(usize, 5), newer.len);
+
+    try journal.compact(io);
+    try std.testing.expectEqual(@as(usize, 5), journal.len);
+
+    // Plain reader behind compacted entries need fullscan.
+    try std.testing.expect((try journal.getSince(io, allocator, null, 2, 11)) == null);
+
+    // Reader after compaction get rest of journal.
+    const compacted = (try journal.getSince(io, allocator, null, 6, 11)).?;
+    defer allocator.free(compacted);
+    try std.testing.expectEqual(@as(usize, 5), compacted.len);
+
+    // Consumer registered behind compacted entries need fullscan too.
+    const late_consumer = try journal.addConsumer(io, 2);
+    try std.testing.expect((try journal.getSince(io, allocator, late_consumer, 2, 11)) == null);
+    journal.removeConsumer(io, late_consumer);
+
+    // Without consumers nothing is compacted but ring is bounded.
+    journal.removeConsumer(io, consumer);
+    for (0..ChangeJournal.max_capacity) |_| {
+        journal.addChangedObjects(io, 11, &.{obj});
+    }
+    try std.testing.expectEqual(@as(usize, ChangeJournal.max_capacity), journal.len);
+    try std.testing.expect((try journal.getSince(io, allocator, null, 6, 12)) == null);
+
+    const last = (try journal.getSince(io, allocator, null, 11, 12)).?;
+    defer allocator.free(last);
+    try std.testing.expectEqual(@as(usize, ChangeJournal.max_capacity), last.len);
+}
+
+test "cdb: Change journal mark change lost if it can not grow" {
+    const io = std.testing.io;
+
+    var failing = std.testing.FailingAllocator.init(std.testing.allocator, .{ .fail_index = 0 });
+    var journal = ChangeJournal.init(failing.allocator());
+    defer journal.deinit();
+
+    const obj = public.ObjId{ .type_idx = .{ .idx = 0 }, .id = 1 };
+    journal.addChangedObjects(io, 5, &.{obj});
+
+    try std.testing.expectEqual(@as(usize, 0), journal.len);
+    try std.testing.expect((try journal.getSince(io, std.testing.allocator, null, 5, 6)) == null);
+}
+
 // Assert C api == C api in zig.
 comptime {}
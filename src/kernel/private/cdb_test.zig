@@ -2,6 +2,7 @@ const builtin = @import("builtin");
 const std = @import("std");
 
 const cetech1 = @import("cetech1");
+const cetech1_options = @import("cetech1_options");
 const public = cetech1.cdb;
 const task = cetech1.task;
 const apidb = cetech1.apidb;
@@ -253,6 +254,339 @@ test "cdb: Should create object from type" {
     try std.testing.expect(!cdb.isAlive(obj2));
 }
 
+test "cdb: Should create more objects than first storage chunk" {
+    try testInit();
+    defer testDeinit();
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.U64 },
+        },
+    );
+
+    // Over old 100k per type cap.
+    const obj_count = 150_000;
+    const objs = try std.testing.allocator.alloc(cdb.ObjId, obj_count);
+    defer std.testing.allocator.free(objs);
+
+    for (objs, 0..) |*obj, idx| {
+        obj.* = try cdb.createObject(db, type_hash);
+
+        const w = cdb.writeObj(obj.*).?;
+        cdb.setValue(u64, w, 0, idx);
+        try cdb.writeCommit(w);
+    }
+
+    for (objs, 0..) |obj, idx| {
+        try std.testing.expect(cdb.isAlive(obj));
+        try std.testing.expectEqual(@as(u64, idx), cdb.readValue(u64, cdb.readObj(obj).?, 0));
+    }
+
+    var true_db = cdb_private.toDbFromDbT(db);
+    const storage = true_db.getTypeStorageByTypeIdx(type_hash).?;
+    try std.testing.expect(storage.committedBytes() > 0);
+
+    for (objs) |obj| cdb.destroyObject(obj);
+    try cdb.gc(std.testing.allocator, db);
+}
+
+test "cdb: read throughput and object footprint" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const prop_count = 8;
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop0", .type = public.PropType.U64 },
+            .{ .prop_idx = 1, .name = "prop1", .type = public.PropType.U64 },
+            .{ .prop_idx = 2, .name = "prop2", .type = public.PropType.U64 },
+            .{ .prop_idx = 3, .name = "prop3", .type = public.PropType.U64 },
+            .{ .prop_idx = 4, .name = "prop4", .type = public.PropType.U64 },
+            .{ .prop_idx = 5, .name = "prop5", .type = public.PropType.U64 },
+            .{ .prop_idx = 6, .name = "prop6", .type = public.PropType.U64 },
+            .{ .prop_idx = 7, .name = "prop7", .type = public.PropType.U64 },
+        },
+    );
+
+    const obj_count = 10_000;
+    const rounds = 10;
+
+    const objs = try std.testing.allocator.alloc(cdb.ObjId, obj_count);
+    defer std.testing.allocator.free(objs);
+
+    for (objs, 0..) |*obj, idx| {
+        obj.* = try cdb.createObject(db, type_hash);
+
+        const w = cdb.writeObj(obj.*).?;
+        for (0..prop_count) |prop_idx| cdb.setValue(u64, w, @truncate(prop_idx), idx);
+        try cdb.writeCommit(w);
+    }
+
+    var sum: u64 = 0;
+    const start = std.Io.Timestamp.now(io, .awake);
+    for (0..rounds) |_| {
+        for (objs) |obj| {
+            const r = cdb.readObj(obj).?;
+            for (0..prop_count) |prop_idx| sum +%= cdb.readValue(u64, r, @truncate(prop_idx));
+        }
+    }
+    const read_ns = start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    var true_db = cdb_private.toDbFromDbT(db);
+    const storage = true_db.getTypeStorageByTypeIdx(type_hash).?;
+
+    try std.testing.expectEqual(@as(u64, rounds * prop_count * (obj_count * (obj_count - 1) / 2)), sum);
+
+    // Compare with layout before inline properties: object header with props slice into separate array.
+    const OldObject = struct {
+        obj: cdb_private.Object,
+        props_mem: []usize,
+    };
+
+    var old_pool = try cetech1.heap.ChunkedPool(OldObject).init(std.testing.allocator);
+    defer old_pool.deinit();
+    var old_props = cetech1.heap.ChunkedArray(usize).init(std.testing.allocator, prop_count);
+    defer old_props.deinit();
+
+    var new_pool = try cetech1.heap.ChunkedPool(cdb_private.Object).initWithTail(std.testing.allocator, prop_count);
+    defer new_pool.deinit();
+
+    const old_objs = try std.testing.allocator.alloc(*OldObject, obj_count);
+    defer std.testing.allocator.free(old_objs);
+    const new_objs = try std.testing.allocator.alloc(*cdb_private.Object, obj_count);
+    defer std.testing.allocator.free(new_objs);
+
+    for (old_objs, new_objs, 0..) |*old, *new, idx| {
+        old.* = try old_pool.create(null);
+        const old_idx = old_pool.index(old.*);
+        try old_props.ensure(old_idx);
+        old.*.props_mem = old_props.getMany(old_idx);
+        @memset(old.*.props_mem, idx);
+
+        new.* = try new_pool.create(null);
+        @memset(new_pool.tail(new.*), idx);
+    }
+
+    var old_sum: u64 = 0;
+    const old_start = std.Io.Timestamp.now(io, .awake);
+    for (0..rounds) |_| {
+        for (old_objs) |obj| {
+            for (0..prop_count) |prop_idx| old_sum +%= obj.props_mem[prop_idx];
+        }
+    }
+    const old_read_ns = old_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    var new_sum: u64 = 0;
+    const new_start = std.Io.Timestamp.now(io, .awake);
+    for (0..rounds) |_| {
+        for (new_objs) |obj| {
+            for (0..prop_count) |prop_idx| new_sum +%= obj.getPropPtr(u64, prop_idx).*;
+        }
+    }
+    const new_read_ns = new_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    try std.testing.expectEqual(sum, old_sum);
+    try std.testing.expectEqual(sum, new_sum);
+
+    const old_bytes = old_pool.itemSize() + prop_count * @sizeOf(usize);
+    const new_bytes = new_pool.itemSize();
+    const old_committed = old_pool.committed() + old_props.committed();
+    const new_committed = new_pool.committed();
+
+    // Slice is gone so one object is smaller.
+    try std.testing.expect(new_bytes < old_bytes);
+
+    if (cetech1_options.enable_bench) {
+        std.debug.print(
+            "cdb read: objects={d} props={d} readObj+readValue={d}ns/obj object_bytes={d} committed_per_obj={d}\n",
+            .{
+                obj_count,
+                prop_count,
+                @divTrunc(read_ns, obj_count * rounds),
+                storage.object_pool.itemSize(),
+                storage.committedBytes() / obj_count,
+            },
+        );
+        std.debug.print(
+            "cdb layout: old read={d}ns/obj bytes={d} committed_per_obj={d} | new read={d}ns/obj bytes={d} committed_per_obj={d}\n",
+            .{
+                @divTrunc(old_read_ns, obj_count * rounds),
+                old_bytes,
+                old_committed / obj_count,
+                @divTrunc(new_read_ns, obj_count * rounds),
+                new_bytes,
+                new_committed / obj_count,
+            },
+        );
+    }
+
+    for (objs) |obj| cdb.destroyObject(obj);
+    try cdb.gc(std.testing.allocator, db);
+}
+
+test "cdb: Should gc more types in parallel" {
+    try testInit();
+    defer testDeinit();
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_count = 8;
+    const obj_count = 100;
+
+    var types: [type_count]cdb.TypeIdx = undefined;
+    for (&types, 0..) |*type_idx, idx| {
+        var buf: [32]u8 = undefined;
+        type_idx.* = try cdb.addType(
+            db,
+            try std.fmt.bufPrint(&buf, "foo{d}", .{idx}),
+            &.{
+                .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.U64 },
+            },
+        );
+    }
+
+    for (types) |type_idx| {
+        for (0..obj_count) |_| {
+            const obj = try cdb.createObject(db, type_idx);
+            cdb.destroyObject(obj);
+        }
+    }
+
+    try cdb.gc(std.testing.allocator, db);
+    try expectGCStats(db, type_count * obj_count, type_count * obj_count);
+
+    // Nothing to free.
+    try cdb.gc(std.testing.allocator, db);
+    try expectGCStats(db, type_count * obj_count, 0);
+}
+
+test "cdb: Should gc subobjects across more types in one gc" {
+    try testInit();
+    defer testDeinit();
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_count = 8;
+
+    var types: [type_count]cdb.TypeIdx = undefined;
+    for (&types, 0..) |*type_idx, idx| {
+        var buf: [32]u8 = undefined;
+        type_idx.* = try cdb.addType(
+            db,
+            try std.fmt.bufPrint(&buf, "foo{d}", .{idx}),
+            &.{
+                .{ .prop_idx = 0, .name = "sub", .type = public.PropType.SUBOBJECT },
+                .{ .prop_idx = 1, .name = "ref", .type = public.PropType.REFERENCE },
+            },
+        );
+    }
+
+    // Chain of subobjects where every object reference first object of other chain.
+    var chain: [type_count]cdb.ObjId = undefined;
+    for (&chain, types) |*obj, type_idx| obj.* = try cdb.createObject(db, type_idx);
+    const referenced = try cdb.createObject(db, types[0]);
+
+    var idx: usize = type_count - 1;
+    while (idx > 0) {
+        idx -= 1;
+        const writer = cdb.writeObj(chain[idx]).?;
+        const sub_writer = cdb.writeObj(chain[idx + 1]).?;
+        try cdb.setSubObj(writer, 0, sub_writer);
+        try cdb.setRef(sub_writer, 1, referenced);
+        try cdb.writeCommit(sub_writer);
+        try cdb.writeCommit(writer);
+    }
+
+    cdb.destroyObject(chain[0]);
+    try cdb.gc(std.testing.allocator, db);
+
+    for (chain) |obj| try std.testing.expectEqual(@as(?*public.Obj, null), cdb.readObj(obj));
+    try std.testing.expect(cdb.readObj(referenced) != null);
+
+    cdb.destroyObject(referenced);
+    try cdb.gc(std.testing.allocator, db);
+    try std.testing.expectEqual(@as(?*public.Obj, null), cdb.readObj(referenced));
+}
+
+test "cdb: Should create one object per uuid from more workers" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.U64 },
+        },
+    );
+
+    const uuid_count = 10_000;
+    const lookups_per_uuid = 8;
+
+    const Ctx = struct {
+        db: cdb.DbId,
+        type_idx: cdb.TypeIdx,
+    };
+
+    const start = std.Io.Timestamp.now(io, .awake);
+    try task.parallelFor(
+        .{ .count = uuid_count * lookups_per_uuid },
+        Ctx{ .db = db, .type_idx = type_hash },
+        struct {
+            pub fn exec(ctx: Ctx, range: task.Range) !void {
+                for (range.begin..range.end) |idx| {
+                    _ = try cdb.getOrCreate(ctx.db, uuid_private.fromInt(idx % uuid_count + 1), ctx.type_idx);
+                }
+            }
+        },
+    );
+    const create_ns = start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    if (cetech1_options.enable_bench) {
+        std.debug.print(
+            "cdb uuid: uuids={d} getOrCreate={d}ns/op workers={d}\n",
+            .{ uuid_count, @divTrunc(create_ns, uuid_count * lookups_per_uuid), task.getThreadNum() },
+        );
+    }
+
+    for (0..uuid_count) |idx| {
+        const obj_uuid = uuid_private.fromInt(idx + 1);
+        const obj = cdb.getObjId(db, obj_uuid);
+        try std.testing.expect(obj != null);
+        try std.testing.expectEqual(obj_uuid, try cdb.getOrCreateUuid(obj.?));
+    }
+
+    // Objects that lost the race are freed and do not take uuid with them.
+    try cdb.gc(std.testing.allocator, db);
+    for (0..uuid_count) |idx| {
+        try std.testing.expect(cdb.getObjId(db, uuid_private.fromInt(idx + 1)) != null);
+    }
+
+    // No reader is running so all tables retired by rehash are freed in one gc.
+    var true_db = cdb_private.toDbFromDbT(db);
+    try std.testing.expectEqual(@as(usize, 0), true_db.uuid2objid.retiredCount(io));
+    try std.testing.expectEqual(@as(usize, 0), true_db.objid2uuid.retiredCount(io));
+}
+
 // test "cdb: Should create object from type with uuid" {
 //     try testInit();
 //     defer testDeinit();
@@ -1257,6 +1591,162 @@ test "cdb: Should use prototype" {
     try expectGCStats(db, 2, 6);
 }
 
+test "cdb: Should propagate version to instances once per gc if deferred" {
+    try testInit();
+    defer testDeinit();
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.F64 },
+        },
+    );
+
+    const obj1 = try cdb.createObject(db, type_hash);
+    const obj2 = try cdb.createObjectFromPrototype(obj1);
+    const obj3 = try cdb.createObjectFromPrototype(obj2);
+
+    // Immediate propagation, every commit increase all instances.
+    {
+        const obj2_version = cdb.getVersion(obj2);
+        const obj3_version = cdb.getVersion(obj3);
+
+        for (0..3) |idx| {
+            const w = cdb.writeObj(obj1).?;
+            cdb.setValue(f64, w, 0, @floatFromInt(idx));
+            try cdb.writeCommit(w);
+        }
+
+        try std.testing.expectEqual(obj2_version + 3, cdb.getVersion(obj2));
+        try std.testing.expectEqual(obj3_version + 3, cdb.getVersion(obj3));
+    }
+
+    // Deferred propagation, instances are increased once on gc.
+    try cdb.setDeferredVersionPropagation(db, true);
+    {
+        const obj1_version = cdb.getVersion(obj1);
+        const obj2_version = cdb.getVersion(obj2);
+        const obj3_version = cdb.getVersion(obj3);
+
+        for (0..3) |idx| {
+            const w = cdb.writeObj(obj1).?;
+            cdb.setValue(f64, w, 0, @floatFromInt(idx));
+            try cdb.writeCommit(w);
+        }
+
+        try std.testing.expectEqual(obj1_version + 3, cdb.getVersion(obj1));
+        try std.testing.expectEqual(obj2_version, cdb.getVersion(obj2));
+
+        try cdb.gc(std.testing.allocator, db);
+
+        try std.testing.expectEqual(obj2_version + 1, cdb.getVersion(obj2));
+        try std.testing.expectEqual(obj3_version + 1, cdb.getVersion(obj3));
+    }
+    try cdb.setDeferredVersionPropagation(db, false);
+
+    cdb.destroyObject(obj3);
+    cdb.destroyObject(obj2);
+    cdb.destroyObject(obj1);
+    try cdb.gc(std.testing.allocator, db);
+}
+
+test "cdb: prototype read cache and chain depth throughput" {
+    try testInit();
+    defer testDeinit();
+
+    const io = std.testing.io;
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const prop_count = 4;
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop0", .type = public.PropType.U64 },
+            .{ .prop_idx = 1, .name = "prop1", .type = public.PropType.U64 },
+            .{ .prop_idx = 2, .name = "prop2", .type = public.PropType.U64 },
+            .{ .prop_idx = 3, .name = "prop3", .type = public.PropType.U64 },
+        },
+    );
+
+    const max_depth = 5;
+    var chain: [max_depth + 1]cdb.ObjId = undefined;
+    chain[0] = try cdb.createObject(db, type_hash);
+    {
+        const w = cdb.writeObj(chain[0]).?;
+        for (0..prop_count) |prop_idx| cdb.setValue(u64, w, @truncate(prop_idx), prop_idx + 1);
+        try cdb.writeCommit(w);
+    }
+    for (1..max_depth + 1) |depth| {
+        chain[depth] = try cdb.createObjectFromPrototype(chain[depth - 1]);
+    }
+
+    const reads = 100_000;
+    var ns_per_read: [2][max_depth + 1]i96 = undefined;
+
+    for (0..2) |cached| {
+        if (cached == 1) try cdb.enablePrototypeReadCache(db, type_hash);
+
+        for (0..max_depth + 1) |depth| {
+            var sum: u64 = 0;
+            const start = std.Io.Timestamp.now(io, .awake);
+            for (0..reads / prop_count) |_| {
+                const r = cdb.readObj(chain[depth]).?;
+                for (0..prop_count) |prop_idx| sum +%= cdb.readValue(u64, r, @truncate(prop_idx));
+            }
+            ns_per_read[cached][depth] = @divTrunc(start.durationTo(.now(io, .awake)).toNanoseconds(), reads);
+            try std.testing.expectEqual(@as(u64, (reads / prop_count) * 10), sum);
+        }
+    }
+
+    if (cetech1_options.enable_bench) {
+        for (0..max_depth + 1) |depth| {
+            std.debug.print(
+                "cdb prototype read: depth={d} uncached={d}ns cached={d}ns\n",
+                .{ depth, ns_per_read[0][depth], ns_per_read[1][depth] },
+            );
+        }
+    }
+
+    // Change in prototype must be visible through cache.
+    {
+        const w = cdb.writeObj(chain[0]).?;
+        cdb.setValue(u64, w, 0, 42);
+        try cdb.writeCommit(w);
+    }
+    try std.testing.expectEqual(@as(u64, 42), cdb.readValue(u64, cdb.readObj(chain[max_depth]).?, 0));
+
+    // Override in middle of chain too.
+    {
+        const w = cdb.writeObj(chain[2]).?;
+        cdb.setValue(u64, w, 1, 7);
+        try cdb.writeCommit(w);
+    }
+    try std.testing.expectEqual(@as(u64, 7), cdb.readValue(u64, cdb.readObj(chain[max_depth]).?, 1));
+    try std.testing.expectEqual(@as(u64, 42), cdb.readValue(u64, cdb.readObj(chain[max_depth]).?, 0));
+
+    // Destroyed prototype must not be used as cached source.
+    try std.testing.expectEqual(@as(u64, 3), cdb.readValue(u64, cdb.readObj(chain[max_depth]).?, 2));
+    const chain1_version = cdb.getVersion(chain[1]);
+    cdb.destroyObject(chain[0]);
+    try cdb.gc(std.testing.allocator, db);
+    try std.testing.expect(cdb.getVersion(chain[1]) != chain1_version);
+    try std.testing.expectEqual(@as(u64, 3), cdb.readValue(u64, cdb.readObj(chain[max_depth]).?, 2));
+
+    var depth: usize = max_depth + 1;
+    while (depth > 1) {
+        depth -= 1;
+        cdb.destroyObject(chain[depth]);
+    }
+    try cdb.gc(std.testing.allocator, db);
+}
+
 test "cdb: Should use prototype on sets" {
     try testInit();
     defer testDeinit();
@@ -1656,6 +2146,140 @@ test "cdb: Should tracking changed objects" {
     try std.testing.expectEqualSlices(public.ObjId, &.{ obj1, obj2, obj2 }, changed_begin.objects);
 }
 
+test "cdb: Should compact changed objects read by consumer" {
+    try testInit();
+    defer testDeinit();
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.BOOL },
+        },
+    );
+
+    const consumer = try cdb.addChangeConsumer(db, type_hash);
+    defer cdb.removeChangeConsumer(consumer);
+
+    const obj1 = try cdb.createObject(db, type_hash);
+
+    const changed_0 = try cdb.getConsumerChangeObjects(std.testing.allocator, consumer, 0);
+    defer std.testing.allocator.free(changed_0.objects);
+    try std.testing.expect(changed_0.need_fullscan);
+
+    const obj1_w = cdb.writeObj(obj1).?;
+    cdb.setValue(bool, obj1_w, 0, true);
+    try cdb.writeCommit(obj1_w);
+    try cdb.gc(std.testing.allocator, db);
+
+    const changed_1 = try cdb.getConsumerChangeObjects(std.testing.allocator, consumer, changed_0.last_version);
+    defer std.testing.allocator.free(changed_1.objects);
+    try std.testing.expect(!changed_1.need_fullscan);
+    try std.testing.expectEqualSlices(public.ObjId, &.{obj1}, changed_1.objects);
+
+    // Consumer read all so GC compact journal.
+    const changed_2 = try cdb.getConsumerChangeObjects(std.testing.allocator, consumer, changed_1.last_version);
+    defer std.testing.allocator.free(changed_2.objects);
+    try std.testing.expectEqual(@as(usize, 0), changed_2.objects.len);
+    try cdb.gc(std.testing.allocator, db);
+
+    // Reader from version before compaction missed compacted changes and must fullscan.
+    const changed_old = try cdb.getChangeObjects(std.testing.allocator, db, type_hash, changed_0.last_version);
+    defer std.testing.allocator.free(changed_old.objects);
+    try std.testing.expect(changed_old.need_fullscan);
+
+    // Consumer still get changes after compaction without fullscan.
+    const obj1_w2 = cdb.writeObj(obj1).?;
+    cdb.setValue(bool, obj1_w2, 0, false);
+    try cdb.writeCommit(obj1_w2);
+
+    const changed_3 = try cdb.getConsumerChangeObjects(std.testing.allocator, consumer, changed_2.last_version);
+    defer std.testing.allocator.free(changed_3.objects);
+    try std.testing.expect(!changed_3.need_fullscan);
+    try std.testing.expectEqualSlices(public.ObjId, &.{obj1}, changed_3.objects);
+
+    cdb.destroyObject(obj1);
+    try cdb.gc(std.testing.allocator, db);
+}
+
+test "cdb: Should commit writers in transaction" {
+    try testInit();
+    defer testDeinit();
+
+    const db = try cdb.createDb("Test");
+    defer cdb.destroyDb(db);
+
+    const type_hash = try cdb.addType(
+        db,
+        "foo",
+        &.{
+            .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.U64 },
+        },
+    );
+    const type_hash2 = try cdb.addType(
+        db,
+        "foo2",
+        &.{
+            .{ .prop_idx = 0, .name = "prop1", .type = public.PropType.U64 },
+        },
+    );
+
+    var objs: [8]cdb.ObjId = undefined;
+    for (&objs, 0..) |*obj, idx| {
+        obj.* = try cdb.createObject(db, if (idx % 2 == 0) type_hash else type_hash2);
+    }
+
+    const version_1 = (try cdb.getChangeObjects(std.testing.allocator, db, type_hash, 0)).last_version;
+    const version_2 = (try cdb.getChangeObjects(std.testing.allocator, db, type_hash2, 0)).last_version;
+
+    // Commit
+    {
+        const tx = try cdb.beginTransaction(db);
+        for (objs, 0..) |obj, idx| {
+            const w = cdb.transactionWriteObj(tx, obj).?;
+            cdb.setValue(u64, w, 0, idx + 1);
+
+            // Same object same writer.
+            try std.testing.expectEqual(w, cdb.transactionWriteObj(tx, obj).?);
+        }
+        try cdb.commitTransaction(tx);
+    }
+
+    for (objs, 0..) |obj, idx| {
+        try std.testing.expectEqual(@as(u64, idx + 1), cdb.readValue(u64, cdb.readObj(obj).?, 0));
+    }
+
+    const changed_1 = try cdb.getChangeObjects(std.testing.allocator, db, type_hash, version_1);
+    defer std.testing.allocator.free(changed_1.objects);
+    try std.testing.expectEqual(version_1 + 1, changed_1.last_version);
+    try std.testing.expectEqualSlices(public.ObjId, &.{ objs[0], objs[2], objs[4], objs[6] }, changed_1.objects);
+
+    const changed_2 = try cdb.getChangeObjects(std.testing.allocator, db, type_hash2, version_2);
+    defer std.testing.allocator.free(changed_2.objects);
+    try std.testing.expectEqual(version_2 + 1, changed_2.last_version);
+    try std.testing.expectEqualSlices(public.ObjId, &.{ objs[1], objs[3], objs[5], objs[7] }, changed_2.objects);
+
+    // Abort
+    {
+        const tx = try cdb.beginTransaction(db);
+        for (objs) |obj| {
+            const w = cdb.transactionWriteObj(tx, obj).?;
+            cdb.setValue(u64, w, 0, 666);
+        }
+        cdb.abortTransaction(tx);
+    }
+
+    for (objs, 0..) |obj, idx| {
+        try std.testing.expectEqual(@as(u64, idx + 1), cdb.readValue(u64, cdb.readObj(obj).?, 0));
+    }
+
+    for (objs) |obj| cdb.destroyObject(obj);
+    try cdb.gc(std.testing.allocator, db);
+}
+
 test "cdb: Should get object realtion" {
     try testInit();
     defer testDeinit();
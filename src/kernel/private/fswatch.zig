@@ -0,0 +1,645 @@
+//! File watch service.
+//!
+//! Watch directory trees and deliver debounced and coalesced change events to subscriber.
+//! Events for same path are merged and delivered only after path is quiet for `debounce_ms`.
+//! On Linux it use inotify, elsewhere or if inotify can not be used it poll size and mtime of files.
+//! All functions must be called from same thread, callbacks are called from `update`.
+
+const std = @import("std");
+const builtin = @import("builtin");
+
+const cetech1 = @import("cetech1");
+const profiler = cetech1.profiler;
+
+const linux = std.os.linux;
+
+const module_name = .fswatch;
+const log = std.log.scoped(module_name);
+
+/// Polling interval of watch without inotify.
+const POLL_INTERVAL_MS = 500;
+
+const INOTIFY_MASK = linux.IN.CLOSE_WRITE | linux.IN.MOVED_TO | linux.IN.MOVED_FROM | linux.IN.CREATE | linux.IN.DELETE;
+
+pub const EventKind = enum {
+    changed,
+    removed,
+
+    /// Directory is removed or moved away, path is directory and everything under it is gone.
+    dir_removed,
+};
+
+pub const Event = struct {
+    /// Path relative to watched root.
+    path: []const u8,
+    kind: EventKind,
+};
+
+/// Callback return `error.WatchBusy` if it can not process events now, same events are delivered again in next update.
+pub const OnChangeFn = *const fn (ctx: ?*anyopaque, root_path: []const u8, events: []const Event) anyerror!void;
+
+pub const WatchId = u32;
+
+pub const WatchOptions = struct {
+    /// Watch subdirs too.
+    recursive: bool = true,
+
+    /// Skip files and dirs that start with `.`.
+    skip_hidden: bool = true,
+
+    /// Deliver event only after path is quiet for this time.
+    debounce_ms: i64 = 50,
+};
+
+const Backend = enum {
+    inotify,
+    poll,
+};
+
+const FileState = struct {
+    size: u64,
+    mtime: i96,
+};
+
+const Pending = struct {
+    kind: EventKind,
+    last_ns: i96,
+};
+
+const FileStateMap = std.StringArrayHashMapUnmanaged(FileState);
+const PendingMap = std.StringArrayHashMapUnmanaged(Pending);
+const Wd2Dir = cetech1.AutoArrayHashMap(i32, []u8);
+
+const Watch = struct {
+    id: WatchId,
+    root_path: []u8,
+    options: WatchOptions,
+    ctx: ?*anyopaque,
+    on_change: OnChangeFn,
+
+    backend: Backend,
+
+    // inotify
+    fd: i32 = -1,
+    wd2dir: Wd2Dir = .empty,
+
+    // poll
+    files: FileStateMap = .{},
+    last_poll_ns: i96 = 0,
+
+    pending: PendingMap = .{},
+};
+
+var _allocator: std.mem.Allocator = undefined;
+var _io: std.Io = undefined;
+var _watches: cetech1.ArrayList(*Watch) = undefined;
+var _next_id: WatchId = 1;
+
+pub fn init(io: std.Io, allocator: std.mem.Allocator) !void {
+    _allocator = allocator;
+    _io = io;
+    _watches = .empty;
+    _next_id = 1;
+}
+
+pub fn deinit() void {
+    for (_watches.items) |w| destroyWatch(w);
+    _watches.deinit(_allocator);
+}
+
+/// Start watching `root_path`. `on_change` is called from `update` with all events that are ready.
+pub fn watch(root_path: []const u8, options: WatchOptions, ctx: ?*anyopaque, on_change: OnChangeFn) !WatchId {
+    var zone_ctx = profiler.ZoneN(@src(), "fswatch.watch");
+    defer zone_ctx.End();
+
+    const owned_root_path = try _allocator.dupe(u8, root_path);
+    errdefer _allocator.free(owned_root_path);
+
+    const w = try _allocator.create(Watch);
+    w.* = .{
+        .id = _next_id,
+        .root_path = owned_root_path,
+        .options = options,
+        .ctx = ctx,
+        .on_change = on_change,
+        .backend = .poll,
+    };
+    errdefer {
+        closeInotify(w);
+        for (w.files.keys()) |k| _allocator.free(k);
+        w.files.deinit(_allocator);
+        _allocator.destroy(w);
+    }
+
+    if (builtin.os.tag == .linux) {
+        if (initInotify(w)) {
+            w.backend = .inotify;
+        } else |err| {
+            log.warn("Could not use inotify for {s}, fallback to polling: {}", .{ root_path, err });
+            closeInotify(w);
+        }
+    }
+
+    if (w.backend == .poll) {
+        try scanFiles(w, "", &w.files);
+        w.last_poll_ns = nowNs();
+    }
+
+    try _watches.append(_allocator, w);
+    _next_id += 1;
+
+    log.debug("Watching {s} with {s}", .{ root_path, @tagName(w.backend) });
+    return w.id;
+}
+
+pub fn unwatch(id: WatchId) void {
+    for (_watches.items, 0..) |w, idx| {
+        if (w.id != id) continue;
+        _ = _watches.orderedRemove(idx);
+        destroyWatch(w);
+        return;
+    }
+}
+
+/// Read changes and call subscribers with events that are ready. Call it once per tick.
+pub fn update(allocator: std.mem.Allocator) !void {
+    var zone_ctx = profiler.ZoneN(@src(), "fswatch.update");
+    defer zone_ctx.End();
+
+    const now = nowNs();
+
+    var events = cetech1.ArrayList(Event).empty;
+    defer events.deinit(allocator);
+
+    // Callback can unwatch so iterate over ids.
+    const ids = try allocator.alloc(WatchId, _watches.items.len);
+    defer allocator.free(ids);
+    for (_watches.items, ids) |w, *id| id.* = w.id;
+
+    for (ids) |id| {
+        const w = findWatch(id) orelse continue;
+
+        switch (w.backend) {
+            .inotify => readInotify(w) catch |err| {
+                log.err("Could not read changes for {s}: {}", .{ w.root_path, err });
+            },
+            .poll => if (now - w.last_poll_ns >= POLL_INTERVAL_MS * std.time.ns_per_ms) {
+                w.last_poll_ns = now;
+                pollFiles(w) catch |err| {
+                    log.err("Could not poll changes for {s}: {}", .{ w.root_path, err });
+                };
+            },
+        }
+
+        if (w.pending.count() == 0) continue;
+
+        // Collect quiet paths.
+        events.clearRetainingCapacity();
+        const debounce_ns = w.options.debounce_ms * std.time.ns_per_ms;
+        for (w.pending.keys(), w.pending.values()) |path, pending| {
+            if (now - pending.last_ns < debounce_ns) continue;
+            try events.append(allocator, .{ .path = path, .kind = pending.kind });
+        }
+
+        if (events.items.len == 0) continue;
+
+        w.on_change(w.ctx, w.root_path, events.items) catch |err| switch (err) {
+            error.WatchBusy => continue,
+            else => log.err("Watch callback for {s} failed: {}", .{ w.root_path, err }),
+        };
+
+        // Watch could be removed in callback and its paths are freed.
+        const still_w = findWatch(id) orelse continue;
+        for (events.items) |event| {
+            const kv = still_w.pending.fetchSwapRemove(event.path) orelse continue;
+            _allocator.free(kv.key);
+        }
+    }
+}
+
+fn findWatch(id: WatchId) ?*Watch {
+    for (_watches.items) |w| {
+        if (w.id == id) return w;
+    }
+    return null;
+}
+
+fn destroyWatch(w: *Watch) void {
+    closeInotify(w);
+
+    for (w.files.keys()) |k| _allocator.free(k);
+    w.files.deinit(_allocator);
+
+    for (w.pending.keys()) |k| _allocator.free(k);
+    w.pending.deinit(_allocator);
+
+    _allocator.free(w.root_path);
+    _allocator.destroy(w);
+}
+
+fn nowNs() i96 {
+    return std.Io.Timestamp.now(_io, .awake).nanoseconds;
+}
+
+fn isSkipped(w: *const Watch, name: []const u8) bool {
+    return w.options.skip_hidden and std.mem.startsWith(u8, name, ".");
+}
+
+// Last event for path win, changed and removed are all subscriber need.
+fn addPending(w: *Watch, path: []const u8, kind: EventKind) !void {
+    const entry = try w.pending.getOrPut(_allocator, path);
+    if (!entry.found_existing) {
+        entry.key_ptr.* = _allocator.dupe(u8, path) catch |err| {
+            _ = w.pending.swapRemove(path);
+            return err;
+        };
+    }
+    entry.value_ptr.* = .{ .kind = kind, .last_ns = nowNs() };
+}
+
+fn openDir(w: *const Watch, rel_dir: []const u8) !std.Io.Dir {
+    var root_dir = try std.Io.Dir.cwd().openDir(_io, w.root_path, .{ .iterate = true });
+    if (rel_dir.len == 0) return root_dir;
+    defer root_dir.close(_io);
+    return root_dir.openDir(_io, rel_dir, .{ .iterate = true });
+}
+
+//
+// Inotify
+//
+fn sysResult(rc: usize) !usize {
+    return switch (linux.E.init(rc)) {
+        .SUCCESS => rc,
+        .AGAIN => error.WouldBlock,
+        .NOSPC => error.WatchLimitReached,
+        .MFILE, .NFILE => error.ProcessFdQuotaExceeded,
+        .NOENT => error.FileNotFound,
+        else => error.Unexpected,
+    };
+}
+
+fn initInotify(w: *Watch) !void {
+    w.fd = @intCast(try sysResult(linux.inotify_init1(linux.IN.NONBLOCK | linux.IN.CLOEXEC)));
+    try addDirWatches(w, "", false);
+}
+
+fn closeInotify(w: *Watch) void {
+    if (w.fd >= 0) {
+        _ = linux.close(w.fd);
+        w.fd = -1;
+    }
+
+    for (w.wd2dir.values()) |v| _allocator.free(v);
+    w.wd2dir.deinit(_allocator);
+    w.wd2dir = .empty;
+}
+
+// Add watch for dir and its subdirs. Files in new dir are reported if `report_files` is set.
+fn addDirWatches(w: *Watch, rel_dir: []const u8, report_files: bool) !void {
+    const path = try std.fs.path.joinZ(_allocator, &.{ w.root_path, rel_dir });
+    defer _allocator.free(path);
+
+    const wd: i32 = @intCast(try sysResult(linux.inotify_add_watch(w.fd, path, INOTIFY_MASK | linux.IN.ONLYDIR)));
+
+    const entry = try w.wd2dir.getOrPut(_allocator, wd);
+    if (entry.found_existing) _allocator.free(entry.value_ptr.*);
+    entry.value_ptr.* = try _allocator.dupe(u8, rel_dir);
+
+    if (!w.options.recursive and !report_files) return;
+
+    var dir = try openDir(w, rel_dir);
+    defer dir.close(_io);
+
+    var it = dir.iterate();
+    while (try it.next(_io)) |e| {
+        if (isSkipped(w, e.name)) continue;
+
+        const rel_path = try std.fs.path.join(_allocator, &.{ rel_dir, e.name });
+        defer _allocator.free(rel_path);
+
+        switch (e.kind) {
+            .directory => if (w.options.recursive) try addDirWatches(w, rel_path, report_files),
+            .file => if (report_files) try addPending(w, rel_path, .changed),
+            else => {},
+        }
+    }
+}
+
+// Remove watches of dir and its subdirs.
+fn removeDirWatches(w: *Watch, rel_dir: []const u8) void {
+    var idx: usize = 0;
+    while (idx < w.wd2dir.count()) {
+        const dir = w.wd2dir.values()[idx];
+        const in_subtree = std.mem.startsWith(u8, dir, rel_dir) and (dir.len == rel_dir.len or dir[rel_dir.len] == std.fs.path.sep);
+        if (!in_subtree) {
+            idx += 1;
+            continue;
+        }
+
+        // Watch of deleted dir is already removed by kernel.
+        _ = linux.inotify_rm_watch(w.fd, w.wd2dir.keys()[idx]);
+        _allocator.free(dir);
+        w.wd2dir.swapRemoveAt(idx);
+    }
+}
+
+fn readInotify(w: *Watch) !void {
+    var buf: [16 * 1024]u8 align(@alignOf(linux.inotify_event)) = undefined;
+
+    while (true) {
+        const len = sysResult(linux.read(w.fd, &buf, buf.len)) catch |err| switch (err) {
+            error.WouldBlock => return,
+            else => return err,
+        };
+        if (len == 0) return;
+
+        var offset: usize = 0;
+        while (offset < len) {
+            const event: *const linux.inotify_event = @ptrCast(@alignCast(&buf[offset]));
+            const name_start = offset + @sizeOf(linux.inotify_event);
+            const name = std.mem.sliceTo(buf[name_start .. name_start + event.len], 0);
+            offset = name_start + event.len;
+
+            try handleInotifyEvent(w, event.*, name);
+        }
+    }
+}
+
+fn handleInotifyEvent(w: *Watch, event: linux.inotify_event, name: []const u8) !void {
+    // Lost events, report everything.
+    if (event.mask & linux.IN.Q_OVERFLOW != 0) {
+        log.warn("Watch queue overflow for {s}", .{w.root_path});
+        try addDirWatches(w, "", true);
+        return;
+    }
+
+    if (event.mask & linux.IN.IGNORED != 0) {
+        if (w.wd2dir.fetchSwapRemove(event.wd)) |kv| _allocator.free(kv.value);
+        return;
+    }
+
+    if (name.len == 0 or isSkipped(w, name)) return;
+    const rel_dir = w.wd2dir.get(event.wd) orelse return;
+
+    const rel_path = try std.fs.path.join(_allocator, &.{ rel_dir, name });
+    defer _allocator.free(rel_path);
+
+    if (event.mask & linux.IN.ISDIR != 0) {
+        if (event.mask & (linux.IN.DELETE | linux.IN.MOVED_FROM) != 0) {
+            // Moved dir keep its watches, events from new place would be reported with old path.
+            removeDirWatches(w, rel_path);
+            try addPending(w, rel_path, .dir_removed);
+        } else if (w.options.recursive and event.mask & (linux.IN.CREATE | linux.IN.MOVED_TO) != 0) {
+            // Dir moved or created with content.
+            addDirWatches(w, rel_path, true) catch |err| {
+                log.warn("Could not watch {s}: {}", .{ rel_path, err });
+            };
+        }
+        return;
+    }
+
+    if (event.mask & (linux.IN.DELETE | linux.IN.MOVED_FROM) != 0) {
+        try addPending(w, rel_path, .removed);
+    } else if (event.mask & (linux.IN.CLOSE_WRITE | linux.IN.MOVED_TO) != 0) {
+        try addPending(w, rel_path, .changed);
+    }
+}
+
+//
+// Poll
+//
+fn scanFiles(w: *Watch, rel_dir: []const u8, files: *FileStateMap) !void {
+    var dir = openDir(w, rel_dir) catch |err| switch (err) {
+        error.FileNotFound => return,
+        else => return err,
+    };
+    defer dir.close(_io);
+
+    var it = dir.iterate();
+    while (try it.next(_io)) |e| {
+        if (isSkipped(w, e.name)) continue;
+
+        const rel_path = try std.fs.path.join(_allocator, &.{ rel_dir, e.name });
+
+        switch (e.kind) {
+            .directory => {
+                defer _allocator.free(rel_path);
+                if (w.options.recursive) try scanFiles(w, rel_path, files);
+            },
+            .file => {
+                errdefer _allocator.free(rel_path);
+                const stat = dir.statFile(_io, e.name, .{}) catch {
+                    _allocator.free(rel_path);
+                    continue;
+                };
+                try files.put(_allocator, rel_path, .{ .size = stat.size, .mtime = stat.mtime.nanoseconds });
+            },
+            else => _allocator.free(rel_path),
+        }
+    }
+}
+
+fn pollFiles(w: *Watch) !void {
+    var files = FileStateMap{};
+    errdefer {
+        for (files.keys()) |k| _allocator.free(k);
+        files.deinit(_allocator);
+    }
+    try scanFiles(w, "", &files);
+
+    for (files.keys(), files.values()) |path, state| {
+        const old = w.files.get(path);
+        if (old == null or old.?.size != state.size or old.?.mtime != state.mtime) {
+            try addPending(w, path, .changed);
+        }
+    }
+
+    for (w.files.keys()) |path| {
+        if (!files.contains(path)) try addPending(w, path, .removed);
+    }
+
+    for (w.files.keys()) |k| _allocator.free(k);
+    w.files.deinit(_allocator);
+    w.files = files;
+}
+
+test "fswatch: Should report debounced changes" {
+    const io = std.testing.io;
+
+    try init(io, std.testing.allocator);
+    defer deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_path = try tmp_dir.dir.realPathFileAlloc(io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_path);
+
+    try tmp_dir.dir.createDirPath(io, "sub");
+
+    const Collector = struct {
+        changed: usize = 0,
+        removed: usize = 0,
+        dir_removed: usize = 0,
+
+        fn onChange(ctx: ?*anyopaque, root: []const u8, events: []const Event) !void {
+            _ = root;
+            const self: *@This() = @ptrCast(@alignCast(ctx.?));
+            for (events) |event| {
+                if (!std.mem.eql(u8, std.fs.path.basename(event.path), "foo.txt")) continue;
+                switch (event.kind) {
+                    .changed => self.changed += 1,
+                    .removed => self.removed += 1,
+                    .dir_removed => {},
+                }
+            }
+        }
+    };
+    var collector = Collector{};
+
+    _ = try watch(root_path, .{ .debounce_ms = 10 }, &collector, Collector.onChange);
+
+    // Hidden files are skipped.
+    {
+        var f = try tmp_dir.dir.createFile(io, ".hidden", .{});
+        f.close(io);
+    }
+
+    // Many writes are one event.
+    for (0..3) |_| {
+        var f = try tmp_dir.dir.createFile(io, "sub/foo.txt", .{});
+        try f.writePositionalAll(io, "hello", 0);
+        f.close(io);
+    }
+
+    const deadline = nowNs() + 5 * std.time.ns_per_s;
+    while (collector.changed == 0 and nowNs() < deadline) {
+        try update(std.testing.allocator);
+        try std.Io.sleep(io, .fromNanoseconds(5 * std.time.ns_per_ms), .awake);
+    }
+    try std.testing.expectEqual(@as(usize, 1), collector.changed);
+
+    try tmp_dir.dir.deleteFile(io, "sub/foo.txt");
+    while (collector.removed == 0 and nowNs() < deadline) {
+        try update(std.testing.allocator);
+        try std.Io.sleep(io, .fromNanoseconds(5 * std.time.ns_per_ms), .awake);
+    }
+    try std.testing.expectEqual(@as(usize, 1), collector.removed);
+}
+
+test "fswatch: Should deliver events again if callback is busy" {
+    const io = std.testing.io;
+
+    try init(io, std.testing.allocator);
+    defer deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_path = try tmp_dir.dir.realPathFileAlloc(io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_path);
+
+    const Collector = struct {
+        busy: usize = 2,
+        calls: usize = 0,
+        changed: usize = 0,
+
+        fn onChange(ctx: ?*anyopaque, root: []const u8, events: []const Event) !void {
+            _ = root;
+            const self: *@This() = @ptrCast(@alignCast(ctx.?));
+            self.calls += 1;
+            if (self.busy != 0) {
+                self.busy -= 1;
+                return error.WatchBusy;
+            }
+            for (events) |event| {
+                if (event.kind == .changed and std.mem.eql(u8, event.path, "foo.txt")) self.changed += 1;
+            }
+        }
+    };
+    var collector = Collector{};
+
+    _ = try watch(root_path, .{ .debounce_ms = 10 }, &collector, Collector.onChange);
+
+    {
+        var f = try tmp_dir.dir.createFile(io, "foo.txt", .{});
+        try f.writePositionalAll(io, "hello", 0);
+        f.close(io);
+    }
+
+    const deadline = nowNs() + 5 * std.time.ns_per_s;
+    while (collector.changed == 0 and nowNs() < deadline) {
+        try update(std.testing.allocator);
+        try std.Io.sleep(io, .fromNanoseconds(5 * std.time.ns_per_ms), .awake);
+    }
+    try std.testing.expectEqual(@as(usize, 3), collector.calls);
+    try std.testing.expectEqual(@as(usize, 1), collector.changed);
+}
+
+test "fswatch: Should report renamed directory" {
+    if (builtin.os.tag != .linux) return error.SkipZigTest;
+
+    const io = std.testing.io;
+
+    try init(io, std.testing.allocator);
+    defer deinit();
+
+    var tmp_dir = std.testing.tmpDir(.{});
+    defer tmp_dir.cleanup();
+    const root_path = try tmp_dir.dir.realPathFileAlloc(io, ".", std.testing.allocator);
+    defer std.testing.allocator.free(root_path);
+
+    try tmp_dir.dir.createDirPath(io, "old/sub");
+    {
+        var f = try tmp_dir.dir.createFile(io, "old/sub/foo.txt", .{});
+        f.close(io);
+    }
+
+    const Collector = struct {
+        dir_removed: usize = 0,
+        new_changed: usize = 0,
+        old_changed: usize = 0,
+
+        fn onChange(ctx: ?*anyopaque, root: []const u8, events: []const Event) !void {
+            _ = root;
+            const self: *@This() = @ptrCast(@alignCast(ctx.?));
+            for (events) |event| {
+                switch (event.kind) {
+                    .dir_removed => {
+                        if (std.mem.eql(u8, event.path, "old")) self.dir_removed += 1;
+                    },
+                    .changed => {
+                        if (std.mem.startsWith(u8, event.path, "new")) self.new_changed += 1;
+                        if (std.mem.startsWith(u8, event.path, "old")) self.old_changed += 1;
+                    },
+                    .removed => {},
+                }
+            }
+        }
+    };
+    var collector = Collector{};
+
+    const id = try watch(root_path, .{ .debounce_ms = 10 }, &collector, Collector.onChange);
+    if (findWatch(id).?.backend != .inotify) return error.SkipZigTest;
+
+    try tmp_dir.dir.rename("old", tmp_dir.dir, "new", io);
+
+    const deadline = nowNs() + 5 * std.time.ns_per_s;
+    while ((collector.dir_removed == 0 or collector.new_changed == 0) and nowNs() < deadline) {
+        try update(std.testing.allocator);
+        try std.Io.sleep(io, .fromNanoseconds(5 * std.time.ns_per_ms), .awake);
+    }
+    try std.testing.expectEqual(@as(usize, 1), collector.dir_removed);
+    try std.testing.expectEqual(@as(usize, 1), collector.new_changed);
+
+    // Watches of old path are removed so write in moved dir is reported with new path.
+    {
+        var f = try tmp_dir.dir.createFile(io, "new/sub/foo.txt", .{});
+        try f.writePositionalAll(io, "hello", 0);
+        f.close(io);
+    }
+    while (collector.new_changed < 2 and nowNs() < deadline) {
+        try update(std.testing.allocator);
+        try std.Io.sleep(io, .fromNanoseconds(5 * std.time.ns_per_ms), .awake);
+    }
+    try std.testing.expectEqual(@as(usize, 2), collector.new_changed);
+    try std.testing.expectEqual(@as(usize, 0), collector.old_changed);
+}
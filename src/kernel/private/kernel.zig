@@ -14,6 +14,7 @@ const uuid_private = @import("uuid.zig");
 const assetdb_private = @import("assetdb.zig");
 const host_private = @import("host.zig");
 const input_private = @import("input.zig");
+const fswatch_private = @import("fswatch.zig");
 const gpu_privat = @import("gpu.zig");
 const coreui_private = @import("../../coreui/private/coreui.zig");
 const ecs_private = @import("../../ecs/private/ecs.zig");
@@ -176,6 +177,7 @@ var _tmp_alocator_pool_allocator: profiler.AllocatorProfiler = undefined;
 var _ecs_allocator: profiler.AllocatorProfiler = undefined;
 var _actions_allocator: profiler.AllocatorProfiler = undefined;
 var _metrics_allocator: profiler.AllocatorProfiler = undefined;
+var _fswatch_allocator: profiler.AllocatorProfiler = undefined;
 
 var _update_dag: cetech1.dag.StrId64DAG = undefined;
 
@@ -298,6 +300,7 @@ pub fn init(io: std.Io, allocator: std.mem.Allocator, headless: bool, boot_args:
     _ecs_allocator = profiler.AllocatorProfiler.init(_kernel_allocator, "ecs");
     _actions_allocator = profiler.AllocatorProfiler.init(_kernel_allocator, "actions");
     _metrics_allocator = profiler.AllocatorProfiler.init(_kernel_allocator, "metrics");
+    _fswatch_allocator = profiler.AllocatorProfiler.init(_kernel_allocator, "fswatch");
 
     _update_dag = cetech1.dag.StrId64DAG.init(_kernel_allocator);
     _phases_dag = cetech1.dag.StrId64DAG.init(_kernel_allocator);
@@ -316,8 +319,10 @@ pub fn init(io: std.Io, allocator: std.mem.Allocator, headless: bool, boot_args:
     try tempalloc_private.init(_tmp_alocator_pool_allocator.allocator(), 256);
 
     try apidb_private.init(_apidb_allocator.allocator());
+    try fswatch_private.init(io, _fswatch_allocator.allocator());
     try modules_private.init(_modules_allocator.allocator(), boot_args.ignored_modules, boot_args.ignored_modules_prefix);
     try metrics.init(_metrics_allocator.allocator());
+    try task_private.initMetrics();
     try cdb_private.init(io, _cdb_allocator.allocator());
     try host_private.init(io, _host_allocator.allocator(), headless);
     try input_private.init(_input_allocator.allocator());
@@ -371,6 +376,7 @@ pub fn deinit(io: std.Io, allocator: std.mem.Allocator) !void {
 
     assetdb_private.deinit();
     modules_private.deinit();
+    fswatch_private.deinit();
 
     task_private.stop();
 
@@ -608,6 +614,12 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
         _running = true;
         _quit = false;
 
+        // Only cook asset snapshot and quit.
+        if (asset_root.len != 0 and 1 == getIntArgs("--cook-snapshot") orelse 0) {
+            try cetech1.assetdb.cookAssetRootSnapshot(asset_root, _assetdb_allocator.allocator());
+            break;
+        }
+
         // If asset root is set open it.
         if (asset_root.len != 0 or _next_asset_root != null) {
             try cetech1.assetdb.openAssetRootFolder(
@@ -673,7 +685,6 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
         // Register OS signals
         try registerSignals();
 
-        var checkfs_timer: i64 = 0;
         const dt_couter = try metrics.getCounter("kernel/dt");
         const tick_duration_counter = try metrics.getCounter("kernel/tick_duration");
 
@@ -682,6 +693,9 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
 
         var game_tick: usize = 0;
 
+        const jitter_counter = try metrics.getCounter("kernel/pacing_jitter");
+        var frame_pacer = FramePacer.init(process_init.io);
+
         var frame_arena = std.heap.ArenaAllocator.init(_main_profiler_allocator.allocator());
         defer frame_arena.deinit();
 
@@ -701,19 +715,15 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
 
             dt_couter.* = @floatFromInt(kernel_dt_ms);
 
-            checkfs_timer += kernel_dt_ms;
-
             _ = frame_arena.reset(.retain_capacity);
             const tmp_frame_alloc = frame_arena.allocator();
 
-            // Any dynamic modules changed?
-            // TODO: Watch
-            if (checkfs_timer >= (10 * std.time.ms_per_s)) {
-                checkfs_timer = 0;
+            // Deliver file changes to watchers (modules, asset root).
+            try fswatch_private.update(tmp_frame_alloc);
 
-                const reloaded_modules = try modules_private.reloadAllIfNeeded(process_init.io, tmp_frame_alloc);
-                if (reloaded_modules) {}
-            }
+            // Any dynamic modules changed?
+            const reloaded_modules = try modules_private.reloadChangedModules(process_init.io, tmp_frame_alloc);
+            if (reloaded_modules) {}
 
             // Any public.KernelTaskI iface changed? (add/remove)?
             const new_kernel_gen = apidb.getInterafcesVersion(public.KernelTaskI);
@@ -734,14 +744,10 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
             const GameTickTask = struct {
                 kernel_tick: u64,
                 dt_s: f32,
-                fast_mode: bool,
-                io: *const std.Io,
 
                 pub fn exec(self: *@This()) !void {
                     profiler.frameMark();
 
-                    const call_time: std.Io.Timestamp = .now(self.io.*, .awake);
-
                     var task_zone_ctx = profiler.ZoneN(@src(), "GameTick");
                     defer task_zone_ctx.End();
 
@@ -754,12 +760,9 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
                     // clean main DB
                     try cdb.gc(allocator, assetdb_private.getDb());
 
+                    task_private.updateMetrics();
+                    task_private.newFrame();
                     try metrics.pushFrames();
-
-                    if (!(isTestigMode() and self.fast_mode)) {
-                        const t = try sleepIfNeed(self.io, allocator, call_time, _max_tick_rate, task.getThreadNum() - 1);
-                        task.wait(t);
-                    }
                 }
             };
 
@@ -771,7 +774,15 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
                     );
                     _next_asset_root = null;
                 } else {
+                    if (!(isTestigMode() and fast_mode) and !frame_pacer.isTickDue(process_init.io, _max_tick_rate)) {
+                        // Only main loop wait, workers are free for background work.
+                        frame_pacer.wait(process_init.io);
+                    }
+
                     const noww = std.Io.Timestamp.now(process_init.io, .awake);
+                    frame_pacer.tickStarted(noww, _max_tick_rate);
+                    jitter_counter.* = frame_pacer.jitterMs();
+
                     const game_dt_ms = game_tick_last_call.durationTo(noww).toMilliseconds();
                     const game_dt_s: f32 = @as(f32, @floatFromInt(game_dt_ms)) / std.time.ms_per_s;
                     game_tick_last_call = noww;
@@ -781,10 +792,8 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
                         GameTickTask{
                             .dt_s = game_dt_s,
                             .kernel_tick = kernel_tick,
-                            .fast_mode = fast_mode,
-                            .io = &process_init.io,
                         },
-                        .{},
+                        .{ .priority = .frame_critical },
                     );
                     last_game_tick_task = t;
                     // task.api.wait(t);
@@ -863,40 +872,66 @@ pub fn boot(process_init: std.process.Init, static_modules: []const cetech1.modu
     }
 }
 
-fn sleepIfNeed(io: *const std.Io, allocator: std.mem.Allocator, last_call: std.Io.Timestamp, max_rate: u32, worker_n: u64) !cetech1.task.TaskID {
-    const frame_limit_time: f32 = (1.0 / @as(f32, @floatFromInt(max_rate)) * std.time.ms_per_s);
+/// Pace game ticks to max tick rate.
+/// Only main loop sleep so workers can drain background work during frame slack.
+const FramePacer = struct {
+    const Self = @This();
 
-    const dt: f32 = @floatFromInt(last_call.durationTo(.now(io.*, .awake)).toMilliseconds());
-    if (dt < frame_limit_time) {
-        const sleep_time: u64 = @intFromFloat((frame_limit_time - dt) * 0.62 * std.time.ns_per_ms);
+    // OS sleep can oversleep so last part before deadline is spin-waited.
+    const spin_threshold_ns = 1 * std.time.ns_per_ms;
 
-        const n = worker_n;
-        var wait_tasks = try cetech1.task.TaskIdList.initCapacity(allocator, n);
-        defer wait_tasks.deinit(allocator);
+    next_tick_ns: i96,
+    deadline_ns: i96 = 0,
+    remaining_ns: i96 = 0,
+    jitter_ns: i96 = 0,
 
-        for (0..n) |idx| {
-            const SleepTask = struct {
-                sleep_time: u64,
-                io: *const std.Io,
-                pub fn exec(self: *@This()) !void {
-                    var task_zone_ctx = profiler.ZoneN(@src(), "ShityFrameLimitSleeper");
-                    defer task_zone_ctx.End();
-                    try std.Io.sleep(self.io.*, .fromNanoseconds(self.sleep_time), .awake);
-                }
-            };
-            const t = try task.schedule(
-                .none,
-                SleepTask{ .sleep_time = sleep_time, .io = io },
-                .{ .affinity = @intCast(idx + 1) },
-            );
-            wait_tasks.appendAssumeCapacity(t);
+    pub fn init(io: std.Io) Self {
+        return .{ .next_tick_ns = std.Io.Timestamp.now(io, .awake).nanoseconds };
+    }
+
+    fn periodNs(max_rate: u32) i96 {
+        return @divTrunc(std.time.ns_per_s, @max(1, max_rate));
+    }
+
+    pub fn isTickDue(self: *Self, io: std.Io, max_rate: u32) bool {
+        const now_ns = std.Io.Timestamp.now(io, .awake).nanoseconds;
+
+        // Rate was increased => do not wait for old deadline.
+        self.remaining_ns = @min(self.next_tick_ns - now_ns, periodNs(max_rate));
+        self.deadline_ns = now_ns + self.remaining_ns;
+        return self.remaining_ns <= 0;
+    }
+
+    /// Wait until deadline from last isTickDue().
+    /// Sleep most of remaining time and spin the rest.
+    pub fn wait(self: *Self, io: std.Io) void {
+        var zone_ctx = profiler.ZoneN(@src(), "FramePacer - wait");
+        defer zone_ctx.End();
+
+        if (self.remaining_ns > spin_threshold_ns) {
+            std.Io.sleep(io, .fromNanoseconds(@intCast(self.remaining_ns - spin_threshold_ns)), .awake) catch undefined;
         }
 
-        return task.combine(wait_tasks.items);
+        while (std.Io.Timestamp.now(io, .awake).nanoseconds < self.deadline_ns) {
+            std.atomic.spinLoopHint();
+        }
     }
 
-    return .none;
-}
+    pub fn tickStarted(self: *Self, now: std.Io.Timestamp, max_rate: u32) void {
+        const period = periodNs(max_rate);
+        const late_ns = now.nanoseconds - self.next_tick_ns;
+
+        self.jitter_ns = @intCast(@abs(late_ns));
+
+        // Keep deadlines on grid so error does not accumulate.
+        // If we are behind more than one period start new grid from now.
+        self.next_tick_ns = if (late_ns > period) now.nanoseconds + period else self.next_tick_ns + period;
+    }
+
+    pub fn jitterMs(self: *const Self) f64 {
+        return @as(f64, @floatFromInt(self.jitter_ns)) / std.time.ns_per_ms;
+    }
+};
 
 fn addPhase(name: [:0]const u8, depend: []const cetech1.StrId64) !void {
     const name_hash = cetech1.strId64(name);
@@ -1033,7 +1068,7 @@ fn doKernelUpdateTasks(kernel_tick: u64, dt: f32) !void {
                     .kernel_tick = kernel_tick,
                     .dt = dt,
                 },
-                .{ .affinity = update_handler.affinity },
+                .{ .affinity = update_handler.affinity, .priority = .frame_critical },
             );
             try _tmp_taskid_map.put(_kernel_allocator, task_strid, job_id);
         }
@@ -11,6 +11,8 @@ const cetech1 = @import("cetech1");
 const public = cetech1.modules;
 const profiler = cetech1.profiler;
 
+const fswatch = @import("fswatch.zig");
+
 const module_name = .modules;
 
 const MODULE_PREFIX = "ct_";
@@ -51,6 +53,10 @@ var _modules_map: ModuleHashMap = undefined;
 var _dyn_modules_map: DynModuleHashMap = undefined;
 var _modules_allocator_map: ModuleAlocatorMap = undefined;
 
+// Basenames of dynamic modules changed on disk.
+var _changed_modules: std.StringArrayHashMapUnmanaged(void) = undefined;
+var _modules_watch: ?fswatch.WatchId = null;
+
 var _ignored_modules: ?[]const []const u8 = null;
 var _ignored_modules_prefix: ?[]const []const u8 = null;
 
@@ -75,11 +81,18 @@ pub fn init(allocator: Allocator, ignored_modules: ?[]const []const u8, ignored_
     _dyn_modules_map = .{};
     _modules_map = .{};
     _modules_allocator_map = .{};
+    _changed_modules = .{};
+    _modules_watch = null;
     _ignored_modules = ignored_modules;
     _ignored_modules_prefix = ignored_modules_prefix;
 }
 
 pub fn deinit() void {
+    if (_modules_watch) |id| fswatch.unwatch(id);
+
+    for (_changed_modules.keys()) |k| _allocator.free(k);
+    _changed_modules.deinit(_allocator);
+
     for (_modules_allocator_map.values()) |value| {
         _allocator.destroy(value);
     }
@@ -285,12 +298,43 @@ pub fn loadDynModules(io: std.Io) !void {
             try addDynamicModule(.{ .name = dyn_lib_info.name, .module_fce = .{ .c_fce = dyn_lib_info.symbol } }, dyn_lib_info.full_path);
         }
     }
+
+    if (_modules_watch == null) {
+        _modules_watch = fswatch.watch(module_dir, .{ .recursive = false, .debounce_ms = 100 }, null, onModulesChanged) catch |err| blk: {
+            log.warn("Could not watch dynamic modules dir {}", .{err});
+            break :blk null;
+        };
+    }
+}
+
+fn onModulesChanged(ctx: ?*anyopaque, root_path: []const u8, events: []const fswatch.Event) !void {
+    _ = ctx;
+    _ = root_path;
+
+    for (events) |event| {
+        if (event.kind != .changed) continue;
+
+        const basename = std.fs.path.basename(event.path);
+        if (!isDynamicModule(basename)) continue;
+        if (_changed_modules.contains(basename)) continue;
+
+        const name = try _allocator.dupe(u8, basename);
+        errdefer _allocator.free(name);
+        try _changed_modules.put(_allocator, name, {});
+    }
 }
 
-pub fn reloadAllIfNeeded(io: std.Io, allocator: std.mem.Allocator) !bool {
-    var zone_ctx = profiler.ZoneN(@src(), "reloadAllIfNeeded");
+/// Reload dynamic modules reported by file watch that are newer than loaded one.
+pub fn reloadChangedModules(io: std.Io, allocator: std.mem.Allocator) !bool {
+    var zone_ctx = profiler.ZoneN(@src(), "reloadChangedModules");
     defer zone_ctx.End();
 
+    if (_changed_modules.count() == 0) return false;
+    defer {
+        for (_changed_modules.keys()) |k| _allocator.free(k);
+        _changed_modules.clearRetainingCapacity();
+    }
+
     const keys = _dyn_modules_map.keys();
     const value = _dyn_modules_map.values();
 
@@ -302,6 +346,8 @@ pub fn reloadAllIfNeeded(io: std.Io, allocator: std.mem.Allocator) !bool {
         const k = keys[dyn_modules_map_n - 1 - i];
         const v = value[dyn_modules_map_n - 1 - i];
 
+        if (!_changed_modules.contains(std.fs.path.basename(k))) continue;
+
         const f = std.Io.Dir.cwd().openFile(io, k, .{ .mode = .read_only }) catch |err| switch (err) {
             error.FileNotFound => {
                 continue;
@@ -6,6 +6,7 @@ const zjobs = @import("zjobs");
 const apidb = cetech1.apidb;
 const profiler = @import("profiler.zig");
 const cetech1 = @import("cetech1");
+const cetech1_options = @import("cetech1_options");
 const public = cetech1.task;
 
 const module_name = .task;
@@ -13,14 +14,26 @@ const module_name = .task;
 const log = std.log.scoped(module_name);
 
 pub const QueueConfig = struct {
+    // Slots are allocated in pages of max_jobs, up to max_job_pages.
     max_jobs: u16 = 256,
+    max_job_pages: u32 = 1,
     max_job_size: u16 = 64,
     max_threads: u8 = 32,
     idle_sleep_ns: u32 = 50,
+    idle_spin_min: u32 = 64,
+    idle_spin_max: u32 = 4096,
+    max_edges_per_job: u32 = 8,
+    // Nested inline runs under back-pressure before ready tasks go to overflow list.
+    max_inline_depth: u32 = 4,
+    // CPU time all workers can spend starting background tasks in one frame.
+    background_budget_ns: u64 = 4 * std.time.ns_per_ms,
 };
 inline fn ignore(_: anytype) void {}
 
 threadlocal var THREAD_IDX: u32 = 0;
+threadlocal var THREAD_IS_WORKER: bool = false;
+threadlocal var THREAD_RNG: u32 = 0;
+threadlocal var INLINE_DEPTH: u32 = 0;
 pub const cache_line_size = std.atomic.cache_line;
 
 inline fn isFreeCycle(cycle: u64) bool {
@@ -31,44 +44,265 @@ inline fn isLiveCycle(cycle: u64) bool {
     return (cycle & 1) == 1;
 }
 
+// xorshift32, only for victim selection.
+inline fn nextRandom() u32 {
+    var x = THREAD_RNG;
+    if (x == 0) x = 0x9E3779B9 +% THREAD_IDX;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    THREAD_RNG = x;
+    return x;
+}
+
+// Eventcount for parking idle threads.
+// Waiter: prepare() -> recheck condition -> park() or cancel().
+// Notifier: make condition true -> notify().
+const Parker = struct {
+    const Self = @This();
+
+    mutex: std.Io.Mutex = .init,
+    cond: std.Io.Condition = .init,
+    epoch: std.atomic.Value(u32) = .init(0),
+    sleepers: std.atomic.Value(u32) = .init(0),
+
+    fn prepare(self: *Self) u32 {
+        const epoch = self.epoch.load(.acquire);
+        _ = self.sleepers.fetchAdd(1, .seq_cst);
+        return epoch;
+    }
+
+    fn cancel(self: *Self) void {
+        _ = self.sleepers.fetchSub(1, .monotonic);
+    }
+
+    fn park(self: *Self, io: std.Io, epoch: u32) void {
+        self.mutex.lockUncancelable(io);
+        while (self.epoch.load(.acquire) == epoch) {
+            self.cond.waitUncancelable(io, &self.mutex);
+        }
+        self.mutex.unlock(io);
+        _ = self.sleepers.fetchSub(1, .monotonic);
+    }
+
+    fn notify(self: *Self, io: std.Io, all: bool) void {
+        // RMW instead of load so it's ordered after condition store.
+        if (self.sleepers.fetchAdd(0, .seq_cst) == 0) return;
+
+        self.mutex.lockUncancelable(io);
+        defer self.mutex.unlock(io);
+
+        _ = self.epoch.fetchAdd(1, .release);
+        if (all) self.cond.broadcast(io) else self.cond.signal(io);
+    }
+};
+
+// Lock-free free list over pages that are allocated on demand and never freed.
+// T must have `next_free: u32` field.
+fn PagedPool(comptime T: type, comptime page_size: u32, comptime max_pages: u32) type {
+    comptime std.debug.assert(page_size != 0 and max_pages != 0);
+
+    return struct {
+        const Self = @This();
+        const Page = [page_size]T;
+        pub const max_items = page_size * max_pages;
+
+        // idx + 1, 0 == empty
+        const Head = packed struct(u64) {
+            tag: u32 = 0,
+            idx: u32 = 0,
+        };
+
+        pages: [max_pages]std.atomic.Value(?*Page) = @splat(.init(null)),
+        page_count: std.atomic.Value(u32) = .init(0),
+        free_head: std.atomic.Value(Head) = .init(.{}),
+        grow_lock: std.Io.Mutex = .init,
+
+        pub fn deinit(self: *Self, allocator: std.mem.Allocator) void {
+            for (self.pages[0..self.page_count.load(.monotonic)]) |*page| {
+                allocator.destroy(page.load(.monotonic).?);
+            }
+        }
+
+        pub inline fn get(self: *Self, idx: usize) *T {
+            const page = self.pages[idx / page_size].load(.acquire).?;
+            return &page[idx % page_size];
+        }
+
+        pub fn capacity(self: *const Self) u32 {
+            return self.page_count.load(.monotonic) * page_size;
+        }
+
+        pub fn isEmpty(self: *const Self) bool {
+            return self.free_head.load(.monotonic).idx == 0;
+        }
+
+        pub fn pop(self: *Self) ?u32 {
+            var head = self.free_head.load(.acquire);
+            while (head.idx != 0) {
+                const idx = head.idx - 1;
+                const next = @atomicLoad(u32, &self.get(idx).next_free, .monotonic);
+                if (self.free_head.cmpxchgWeak(head, .{ .tag = head.tag +% 1, .idx = next }, .acquire, .acquire)) |actual| {
+                    head = actual;
+                } else {
+                    return idx;
+                }
+            }
+            return null;
+        }
+
+        pub fn push(self: *Self, idx: u32) void {
+            const item = self.get(idx);
+            var head = self.free_head.load(.monotonic);
+            while (true) {
+                @atomicStore(u32, &item.next_free, head.idx, .monotonic);
+                if (self.free_head.cmpxchgWeak(head, .{ .tag = head.tag +% 1, .idx = idx + 1 }, .release, .monotonic)) |actual| {
+                    head = actual;
+                } else {
+                    return;
+                }
+            }
+        }
+
+        /// Return false if pool is on max_pages.
+        pub fn addPage(self: *Self, io: std.Io, allocator: std.mem.Allocator) !bool {
+            self.grow_lock.lockUncancelable(io);
+            defer self.grow_lock.unlock(io);
+
+            // Somebody was faster.
+            if (!self.isEmpty()) return true;
+
+            const page_idx = self.page_count.load(.monotonic);
+            if (page_idx == max_pages) return false;
+
+            const page = try allocator.create(Page);
+            page.* = @splat(.{});
+
+            self.pages[page_idx].store(page, .release);
+            self.page_count.store(page_idx + 1, .release);
+
+            // Reverse so low idx is used first.
+            const first = page_idx * page_size;
+            var i: u32 = page_size;
+            while (i > 0) {
+                i -= 1;
+                self.push(first + i);
+            }
+
+            return true;
+        }
+    };
+}
+
 pub fn JobSystem(comptime queue_config: QueueConfig) type {
     const Atomic = std.atomic.Value;
-    const FreeQueue = cetech1.MPMCBoundedQueue(usize, queue_config.max_jobs);
+    comptime std.debug.assert(@as(usize, queue_config.max_jobs) * queue_config.max_job_pages <= std.math.maxInt(u16) + 1);
     const TaskQueue = cetech1.MPMCBoundedQueue(public.TaskID, queue_config.max_jobs);
+    const TaskDeque = cetech1.WorkStealingDeque(public.TaskID, queue_config.max_jobs);
     const PrioTaskQueue = cetech1.MPMCBoundedQueue(public.TaskID, 1024);
 
-    const TaskBuffer = cetech1.ArrayList(public.TaskID);
+    // Dependency edge prereq -> successor.
+    const Edge = struct {
+        next: u32 = empty_edge,
+        successor: u32 = 0,
+        next_free: u32 = 0,
+
+        const empty_edge: u32 = 0;
+        const closed_edge: u32 = std.math.maxInt(u32);
+    };
+
+    // Head of successor list. Cycle protect from adding successor to reused slot.
+    const Successors = packed struct(u64) {
+        edge: u32 = Edge.empty_edge,
+        cycle: u16 = 0,
+        _pad: u16 = 0,
+    };
+
+    // Unbounded FIFO for ready tasks that not fit to bounded queues.
+    // Linked through task slots so it never allocate.
+    const TaskOverflow = struct {
+        const Self = @This();
+
+        lock: std.Io.Mutex = .init,
+        // idx + 1, 0 == empty
+        head: u32 = 0,
+        tail: u32 = 0,
+        len: Atomic(u32) = .init(0),
+
+        fn isEmpty(self: *const Self) bool {
+            return self.len.load(.acquire) == 0;
+        }
+
+        fn push(self: *Self, io: std.Io, slots: anytype, task: public.TaskID) void {
+            const idx: u32 = task.index();
+            slots.get(idx).next_overflow = 0;
+
+            self.lock.lockUncancelable(io);
+            defer self.lock.unlock(io);
+
+            if (self.tail == 0) {
+                self.head = idx + 1;
+            } else {
+                slots.get(self.tail - 1).next_overflow = idx + 1;
+            }
+            self.tail = idx + 1;
+            _ = self.len.fetchAdd(1, .release);
+        }
+
+        fn pop(self: *Self, io: std.Io, slots: anytype) ?public.TaskID {
+            if (self.isEmpty()) return null;
+
+            self.lock.lockUncancelable(io);
+            defer self.lock.unlock(io);
+
+            if (self.head == 0) return null;
+
+            const slot = slots.get(self.head - 1);
+            self.head = slot.next_overflow;
+            if (self.head == 0) self.tail = 0;
+            _ = self.len.fetchSub(1, .monotonic);
+
+            return @atomicLoad(public.TaskID, &slot.id, .acquire);
+        }
+    };
 
     const Worker = struct {
         const Self = @This();
 
         thread: ?std.Thread = null,
+        spin_limit: u32 = queue_config.idle_spin_min,
         prioqueue: PrioTaskQueue = undefined,
-        queue: TaskQueue = undefined,
+        // Affinity tasks that not fit to prioqueue.
+        prio_overflow: TaskOverflow = .{},
+        deque: TaskDeque = undefined,
 
-        buffer: TaskBuffer,
-
-        pub fn pushJob(self: *Self, taks: public.TaskID) void {
-            const b = self.queue.push(taks);
-            std.debug.assert(b);
+        /// Owner only.
+        pub fn pushJob(self: *Self, taks: public.TaskID) bool {
+            return self.deque.push(taks);
         }
 
+        /// Owner only.
         pub fn popJob(self: *Self) ?public.TaskID {
-            return self.queue.pop();
+            return self.deque.pop();
         }
 
+        /// Any thread.
         pub fn stealJob(self: *Self) ?public.TaskID {
-            return self.queue.pop();
+            return self.deque.steal();
         }
 
-        pub fn pushPrioJob(self: *Self, taks: public.TaskID) void {
-            const b = self.prioqueue.push(taks);
-            std.debug.assert(b);
+        /// Return false if prioqueue is full.
+        pub fn pushPrioJob(self: *Self, taks: public.TaskID) bool {
+            return self.prioqueue.push(taks);
         }
 
         pub fn popPrioJob(self: *Self) ?public.TaskID {
             return self.prioqueue.pop();
         }
+
+        pub fn hasPrioJob(self: *const Self) bool {
+            return !self.prioqueue.isEmpty() or !self.prio_overflow.isEmpty();
+        }
     };
 
     const Slot = struct {
@@ -83,17 +317,27 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
         exec: Main align(cache_line_size) = undefined,
 
         id: public.TaskID = public.TaskID.none,
-        prereq: public.TaskID = public.TaskID.none,
         cycle: Atomic(u16) = .{ .raw = 0 },
 
+        // Unfinished prereqs + 1 while scheduling.
+        pending: Atomic(u32) = .{ .raw = 0 },
+        successors: Atomic(Successors) = .{ .raw = .{} },
+
+        affinity: ?u32 = null,
+        priority: public.Priority = .normal,
         combine: bool = false,
 
+        next_free: u32 = 0,
+        // Link in TaskOverflow while task is waiting there.
+        next_overflow: u32 = 0,
+
         fn storeJob(
             self: *Self,
             comptime Job: type,
             job: *const Job,
             index: usize,
-            prereq: public.TaskID,
+            combine: bool,
+            config: public.ScheduleConfig,
         ) public.TaskID {
             const old_cycle: u16 = self.cycle.load(.acquire);
             std.debug.assert(isFreeCycle(old_cycle));
@@ -121,35 +365,51 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
 
             self.exec = @as(Main, @ptrCast(exec));
             self.id = id;
-            self.prereq = if (prereq != id) prereq else public.TaskID.none;
+            self.combine = combine;
+            self.affinity = config.affinity;
+            self.priority = config.priority;
+
+            // Scheduler hold one dependency until all prereqs are registered.
+            self.pending.store(1, .monotonic);
+            self.successors.store(.{ .cycle = new_cycle }, .release);
             return id;
         }
 
-        fn executeJob(self: *Self, id: public.TaskID) bool {
+        fn executeJob(self: *Self, id: public.TaskID) void {
             const old_id = @atomicLoad(public.TaskID, &self.id, .acquire);
             std.debug.assert(old_id == id);
+            std.debug.assert(isLiveCycle(old_id.cycle()));
 
-            const old_cycle: u16 = old_id.cycle();
+            self.exec(&self.data) catch undefined;
+
+            const old_id2 = @atomicLoad(public.TaskID, &self.id, .acquire);
+            std.debug.assert(old_id2 == id);
+        }
+
+        /// Mark job as done and return head of detached successor list.
+        fn finishJob(self: *Self, id: public.TaskID) u32 {
+            const old_cycle: u16 = id.cycle();
             std.debug.assert(isLiveCycle(old_cycle));
 
             const new_cycle: u16 = old_cycle +% 1;
             std.debug.assert(isFreeCycle(new_cycle));
 
-            self.exec(&self.data) catch undefined;
-
-            const old_id2 = @atomicLoad(public.TaskID, &self.id, .acquire);
-            std.debug.assert(old_id2 == id);
+            // Close list so nobody can add successor after this point.
+            const successors = self.successors.swap(.{ .cycle = old_cycle, .edge = Edge.closed_edge }, .acq_rel);
+            std.debug.assert(successors.cycle == old_cycle);
+            std.debug.assert(successors.edge != Edge.closed_edge);
 
             {
                 const released: bool = null == self.cycle.cmpxchgStrong(
                     old_cycle,
                     new_cycle,
-                    .monotonic,
+                    .seq_cst,
                     .monotonic,
                 );
                 std.debug.assert(released);
             }
-            return true;
+
+            return successors.edge;
         }
 
         fn jobId(index: u16, cycle: u16) public.TaskID {
@@ -157,6 +417,9 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
         }
     };
 
+    const SlotPool = PagedPool(Slot, queue_config.max_jobs, queue_config.max_job_pages);
+    const EdgePool = PagedPool(Edge, @as(u32, queue_config.max_jobs) * queue_config.max_edges_per_job, queue_config.max_job_pages);
+
     const Queue = struct {
         const Self = @This();
 
@@ -166,28 +429,53 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
 
         workers: [queue_config.max_threads]Worker = undefined,
 
-        tasks: [queue_config.max_jobs]Slot align(cache_line_size) = @splat(.{}),
-        free_tasks: FreeQueue = undefined,
+        tasks: SlotPool = .{},
+        edges: EdgePool = .{},
+
+        in_flight: Atomic(u32) = .init(0),
+        peak_in_flight: Atomic(u32) = .init(0),
+
+        // Tasks scheduled from non worker threads.
+        inject_queue: TaskQueue = undefined,
+        // Ready tasks that not fit anywhere while inline depth is spent.
+        overflow: TaskOverflow = .{},
 
-        job_signal: std.Io.Semaphore = .{},
+        critical_queue: TaskQueue = undefined,
+        background_queue: TaskQueue = undefined,
+
+        // Ready but not started tasks by priority.
+        queue_depth: [public.priority_count]Atomic(u32) = @splat(.init(0)),
+
+        // Budget is applied only while frame critical work is in flight so loading without frames is not starved.
+        critical_in_flight: Atomic(u32) = .init(0),
+        background_budget_ns: Atomic(u64) = .init(queue_config.background_budget_ns),
+        background_spent_ns: Atomic(u64) = .init(0),
+
+        // Idle workers wait for new work.
+        work_parker: Parker = .{},
+        // Waiters wait for task completion.
+        done_parker: Parker = .{},
 
         pub fn init(allocator: std.mem.Allocator) !Self {
             var self = Self{
                 .allocator = allocator,
-                .free_tasks = .init(),
+                .inject_queue = .init(),
+                .critical_queue = .init(),
+                .background_queue = .init(),
             };
 
-            for (0..queue_config.max_jobs) |value| {
-                _ = self.free_tasks.push(value);
-            }
+            _ = try self.tasks.addPage(_io, allocator);
+            _ = try self.edges.addPage(_io, allocator);
+
+            // Edge 0 is empty_edge
+            std.debug.assert(self.edges.pop().? == Edge.empty_edge);
 
             return self;
         }
 
         pub fn deinit(self: *Self) void {
-            for (0..queue_config.max_threads) |wid| {
-                self.workers[wid].buffer.deinit(self.allocator);
-            }
+            self.tasks.deinit(self.allocator);
+            self.edges.deinit(self.allocator);
         }
 
         pub fn isRunning(self: *const Self) bool {
@@ -210,22 +498,21 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
             const was_running = self.running.swap(true, .monotonic);
             std.debug.assert(was_running == false);
 
-            const main_worker = &self.workers[0];
-            main_worker.* = .{
-                .buffer = try TaskBuffer.initCapacity(self.allocator, queue_config.max_jobs),
-                .queue = .init(),
-                .prioqueue = .init(),
-            };
+            // Caller thread is main worker.
+            THREAD_IDX = 0;
+            THREAD_IS_WORKER = true;
+
+            // Worker must be ready before any thread can steal from it.
+            for (self.workers[0..self.num_threads]) |*worker| {
+                worker.* = .{
+                    .deque = .init(),
+                    .prioqueue = .init(),
+                };
+            }
 
             for (self.workers[1..self.num_threads], 1..) |*worker, thread_index| {
                 if (std.Thread.spawn(.{}, threadMain, .{ self, thread_index })) |spawned_thread| {
-                    worker.* = .{
-                        .thread = spawned_thread,
-                        .buffer = try TaskBuffer.initCapacity(self.allocator, queue_config.max_jobs),
-                        .queue = .init(),
-                        .prioqueue = .init(),
-                    };
-
+                    worker.thread = spawned_thread;
                     nameThread(worker.thread.?, "Task Worker[{}]", .{thread_index});
                 } else |err| {
                     log.err("thread[{}]: {}\n", .{ thread_index, err });
@@ -236,9 +523,11 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
         }
 
         pub fn stop(self: *Self) void {
-            const was_running = self.running.swap(false, .monotonic);
+            const was_running = self.running.swap(false, .seq_cst);
             std.debug.assert(was_running == true);
 
+            self.work_parker.notify(_io, true);
+
             for (self.workers[1..self.num_threads]) |*worker| {
                 worker.thread.?.join();
             }
@@ -249,293 +538,526 @@ pub fn JobSystem(comptime queue_config: QueueConfig) type {
             return THREAD_IDX;
         }
 
-        pub fn schedule(self: *Self, prereq: public.TaskID, job: anytype, combinee: bool, config: public.ScheduleConfig) !public.TaskID {
+        pub fn schedule(self: *Self, prereq: public.TaskID, job: anytype, config: public.ScheduleConfig) !public.TaskID {
+            return self.scheduleWithPrereqs(&.{prereq}, job, false, config);
+        }
+
+        fn scheduleWithPrereqs(self: *Self, prereqs: []const public.TaskID, job: anytype, combinee: bool, config: public.ScheduleConfig) !public.TaskID {
             const Job = @TypeOf(job);
 
             const index = self.getNewTaskIdx();
 
-            const slot: *Slot = &self.tasks[index];
-            slot.combine = combinee;
+            const slot: *Slot = self.tasks.get(index);
+            const id = slot.storeJob(Job, &job, index, combinee, config);
+            if (config.priority == .frame_critical) _ = self.critical_in_flight.fetchAdd(1, .monotonic);
 
-            const id = slot.storeJob(Job, &job, index, prereq);
+            for (prereqs) |prereq| {
+                if (prereq == .none or prereq == id) continue;
 
-            if (config.affinity) |affinity| {
-                // _ = affinity;
-                var w = &self.workers[affinity];
-                w.pushPrioJob(id);
-            } else {
-                var w = self.getWorker();
-                w.pushJob(id);
+                // Count it first, prereq can finish right after it accept us.
+                _ = slot.pending.fetchAdd(1, .monotonic);
+                if (!self.addSuccessor(prereq, index)) {
+                    _ = slot.pending.fetchSub(1, .monotonic);
+                }
             }
-            self.job_signal.post(_io);
-            return id;
-        }
 
-        fn getNewTaskIdx(self: *Self) usize {
-            return self.free_tasks.pop().?;
-        }
+            // Release scheduler dependency.
+            const successors = self.releaseDependency(index);
+            if (successors != Edge.empty_edge) self.releaseSuccessors(successors);
 
-        fn freeTaskIdx(self: *Self, idx: usize) void {
-            const b = self.free_tasks.push(idx);
-            std.debug.assert(b);
+            return id;
         }
 
-        fn threadMain(self: *Self, thread_index: usize) !void {
-            THREAD_IDX = @intCast(thread_index);
+        /// Return false if prereq is already done.
+        fn addSuccessor(self: *Self, prereq: public.TaskID, successor_idx: usize) bool {
+            const prereq_id = prereq.fields();
+            std.debug.assert(isLiveCycle(prereq_id.cycle));
 
-            log.debug("Worker thread {d} spawned", .{self.getWokerId()});
+            const prereq_slot = self.tasks.get(prereq_id.index);
 
-            var buf: [std.Thread.max_name_len]u8 = undefined;
-            if (std.fmt.bufPrintZ(&buf, "Worker {}", .{THREAD_IDX})) |name| {
-                profiler.ztracy.SetThreadName(name);
-            } else |err| {
-                ignore(err);
-            }
+            var head = prereq_slot.successors.load(.acquire);
+            if (head.cycle != prereq_id.cycle or head.edge == Edge.closed_edge) return false;
 
-            while (self.isRunning()) {
-                if (self.getWorkToDo(false)) |task| {
-                    const slot = &self.tasks[task.index()];
+            const edge_idx = self.getNewEdgeIdx();
+            const edge = self.edges.get(edge_idx);
+            edge.successor = @intCast(successor_idx);
 
-                    if (slot.executeJob(task)) {
-                        self.freeTaskIdx(task.index());
-                    }
+            while (true) {
+                if (head.cycle != prereq_id.cycle or head.edge == Edge.closed_edge) {
+                    self.freeEdgeIdx(edge_idx);
+                    return false;
+                }
+
+                edge.next = head.edge;
+                if (prereq_slot.successors.cmpxchgWeak(
+                    head,
+                    .{ .cycle = head.cycle, .edge = edge_idx },
+                    .acq_rel,
+                    .acquire,
+                )) |actual| {
+                    head = actual;
                 } else {
-                    //self.job_signal.timedWait(queue_config.idle_sleep_ns) catch undefined;
-                    // self.job_signal.wait();
-                    //std.Thread.yield() catch undefined;
-                    try std.Io.sleep(_io, .fromNanoseconds(queue_config.idle_sleep_ns), .awake);
+                    return true;
                 }
             }
         }
 
-        fn nameThread(t: std.Thread, comptime fmt: []const u8, args: anytype) void {
-            var buf: [std.Thread.max_name_len]u8 = undefined;
-            if (std.fmt.bufPrint(&buf, fmt, args)) |name| {
-                t.setName(_io, name) catch |err| ignore(err);
-            } else |err| {
-                ignore(err);
+        /// Decrement pending counter and enqueue task if it's ready.
+        /// Combine tasks are completed inline and their successor list is returned.
+        fn releaseDependency(self: *Self, index: usize) u32 {
+            const slot = self.tasks.get(index);
+            if (slot.pending.fetchSub(1, .acq_rel) != 1) return Edge.empty_edge;
+
+            const id = @atomicLoad(public.TaskID, &slot.id, .acquire);
+
+            if (!slot.combine) {
+                self.enqueue(id, slot.affinity, slot.priority);
+                return Edge.empty_edge;
             }
-        }
 
-        fn getWorker(self: *Self) *Worker {
-            const wid = self.getWokerId();
-            return &self.workers[wid];
+            const successors = slot.finishJob(id);
+            self.freeTaskIdx(index);
+            self.done_parker.notify(_io, true);
+            return successors;
         }
 
-        fn getWorkToDo(self: *Self, only_prio: bool) ?public.TaskID {
-
-            // var zone_ctx = profiler.ztracy.Zone(@src());
-            // defer zone_ctx.End();
+        fn releaseSuccessors(self: *Self, first_edge: u32) void {
+            // Combine tasks done inline push their successors here so long combine chain not recurse.
+            var stack: [64]u32 = undefined;
+            var stack_len: usize = 0;
 
-            const wid = self.getWokerId();
-            var self_w = self.getWorker();
-            self_w.buffer.clearRetainingCapacity();
+            var edge_idx = first_edge;
+            while (true) {
+                while (edge_idx != Edge.empty_edge) {
+                    const edge = self.edges.get(edge_idx).*;
+                    self.freeEdgeIdx(edge_idx);
+                    edge_idx = edge.next;
 
-            {
-                defer {
-                    // var zone_ctx = profiler.ztracy.Zone(@src());
+                    const successors = self.releaseDependency(edge.successor);
+                    if (successors == Edge.empty_edge) continue;
 
-                    for (0..self_w.buffer.items.len) |idx| {
-                        self_w.pushPrioJob(self_w.buffer.items[idx]);
+                    if (stack_len < stack.len) {
+                        stack[stack_len] = successors;
+                        stack_len += 1;
+                    } else {
+                        self.releaseSuccessors(successors);
                     }
-                    self_w.buffer.clearRetainingCapacity();
-
-                    // zone_ctx.End();
                 }
 
-                while (self_w.popPrioJob()) |task| {
-                    std.debug.assert(task != .none);
-
-                    var slot = &self.tasks[task.index()];
+                if (stack_len == 0) break;
+                stack_len -= 1;
+                edge_idx = stack[stack_len];
+            }
+        }
 
-                    // TODO: SHIT
-                    if (slot.combine) {
-                        const d: *CombineTask = @ptrCast(@alignCast(&slot.data));
-                        var done = true;
-                        for (d.prereqs) |p| {
-                            if (!self.isDone(p)) {
-                                done = false;
-                                break;
-                            }
-                        }
+        fn enqueue(self: *Self, task: public.TaskID, affinity: ?u32, priority: public.Priority) void {
+            _ = self.queue_depth[@intFromEnum(priority)].fetchAdd(1, .monotonic);
 
-                        if (!done) {
-                            self_w.buffer.appendAssumeCapacity(task);
-                            continue;
-                        }
-                    }
+            if (affinity) |a| {
+                self.pushPrioJob(&self.workers[a], task);
+            } else switch (priority) {
+                .frame_critical => if (!self.critical_queue.push(task)) self.pushJob(task),
+                .normal => self.pushJob(task),
+                // Full background queue lose priority but keep running.
+                .background => if (!self.background_queue.push(task)) self.pushJob(task),
+            }
 
-                    // Depend on other task?
-                    if (slot.prereq != .none) {
-                        const prereq_id = slot.prereq.fields();
-                        std.debug.assert(isLiveCycle(prereq_id.cycle));
+            // Affinity task need wake the right worker so wake all.
+            self.work_parker.notify(_io, affinity != null);
+        }
 
-                        if (!self.isDone(slot.prereq)) {
-                            self_w.buffer.appendAssumeCapacity(task);
-                            continue;
-                        } else {
-                            return task;
-                        }
-                    } else {
-                        return task;
-                    }
-                }
+        fn pushJob(self: *Self, task: public.TaskID) void {
+            if (THREAD_IS_WORKER) {
+                var w = self.getWorker();
+                if (w.pushJob(task)) return;
             }
 
-            if (only_prio) {
-                return null;
+            if (self.inject_queue.push(task)) return;
+
+            // Back-pressure: all queues are full so do it now.
+            // Task can release successors that end here again so depth is limited.
+            if (INLINE_DEPTH < queue_config.max_inline_depth) {
+                INLINE_DEPTH += 1;
+                defer INLINE_DEPTH -= 1;
+
+                self.markDequeued(task);
+                self.runTask(task);
+                return;
             }
 
-            for (0..self.num_threads) |value| {
-                const worker_idx = (wid + value) % self.num_threads;
+            self.overflow.push(_io, &self.tasks, task);
+        }
 
-                var w = &self.workers[worker_idx];
+        // Affinity task can run only on given worker so it can not be done inline.
+        fn pushPrioJob(self: *Self, w: *Worker, task: public.TaskID) void {
+            if (w.pushPrioJob(task)) return;
+            w.prio_overflow.push(_io, &self.tasks, task);
+        }
 
-                defer {
-                    // var zone_ctx = profiler.ztracy.Zone(@src());
-                    for (0..self_w.buffer.items.len) |idx| {
-                        if (!self.isDone(self_w.buffer.items[idx])) {
-                            self_w.pushJob(self_w.buffer.items[idx]);
-                        }
-                    }
-                    self_w.buffer.clearRetainingCapacity();
-                    // zone_ctx.End();
-                }
+        fn popPrioJob(self: *Self, w: *Worker) ?public.TaskID {
+            if (w.popPrioJob()) |task| return task;
+            return w.prio_overflow.pop(_io, &self.tasks);
+        }
 
-                while (w.stealJob()) |task| {
-                    std.debug.assert(task != .none);
+        fn markDequeued(self: *Self, task: public.TaskID) void {
+            const slot = self.tasks.get(task.index());
+            _ = self.queue_depth[@intFromEnum(slot.priority)].fetchSub(1, .monotonic);
+        }
 
-                    var slot = &self.tasks[task.index()];
+        pub fn getQueueDepth(self: *Self, priority: public.Priority) u32 {
+            return self.queue_depth[@intFromEnum(priority)].load(.monotonic);
+        }
 
-                    // TODO: SHIT
-                    if (slot.combine) {
-                        const d: *CombineTask = @ptrCast(@alignCast(&slot.data));
-                        var done = true;
-                        for (d.prereqs) |p| {
-                            if (!self.isDone(p)) {
-                                done = false;
-                                break;
-                            }
-                        }
+        /// Reset per-frame background budget. Call once per frame.
+        pub fn newFrame(self: *Self) void {
+            self.background_spent_ns.store(0, .monotonic);
 
-                        if (!done) {
-                            self_w.buffer.appendAssumeCapacity(task);
-                            continue;
-                        }
-                    }
+            // Workers could park with background work while budget was spent.
+            if (!self.background_queue.isEmpty()) self.work_parker.notify(_io, true);
+        }
 
-                    // Depend on other task?
-                    if (slot.prereq != .none) {
-                        const prereq_id = slot.prereq.fields();
-                        std.debug.assert(isLiveCycle(prereq_id.cycle));
+        pub fn setBackgroundBudget(self: *Self, budget_ns: u64) void {
+            self.background_budget_ns.store(budget_ns, .monotonic);
+        }
 
-                        if (!self.isDone(slot.prereq)) {
-                            self_w.buffer.appendAssumeCapacity(task);
-                            continue;
-                        } else {
-                            return task;
-                        }
-                    } else {
-                        return task;
-                    }
-                }
-            }
+        pub fn getBackgroundSpent(self: *Self) u64 {
+            return self.background_spent_ns.load(.monotonic);
+        }
 
-            return null;
+        fn canStartBackground(self: *Self) bool {
+            if (self.critical_in_flight.load(.monotonic) == 0) return true;
+            return self.background_spent_ns.load(.monotonic) < self.background_budget_ns.load(.monotonic);
         }
 
-        pub fn waitForManyTask(self: *Self, io: std.Io, tasks: []const public.TaskID) !void {
-            // var zone_ctx = profiler.ztracy.Zone(@src());
-            // defer zone_ctx.End();
-            for (tasks) |task| {
-                if (task == .none) continue;
-                const _id = task.fields();
+        fn getNewTaskIdx(self: *Self) u32 {
+            const idx = self.allocFromPool(&self.tasks);
 
-                std.debug.assert(isLiveCycle(_id.cycle));
+            const in_flight = self.in_flight.fetchAdd(1, .monotonic) + 1;
+            _ = self.peak_in_flight.fetchMax(in_flight, .monotonic);
 
-                while (!self.isDone(task)) {
-                    if (self.getWorkToDo(false)) |t| {
-                        var task_slot = &self.tasks[t.index()];
-                        if (task_slot.executeJob(t)) {
-                            self.freeTaskIdx(t.index());
-                        }
-                    } else {
-                        // self.job_signal.timedWait(queue_config.idle_sleep_ns) catch undefined;
-                        // self.job_signal.wait();
-                    }
-                    try std.Io.sleep(io, .fromNanoseconds(queue_config.idle_sleep_ns), .awake);
-                }
-            }
+            return idx;
         }
 
-        pub fn doOneTask(self: *Self, io: std.Io, only_prio: bool) !void {
-            if (self.getWorkToDo(only_prio)) |t| {
-                var task_slot = &self.tasks[t.index()];
-                if (task_slot.executeJob(t)) {
-                    self.freeTaskIdx(t.index());
+        fn freeTaskIdx(self: *Self, idx: usize) void {
+            _ = self.in_flight.fetchSub(1, .monotonic);
+            self.tasks.push(@intCast(idx));
+        }
+
+        fn getNewEdgeIdx(self: *Self) u32 {
+            return self.allocFromPool(&self.edges);
+        }
+
+        fn freeEdgeIdx(self: *Self, idx: u32) void {
+            self.edges.push(idx);
+        }
+
+        // Grow pool by page and if it's full help with other tasks until something is freed.
+        fn allocFromPool(self: *Self, pool: anytype) u32 {
+            while (true) {
+                if (pool.pop()) |idx| return idx;
+
+                const added = pool.addPage(_io, self.allocator) catch |err| blk: {
+                    log.err("Could not grow task pool: {}", .{err});
+                    break :blk false;
+                };
+                if (added) continue;
+
+                // Back-pressure. Background only if there is nothing else, one finished task free slot.
+                if (self.getWorkToDo(.budgeted) orelse self.getWorkToDo(.all)) |t| {
+                    self.runTask(t);
+                    continue;
                 }
+
+                const epoch = self.done_parker.prepare();
+                if (!pool.isEmpty() or self.hasWork(.all)) {
+                    self.done_parker.cancel();
+                    continue;
+                }
+                self.done_parker.park(_io, epoch);
             }
-            try std.Io.sleep(io, .fromNanoseconds(queue_config.idle_sleep_ns), .awake);
         }
 
-        pub fn isDone(self: *Self, task: public.TaskID) bool {
-            if (task == .none) return true;
+        /// Reset peak to current in-flight count and return old peak.
+        pub fn takePeakInFlight(self: *Self) u32 {
+            return self.peak_in_flight.swap(self.in_flight.load(.monotonic), .monotonic);
+        }
 
-            const _id = task.fields();
-            const cycle = _id.cycle;
-            var slot: *Slot = &self.tasks[_id.index];
-            const slot_cycle = slot.cycle.load(.monotonic);
-            return slot_cycle != cycle;
+        pub fn getInFlight(self: *Self) u32 {
+            return self.in_flight.load(.monotonic);
         }
 
-        const CombineTask = struct {
-            const jobs_size = @sizeOf(*Self);
-            const prereq_size = @sizeOf(public.TaskID);
-            const max_prereqs = (queue_config.max_job_size - jobs_size) / prereq_size;
+        pub fn getCapacity(self: *Self) u32 {
+            return self.tasks.capacity();
+        }
+
+        fn threadMain(self: *Self, thread_index: usize) !void {
+            THREAD_IDX = @intCast(thread_index);
+            THREAD_IS_WORKER = true;
 
-            jobs: *Self,
-            prereqs: [max_prereqs]public.TaskID = @splat(public.TaskID.none),
+            log.debug("Worker thread {d} spawned", .{self.getWokerId()});
 
-            pub fn exec(_: *@This()) !void {}
-        };
-        pub fn combine(self: *Self, prereqs: []const public.TaskID) !public.TaskID {
-            if (prereqs.len == 0) return public.TaskID.none;
-            if (prereqs.len == 1) return prereqs[0];
+            var buf: [std.Thread.max_name_len]u8 = undefined;
+            if (std.fmt.bufPrintZ(&buf, "Worker {}", .{THREAD_IDX})) |name| {
+                profiler.ztracy.SetThreadName(name);
+            } else |err| {
+                ignore(err);
+            }
+
+            var self_w = self.getWorker();
+            var spin: u32 = 0;
+
+            while (self.isRunning()) {
+                if (self.getWorkToDo(.budgeted)) |task| {
+                    // Work found while spinning => spin longer next time.
+                    if (spin != 0) self_w.spin_limit = @min(queue_config.idle_spin_max, self_w.spin_limit * 2);
+                    spin = 0;
+
+                    self.runTask(task);
+                    continue;
+                }
 
-            var id = public.TaskID.none;
-            var in: []const public.TaskID = prereqs;
-            while (in.len > 0) {
-                var job = CombineTask{ .jobs = self };
+                if (spin < self_w.spin_limit) {
+                    spin += 1;
+                    std.atomic.spinLoopHint();
+                    continue;
+                }
 
-                const out: []public.TaskID = &job.prereqs;
+                // Nothing to do => park
+                const epoch = self.work_parker.prepare();
+                if (!self.isRunning() or self.hasWork(.budgeted)) {
+                    self.work_parker.cancel();
+                    spin = 0;
+                    continue;
+                }
 
-                const copy_len = @min(in.len, out.len);
-                std.mem.copyForwards(public.TaskID, out, in[0..copy_len]);
-                in = in[copy_len..];
+                var zone_ctx = profiler.ZoneN(@src(), "TaskWorkerPark");
+                self.work_parker.park(_io, epoch);
+                zone_ctx.End();
 
-                id = try self.schedule(
-                    id,
-                    job,
-                    true,
-                    .{},
-                );
+                self_w.spin_limit = @max(queue_config.idle_spin_min, self_w.spin_limit / 2);
+                spin = 0;
             }
-            return id;
         }
-    };
 
-    return Queue;
-}
+        fn runTask(self: *Self, task: public.TaskID) void {
+            const slot = self.tasks.get(task.index());
 
-const api = public.TaskAPI{
-    .schedule = schedule,
-    .wait = wait,
-    .waitMany = waitMany,
-    .combine = combine,
-    .getThreadNum = getThreadNum,
+            if (slot.priority == .background) {
+                const start_time = std.Io.Timestamp.now(_io, .awake);
+                slot.executeJob(task);
+                const duration = start_time.durationTo(.now(_io, .awake));
+                _ = self.background_spent_ns.fetchAdd(@intCast(@max(0, duration.toNanoseconds())), .monotonic);
+            } else {
+                slot.executeJob(task);
+            }
+
+            if (slot.priority == .frame_critical) {
+                // Frame work done => background can continue regardless of budget.
+                if (self.critical_in_flight.fetchSub(1, .monotonic) == 1 and !self.background_queue.isEmpty()) {
+                    self.work_parker.notify(_io, true);
+                }
+            }
+
+            const successors = slot.finishJob(task);
+            self.freeTaskIdx(task.index());
+
+            self.releaseSuccessors(successors);
+            self.done_parker.notify(_io, true);
+        }
+
+        /// Only approximation.
+        fn hasWork(self: *Self, mode: WorkMode) bool {
+            if (!self.inject_queue.isEmpty()) return true;
+            if (!self.overflow.isEmpty()) return true;
+            if (!self.critical_queue.isEmpty()) return true;
+            if (mode == .all or self.canStartBackground()) {
+                if (!self.background_queue.isEmpty()) return true;
+            }
+            if (THREAD_IS_WORKER and self.getWorker().hasPrioJob()) return true;
+            for (self.workers[0..self.num_threads]) |*w| {
+                if (!w.deque.isEmpty()) return true;
+            }
+            return false;
+        }
+
+        /// Nothing queued for stealing from calling thread.
+        /// Used by lazy splitting in parallelFor so range is bisected only when someone can take it.
+        pub fn isLocalQueueEmpty(self: *Self) bool {
+            if (THREAD_IS_WORKER) return self.getWorker().deque.isEmpty();
+            return self.inject_queue.isEmpty();
+        }
+
+        fn nameThread(t: std.Thread, comptime fmt: []const u8, args: anytype) void {
+            var buf: [std.Thread.max_name_len]u8 = undefined;
+            if (std.fmt.bufPrint(&buf, fmt, args)) |name| {
+                t.setName(_io, name) catch |err| ignore(err);
+            } else |err| {
+                ignore(err);
+            }
+        }
+
+        fn getWorker(self: *Self) *Worker {
+            const wid = self.getWokerId();
+            return &self.workers[wid];
+        }
+
+        const WorkMode = enum {
+            // Only affinity tasks.
+            only_prio,
+            // Background tasks only if frame budget allow it.
+            budgeted,
+            // Everything.
+            all,
+        };
+
+        fn getWorkToDo(self: *Self, mode: WorkMode) ?public.TaskID {
+            const task = self.popWork(mode) orelse return null;
+            self.markDequeued(task);
+            return task;
+        }
+
+        // Only ready tasks are in queues.
+        fn popWork(self: *Self, mode: WorkMode) ?public.TaskID {
+
+            // var zone_ctx = profiler.ztracy.Zone(@src());
+            // defer zone_ctx.End();
+
+            const wid = self.getWokerId();
+
+            if (THREAD_IS_WORKER) {
+                if (self.popPrioJob(self.getWorker())) |task| return task;
+            }
+
+            if (mode == .only_prio) {
+                return null;
+            }
+
+            // Frame critical first
+            if (self.critical_queue.pop()) |task| return task;
+
+            // Own deque (LIFO)
+            if (THREAD_IS_WORKER) {
+                if (self.getWorker().popJob()) |task| return task;
+            }
+
+            // Tasks from non worker threads
+            if (self.inject_queue.pop()) |task| return task;
+            if (self.overflow.pop(_io, &self.tasks)) |task| return task;
+
+            // Steal (FIFO) from random victim
+            const n = self.num_threads;
+            const first_victim = nextRandom() % n;
+            for (0..n) |value| {
+                const worker_idx = (first_victim + value) % n;
+                if (THREAD_IS_WORKER and worker_idx == wid) continue;
+
+                var w = &self.workers[worker_idx];
+                if (w.stealJob()) |task| return task;
+            }
+
+            // Background only if there is nothing else.
+            if (mode == .all or self.canStartBackground()) {
+                if (self.background_queue.pop()) |task| return task;
+            }
+
+            return null;
+        }
+
+        pub fn waitForManyTask(self: *Self, io: std.Io, tasks: []const public.TaskID) !void {
+            // var zone_ctx = profiler.ztracy.Zone(@src());
+            // defer zone_ctx.End();
+            for (tasks) |task| {
+                if (task == .none) continue;
+                const _id = task.fields();
+
+                std.debug.assert(isLiveCycle(_id.cycle));
+
+                // Waiting on background task run background regardless of budget.
+                // Other waits keep budget so frame critical wait does not drain background work.
+                const slot = self.tasks.get(_id.index);
+                const mode: WorkMode = if (slot.priority == .background) .all else .budgeted;
+
+                var spin: u32 = 0;
+                while (!self.isDone(task)) {
+                    if (self.getWorkToDo(mode)) |t| {
+                        self.runTask(t);
+                        spin = 0;
+                        continue;
+                    }
+
+                    // Waited task still wait for prereqs and there is nothing else to do.
+                    // Prereq can be background task, take one so spent budget can not deadlock frame.
+                    if (mode == .budgeted and slot.pending.load(.acquire) != 0 and !self.isDone(task)) {
+                        if (self.getWorkToDo(.all)) |t| {
+                            self.runTask(t);
+                            spin = 0;
+                            continue;
+                        }
+                    }
+
+                    if (spin < queue_config.idle_spin_min) {
+                        spin += 1;
+                        std.atomic.spinLoopHint();
+                        continue;
+                    }
+
+                    // Task is running somewhere else => park until some task is done.
+                    const epoch = self.done_parker.prepare();
+                    if (self.isDone(task) or self.hasWork(mode)) {
+                        self.done_parker.cancel();
+                        continue;
+                    }
+                    self.done_parker.park(io, epoch);
+                    spin = 0;
+                }
+            }
+        }
+
+        pub fn doOneTask(self: *Self, io: std.Io, only_prio: bool) !void {
+            if (self.getWorkToDo(if (only_prio) .only_prio else .budgeted)) |t| {
+                self.runTask(t);
+            } else {
+                try std.Io.sleep(io, .fromNanoseconds(queue_config.idle_sleep_ns), .awake);
+            }
+        }
+
+        pub fn isDone(self: *Self, task: public.TaskID) bool {
+            if (task == .none) return true;
+
+            const _id = task.fields();
+            const cycle = _id.cycle;
+            var slot: *Slot = self.tasks.get(_id.index);
+            const slot_cycle = slot.cycle.load(.seq_cst);
+            return slot_cycle != cycle;
+        }
+
+        // Join node, never executed.
+        const CombineTask = struct {
+            pub fn exec(_: *@This()) !void {}
+        };
+
+        pub fn combine(self: *Self, prereqs: []const public.TaskID) !public.TaskID {
+            if (prereqs.len == 0) return public.TaskID.none;
+            if (prereqs.len == 1) return prereqs[0];
+
+            return self.scheduleWithPrereqs(prereqs, CombineTask{}, true, .{});
+        }
+    };
+
+    return Queue;
+}
+
+const api = public.TaskAPI{
+    .schedule = schedule,
+    .wait = wait,
+    .waitMany = waitMany,
+    .combine = combine,
+    .getThreadNum = getThreadNum,
     .getWorkerId = getWorkerId,
+    .isWorker = isWorker,
     .isDone = isDone,
     .doOneTask = doOneTask,
+    .isLocalQueueEmpty = isLocalQueueEmpty,
 };
 
 fn getThreadNum() u64 {
@@ -546,6 +1068,14 @@ fn getWorkerId() usize {
     return _job_system.getWokerId();
 }
 
+fn isWorker() bool {
+    return THREAD_IS_WORKER;
+}
+
+fn isLocalQueueEmpty() bool {
+    return _job_system.isLocalQueueEmpty();
+}
+
 fn doOneTask(only_prio: bool) void {
     _job_system.doOneTask(_io, only_prio) catch undefined;
 }
@@ -554,6 +1084,7 @@ const JobSystemImpl = JobSystem(.{
     .idle_sleep_ns = 50,
     .max_job_size = 128,
     .max_jobs = 1024 * 2,
+    .max_job_pages = 32,
 });
 
 var _allocator: std.mem.Allocator = undefined;
@@ -582,6 +1113,40 @@ pub fn registerToApi() !void {
     try apidb.setZigApi(module_name, public.TaskAPI, &api);
 }
 
+var _in_flight_counter: *f64 = undefined;
+var _peak_in_flight_counter: *f64 = undefined;
+var _capacity_counter: *f64 = undefined;
+var _queue_depth_counters: [public.priority_count]*f64 = undefined;
+var _background_ms_counter: *f64 = undefined;
+
+pub fn initMetrics() !void {
+    _in_flight_counter = try cetech1.metrics.getCounter("task/in_flight");
+    _peak_in_flight_counter = try cetech1.metrics.getCounter("task/peak_in_flight");
+    _capacity_counter = try cetech1.metrics.getCounter("task/capacity");
+    _background_ms_counter = try cetech1.metrics.getCounter("task/background_ms");
+
+    inline for (std.enums.values(public.Priority), 0..) |priority, idx| {
+        _queue_depth_counters[idx] = try cetech1.metrics.getCounter("task/queue_" ++ @tagName(priority));
+    }
+}
+
+/// Call once per frame before metrics push.
+pub fn updateMetrics() void {
+    _in_flight_counter.* = @floatFromInt(_job_system.getInFlight());
+    _peak_in_flight_counter.* = @floatFromInt(_job_system.takePeakInFlight());
+    _capacity_counter.* = @floatFromInt(_job_system.getCapacity());
+    _background_ms_counter.* = @as(f64, @floatFromInt(_job_system.getBackgroundSpent())) / std.time.ns_per_ms;
+
+    inline for (std.enums.values(public.Priority), 0..) |priority, idx| {
+        _queue_depth_counters[idx].* = @floatFromInt(_job_system.getQueueDepth(priority));
+    }
+}
+
+/// Call once per frame after updateMetrics.
+pub fn newFrame() void {
+    _job_system.newFrame();
+}
+
 fn schedule(prereq: public.TaskID, task: public.TaskStub, config: public.ScheduleConfig) !public.TaskID {
     const Job = struct {
         t: public.TaskStub,
@@ -596,7 +1161,6 @@ fn schedule(prereq: public.TaskID, task: public.TaskStub, config: public.Schedul
     const job_id = try _job_system.schedule(
         prereq,
         Job{ .t = task },
-        false,
         config,
     );
     return job_id;
@@ -641,8 +1205,33 @@ test "MPMCBoundedQueue" {
     try std.testing.expectEqual(5, q.pop());
 }
 
+test "WorkStealingDeque" {
+    const Q = cetech1.WorkStealingDeque(u32, 128);
+    var q = Q.init();
+
+    try std.testing.expect(null == q.pop());
+    try std.testing.expect(null == q.steal());
+
+    try std.testing.expect(q.push(1));
+    try std.testing.expect(q.push(2));
+    try std.testing.expect(q.push(3));
+    try std.testing.expect(q.push(4));
+
+    // Thief take oldest
+    try std.testing.expectEqual(1, q.steal());
+    try std.testing.expectEqual(2, q.steal());
+
+    // Owner take newest
+    try std.testing.expectEqual(4, q.pop());
+    try std.testing.expectEqual(3, q.pop());
+
+    try std.testing.expect(null == q.pop());
+    try std.testing.expect(q.isEmpty());
+}
+
 test "task: basic test" {
     const allocator = std.testing.allocator;
+    _io = std.testing.io;
     const Queue = JobSystem(.{ .max_threads = 4 });
 
     var job_system = try Queue.init(allocator);
@@ -672,9 +1261,9 @@ test "task: basic test" {
         }
     };
 
-    const t1 = try job_system.schedule(.none, TaskA{ .job = &job_system }, false, .{});
-    const t2 = try job_system.schedule(t1, TaskB{ .job = &job_system }, false, .{});
-    const t3 = try job_system.schedule(t2, TaskC{ .job = &job_system }, false, .{});
+    const t1 = try job_system.schedule(.none, TaskA{ .job = &job_system }, .{});
+    const t2 = try job_system.schedule(t1, TaskB{ .job = &job_system }, .{});
+    const t3 = try job_system.schedule(t2, TaskC{ .job = &job_system }, .{});
     try job_system.waitForManyTask(std.testing.io, &.{t3});
 
     try std.testing.expect(job_system.isDone(t1));
@@ -682,25 +1271,25 @@ test "task: basic test" {
     try std.testing.expect(job_system.isDone(t3));
 
     const batch = [_]public.TaskID{
-        try job_system.schedule(.none, TaskA{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskB{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskC{ .job = &job_system }, false, .{}),
+        try job_system.schedule(.none, TaskA{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskB{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskC{ .job = &job_system }, .{}),
 
-        try job_system.schedule(.none, TaskA{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskB{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskC{ .job = &job_system }, false, .{}),
+        try job_system.schedule(.none, TaskA{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskB{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskC{ .job = &job_system }, .{}),
 
-        try job_system.schedule(.none, TaskA{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskB{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskC{ .job = &job_system }, false, .{}),
+        try job_system.schedule(.none, TaskA{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskB{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskC{ .job = &job_system }, .{}),
 
-        try job_system.schedule(.none, TaskA{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskB{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskC{ .job = &job_system }, false, .{}),
+        try job_system.schedule(.none, TaskA{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskB{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskC{ .job = &job_system }, .{}),
 
-        try job_system.schedule(.none, TaskA{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskB{ .job = &job_system }, false, .{}),
-        try job_system.schedule(.none, TaskC{ .job = &job_system }, false, .{}),
+        try job_system.schedule(.none, TaskA{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskB{ .job = &job_system }, .{}),
+        try job_system.schedule(.none, TaskC{ .job = &job_system }, .{}),
     };
 
     const batch_task = try job_system.combine(&batch);
@@ -713,6 +1302,7 @@ test "task: basic test" {
 
 test "task: spawn task from task" {
     const allocator = std.testing.allocator;
+    _io = std.testing.io;
     const Queue = JobSystem(.{ .max_threads = 4 });
 
     var job_system = try Queue.init(allocator);
@@ -734,18 +1324,18 @@ test "task: spawn task from task" {
     const TaskDep2 = struct {
         job: *Queue,
         pub fn exec(self: *@This()) !void {
-            const td1 = try self.job.schedule(.none, TaskDep1{}, false, .{});
-            const td2 = try self.job.schedule(.none, TaskDep1{}, false, .{});
-            const td3 = try self.job.schedule(.none, TaskDep1{}, false, .{});
+            const td1 = try self.job.schedule(.none, TaskDep1{}, .{});
+            const td2 = try self.job.schedule(.none, TaskDep1{}, .{});
+            const td3 = try self.job.schedule(.none, TaskDep1{}, .{});
 
             try self.job.waitForManyTask(
                 std.testing.io,
                 &.{
                     try self.job.combine(
                         &.{
-                            try self.job.schedule(td1, TaskDep1{}, false, .{}),
-                            try self.job.schedule(td2, TaskDep1{}, false, .{}),
-                            try self.job.schedule(td3, TaskDep1{}, false, .{}),
+                            try self.job.schedule(td1, TaskDep1{}, .{}),
+                            try self.job.schedule(td2, TaskDep1{}, .{}),
+                            try self.job.schedule(td3, TaskDep1{}, .{}),
                         },
                     ),
                 },
@@ -758,11 +1348,582 @@ test "task: spawn task from task" {
         &.{
             try job_system.combine(
                 &.{
-                    try job_system.schedule(.none, TaskDep2{ .job = &job_system }, false, .{}),
-                    try job_system.schedule(.none, TaskDep2{ .job = &job_system }, false, .{}),
-                    try job_system.schedule(.none, TaskDep2{ .job = &job_system }, false, .{}),
+                    try job_system.schedule(.none, TaskDep2{ .job = &job_system }, .{}),
+                    try job_system.schedule(.none, TaskDep2{ .job = &job_system }, .{}),
+                    try job_system.schedule(.none, TaskDep2{ .job = &job_system }, .{}),
                 },
             ),
         },
     );
 }
+
+test "task: successor run after prereq" {
+    const allocator = std.testing.allocator;
+    const Queue = JobSystem(.{ .max_threads = 4 });
+
+    _io = std.testing.io;
+
+    var job_system = try Queue.init(allocator);
+    defer job_system.deinit();
+
+    try job_system.start(null);
+    defer job_system.stop();
+
+    const TaskSlow = struct {
+        done: *std.atomic.Value(bool),
+        pub fn exec(self: *@This()) !void {
+            try std.Io.sleep(_io, .fromNanoseconds(std.time.ns_per_ms * 5), .awake);
+            self.done.store(true, .release);
+        }
+    };
+
+    const TaskCheck = struct {
+        done: *std.atomic.Value(bool),
+        ok: *std.atomic.Value(bool),
+        pub fn exec(self: *@This()) !void {
+            self.ok.store(self.done.load(.acquire), .release);
+        }
+    };
+
+    var done = std.atomic.Value(bool).init(false);
+    var ok = std.atomic.Value(bool).init(false);
+
+    const t1 = try job_system.schedule(.none, TaskSlow{ .done = &done }, .{});
+    const t2 = try job_system.schedule(t1, TaskCheck{ .done = &done, .ok = &ok }, .{});
+    try job_system.waitForManyTask(std.testing.io, &.{t2});
+
+    try std.testing.expect(ok.load(.acquire));
+}
+
+test "task: long combine chain" {
+    const allocator = std.testing.allocator;
+    const Queue = JobSystem(.{ .max_threads = 4 });
+
+    _io = std.testing.io;
+
+    var job_system = try Queue.init(allocator);
+    defer job_system.deinit();
+
+    try job_system.start(null);
+    defer job_system.stop();
+
+    const TaskInc = struct {
+        counter: *std.atomic.Value(usize),
+        pub fn exec(self: *@This()) !void {
+            _ = self.counter.fetchAdd(1, .monotonic);
+        }
+    };
+
+    var counter = std.atomic.Value(usize).init(0);
+
+    // Chain of combine (join) tasks. Each join is completed inline when its last prereq finish.
+    const chain_len = 64; // 3 slots per link, must fit max_jobs
+    var last = public.TaskID.none;
+    for (0..chain_len) |_| {
+        const a = try job_system.schedule(last, TaskInc{ .counter = &counter }, .{});
+        const b = try job_system.schedule(last, TaskInc{ .counter = &counter }, .{});
+        last = try job_system.combine(&.{ a, b });
+    }
+
+    try job_system.waitForManyTask(std.testing.io, &.{last});
+    try std.testing.expectEqual(chain_len * 2, counter.load(.monotonic));
+}
+
+test "task: benchmark steal scaling" {
+    if (!cetech1_options.enable_bench) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const Queue = JobSystem(.{ .max_threads = 32, .max_jobs = 1024 });
+
+    _io = std.testing.io;
+
+    const task_count = 1_000_000;
+    const chunk_size = 512;
+
+    const TaskInc = struct {
+        counter: *std.atomic.Value(usize),
+        pub fn exec(self: *@This()) !void {
+            _ = self.counter.fetchAdd(1, .monotonic);
+        }
+    };
+
+    const job_system = try allocator.create(Queue);
+    defer allocator.destroy(job_system);
+
+    var chunk: [chunk_size]public.TaskID = undefined;
+
+    for ([_]u32{ 2, 4, 8, 16, 32 }) |worker_count| {
+        job_system.* = try Queue.init(allocator);
+        defer job_system.deinit();
+
+        try job_system.start(worker_count);
+        defer job_system.stop();
+
+        var counter = std.atomic.Value(usize).init(0);
+
+        const start_time = std.Io.Timestamp.now(std.testing.io, .awake);
+
+        var scheduled: usize = 0;
+        while (scheduled < task_count) {
+            const n = @min(chunk_size, task_count - scheduled);
+            for (chunk[0..n]) |*t| {
+                t.* = try job_system.schedule(.none, TaskInc{ .counter = &counter }, .{});
+            }
+            try job_system.waitForManyTask(std.testing.io, chunk[0..n]);
+            scheduled += n;
+        }
+
+        const duration = start_time.durationTo(.now(std.testing.io, .awake));
+        try std.testing.expectEqual(task_count, counter.load(.monotonic));
+
+        const ns: f64 = @floatFromInt(duration.toNanoseconds());
+        std.debug.print(
+            "task steal benchmark: workers={d} tasks={d} total={d:.2}ms per_task={d:.1}ns\n",
+            .{ job_system.num_threads, task_count, ns / std.time.ns_per_ms, ns / task_count },
+        );
+    }
+}
+
+fn waitForParkedWorkers(job_system: anytype, io: std.Io, count: u32) !bool {
+    // Generous limit, only behaviour is tested here.
+    for (0..5000) |_| {
+        if (job_system.work_parker.sleepers.load(.seq_cst) == count) return true;
+        try std.Io.sleep(io, .fromNanoseconds(std.time.ns_per_ms), .awake);
+    }
+    return false;
+}
+
+test "task: idle workers park" {
+    const allocator = std.testing.allocator;
+    const Queue = JobSystem(.{ .max_threads = 4 });
+
+    _io = std.testing.io;
+    const io = std.testing.io;
+
+    const job_system = try allocator.create(Queue);
+    defer allocator.destroy(job_system);
+
+    job_system.* = try Queue.init(allocator);
+    defer job_system.deinit();
+
+    try job_system.start(4);
+    defer job_system.stop();
+
+    const worker_count = job_system.num_threads - 1;
+
+    // Without work all workers spin out and park.
+    try std.testing.expect(try waitForParkedWorkers(job_system, io, worker_count));
+
+    // Parked workers burn almost no CPU, spinning ones burn (workers * wall).
+    // Bound is loose so loaded machine does not fail it, precise numbers are in benchmark.
+    {
+        const wall_start = std.Io.Timestamp.now(io, .awake);
+        const cpu_start = std.Io.Timestamp.now(io, .cpu_process);
+
+        try std.Io.sleep(io, .fromNanoseconds(50 * std.time.ns_per_ms), .awake);
+
+        const cpu_ns = cpu_start.durationTo(.now(io, .cpu_process)).toNanoseconds();
+        const wall_ns = wall_start.durationTo(.now(io, .awake)).toNanoseconds();
+        try std.testing.expect(cpu_ns < wall_ns);
+    }
+
+    const TaskMark = struct {
+        out: *std.atomic.Value(u32),
+        executed_at: *std.Io.Timestamp,
+        pub fn exec(self: *@This()) !void {
+            self.executed_at.* = .now(_io, .awake);
+            _ = self.out.fetchAdd(1, .monotonic);
+        }
+    };
+
+    // Enqueue must wake parked worker and it must park again after work is done.
+    var executed: std.atomic.Value(u32) = .init(0);
+    for (1..job_system.num_threads) |worker_idx| {
+        var executed_at: std.Io.Timestamp = undefined;
+        const scheduled_at = std.Io.Timestamp.now(io, .awake);
+
+        // Pin to worker so main thread can not execute it.
+        const t = try job_system.schedule(.none, TaskMark{ .out = &executed, .executed_at = &executed_at }, .{ .affinity = @as(u32, @intCast(worker_idx)) });
+        try job_system.waitForManyTask(io, &.{t});
+
+        // Missed wake-up would leave task waiting, bound only catch that.
+        try std.testing.expect(scheduled_at.durationTo(executed_at).toNanoseconds() < 500 * std.time.ns_per_ms);
+
+        try std.testing.expect(try waitForParkedWorkers(job_system, io, worker_count));
+    }
+
+    try std.testing.expectEqual(worker_count, executed.load(.monotonic));
+}
+
+test "task: benchmark idle workers" {
+    if (!cetech1_options.enable_bench) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const Queue = JobSystem(.{ .max_threads = 4 });
+
+    _io = std.testing.io;
+    const io = std.testing.io;
+
+    const job_system = try allocator.create(Queue);
+    defer allocator.destroy(job_system);
+
+    job_system.* = try Queue.init(allocator);
+    defer job_system.deinit();
+
+    try job_system.start(4);
+    defer job_system.stop();
+
+    // Let workers spin out and park.
+    _ = try waitForParkedWorkers(job_system, io, job_system.num_threads - 1);
+
+    // Idle CPU time
+    {
+        const wall_start = std.Io.Timestamp.now(io, .awake);
+        const cpu_start = std.Io.Timestamp.now(io, .cpu_process);
+
+        try std.Io.sleep(io, .fromNanoseconds(100 * std.time.ns_per_ms), .awake);
+
+        const cpu_ns = cpu_start.durationTo(.now(io, .cpu_process)).toNanoseconds();
+        const wall_ns = wall_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+        std.debug.print(
+            "task idle: workers={d} wall={d}us cpu={d}us\n",
+            .{ job_system.num_threads, @divTrunc(wall_ns, std.time.ns_per_us), @divTrunc(cpu_ns, std.time.ns_per_us) },
+        );
+
+        // Spinning workers burn (workers * wall), parked ones almost nothing.
+        try std.testing.expect(cpu_ns < @divTrunc(wall_ns, 2));
+    }
+
+    // Wake-up latency
+    {
+        const TaskStamp = struct {
+            out: *std.Io.Timestamp,
+            pub fn exec(self: *@This()) !void {
+                self.out.* = .now(_io, .awake);
+            }
+        };
+
+        const samples = 50;
+        var sum_ns: i96 = 0;
+        var max_ns: i96 = 0;
+
+        for (0..samples) |_| {
+            // Worker must be parked.
+            try std.Io.sleep(io, .fromNanoseconds(2 * std.time.ns_per_ms), .awake);
+
+            var executed_at: std.Io.Timestamp = undefined;
+            const scheduled_at = std.Io.Timestamp.now(io, .awake);
+
+            // Pin to worker 1 so main thread can not execute it.
+            const t = try job_system.schedule(.none, TaskStamp{ .out = &executed_at }, .{ .affinity = 1 });
+            try job_system.waitForManyTask(io, &.{t});
+
+            const latency_ns = scheduled_at.durationTo(executed_at).toNanoseconds();
+            sum_ns += latency_ns;
+            max_ns = @max(max_ns, latency_ns);
+        }
+
+        std.debug.print(
+            "task wake-up latency: avg={d}us max={d}us\n",
+            .{ @divTrunc(@divTrunc(sum_ns, samples), std.time.ns_per_us), @divTrunc(max_ns, std.time.ns_per_us) },
+        );
+
+        try std.testing.expect(max_ns < 50 * std.time.ns_per_ms);
+    }
+}
+
+test "task: slot pool grow and back-pressure" {
+    const allocator = std.testing.allocator;
+
+    _io = std.testing.io;
+
+    const TaskInc = struct {
+        counter: *std.atomic.Value(usize),
+        pub fn exec(self: *@This()) !void {
+            _ = self.counter.fetchAdd(1, .monotonic);
+        }
+    };
+
+    // Burst bigger than one page => pool grow.
+    {
+        const Queue = JobSystem(.{ .max_threads = 4, .max_jobs = 64, .max_job_pages = 8 });
+        var job_system = try Queue.init(allocator);
+        defer job_system.deinit();
+
+        try job_system.start(null);
+        defer job_system.stop();
+
+        const TaskGate = struct {
+            counter: *std.atomic.Value(usize),
+            pub fn exec(self: *@This()) !void {
+                try std.Io.sleep(_io, .fromNanoseconds(std.time.ns_per_ms * 20), .awake);
+                _ = self.counter.fetchAdd(1, .monotonic);
+            }
+        };
+
+        var counter = std.atomic.Value(usize).init(0);
+        const gate = try job_system.schedule(.none, TaskGate{ .counter = &counter }, .{});
+
+        var tasks: [300]public.TaskID = undefined;
+        for (&tasks) |*t| {
+            t.* = try job_system.schedule(gate, TaskInc{ .counter = &counter }, .{});
+        }
+
+        try job_system.waitForManyTask(std.testing.io, &tasks);
+        try std.testing.expectEqual(tasks.len + 1, counter.load(.monotonic));
+        try std.testing.expect(job_system.getCapacity() > 64);
+        try std.testing.expect(job_system.takePeakInFlight() > 64);
+    }
+
+    // Burst bigger than all pages => schedule help drain.
+    {
+        const Queue = JobSystem(.{ .max_threads = 4, .max_jobs = 64, .max_job_pages = 1 });
+        var job_system = try Queue.init(allocator);
+        defer job_system.deinit();
+
+        try job_system.start(null);
+        defer job_system.stop();
+
+        var counter = std.atomic.Value(usize).init(0);
+
+        const task_count = 10_000;
+        for (0..task_count) |_| {
+            _ = try job_system.schedule(.none, TaskInc{ .counter = &counter }, .{});
+        }
+
+        while (counter.load(.monotonic) != task_count) {
+            try job_system.doOneTask(std.testing.io, false);
+        }
+
+        try std.testing.expectEqual(64, job_system.getCapacity());
+        try std.testing.expect(job_system.takePeakInFlight() <= 64);
+    }
+
+    // Affinity burst bigger than prioqueue => worker overflow list.
+    {
+        const Queue = JobSystem(.{ .max_threads = 4, .max_jobs = 256, .max_job_pages = 16 });
+        var job_system = try Queue.init(allocator);
+        defer job_system.deinit();
+
+        try job_system.start(4);
+        defer job_system.stop();
+
+        const TaskGate = struct {
+            pub fn exec(_: *@This()) !void {
+                try std.Io.sleep(_io, .fromNanoseconds(std.time.ns_per_ms * 20), .awake);
+            }
+        };
+
+        var counter = std.atomic.Value(usize).init(0);
+        const gate = try job_system.schedule(.none, TaskGate{}, .{});
+
+        // All are released at once when gate is done.
+        var tasks: [3000]public.TaskID = undefined;
+        for (&tasks) |*t| {
+            t.* = try job_system.schedule(gate, TaskInc{ .counter = &counter }, .{ .affinity = 1 });
+        }
+
+        try job_system.waitForManyTask(std.testing.io, &tasks);
+        try std.testing.expectEqual(tasks.len, counter.load(.monotonic));
+    }
+}
+
+test "task: parallelFor and parallelReduce" {
+    const allocator = std.testing.allocator;
+
+    try init(std.testing.io, allocator);
+    defer deinit();
+
+    try start(4);
+    defer stop();
+
+    const count = 100_000;
+    const items = try allocator.alloc(u32, count);
+    defer allocator.free(items);
+    @memset(items, 0);
+
+    try public.parallelFor(.{ .count = count }, items, struct {
+        pub fn exec(ctx: []u32, range: public.Range) !void {
+            for (ctx[range.begin..range.end], range.begin..) |*item, i| {
+                item.* += @intCast(i);
+            }
+        }
+    });
+
+    for (items, 0..) |item, i| {
+        try std.testing.expectEqual(@as(u32, @intCast(i)), item);
+    }
+
+    const sum = try public.parallelReduce(
+        u64,
+        allocator,
+        .{ .count = count, .grain_size = 64 },
+        items,
+        struct {
+            pub fn exec(ctx: []u32, range: public.Range, acc: *u64) !void {
+                for (ctx[range.begin..range.end]) |item| acc.* += item;
+            }
+        },
+        0,
+        struct {
+            fn add(a: u64, b: u64) u64 {
+                return a + b;
+            }
+        }.add,
+    );
+
+    try std.testing.expectEqual(@as(u64, count * (count - 1) / 2), sum);
+
+    // Thread that is not worker does not share partial with main thread.
+    const Reduce = struct {
+        fn run(data: []u32, out: *u64) !void {
+            out.* = try public.parallelReduce(
+                u64,
+                std.testing.allocator,
+                .{ .count = data.len, .grain_size = 64 },
+                data,
+                struct {
+                    pub fn exec(ctx: []u32, range: public.Range, acc: *u64) !void {
+                        for (ctx[range.begin..range.end]) |item| acc.* += item;
+                    }
+                },
+                0,
+                struct {
+                    fn add(a: u64, b: u64) u64 {
+                        return a + b;
+                    }
+                }.add,
+            );
+        }
+    };
+
+    var thread_sum: u64 = 0;
+    const thread = try std.Thread.spawn(.{}, Reduce.run, .{ items, &thread_sum });
+    var main_sum: u64 = 0;
+    try Reduce.run(items, &main_sum);
+    thread.join();
+
+    try std.testing.expectEqual(@as(u64, count * (count - 1) / 2), thread_sum);
+    try std.testing.expectEqual(@as(u64, count * (count - 1) / 2), main_sum);
+}
+
+test "task: frame critical wait should not drain background work" {
+    const allocator = std.testing.allocator;
+    _io = std.testing.io;
+
+    const Queue = JobSystem(.{ .max_threads = 2, .background_budget_ns = 0 });
+    var job_system = try Queue.init(allocator);
+    defer job_system.deinit();
+
+    try job_system.start(2);
+    defer job_system.stop();
+
+    const TaskCount = struct {
+        done: *std.atomic.Value(u32),
+        pub fn exec(self: *@This()) !void {
+            _ = self.done.fetchAdd(1, .monotonic);
+        }
+    };
+
+    // Spin for a while so waiting thread has time to take work, then record background done so far.
+    const TaskFrame = struct {
+        done: *std.atomic.Value(u32),
+        seen: *u32,
+        pub fn exec(self: *@This()) !void {
+            const start = std.Io.Timestamp.now(_io, .awake);
+            while (start.durationTo(.now(_io, .awake)).toNanoseconds() < 20 * std.time.ns_per_ms) std.atomic.spinLoopHint();
+            self.seen.* = self.done.load(.monotonic);
+        }
+    };
+
+    var done = std.atomic.Value(u32).init(0);
+    var seen: u32 = std.math.maxInt(u32);
+
+    // Frame critical task is in flight before background is scheduled => zero budget block it.
+    const frame_task = try job_system.schedule(.none, TaskFrame{ .done = &done, .seen = &seen }, .{ .priority = .frame_critical });
+
+    var background: [8]public.TaskID = undefined;
+    for (&background) |*t| {
+        t.* = try job_system.schedule(.none, TaskCount{ .done = &done }, .{ .priority = .background });
+    }
+
+    try job_system.waitForManyTask(std.testing.io, &.{frame_task});
+    try std.testing.expectEqual(0, seen);
+
+    // Waiting on background run it.
+    try job_system.waitForManyTask(std.testing.io, &background);
+    try std.testing.expectEqual(@as(u32, background.len), done.load(.monotonic));
+}
+
+test "task: priorities and background budget" {
+    const allocator = std.testing.allocator;
+    _io = std.testing.io;
+
+    const Queue = JobSystem(.{ .max_threads = 2, .background_budget_ns = 0 });
+    var job_system = try Queue.init(allocator);
+    defer job_system.deinit();
+
+    try job_system.start(2);
+    defer job_system.stop();
+
+    const TaskBlock = struct {
+        started: *std.atomic.Value(bool),
+        release: *std.atomic.Value(bool),
+        pub fn exec(self: *@This()) !void {
+            self.started.store(true, .release);
+            while (!self.release.load(.acquire)) std.atomic.spinLoopHint();
+        }
+    };
+
+    // Frame critical task in flight => zero budget block background for idle workers.
+    // Task is blocked until check is done so worker can not finish it before.
+    {
+        var frame_started = std.atomic.Value(bool).init(false);
+        var frame_release = std.atomic.Value(bool).init(false);
+        const frame_task = try job_system.schedule(.none, TaskBlock{ .started = &frame_started, .release = &frame_release }, .{ .priority = .frame_critical });
+        try std.testing.expect(!job_system.canStartBackground());
+        frame_release.store(true, .release);
+        try job_system.waitForManyTask(std.testing.io, &.{frame_task});
+        try std.testing.expect(job_system.canStartBackground());
+    }
+
+    // Keep worker 1 busy so caller thread is only one that take work => order is deterministic.
+    var started = std.atomic.Value(bool).init(false);
+    var release = std.atomic.Value(bool).init(false);
+    const block = try job_system.schedule(.none, TaskBlock{ .started = &started, .release = &release }, .{ .affinity = 1 });
+    while (!started.load(.acquire)) std.atomic.spinLoopHint();
+
+    const TaskRecord = struct {
+        order: *[3]public.Priority,
+        order_len: *usize,
+        priority: public.Priority,
+        pub fn exec(self: *@This()) !void {
+            self.order[self.order_len.*] = self.priority;
+            self.order_len.* += 1;
+        }
+    };
+
+    var order: [3]public.Priority = undefined;
+    var order_len: usize = 0;
+
+    var tasks: [3]public.TaskID = undefined;
+    for (&tasks, [_]public.Priority{ .background, .normal, .frame_critical }) |*t, priority| {
+        t.* = try job_system.schedule(.none, TaskRecord{ .order = &order, .order_len = &order_len, .priority = priority }, .{ .priority = priority });
+    }
+
+    for (std.enums.values(public.Priority)) |priority| {
+        try std.testing.expectEqual(1, job_system.getQueueDepth(priority));
+    }
+
+    try job_system.waitForManyTask(std.testing.io, &tasks);
+
+    release.store(true, .release);
+    try job_system.waitForManyTask(std.testing.io, &.{block});
+
+    try std.testing.expectEqual(3, order_len);
+    try std.testing.expectEqualSlices(public.Priority, &.{ .frame_critical, .normal, .background }, &order);
+    for (std.enums.values(public.Priority)) |priority| {
+        try std.testing.expectEqual(0, job_system.getQueueDepth(priority));
+    }
+}
@@ -80,6 +80,89 @@ pub fn MPMCBoundedQueue(comptime T: type, comptime size: usize) type {
             cell.sequence.store(pos +% mask +% 1, .release);
             return cell.data;
         }
+
+        /// Any thread, only approximation.
+        pub fn isEmpty(self: *const Self) bool {
+            return self.enqueue_pos.load(.monotonic) == self.dequeue_pos.load(.monotonic);
+        }
+    };
+}
+
+// Based on "Dynamic Circular Work-Stealing Deque" (Chase, Lev) and
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (Le, Pop, Cohen, Nardelli).
+// Bounded variant: owner push/pop on bottom (LIFO), thieves steal from top (FIFO).
+pub fn WorkStealingDeque(comptime T: type, comptime size: usize) type {
+    comptime std.debug.assert(size >= 2);
+    comptime std.debug.assert(size < std.math.maxInt(isize));
+    comptime std.debug.assert(std.math.isPowerOfTwo(size));
+
+    const mask: isize = @intCast(size - 1);
+
+    return struct {
+        const Self = @This();
+
+        top: std.atomic.Value(isize) align(std.atomic.cache_line),
+        bottom: std.atomic.Value(isize) align(std.atomic.cache_line),
+
+        buffer: [size]T align(std.atomic.cache_line) = undefined,
+
+        pub fn init() Self {
+            return Self{
+                .top = .{ .raw = 0 },
+                .bottom = .{ .raw = 0 },
+            };
+        }
+
+        /// Owner only.
+        pub fn push(self: *Self, value: T) bool {
+            const b = self.bottom.load(.monotonic);
+            const t = self.top.load(.acquire);
+            if (b - t >= size) return false;
+
+            @atomicStore(T, &self.buffer[@intCast(b & mask)], value, .monotonic);
+            self.bottom.store(b + 1, .release);
+            return true;
+        }
+
+        /// Owner only.
+        pub fn pop(self: *Self) ?T {
+            const b = self.bottom.load(.monotonic) - 1;
+            self.bottom.store(b, .seq_cst);
+            const t = self.top.load(.seq_cst);
+
+            if (t > b) {
+                // Empty
+                self.bottom.store(b + 1, .monotonic);
+                return null;
+            }
+
+            const value = @atomicLoad(T, &self.buffer[@intCast(b & mask)], .monotonic);
+            if (t != b) return value;
+
+            // Last item, race with thieves.
+            const won = null == self.top.cmpxchgStrong(t, t + 1, .seq_cst, .monotonic);
+            self.bottom.store(b + 1, .monotonic);
+            return if (won) value else null;
+        }
+
+        /// Any thread.
+        pub fn steal(self: *Self) ?T {
+            const t = self.top.load(.seq_cst);
+            const b = self.bottom.load(.seq_cst);
+            if (t >= b) return null;
+
+            const value = @atomicLoad(T, &self.buffer[@intCast(t & mask)], .monotonic);
+            if (null != self.top.cmpxchgStrong(t, t + 1, .seq_cst, .monotonic)) {
+                // Lost race with other thief or owner.
+                return null;
+            }
+            return value;
+        }
+
+        /// Any thread, only approximation.
+        pub fn isEmpty(self: *const Self) bool {
+            return self.bottom.load(.monotonic) <= self.top.load(.monotonic);
+        }
     };
 }
 
@@ -115,5 +198,11 @@ pub fn QueueWithLock(comptime T: type) type {
             defer self.mutex.unlock(io);
             self.ll.prepend(&new_node.node);
         }
+
+        pub fn isEmpty(self: *Self, io: std.Io) bool {
+            self.mutex.lockUncancelable(io);
+            defer self.mutex.unlock(io);
+            return self.ll.first == null;
+        }
     };
 }
@@ -56,14 +56,23 @@ pub const TaskStub = struct {
     task: Main,
 };
 
+/// Lower bound for derived batch size so small workloads do not pay for many tasks.
 pub const default_batch_size = 32;
 
 pub const BatchWorkloadArgs = struct {
     allocator: std.mem.Allocator,
-    batch_size: usize = default_batch_size,
+
+    /// Items per task.
+    /// 0 == derive from count and worker count.
+    batch_size: usize = 0,
     count: usize,
 };
 
+fn autoBatchSize(count: usize) usize {
+    // Few batches per worker so stealing can balance uneven items.
+    return @max(default_batch_size, count / (getThreadNum() * 4));
+}
+
 pub fn batchWorkloadTask(
     args: BatchWorkloadArgs,
     create_args: anytype,
@@ -74,9 +83,7 @@ pub fn batchWorkloadTask(
 
     if (args.count == 0) return null;
     const items_count = args.count;
-    const batch_size_by_workers = args.batch_size; //items_count / @max(1, args.task_api.getThreadNum() - 1);
-    const batch_size = if (batch_size_by_workers == 0) items_count else batch_size_by_workers;
-    // std.log.debug("dddd {d}", .{batch_size});
+    const batch_size = if (args.batch_size == 0) autoBatchSize(items_count) else args.batch_size;
 
     if (items_count <= batch_size) {
         var a = args;
@@ -96,8 +103,9 @@ pub fn batchWorkloadTask(
     var tasks = try TaskIdList.initCapacity(args.allocator, if (batch_rest == 0) batch_count else batch_count + 1);
     defer tasks.deinit(args.allocator);
 
-    const aargs = args;
-    // aargs.batch_size = batch_size;
+    // createTask compute offsets from batch_size.
+    var aargs = args;
+    aargs.batch_size = batch_size;
 
     for (0..batch_count) |batch_id| {
         if (batch_rest > 0 and (batch_id == batch_count - 1)) {
@@ -122,8 +130,202 @@ pub fn batchWorkloadTask(
     return if (tasks.items.len == 0) null else try combine(tasks.items);
 }
 
+/// Half-open index range [begin, end).
+pub const Range = struct {
+    begin: usize,
+    end: usize,
+
+    pub inline fn len(self: Range) usize {
+        return self.end - self.begin;
+    }
+};
+
+pub const ParallelForArgs = struct {
+    count: usize,
+
+    /// Items processed between split checks.
+    /// 0 == derive from count and worker count.
+    grain_size: usize = 0,
+};
+
+/// Per worker value. Every worker write only to own item so no atomics are needed.
+/// Items are cache line aligned to avoid false sharing.
+/// Threads that are not task workers have no item.
+pub fn PerWorker(comptime T: type) type {
+    return struct {
+        const Self = @This();
+
+        const Item = struct {
+            value: T align(std.atomic.cache_line),
+        };
+
+        items: []Item,
+
+        pub fn init(allocator: std.mem.Allocator, value: T) !Self {
+            const items = try allocator.alloc(Item, getThreadNum());
+            for (items) |*item| item.* = .{ .value = value };
+            return .{ .items = items };
+        }
+
+        pub fn deinit(self: *Self, allocator: std.mem.Allocator) void {
+            allocator.free(self.items);
+        }
+
+        /// Value for calling worker or null if caller is not task worker.
+        pub inline fn local(self: *Self) ?*T {
+            if (!isWorker()) return null;
+            return &self.items[getWorkerId()].value;
+        }
+    };
+}
+
+fn autoGrainSize(count: usize) usize {
+    // Few chunks per worker is enough, splitting is lazy.
+    return @max(1, count / (getThreadNum() * 16));
+}
+
+/// Call `RANGE_FCE.exec(ctx, range)` for all items in [0, args.count) and wait for them.
+/// Calling thread work on range and bisect it only if own queue is empty (lazy binary splitting),
+/// so workers that are busy do not pay for tasks that nobody steal.
+pub fn parallelFor(
+    args: ParallelForArgs,
+    ctx: anytype,
+    comptime RANGE_FCE: type,
+) !void {
+    var zone_ctx = profiler.ZoneN(@src(), "parallelFor");
+    defer zone_ctx.End();
+
+    if (args.count == 0) return;
+
+    const Ctx = @TypeOf(ctx);
+
+    const Shared = struct {
+        ctx: Ctx,
+        grain_size: usize,
+        failed: std.atomic.Value(bool) = .init(false),
+    };
+
+    const RangeTask = struct {
+        const Self = @This();
+
+        shared: *Shared,
+        range: Range,
+
+        pub fn exec(self: *Self) !void {
+            run(self.shared, self.range) catch |err| {
+                self.shared.failed.store(true, .release);
+                return err;
+            };
+        }
+
+        fn run(shared: *Shared, range: Range) !void {
+            // Splits made by this range. Each split halves range so 64 is enough.
+            var children: [64]TaskID = undefined;
+            var children_len: usize = 0;
+            defer waitMany(children[0..children_len]);
+
+            var r = range;
+            while (r.len() != 0) {
+                if (r.len() > shared.grain_size * 2 and children_len < children.len and api.isLocalQueueEmpty()) {
+                    const mid = r.begin + r.len() / 2;
+                    if (schedule(.none, Self{ .shared = shared, .range = .{ .begin = mid, .end = r.end } }, .{})) |t| {
+                        children[children_len] = t;
+                        children_len += 1;
+                        r.end = mid;
+                        continue;
+                    } else |_| {
+                        // No free slot, continue serial.
+                    }
+                }
+
+                const chunk_end = @min(r.end, r.begin + shared.grain_size);
+                try RANGE_FCE.exec(shared.ctx, Range{ .begin = r.begin, .end = chunk_end });
+                r.begin = chunk_end;
+            }
+        }
+    };
+
+    var shared = Shared{
+        .ctx = ctx,
+        .grain_size = if (args.grain_size == 0) autoGrainSize(args.count) else args.grain_size,
+    };
+
+    try RangeTask.run(&shared, .{ .begin = 0, .end = args.count });
+    if (shared.failed.load(.acquire)) return error.ParallelForFailed;
+}
+
+/// Same as parallelFor but `RANGE_FCE.exec(ctx, range, acc: *T)` accumulate into per worker partial
+/// result that are reduced with `REDUCE_FCE` after all ranges are done.
+pub fn parallelReduce(
+    comptime T: type,
+    allocator: std.mem.Allocator,
+    args: ParallelForArgs,
+    ctx: anytype,
+    comptime RANGE_FCE: type,
+    identity: T,
+    comptime REDUCE_FCE: fn (T, T) T,
+) !T {
+    var partials = try PerWorker(T).init(allocator, identity);
+    defer partials.deinit(allocator);
+
+    // Non worker threads can run ranges while waiting, they reduce to shared value under spin lock.
+    const External = struct {
+        value: T,
+        lock: std.atomic.Value(bool) = .init(false),
+
+        fn add(self: *@This(), value: T) void {
+            while (self.lock.cmpxchgWeak(false, true, .acquire, .monotonic) != null) std.atomic.spinLoopHint();
+            defer self.lock.store(false, .release);
+            self.value = REDUCE_FCE(self.value, value);
+        }
+    };
+    var external = External{ .value = identity };
+
+    const Ctx = @TypeOf(ctx);
+    const Wrap = struct {
+        ctx: Ctx,
+        partials: *PerWorker(T),
+        external: *External,
+        identity: T,
+    };
+
+    try parallelFor(
+        args,
+        Wrap{ .ctx = ctx, .partials = &partials, .external = &external, .identity = identity },
+        struct {
+            pub fn exec(wrap: Wrap, range: Range) !void {
+                if (wrap.partials.local()) |acc| {
+                    try RANGE_FCE.exec(wrap.ctx, range, acc);
+                } else {
+                    var acc = wrap.identity;
+                    try RANGE_FCE.exec(wrap.ctx, range, &acc);
+                    wrap.external.add(acc);
+                }
+            }
+        },
+    );
+
+    var result = external.value;
+    for (partials.items) |item| {
+        result = REDUCE_FCE(result, item.value);
+    }
+    return result;
+}
+
+pub const Priority = enum(u8) {
+    /// Work that current frame wait for (game tick, kernel phases). Taken before anything else.
+    frame_critical,
+    normal,
+    /// Long running work (import, save, compile). Started only if there is no other work
+    /// and per-frame background budget is not spent. Waiting on background task run background work regardless of budget,
+    /// waiting on other task take background only if waited task is blocked by prereqs and nothing else can run.
+    background,
+};
+pub const priority_count = std.enums.values(Priority).len;
+
 pub const ScheduleConfig = struct {
     affinity: ?u32 = null,
+    priority: Priority = .normal,
 };
 
 /// Schedule given work and return its TaskID.
@@ -162,10 +364,16 @@ pub inline fn getThreadNum() u64 {
 
 /// Get worker id 0..N.
 /// 0 == main thread.
+/// Threads that are not task workers get 0 too, use `isWorker` to tell them apart.
 pub inline fn getWorkerId() usize {
     return api.getWorkerId();
 }
 
+/// Is calling thread task worker (main thread included).
+pub inline fn isWorker() bool {
+    return api.isWorker();
+}
+
 pub inline fn isDone(task: TaskID) bool {
     return api.isDone(task);
 }
@@ -183,7 +391,9 @@ pub const TaskAPI = struct {
     combine: *const fn (tasks: []const TaskID) anyerror!TaskID,
     getThreadNum: *const fn () u64,
     getWorkerId: *const fn () usize,
+    isWorker: *const fn () bool,
     doOneTask: *const fn (only_prio: bool) void,
+    isLocalQueueEmpty: *const fn () bool,
 };
 
 pub var api: *const TaskAPI = undefined;
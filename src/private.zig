@@ -4,6 +4,7 @@ pub const apidb = @import("kernel/private/apidb.zig");
 pub const assetdb = @import("kernel/private/assetdb.zig");
 pub const cdb = @import("kernel/private/cdb.zig");
 pub const coreui = @import("coreui/private/coreui.zig");
+pub const fswatch = @import("kernel/private/fswatch.zig");
 pub const gpu = @import("kernel/private/gpu.zig");
 pub const kernel = @import("kernel/private/kernel.zig");
 pub const log = @import("kernel/private/log.zig");
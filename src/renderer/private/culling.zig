@@ -2,6 +2,7 @@ const std = @import("std");
 const Allocator = std.mem.Allocator;
 
 const cetech1 = @import("cetech1");
+const cetech1_options = @import("cetech1_options");
 const cdb = cetech1.cdb;
 const ecs = cetech1.ecs;
 const math = cetech1.math;
@@ -26,8 +27,15 @@ const EntitiesIdxList = cetech1.ArrayList(usize);
 
 pub const TransformList = cetech1.ArrayList(transform.WorldTransformComponent);
 pub const CullableBufferList = cetech1.ArrayList(*anyopaque);
-pub const CullingSphereVolumeList = cetech1.ArrayList(public.SphereBoudingVolume);
-pub const CullingBoxVolumeList = cetech1.ArrayList(public.BoxBoudingVolume);
+
+// Cull kernels test `LANES` volumes per iteration.
+pub const LANES = @min(8, std.simd.suggestVectorLength(f32) orelse 4);
+const F32xN = @Vector(LANES, f32);
+pub const LaneMask = std.meta.Int(.unsigned, LANES);
+
+// Cull inputs, components fill them in place as SoA columns.
+pub const SphereSoAList = public.SphereCullingVolumeList;
+pub const BoxSoAList = public.BoxCullingVolumeList;
 
 // Log for module
 const log = std.log.scoped(.culling);
@@ -45,8 +53,8 @@ pub const CullingRequest = struct {
 
     mtx: TransformList = .empty,
     data: CullableBufferList = .empty,
-    sphere_volumes: CullingSphereVolumeList = .empty,
-    box_volumes: CullingBoxVolumeList = .empty,
+    sphere_volumes: SphereSoAList = .empty,
+    box_volumes: BoxSoAList = .empty,
 
     data_size: usize,
 
@@ -61,7 +69,6 @@ pub const CullingRequest = struct {
         try cr.data.ensureTotalCapacityPrecise(cr.allocator, cullable_count);
         try cr.data.resize(cr.allocator, cullable_count);
 
-        try cr.sphere_volumes.ensureTotalCapacityPrecise(cr.allocator, cullable_count);
         try cr.sphere_volumes.resize(cr.allocator, cullable_count);
 
         return cr;
@@ -78,7 +85,6 @@ pub const CullingRequest = struct {
         try self.data.ensureTotalCapacityPrecise(self.allocator, cullable_count);
         try self.data.resize(self.allocator, cullable_count);
 
-        try self.sphere_volumes.ensureTotalCapacityPrecise(self.allocator, cullable_count);
         try self.sphere_volumes.resize(self.allocator, cullable_count);
     }
 
@@ -99,17 +105,17 @@ pub const CullingResult = struct {
     box_entites_idx: EntitiesIdxList = .empty,
     compact_visibility: VisibilityAtomicFieldList = .empty,
 
-    visible_cnt: std.atomic.Value(usize),
+    // Sum of per worker partial counts, written after culling is done.
+    visible_cnt: usize = 0,
 
     pub fn init(allocator: std.mem.Allocator) CullingResult {
         return CullingResult{
             .allocator = allocator,
-            .visible_cnt = std.atomic.Value(usize).init(0),
         };
     }
 
     pub fn clear(self: *CullingResult) void {
-        self.visible_cnt = std.atomic.Value(usize).init(0);
+        self.visible_cnt = 0;
         self.visibility.clearRetainingCapacity();
         self.sphere_entites_idx.clearRetainingCapacity();
         self.box_entites_idx.clearRetainingCapacity();
@@ -132,7 +138,7 @@ pub const CullingResult = struct {
     }
 
     pub fn visibleCount(self: *CullingResult) usize {
-        return self.visible_cnt.raw;
+        return self.visible_cnt;
     }
 
     pub fn prepareBoxCompaction(self: *CullingResult, count: usize) !void {
@@ -159,11 +165,11 @@ pub const CullingResult = struct {
     }
 
     pub fn compactionSpheres(self: *CullingResult, count: usize) !usize {
-        try self.sphere_entites_idx.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt.raw);
-        try self.sphere_entites_idx.resize(self.allocator, self.visible_cnt.raw);
+        try self.sphere_entites_idx.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt);
+        try self.sphere_entites_idx.resize(self.allocator, self.visible_cnt);
 
-        try self.compact_visibility.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt.raw);
-        try self.compact_visibility.resize(self.allocator, self.visible_cnt.raw);
+        try self.compact_visibility.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt);
+        try self.compact_visibility.resize(self.allocator, self.visible_cnt);
         @memset(self.compact_visibility.items, std.atomic.Value(u32).init(0));
 
         return self.compaction(
@@ -174,11 +180,11 @@ pub const CullingResult = struct {
     }
 
     pub fn compactionBox(self: *CullingResult, count: usize) !usize {
-        try self.box_entites_idx.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt.raw);
-        try self.box_entites_idx.resize(self.allocator, self.visible_cnt.raw);
+        try self.box_entites_idx.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt);
+        try self.box_entites_idx.resize(self.allocator, self.visible_cnt);
 
-        try self.compact_visibility.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt.raw);
-        try self.compact_visibility.resize(self.allocator, self.visible_cnt.raw);
+        try self.compact_visibility.ensureTotalCapacityPrecise(self.allocator, self.visible_cnt);
+        try self.compact_visibility.resize(self.allocator, self.visible_cnt);
         @memset(self.compact_visibility.items, std.atomic.Value(u32).init(0));
 
         return self.compaction(
@@ -189,56 +195,189 @@ pub const CullingResult = struct {
     }
 };
 
-// TODO : Faster (Culling in clip space? simd?)
-const CullingSphereTask = struct {
-    count: usize,
-    visibility_offset: usize,
-    volumes: []const public.SphereBoudingVolume,
-    viewers: []const Viewer,
-    result: *CullingResult,
+fn reduceAdd(a: usize, b: usize) usize {
+    return a + b;
+}
+
+// Frustum planes splatted to lanes.
+pub const SimdFrustum = struct {
+    // nx, ny, nz, d
+    p: [6][4]F32xN,
 
-    pub fn exec(self: *@This()) !void {
+    pub fn init(frustum: math.FrustumPlanes) SimdFrustum {
+        var self: SimdFrustum = undefined;
+        for (frustum.p, 0..) |plane, idx| {
+            inline for (0..4) |c| {
+                self.p[idx][c] = @splat(plane.v[c]);
+            }
+        }
+        return self;
+    }
+
+    /// Return bit for every sphere that is inside or intersect frustum.
+    pub fn vsSpheres(self: *const SimdFrustum, x: F32xN, y: F32xN, z: F32xN, r: F32xN) LaneMask {
+        var min_dist: F32xN = @splat(std.math.inf(f32));
+        inline for (self.p) |plane| {
+            const dist = x * plane[0] + y * plane[1] + z * plane[2] + plane[3] + r;
+            min_dist = @min(min_dist, dist);
+        }
+        return @bitCast(min_dist >= @as(F32xN, @splat(0)));
+    }
+
+    /// Return bit for every OBB that is inside or intersect frustum.
+    /// Box is outside if center distance plus box extent projected to plane normal is behind any plane.
+    pub fn vsBoxes(self: *const SimdFrustum, b: BoxLanes) LaneMask {
+        var min_dist: F32xN = @splat(std.math.inf(f32));
+        inline for (self.p) |plane| {
+            const dist = b.cx * plane[0] + b.cy * plane[1] + b.cz * plane[2] + plane[3];
+            const extent = @abs(b.xx * plane[0] + b.xy * plane[1] + b.xz * plane[2]) +
+                @abs(b.yx * plane[0] + b.yy * plane[1] + b.yz * plane[2]) +
+                @abs(b.zx * plane[0] + b.zy * plane[1] + b.zz * plane[2]);
+            min_dist = @min(min_dist, dist + extent);
+        }
+        return @bitCast(min_dist > @as(F32xN, @splat(0)));
+    }
+};
+
+pub const BoxLanes = struct {
+    cx: F32xN,
+    cy: F32xN,
+    cz: F32xN,
+    xx: F32xN,
+    xy: F32xN,
+    xz: F32xN,
+    yx: F32xN,
+    yy: F32xN,
+    yz: F32xN,
+    zx: F32xN,
+    zy: F32xN,
+    zz: F32xN,
+
+    pub fn load(soa: BoxSoAList.Slice, idx: usize, end: usize) BoxLanes {
+        var self: BoxLanes = undefined;
+        inline for (std.meta.fields(BoxLanes)) |field| {
+            @field(self, field.name) = loadLanes(soa.items(@field(BoxSoAList.Field, field.name)), idx, end);
+        }
+        return self;
+    }
+};
+
+// Load lanes from idx, lanes after end are zero.
+inline fn loadLanes(values: []const f32, idx: usize, end: usize) F32xN {
+    if (idx + LANES <= end) return values[idx..][0..LANES].*;
+
+    var tmp: [LANES]f32 = @splat(0);
+    @memcpy(tmp[0 .. end - idx], values[idx..end]);
+    return tmp;
+}
+
+inline fn tailMask(count: usize) LaneMask {
+    if (count >= LANES) return std.math.maxInt(LaneMask);
+    return (@as(LaneMask, 1) << @intCast(count)) - 1;
+}
+
+// Skip bit for every lane.
+inline fn skipMask(skip_culling: []const bool, idx: usize, lanes: usize) LaneMask {
+    var skip: LaneMask = 0;
+    for (skip_culling[idx .. idx + lanes], 0..) |skip_lane, lane| {
+        if (skip_lane) skip |= @as(LaneMask, 1) << @intCast(lane);
+    }
+    return skip;
+}
+
+const CullingSphereRange = struct {
+    const Ctx = struct {
+        soa: SphereSoAList.Slice,
+        viewers: []const Viewer,
+        frustums: []const SimdFrustum,
+        result: *CullingResult,
+    };
+
+    pub fn exec(ctx: Ctx, range: task.Range, visible_cnt: *usize) !void {
         var zone = profiler.ZoneN(@src(), "CullingSphereTask");
         defer zone.End();
 
-        for (self.volumes, 0..) |volume, i| {
-            for (self.viewers, 0..) |viewer, viewer_idx| {
-                if (volume.visibility_mask.intersectWith(viewer.visibility_mask).mask == 0) continue;
-
-                if (volume.skip_culling or viewer.frustum.vsSphereNaive(volume.sphere)) {
-                    self.result.setVisibility(self.visibility_offset + i, viewer_idx, true);
-                    _ = self.result.visible_cnt.fetchAdd(1, .monotonic);
+        const xs = ctx.soa.items(.x);
+        const ys = ctx.soa.items(.y);
+        const zs = ctx.soa.items(.z);
+        const rs = ctx.soa.items(.r);
+        const masks = ctx.soa.items(.visibility_mask);
+        const skips = ctx.soa.items(.skip_culling);
+
+        var cnt: usize = 0;
+        var idx = range.begin;
+        while (idx < range.end) : (idx += LANES) {
+            const x = loadLanes(xs, idx, range.end);
+            const y = loadLanes(ys, idx, range.end);
+            const z = loadLanes(zs, idx, range.end);
+            const r = loadLanes(rs, idx, range.end);
+
+            const lanes = @min(LANES, range.end - idx);
+            const tail = tailMask(lanes);
+            const skip = skipMask(skips, idx, lanes);
+
+            for (ctx.frustums, ctx.viewers, 0..) |*frustum, viewer, viewer_idx| {
+                var bits = (frustum.vsSpheres(x, y, z, r) | skip) & tail;
+                while (bits != 0) : (bits &= bits - 1) {
+                    const i = idx + @ctz(bits);
+                    if (masks[i].intersectWith(viewer.visibility_mask).mask == 0) continue;
+
+                    ctx.result.setVisibility(i, viewer_idx, true);
+                    cnt += 1;
                 }
             }
         }
+        visible_cnt.* += cnt;
     }
 };
 
-// TODO : Faster (Culling in clip space? simd?)
-const CullingBoxTask = struct {
-    count: usize,
-    visibility_offset: usize,
-    volumes: []const public.BoxBoudingVolume,
-    viewers: []const Viewer,
-    result: *CullingResult,
+const CullingBoxRange = struct {
+    const Ctx = struct {
+        soa: BoxSoAList.Slice,
+        viewers: []const Viewer,
+        frustums: []const SimdFrustum,
+        result: *CullingResult,
+    };
 
-    pub fn exec(self: *@This()) !void {
+    pub fn exec(ctx: Ctx, range: task.Range, visible_cnt: *usize) !void {
         var zone = profiler.ZoneN(@src(), "CullingBoxTask");
         defer zone.End();
 
-        for (self.volumes, 0..) |box, i| {
-            for (self.viewers, 0..) |viewer, viewer_idx| {
-                if (box.visibility_mask.intersectWith(viewer.visibility_mask).mask == 0) continue;
+        const masks = ctx.soa.items(.visibility_mask);
+        const skips = ctx.soa.items(.skip_culling);
+
+        var cnt: usize = 0;
+        var idx = range.begin;
+        while (idx < range.end) : (idx += LANES) {
+            const boxes = BoxLanes.load(ctx.soa, idx, range.end);
 
-                if (box.skip_culling or viewer.frustum.vsOBBNaive(box.t, box.min, box.max)) {
-                    self.result.setVisibility(self.visibility_offset + i, viewer_idx, true);
-                    _ = self.result.visible_cnt.fetchAdd(1, .monotonic);
+            const lanes = @min(LANES, range.end - idx);
+            const tail = tailMask(lanes);
+            const skip = skipMask(skips, idx, lanes);
+
+            for (ctx.frustums, ctx.viewers, 0..) |*frustum, viewer, viewer_idx| {
+                var bits = (frustum.vsBoxes(boxes) | skip) & tail;
+                while (bits != 0) : (bits &= bits - 1) {
+                    const i = idx + @ctz(bits);
+                    if (masks[i].intersectWith(viewer.visibility_mask).mask == 0) continue;
+
+                    ctx.result.setVisibility(i, viewer_idx, true);
+                    cnt += 1;
                 }
             }
         }
+        visible_cnt.* += cnt;
     }
 };
 
+fn initSimdFrustums(allocator: std.mem.Allocator, viewers: []const Viewer) ![]SimdFrustum {
+    const frustums = try allocator.alloc(SimdFrustum, viewers.len);
+    for (viewers, frustums) |viewer, *frustum| {
+        frustum.* = .init(viewer.frustum);
+    }
+    return frustums;
+}
+
 pub const CullingSystem = struct {
     const Self = @This();
 
@@ -256,8 +395,6 @@ pub const CullingSystem = struct {
     cr_pool: ResultPool,
     result_map: ResultMap = .{},
 
-    tasks: cetech1.task.TaskIdList = .empty,
-
     draw_culling_sphere_debug: bool = false,
     draw_culling_box_debug: bool = false,
 
@@ -285,8 +422,6 @@ pub const CullingSystem = struct {
 
         self.result_map.deinit(self.allocator);
         self.cr_pool.deinit();
-
-        self.tasks.deinit(self.allocator);
     }
 
     pub fn getNewRequest(self: *Self, io: std.Io, cullable_type: cetech1.StrId64, cullable_count: usize, cullable_size: usize) !*CullingRequest {
@@ -323,8 +458,6 @@ pub const CullingSystem = struct {
         var cull_zone = profiler.ZoneN(@src(), "Culling system - doCullingSpheres");
         defer cull_zone.End();
 
-        self.tasks.clearRetainingCapacity();
-
         //
         // Sphere phase
         //
@@ -332,10 +465,13 @@ pub const CullingSystem = struct {
             var zone = profiler.ZoneN(@src(), "Culling system - Sphere culling");
             defer zone.End();
 
+            const frustums = try initSimdFrustums(allocator, viewers);
+            defer allocator.free(frustums);
+
             for (self.request_map.keys(), self.request_map.values()) |k, request| {
                 const result = self.getResult(k) orelse continue; // TODO: warning
 
-                const items_count = request.sphere_volumes.items.len;
+                const items_count = request.sphere_volumes.len;
 
                 try result.visibility.ensureTotalCapacityPrecise(result.allocator, items_count);
                 try result.visibility.resize(result.allocator, items_count);
@@ -343,43 +479,20 @@ pub const CullingSystem = struct {
 
                 if (items_count == 0) continue;
 
-                const ARGS = struct {
-                    rq: *CullingRequest,
-                    result: *CullingResult,
-
-                    viewers: []const Viewer,
-                };
-
-                if (try cetech1.task.batchWorkloadTask(
-                    .{
-                        .allocator = allocator,
-                        .count = items_count,
-                    },
-                    ARGS{
-                        .rq = request,
-                        .result = result,
+                result.visible_cnt = try task.parallelReduce(
+                    usize,
+                    allocator,
+                    .{ .count = items_count },
+                    CullingSphereRange.Ctx{
+                        .soa = request.sphere_volumes.slice(),
                         .viewers = viewers,
+                        .frustums = frustums,
+                        .result = result,
                     },
-                    struct {
-                        pub fn createTask(create_args: ARGS, batch_id: usize, args: cetech1.task.BatchWorkloadArgs, count: usize) CullingSphereTask {
-                            const rq = create_args.rq;
-
-                            return CullingSphereTask{
-                                .count = count,
-                                .visibility_offset = batch_id * args.batch_size * create_args.viewers.len,
-                                .viewers = create_args.viewers,
-                                .result = create_args.result,
-                                .volumes = rq.sphere_volumes.items[batch_id * args.batch_size .. (batch_id * args.batch_size) + count],
-                            };
-                        }
-                    },
-                )) |t| {
-                    try self.tasks.append(self.allocator, t);
-                }
-            }
-
-            if (self.tasks.items.len != 0) {
-                task.waitMany(self.tasks.items);
+                    CullingSphereRange,
+                    0,
+                    reduceAdd,
+                );
             }
         }
 
@@ -391,7 +504,7 @@ pub const CullingSystem = struct {
             var cnt: usize = 0;
             for (self.request_map.keys(), self.request_map.values()) |k, rq| {
                 const result = self.getResult(k) orelse continue; // TODO: warning
-                cnt += try result.compactionSpheres(rq.sphere_volumes.items.len);
+                cnt += try result.compactionSpheres(rq.sphere_volumes.len);
             }
             return cnt;
         }
@@ -401,8 +514,6 @@ pub const CullingSystem = struct {
         var cull_zone = profiler.ZoneN(@src(), "Culling system - doCullingBox");
         defer cull_zone.End();
 
-        self.tasks.clearRetainingCapacity();
-
         //
         // Box phase
         //
@@ -410,12 +521,15 @@ pub const CullingSystem = struct {
             var zone = profiler.ZoneN(@src(), "Culling system - Box culling");
             defer zone.End();
 
+            const frustums = try initSimdFrustums(allocator, viewers);
+            defer allocator.free(frustums);
+
             for (self.request_map.keys(), self.request_map.values()) |k, value| {
                 const result = self.getResult(k) orelse continue; // TODO: warning
 
-                const items_count = value.box_volumes.items.len;
+                const items_count = value.box_volumes.len;
 
-                result.visible_cnt = std.atomic.Value(usize).init(0);
+                result.visible_cnt = 0;
 
                 try result.visibility.ensureTotalCapacityPrecise(result.allocator, items_count);
                 try result.visibility.resize(result.allocator, items_count);
@@ -423,42 +537,20 @@ pub const CullingSystem = struct {
 
                 if (items_count == 0) continue;
 
-                const ARGS = struct {
-                    rq: *CullingRequest,
-                    result: *CullingResult,
-                    viewers: []const Viewer,
-                };
-
-                if (try cetech1.task.batchWorkloadTask(
-                    .{
-                        .allocator = allocator,
-                        .count = items_count,
-                    },
-                    ARGS{
-                        .rq = value,
-                        .result = result,
+                result.visible_cnt = try task.parallelReduce(
+                    usize,
+                    allocator,
+                    .{ .count = items_count },
+                    CullingBoxRange.Ctx{
+                        .soa = value.box_volumes.slice(),
                         .viewers = viewers,
+                        .frustums = frustums,
+                        .result = result,
                     },
-                    struct {
-                        pub fn createTask(create_args: ARGS, batch_id: usize, args: cetech1.task.BatchWorkloadArgs, count: usize) CullingBoxTask {
-                            const rq = create_args.rq;
-
-                            return CullingBoxTask{
-                                .count = count,
-                                .visibility_offset = batch_id * args.batch_size * create_args.viewers.len,
-                                .viewers = create_args.viewers,
-                                .result = create_args.result,
-                                .volumes = rq.box_volumes.items[batch_id * args.batch_size .. (batch_id * args.batch_size) + count],
-                            };
-                        }
-                    },
-                )) |t| {
-                    try self.tasks.append(self.allocator, t);
-                }
-            }
-
-            if (self.tasks.items.len != 0) {
-                task.waitMany(self.tasks.items);
+                    CullingBoxRange,
+                    0,
+                    reduceAdd,
+                );
             }
         }
 
@@ -470,7 +562,7 @@ pub const CullingSystem = struct {
             var cnt: usize = 0;
             for (self.request_map.keys(), self.request_map.values()) |k, rq| {
                 const result = self.getResult(k) orelse continue; // TODO: warning
-                cnt += try result.compactionBox(rq.box_volumes.items.len);
+                cnt += try result.compactionBox(rq.box_volumes.len);
             }
         }
     }
@@ -485,12 +577,14 @@ pub const CullingSystem = struct {
         for (self.request_map.keys(), self.request_map.values()) |k, rq| {
             const result = self.getResult(k) orelse continue; // TODO: warning
 
+            const volumes = rq.sphere_volumes.slice();
             for (result.sphere_entites_idx.items) |ent_idx| {
-                const volume = rq.sphere_volumes.items[ent_idx];
+                const volume = volumes.get(ent_idx);
+                const center: math.Vec3f = .{ .x = volume.x, .y = volume.y, .z = volume.z };
 
-                dd.drawCircleAxis(.X, volume.sphere.center, volume.sphere.radius, 0);
-                dd.drawCircleAxis(.Y, volume.sphere.center, volume.sphere.radius, 0);
-                dd.drawCircleAxis(.Z, volume.sphere.center, volume.sphere.radius, 0);
+                dd.drawCircleAxis(.X, center, volume.r, 0);
+                dd.drawCircleAxis(.Y, center, volume.r, 0);
+                dd.drawCircleAxis(.Z, center, volume.r, 0);
 
                 // dd.drawSphere(sphere.center, sphere.radius);
             }
@@ -507,11 +601,237 @@ pub const CullingSystem = struct {
         for (self.request_map.keys(), self.request_map.values()) |k, rq| {
             _ = k;
 
-            for (rq.box_volumes.items) |box| {
-                dd.pushTransform(box.t.toMat());
+            const volumes = rq.box_volumes.slice();
+            for (0..volumes.len) |idx| {
+                dd.pushTransform(volumes.get(idx).toMat());
                 defer dd.popTransform();
-                dd.drawAABB(box.min, box.max);
+                dd.drawAABB(.splat(-1), .splat(1));
             }
         }
     }
 };
+
+fn testViewers(allocator: std.mem.Allocator, count: usize) ![]Viewer {
+    const viewers = try allocator.alloc(Viewer, count);
+    const proj = math.Mat44f.perspectiveFovLh(0.25 * std.math.pi, 16.0 / 9.0, 0.1, 500, false);
+    for (viewers, 0..) |*viewer, idx| {
+        const angle = @as(f32, @floatFromInt(idx)) * (2 * std.math.pi / @as(f32, @floatFromInt(count)));
+        viewer.* = .{
+            .frustum = .fromMat44(math.Mat44f.rotationY(angle).mul(proj)),
+            .visibility_mask = .initFull(),
+        };
+    }
+    return viewers;
+}
+
+fn testRandomVec(random: std.Random, size: f32) math.Vec3f {
+    return .{
+        .x = (random.float(f32) * 2 - 1) * size,
+        .y = (random.float(f32) * 2 - 1) * size,
+        .z = (random.float(f32) * 2 - 1) * size,
+    };
+}
+
+test "culling: SIMD kernels should match naive culling" {
+    const allocator = std.testing.allocator;
+
+    var prng = std.Random.DefaultPrng.init(1);
+    const random = prng.random();
+
+    const viewers = try testViewers(allocator, 4);
+    defer allocator.free(viewers);
+
+    const count = 1000 + LANES / 2;
+
+    const spheres = try allocator.alloc(public.SphereBoudingVolume, count);
+    defer allocator.free(spheres);
+    const boxes = try allocator.alloc(public.BoxBoudingVolume, count);
+    defer allocator.free(boxes);
+
+    for (spheres, boxes, 0..) |*sphere, *box, idx| {
+        sphere.* = .{
+            .sphere = .{ .center = testRandomVec(random, 300), .radius = random.float(f32) * 20 },
+            .visibility_mask = .initFull(),
+            .skip_culling = idx % 97 == 0,
+        };
+
+        const half = testRandomVec(random, 10);
+        box.* = .{
+            .t = .{
+                .position = testRandomVec(random, 300),
+                .rotation = .fromRollPitchYaw(random.float(f32) * std.math.pi, random.float(f32) * std.math.pi, 0),
+                .scale = .splat(0.5 + random.float(f32)),
+            },
+            .min = .{ .x = -@abs(half.x), .y = -@abs(half.y), .z = -@abs(half.z) },
+            .max = .{ .x = @abs(half.x), .y = @abs(half.y), .z = @abs(half.z) },
+            .visibility_mask = .initFull(),
+        };
+    }
+
+    var sphere_soa: SphereSoAList = .empty;
+    defer sphere_soa.deinit(allocator);
+    try sphere_soa.resize(allocator, count);
+    for (spheres, 0..) |volume, i| sphere_soa.set(i, .init(volume));
+
+    var box_soa: BoxSoAList = .empty;
+    defer box_soa.deinit(allocator);
+    try box_soa.resize(allocator, count);
+    for (boxes, 0..) |volume, i| box_soa.set(i, .init(volume));
+
+    const frustums = try initSimdFrustums(allocator, viewers);
+    defer allocator.free(frustums);
+
+    var idx: usize = 0;
+    while (idx < count) : (idx += LANES) {
+        const lanes = @min(LANES, count - idx);
+        const sphere_slice = sphere_soa.slice();
+
+        const sphere_bits = frustums[0].vsSpheres(
+            loadLanes(sphere_slice.items(.x), idx, count),
+            loadLanes(sphere_slice.items(.y), idx, count),
+            loadLanes(sphere_slice.items(.z), idx, count),
+            loadLanes(sphere_slice.items(.r), idx, count),
+        );
+        const box_bits = frustums[0].vsBoxes(BoxLanes.load(box_soa.slice(), idx, count));
+
+        for (0..lanes) |lane| {
+            const sphere = spheres[idx + lane].sphere;
+            const box = boxes[idx + lane];
+            try std.testing.expectEqual(viewers[0].frustum.vsSphereNaive(sphere), sphere_bits & (@as(LaneMask, 1) << @intCast(lane)) != 0);
+            try std.testing.expectEqual(viewers[0].frustum.vsOBBNaive(box.t, box.min, box.max), box_bits & (@as(LaneMask, 1) << @intCast(lane)) != 0);
+        }
+    }
+
+    // Whole range with skip and tail.
+    var result = CullingResult.init(allocator);
+    defer result.deinit();
+    try result.visibility.resize(allocator, count);
+    @memset(result.visibility.items, std.atomic.Value(u32).init(0));
+
+    var visible_cnt: usize = 0;
+    try CullingSphereRange.exec(
+        .{ .soa = sphere_soa.slice(), .viewers = viewers, .frustums = frustums, .result = &result },
+        .{ .begin = 0, .end = count },
+        &visible_cnt,
+    );
+
+    var expect_cnt: usize = 0;
+    for (spheres, 0..) |volume, i| {
+        for (viewers, 0..) |viewer, viewer_idx| {
+            const visible = volume.skip_culling or viewer.frustum.vsSphereNaive(volume.sphere);
+            if (visible) expect_cnt += 1;
+            try std.testing.expectEqual(visible, result.visibility.items[i].load(.monotonic) & (@as(u32, 1) << @intCast(viewer_idx)) != 0);
+        }
+    }
+    try std.testing.expectEqual(expect_cnt, visible_cnt);
+}
+
+test "culling: 1M volumes benchmark" {
+    if (!cetech1_options.enable_bench) return error.SkipZigTest;
+
+    const allocator = std.testing.allocator;
+    const io = std.testing.io;
+
+    const count = 1_000_000;
+    const viewers_count = 4;
+
+    var prng = std.Random.DefaultPrng.init(1);
+    const random = prng.random();
+
+    const viewers = try testViewers(allocator, viewers_count);
+    defer allocator.free(viewers);
+
+    const frustums = try initSimdFrustums(allocator, viewers);
+    defer allocator.free(frustums);
+
+    const spheres = try allocator.alloc(public.SphereBoudingVolume, count);
+    defer allocator.free(spheres);
+    const boxes = try allocator.alloc(public.BoxBoudingVolume, count);
+    defer allocator.free(boxes);
+
+    for (spheres, boxes) |*sphere, *box| {
+        sphere.* = .{
+            .sphere = .{ .center = testRandomVec(random, 500), .radius = random.float(f32) * 5 },
+            .visibility_mask = .initFull(),
+        };
+        box.* = .{
+            .t = .{ .position = testRandomVec(random, 500), .rotation = .fromRollPitchYaw(random.float(f32), random.float(f32), 0) },
+            .min = .splat(-1),
+            .max = .splat(1),
+            .visibility_mask = .initFull(),
+        };
+    }
+
+    // Components fill SoA columns directly.
+    var sphere_soa: SphereSoAList = .empty;
+    defer sphere_soa.deinit(allocator);
+    try sphere_soa.resize(allocator, count);
+    for (spheres, 0..) |volume, i| sphere_soa.set(i, .init(volume));
+
+    var box_soa: BoxSoAList = .empty;
+    defer box_soa.deinit(allocator);
+    try box_soa.resize(allocator, count);
+    for (boxes, 0..) |volume, i| box_soa.set(i, .init(volume));
+
+    var result = CullingResult.init(allocator);
+    defer result.deinit();
+    try result.visibility.resize(allocator, count);
+
+    // Naive AoS
+    var naive_sphere_cnt: usize = 0;
+    var naive_box_cnt: usize = 0;
+    const naive_sphere_start = std.Io.Timestamp.now(io, .awake);
+    for (spheres) |volume| {
+        for (viewers) |viewer| {
+            if (viewer.frustum.vsSphereNaive(volume.sphere)) naive_sphere_cnt += 1;
+        }
+    }
+    const naive_sphere_ns = naive_sphere_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    const naive_box_start = std.Io.Timestamp.now(io, .awake);
+    for (boxes) |box| {
+        for (viewers) |viewer| {
+            if (viewer.frustum.vsOBBNaive(box.t, box.min, box.max)) naive_box_cnt += 1;
+        }
+    }
+    const naive_box_ns = naive_box_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    // SIMD SoA
+    @memset(result.visibility.items, std.atomic.Value(u32).init(0));
+    var sphere_cnt: usize = 0;
+    const sphere_start = std.Io.Timestamp.now(io, .awake);
+    try CullingSphereRange.exec(
+        .{ .soa = sphere_soa.slice(), .viewers = viewers, .frustums = frustums, .result = &result },
+        .{ .begin = 0, .end = count },
+        &sphere_cnt,
+    );
+    const sphere_ns = sphere_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    @memset(result.visibility.items, std.atomic.Value(u32).init(0));
+    var box_cnt: usize = 0;
+    const box_start = std.Io.Timestamp.now(io, .awake);
+    try CullingBoxRange.exec(
+        .{ .soa = box_soa.slice(), .viewers = viewers, .frustums = frustums, .result = &result },
+        .{ .begin = 0, .end = count },
+        &box_cnt,
+    );
+    const box_ns = box_start.durationTo(.now(io, .awake)).toNanoseconds();
+
+    // Different operation order can flip volumes that touch plane.
+    const tests = count * viewers_count;
+    try std.testing.expect(@max(naive_sphere_cnt, sphere_cnt) - @min(naive_sphere_cnt, sphere_cnt) <= tests / 10000);
+    try std.testing.expect(@max(naive_box_cnt, box_cnt) - @min(naive_box_cnt, box_cnt) <= tests / 10000);
+
+    std.debug.print(
+        "culling: volumes={d} viewers={d} lanes={d} sphere naive={d:.3} simd={d:.3} box naive={d:.3} simd={d:.3} volumes/ns\n",
+        .{
+            count,
+            viewers_count,
+            LANES,
+            @as(f64, tests) / @as(f64, @floatFromInt(@max(1, naive_sphere_ns))),
+            @as(f64, tests) / @as(f64, @floatFromInt(@max(1, sphere_ns))),
+            @as(f64, tests) / @as(f64, @floatFromInt(@max(1, naive_box_ns))),
+            @as(f64, tests) / @as(f64, @floatFromInt(@max(1, box_ns))),
+        },
+    );
+}
@@ -27,6 +27,10 @@ const editor = cetech1.editor;
 
 const public = cetech1.renderer.viewport;
 
+test {
+    _ = culling;
+}
+
 const module_name = .render_viewport;
 
 // Need for logging from std.
@@ -609,8 +613,7 @@ const RenderViewportTask = struct {
                             null,
                             rq.mtx.items,
                             rq.data.items,
-                            .sphere,
-                            std.mem.sliceAsBytes(rq.sphere_volumes.items),
+                            .{ .sphere = rq.sphere_volumes.slice() },
                         );
                     }
 
@@ -637,7 +640,6 @@ const RenderViewportTask = struct {
                     const rq = viewport.shaderables_culling.getRequest(renderable_id) orelse continue;
                     const result = viewport.shaderables_culling.getResult(renderable_id) orelse continue; // TODO: warning
 
-                    try rq.box_volumes.ensureTotalCapacityPrecise(rq.allocator, result.sphere_entites_idx.items.len);
                     try rq.box_volumes.resize(rq.allocator, result.sphere_entites_idx.items.len);
 
                     if (result.sphere_entites_idx.items.len == 0) continue;
@@ -647,8 +649,7 @@ const RenderViewportTask = struct {
                         result.sphere_entites_idx.items,
                         rq.mtx.items,
                         rq.data.items,
-                        .box,
-                        std.mem.sliceAsBytes(rq.box_volumes.items),
+                        .{ .box = rq.box_volumes.slice() },
                     );
                 }
 
@@ -788,8 +789,7 @@ const RenderViewportTask = struct {
                                 null,
                                 rq.mtx.items,
                                 rq.data.items,
-                                .sphere,
-                                std.mem.sliceAsBytes(rq.sphere_volumes.items),
+                                .{ .sphere = rq.sphere_volumes.slice() },
                             );
                         }
                     }
@@ -815,7 +815,6 @@ const RenderViewportTask = struct {
                         const rq = viewport.renderables_culling.getRequest(renderable_id) orelse continue;
                         const result = viewport.renderables_culling.getResult(renderable_id) orelse continue; // TODO: warning
 
-                        try rq.box_volumes.ensureTotalCapacityPrecise(rq.allocator, result.sphere_entites_idx.items.len);
                         try rq.box_volumes.resize(rq.allocator, result.sphere_entites_idx.items.len);
 
                         if (result.sphere_entites_idx.items.len == 0) continue;
@@ -825,8 +824,7 @@ const RenderViewportTask = struct {
                             result.sphere_entites_idx.items,
                             rq.mtx.items,
                             rq.data.items,
-                            .box,
-                            std.mem.sliceAsBytes(rq.box_volumes.items),
+                            .{ .box = rq.box_volumes.slice() },
                         );
                     }
 
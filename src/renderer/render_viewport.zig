@@ -30,10 +30,104 @@ pub const BoxBoudingVolume = struct {
     skip_culling: bool = false,
 };
 
+// Volumes are stored for culling as SoA columns, `fillBoundingVolumes` write them in place.
+pub const SphereCullingVolume = struct {
+    x: f32 = 0,
+    y: f32 = 0,
+    z: f32 = 0,
+    r: f32 = 0,
+    visibility_mask: visibility_flags.VisibilityFlags,
+    skip_culling: bool = false,
+
+    pub fn init(volume: SphereBoudingVolume) SphereCullingVolume {
+        return .{
+            .x = volume.sphere.center.x,
+            .y = volume.sphere.center.y,
+            .z = volume.sphere.center.z,
+            .r = volume.sphere.radius,
+            .visibility_mask = volume.visibility_mask,
+            .skip_culling = volume.skip_culling,
+        };
+    }
+};
+pub const SphereCullingVolumeList = std.MultiArrayList(SphereCullingVolume);
+
+// World space center and box axes scaled by half extents.
+pub const BoxCullingVolume = struct {
+    cx: f32 = 0,
+    cy: f32 = 0,
+    cz: f32 = 0,
+
+    xx: f32 = 0,
+    xy: f32 = 0,
+    xz: f32 = 0,
+
+    yx: f32 = 0,
+    yy: f32 = 0,
+    yz: f32 = 0,
+
+    zx: f32 = 0,
+    zy: f32 = 0,
+    zz: f32 = 0,
+
+    visibility_mask: visibility_flags.VisibilityFlags,
+    skip_culling: bool = false,
+
+    pub fn init(volume: BoxBoudingVolume) BoxCullingVolume {
+        const t = volume.t;
+        const half = volume.max.sub(volume.min).mul(.splat(0.5));
+        const center = t.mulVec(volume.min.add(volume.max).mul(.splat(0.5))).add(t.position);
+        const ax = t.rotation.rotateVec3(.{ .x = t.scale.x * half.x });
+        const ay = t.rotation.rotateVec3(.{ .y = t.scale.y * half.y });
+        const az = t.rotation.rotateVec3(.{ .z = t.scale.z * half.z });
+
+        return .{
+            .cx = center.x,
+            .cy = center.y,
+            .cz = center.z,
+            .xx = ax.x,
+            .xy = ax.y,
+            .xz = ax.z,
+            .yx = ay.x,
+            .yy = ay.y,
+            .yz = ay.z,
+            .zx = az.x,
+            .zy = az.y,
+            .zz = az.z,
+            .visibility_mask = volume.visibility_mask,
+            .skip_culling = volume.skip_culling,
+        };
+    }
+
+    // Matrix that map unit cube to box.
+    pub fn toMat(self: BoxCullingVolume) math.Mat44f {
+        return .{
+            .xx = self.xx,
+            .xy = self.xy,
+            .xz = self.xz,
+            .yx = self.yx,
+            .yy = self.yy,
+            .yz = self.yz,
+            .zx = self.zx,
+            .zy = self.zy,
+            .zz = self.zz,
+            .wx = self.cx,
+            .wy = self.cy,
+            .wz = self.cz,
+        };
+    }
+};
+pub const BoxCullingVolumeList = std.MultiArrayList(BoxCullingVolume);
+
 pub const BoundingVolumeType = enum(u8) {
     sphere,
     box,
-    _,
+};
+
+// Output for `fillBoundingVolumes`, slice is sized to volume count.
+pub const BoundingVolumes = union(BoundingVolumeType) {
+    sphere: SphereCullingVolumeList.Slice,
+    box: BoxCullingVolumeList.Slice,
 };
 
 pub const MAX_VIEWERS = 32;
@@ -53,8 +147,7 @@ pub const RendereableComponentI = struct {
         entites_idx: ?[]const usize,
         transforms: []const transform.WorldTransformComponent,
         data: []*anyopaque,
-        volume_type: BoundingVolumeType,
-        volumes: []u8,
+        volumes: BoundingVolumes,
     ) anyerror!void = undefined,
 
     render: *const fn (
@@ -101,8 +194,7 @@ pub const ShaderableComponentI = struct {
         entites_idx: ?[]const usize,
         transforms: []const transform.WorldTransformComponent,
         data: []*anyopaque,
-        volume_type: BoundingVolumeType,
-        volumes: []u8,
+        volumes: BoundingVolumes,
     ) anyerror!void = undefined,
 
     update: *const fn (
@@ -167,45 +167,36 @@ const bloom_shaderable = render_viewport.ShaderableComponentI.implement(
             entites_idx: ?[]const usize,
             transforms: []const transform.WorldTransformComponent,
             data: []*anyopaque,
-            volume_type: render_viewport.BoundingVolumeType,
-            volumes: []u8,
+            volumes: render_viewport.BoundingVolumes,
         ) !void {
             _ = allocator;
             _ = entites_idx;
             _ = transforms;
 
-            switch (volume_type) {
-                .sphere => {
-                    var sphere_out_volumes = std.mem.bytesAsSlice(render_viewport.SphereBoudingVolume, volumes);
-
+            switch (volumes) {
+                .sphere => |sphere_out_volumes| {
                     for (data, 0..) |_, idx| {
                         var dc_visibility_flags = visibility_flags.VisibilityFlags.initEmpty();
                         dc_visibility_flags.set(0); // TODO:
 
-                        sphere_out_volumes[idx] = .{
+                        sphere_out_volumes.set(idx, .{
                             .skip_culling = true,
                             .visibility_mask = dc_visibility_flags,
-                        };
+                        });
                     }
                 },
 
-                .box => {
-                    var box_out_volumes = std.mem.bytesAsSlice(render_viewport.BoxBoudingVolume, volumes);
-
+                .box => |box_out_volumes| {
                     for (data, 0..) |_, idx| {
                         var dc_visibility_flags = visibility_flags.VisibilityFlags.initEmpty();
                         dc_visibility_flags.set(0); // TODO:
 
-                        box_out_volumes[idx] = .{
+                        box_out_volumes.set(idx, .{
                             .skip_culling = true,
                             .visibility_mask = dc_visibility_flags,
-                        };
+                        });
                     }
                 },
-
-                else => |v| {
-                    log.err("Invalid bounding volume {d}", .{v});
-                },
             }
         }
 
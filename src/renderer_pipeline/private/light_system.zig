@@ -171,8 +171,7 @@ const light_system_shaderable = render_viewport.ShaderableComponentI.implement(
             entites_idx: ?[]const usize,
             transforms: []const transform.WorldTransformComponent,
             data: []*anyopaque,
-            volume_type: render_viewport.BoundingVolumeType,
-            volumes: []u8,
+            volumes: render_viewport.BoundingVolumes,
         ) !void {
             var zz = profiler.ZoneN(@src(), "Light system - Culling callback");
             defer zz.End();
@@ -193,10 +192,8 @@ const light_system_shaderable = render_viewport.ShaderableComponentI.implement(
                 }
             }
 
-            switch (volume_type) {
-                .sphere => {
-                    var sphere_out_volumes = std.mem.bytesAsSlice(render_viewport.SphereBoudingVolume, volumes);
-
+            switch (volumes) {
+                .sphere => |sphere_out_volumes| {
                     for (lights.items, 0..) |l, idx| {
                         var dc_visibility_flags = visibility_flags.VisibilityFlags.initEmpty();
                         dc_visibility_flags.set(0); // TODO:
@@ -209,15 +206,15 @@ const light_system_shaderable = render_viewport.ShaderableComponentI.implement(
 
                         switch (l.type) {
                             .Point => {
-                                sphere_out_volumes[idx] = .{
+                                sphere_out_volumes.set(idx, .init(.{
                                     .sphere = .{ .center = position, .radius = l.radius },
                                     .visibility_mask = dc_visibility_flags,
-                                };
+                                }));
                             },
                             .Spot => {
                                 const forward = wt.getAxisZ();
 
-                                sphere_out_volumes[idx] = .{
+                                sphere_out_volumes.set(idx, .init(.{
                                     .sphere = .calcBoundingSphereForCone(
                                         position,
                                         forward,
@@ -225,21 +222,19 @@ const light_system_shaderable = render_viewport.ShaderableComponentI.implement(
                                         std.math.degreesToRadians(l.angle_outer),
                                     ),
                                     .visibility_mask = dc_visibility_flags,
-                                };
+                                }));
                             },
                             .Direction => {
-                                sphere_out_volumes[idx] = .{
+                                sphere_out_volumes.set(idx, .{
                                     .skip_culling = true,
                                     .visibility_mask = dc_visibility_flags,
-                                };
+                                });
                             },
                         }
                     }
                 },
 
-                .box => {
-                    var box_out_volumes = std.mem.bytesAsSlice(render_viewport.BoxBoudingVolume, volumes);
-
+                .box => |box_out_volumes| {
                     for (lights.items, 0..) |l, idx| {
                         var dc_visibility_flags = visibility_flags.VisibilityFlags.initEmpty();
                         dc_visibility_flags.set(0); // TODO:
@@ -249,33 +244,29 @@ const light_system_shaderable = render_viewport.ShaderableComponentI.implement(
 
                         switch (l.type) {
                             .Point => {
-                                box_out_volumes[idx] = .{
+                                box_out_volumes.set(idx, .{
                                     .skip_culling = true,
                                     .visibility_mask = dc_visibility_flags,
-                                };
+                                });
                             },
                             .Spot => {
                                 const r = l.radius * std.math.tan(std.math.degreesToRadians(l.angle_outer));
-                                box_out_volumes[idx] = .{
+                                box_out_volumes.set(idx, .init(.{
                                     .t = t.world,
                                     .min = .{ .x = -r, .y = -r },
                                     .max = .{ .x = r, .y = r, .z = l.radius },
                                     .visibility_mask = dc_visibility_flags,
-                                };
+                                }));
                             },
                             .Direction => {
-                                box_out_volumes[idx] = .{
+                                box_out_volumes.set(idx, .{
                                     .skip_culling = true,
                                     .visibility_mask = dc_visibility_flags,
-                                };
+                                });
                             },
                         }
                     }
                 },
-
-                else => |v| {
-                    log.err("Invalid bounding volume {d}", .{v});
-                },
             }
         }
 
@@ -497,8 +497,7 @@ const render_component_renderer_i = render_viewport.RendereableComponentI.implem
             entites_idx: ?[]const usize,
             transforms: []const transform.WorldTransformComponent,
             data: []*anyopaque,
-            volume_type: render_viewport.BoundingVolumeType,
-            volumes: []u8,
+            volumes: render_viewport.BoundingVolumes,
         ) !void {
             var zz = profiler.ZoneN(@src(), "RenderComponent - fillBoundingVolumes");
             defer zz.End();
@@ -543,10 +542,8 @@ const render_component_renderer_i = render_viewport.RendereableComponentI.implem
                 var zzz = profiler.ZoneN(@src(), "RenderComponent - write volumes");
                 defer zzz.End();
 
-                switch (volume_type) {
-                    .sphere => {
-                        var sphere_out_volumes = std.mem.bytesAsSlice(render_viewport.SphereBoudingVolume, volumes);
-
+                switch (volumes) {
+                    .sphere => |sphere_out_volumes| {
                         for (culling_volumes, draw_calls, 0..) |volume, draw_call, idx| {
                             const dc_visibility_flags = if (draw_call) |dc| dc.visibility_mask else visibility_flags.VisibilityFlags.initEmpty();
 
@@ -556,21 +553,19 @@ const render_component_renderer_i = render_viewport.RendereableComponentI.implem
 
                                     const origin = transforms[tidx].world.position;
 
-                                    sphere_out_volumes[idx] = .{
+                                    sphere_out_volumes.set(idx, .init(.{
                                         .sphere = .{ .center = origin, .radius = v.radius },
                                         .visibility_mask = dc_visibility_flags,
-                                    };
+                                    }));
                                 } else {
-                                    sphere_out_volumes[idx] = .{ .visibility_mask = dc_visibility_flags, .skip_culling = true };
+                                    sphere_out_volumes.set(idx, .{ .visibility_mask = dc_visibility_flags, .skip_culling = true });
                                 }
                             } else {
-                                sphere_out_volumes[idx] = .{ .visibility_mask = dc_visibility_flags, .skip_culling = true };
+                                sphere_out_volumes.set(idx, .{ .visibility_mask = dc_visibility_flags, .skip_culling = true });
                             }
                         }
                     },
-                    .box => {
-                        var box_out_volumes = std.mem.bytesAsSlice(render_viewport.BoxBoudingVolume, volumes);
-
+                    .box => |box_out_volumes| {
                         for (culling_volumes, draw_calls, 0..) |volume, draw_call, idx| {
                             const dc_visibility_flags: visibility_flags.VisibilityFlags = if (draw_call) |dc| dc.visibility_mask else .initEmpty();
 
@@ -578,23 +573,20 @@ const render_component_renderer_i = render_viewport.RendereableComponentI.implem
                                 const tidx = if (entites_idx) |idxs| idxs[idx] else idx;
                                 const t = transforms[tidx];
                                 if (v.hasBox()) {
-                                    box_out_volumes[idx] = .{
+                                    box_out_volumes.set(idx, .init(.{
                                         .t = t.world,
                                         .min = v.min,
                                         .max = v.max,
                                         .visibility_mask = dc_visibility_flags,
-                                    };
+                                    }));
                                 } else {
-                                    box_out_volumes[idx] = .{ .visibility_mask = dc_visibility_flags, .skip_culling = true };
+                                    box_out_volumes.set(idx, .{ .visibility_mask = dc_visibility_flags, .skip_culling = true });
                                 }
                             } else {
-                                box_out_volumes[idx] = .{ .visibility_mask = dc_visibility_flags, .skip_culling = true };
+                                box_out_volumes.set(idx, .{ .visibility_mask = dc_visibility_flags, .skip_culling = true });
                             }
                         }
                     },
-                    else => |v| {
-                        log.err("Invalid bounding volume {d}", .{v});
-                    },
                 }
             }
         }
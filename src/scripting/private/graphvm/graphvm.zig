@@ -46,6 +46,7 @@ const G = struct {
     value_type_iface_cdb_map: ValueTypeIfaceMap = undefined,
     graph_to_compile: ChangedObjsSet = undefined,
     string_intern: StringIntern = undefined,
+    graph_changes: ?cdb.ChangeConsumer = null,
 };
 var _g: *G = undefined;
 
@@ -441,16 +442,16 @@ const VMInstance = struct {
     }
 };
 
-const RebuildTask = struct {
+const RebuildRange = struct {
     instances: []const *VMInstance,
     changed_nodes: *const IdxSet,
     deleted_nodes: *const NodeSet,
     vm: *GraphVM,
 
-    pub fn exec(self: *const @This()) !void {
+    pub fn exec(self: *const @This(), range: cetech1.task.Range) !void {
         const alloc = try tempalloc.create();
         defer tempalloc.destroy(alloc);
-        try self.vm.buildInstances(alloc, self.instances, self.deleted_nodes, self.changed_nodes, true);
+        try self.vm.buildInstances(alloc, self.instances[range.begin..range.end], self.deleted_nodes, self.changed_nodes, true);
     }
 };
 const VMNodeMultiArray = std.MultiArrayList(VMNode);
@@ -1585,38 +1586,13 @@ const GraphVM = struct {
                 inst_count += 1;
             }
 
-            const ARGS = struct {
-                items: []const *VMInstance,
-                changed_nodes: *const IdxSet,
-                deleted_nodes: *const NodeSet,
-                vm: *GraphVM,
+            const rebuild_range = RebuildRange{
+                .instances = instances[0..inst_count],
+                .changed_nodes = &changed_nodes,
+                .deleted_nodes = &deleted_nodes,
+                .vm = self,
             };
-
-            if (try cetech1.task.batchWorkloadTask(
-                .{
-                    .allocator = allocator,
-
-                    .count = inst_count,
-                },
-                ARGS{
-                    .items = instances[0..inst_count],
-                    .changed_nodes = &changed_nodes,
-                    .deleted_nodes = &deleted_nodes,
-                    .vm = self,
-                },
-                struct {
-                    pub fn createTask(create_args: ARGS, batch_id: usize, args: cetech1.task.BatchWorkloadArgs, count: usize) RebuildTask {
-                        return RebuildTask{
-                            .instances = create_args.items[batch_id * args.batch_size .. (batch_id * args.batch_size) + count],
-                            .changed_nodes = create_args.changed_nodes,
-                            .deleted_nodes = create_args.deleted_nodes,
-                            .vm = create_args.vm,
-                        };
-                    }
-                },
-            )) |t| {
-                task.wait(t);
-            }
+            try cetech1.task.parallelFor(.{ .count = inst_count }, &rebuild_range, RebuildRange);
         }
 
         var deleted_it = deleted_nodes.iterator();
@@ -2303,17 +2279,23 @@ fn destroyInstance(vmc: public.GraphInstance) void {
     vm.destroyInstance(@ptrCast(@alignCast(vmc.inst)));
 }
 
-const executeNodesTask = struct {
+const executeNodesRange = struct {
     instances: []const public.GraphInstance,
     instance_idx: []const usize,
     out_states: ?[]?*anyopaque,
     event_hash: cetech1.StrId32,
     vm: *GraphVM,
 
-    pub fn exec(self: *const @This()) !void {
+    pub fn exec(self: *const @This(), range: cetech1.task.Range) !void {
         const alloc = try tempalloc.create();
         defer tempalloc.destroy(alloc);
-        try self.vm.executeNodesMany(alloc, self.instances, self.event_hash, self.out_states, self.instance_idx);
+        try self.vm.executeNodesMany(
+            alloc,
+            self.instances[range.begin..range.end],
+            self.event_hash,
+            self.out_states,
+            self.instance_idx[range.begin..range.end],
+        );
     }
 };
 
@@ -2436,50 +2418,37 @@ fn executeNodes(allocator: std.mem.Allocator, instances: []const public.GraphIns
     var clusters = try clusterByGraph(allocator, sorted_instances, instance_idx);
     defer clusters.deinit(allocator);
 
+    // Every cluster is own task so small clusters run in parallel, big ones are split inside.
+    const ExecuteClusterTask = struct {
+        range: executeNodesRange,
+        pub fn exec(self: *@This()) !void {
+            try cetech1.task.parallelFor(.{ .count = self.range.instances.len }, &self.range, executeNodesRange);
+        }
+    };
+
     var tasks = try cetech1.task.TaskIdList.initCapacity(allocator, clusters.instances.len);
     defer tasks.deinit(allocator);
 
-    const ARGS = struct {
-        instances: []const public.GraphInstance,
-        instance_idx: []const usize,
-        event_hash: cetech1.StrId32,
-        cfg: public.ExecuteConfig,
-        vm: *GraphVM,
-    };
-
     for (clusters.instances, 0..) |cluster, cluster_idx| {
-        if (try cetech1.task.batchWorkloadTask(
-            .{
-                .allocator = allocator,
+        if (cluster.len == 0) continue;
+
+        const execute_range = executeNodesRange{
+            .event_hash = event_hash,
+            .instances = cluster,
+            .instance_idx = clusters.instances_idx.?[cluster_idx],
+            .out_states = if (cfg.out_states) |out| out else null,
+            .vm = _g.vm_map.get(cluster[0].graph).?,
+        };
 
-                .count = cluster.len,
-                .batch_size = if (cfg.use_tasks) cetech1.task.default_batch_size else cluster.len,
-            },
-            ARGS{
-                .instances = cluster,
-                .instance_idx = clusters.instances_idx.?[cluster_idx],
-                .event_hash = event_hash,
-                .cfg = cfg,
-                .vm = _g.vm_map.get(clusters.instances[cluster_idx][0].graph).?,
-            },
-            struct {
-                pub fn createTask(create_args: ARGS, batch_id: usize, args: cetech1.task.BatchWorkloadArgs, count: usize) executeNodesTask {
-                    return executeNodesTask{
-                        .event_hash = create_args.event_hash,
-                        .instances = create_args.instances[batch_id * args.batch_size .. (batch_id * args.batch_size) + count],
-                        .instance_idx = create_args.instance_idx[batch_id * args.batch_size .. (batch_id * args.batch_size) + count],
-                        .out_states = if (create_args.cfg.out_states) |out| out else null,
-                        .vm = create_args.vm,
-                    };
-                }
-            },
-        )) |t| {
-            tasks.appendAssumeCapacity(t);
+        if (cfg.use_tasks) {
+            tasks.appendAssumeCapacity(try cetech1.task.schedule(.none, ExecuteClusterTask{ .range = execute_range }, .{}));
+        } else {
+            try execute_range.exec(.{ .begin = 0, .end = cluster.len });
         }
     }
 
     if (tasks.items.len != 0) {
-        task.waitMany(tasks.items);
+        cetech1.task.waitMany(tasks.items);
     }
 }
 
@@ -2860,7 +2829,9 @@ var update_task = cetech1.kernel.KernelTaskUpdateI.implment(
 
                 const db = assetdb.getDb();
 
-                const changed = try cdb.getChangeObjects(alloc, db, public.GraphTypeCdb.typeIdx(db), _last_check);
+                if (_g.graph_changes == null) _g.graph_changes = try cdb.addChangeConsumer(db, public.GraphTypeCdb.typeIdx(db));
+
+                const changed = try cdb.getConsumerChangeObjects(alloc, _g.graph_changes.?, _last_check);
                 defer alloc.free(changed.objects);
 
                 if (!changed.need_fullscan) {
@@ -3373,6 +3344,13 @@ pub fn load_module_zig(io: std.Io, allocator: Allocator, load: bool, reload: boo
     _allocator = allocator;
     public.api = &api;
 
+    // Consumer watermark pin change journal, drop it on unload and create again on first update.
+    if (!load) {
+        if (_g.graph_changes) |consumer| cdb.removeChangeConsumer(consumer);
+        _g.graph_changes = null;
+        _last_check = 0;
+    }
+
     // impl interface
     try apidb.implOrRemove(module_name, cetech1.kernel.KernelTaskI, &kernel_task, load);
     try apidb.implOrRemove(module_name, cetech1.kernel.KernelTaskUpdateI, &update_task, load);
@@ -30,6 +30,9 @@ const log = std.log.scoped(module_name);
 var _allocator: Allocator = undefined;
 
 var _luau_asset_io_i = assetdb.AssetIOI.implement(struct {
+    // Bump if bytecode output change (compile options, luau version).
+    pub const import_cache_version: u32 = 1;
+
     pub fn canImport(filename: []const u8, _: []const u8) bool {
         const extension = std.fs.path.extension(filename);
         return std.ascii.eqlIgnoreCase(extension, ".luau");
@@ -103,7 +106,7 @@ var _luau_asset_io_i = assetdb.AssetIOI.implement(struct {
                 .filename = filename,
                 .reimport_to = reimport_to,
             },
-            .{},
+            .{ .priority = .background },
         );
     }
 });